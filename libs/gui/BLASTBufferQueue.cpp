@@ -1242,11 +1242,8 @@ public:
         UnlockGuard unlockGuard{bufferQueueLock};
 
         ATRACE_FORMAT("waiting for free buffer");
-        ReleaseCallbackId id;
-        sp<Fence> fence;
-        uint32_t maxAcquiredBufferCount;
-        status_t status =
-                bbq->mBufferReleaseReader->readBlocking(id, fence, maxAcquiredBufferCount, timeout);
+        std::vector<gui::BufferReleaseChannel::Message> messages;
+        status_t status = bbq->mBufferReleaseReader->readBlocking(messages, timeout);
         if (status == TIMED_OUT) {
             return TIMED_OUT;
         } else if (status != OK) {
@@ -1255,7 +1252,7 @@ public:
             return OK;
         }
 
-        bbq->releaseBufferCallback(id, fence, maxAcquiredBufferCount);
+        bbq->releaseBufferCallbacks(messages);
         const nsecs_t durationNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
                                               std::chrono::steady_clock::now() - startTime)
                                               .count();
@@ -1384,16 +1381,20 @@ void BLASTBufferQueue::updateBufferReleaseProducer() {
 
 void BLASTBufferQueue::drainBufferReleaseConsumer() {
     ATRACE_CALL();
-    while (true) {
-        ReleaseCallbackId id;
-        sp<Fence> fence;
-        uint32_t maxAcquiredBufferCount;
-        status_t status =
-                mBufferReleaseConsumer->readReleaseFence(id, fence, maxAcquiredBufferCount);
-        if (status != OK) {
-            return;
-        }
-        releaseBufferCallback(id, fence, maxAcquiredBufferCount);
+    std::vector<gui::BufferReleaseChannel::Message> messages;
+    if (mBufferReleaseConsumer->readReleaseFences(messages) != OK) {
+        return;
+    }
+    releaseBufferCallbacks(messages);
+}
+
+void BLASTBufferQueue::releaseBufferCallbacks(
+        const std::vector<gui::BufferReleaseChannel::Message>& messages) {
+    std::lock_guard _lock{mMutex};
+    BBQ_TRACE();
+    for (const auto& message : messages) {
+        releaseBufferCallbackLocked(message.releaseCallbackId, message.releaseFence,
+                                    message.maxAcquiredBufferCount, false /* fakeRelease */);
     }
 }
 
@@ -1430,10 +1431,8 @@ BLASTBufferQueue::BufferReleaseReader::BufferReleaseReader(BLASTBufferQueue& bbq
                         errno, strerror(errno));
 }
 
-status_t BLASTBufferQueue::BufferReleaseReader::readBlocking(ReleaseCallbackId& outId,
-                                                             sp<Fence>& outFence,
-                                                             uint32_t& outMaxAcquiredBufferCount,
-                                                             nsecs_t timeout) {
+status_t BLASTBufferQueue::BufferReleaseReader::readBlocking(
+        std::vector<gui::BufferReleaseChannel::Message>& outMessages, nsecs_t timeout) {
     // TODO(b/363290953) epoll_wait only has millisecond timeout precision. If timeout is less than
     // 1ms, then we round timeout up to 1ms. Otherwise, we round timeout to the nearest
     // millisecond. Once epoll_pwait2 can be used in libgui, we can specify timeout with nanosecond
@@ -1473,8 +1472,7 @@ status_t BLASTBufferQueue::BufferReleaseReader::readBlocking(ReleaseCallbackId&
         return WOULD_BLOCK;
     }
 
-    return mBbq.mBufferReleaseConsumer->readReleaseFence(outId, outFence,
-                                                         outMaxAcquiredBufferCount);
+    return mBbq.mBufferReleaseConsumer->readReleaseFences(outMessages);
 }
 
 void BLASTBufferQueue::BufferReleaseReader::interruptBlockingRead() {
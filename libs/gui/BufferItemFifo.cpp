@@ -0,0 +1,60 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gui/BufferItemFifo.h>
+
+namespace android {
+
+namespace {
+// Enough for the usual double and triple buffering without growing.
+constexpr size_t kInitialCapacity = 4;
+} // namespace
+
+void BufferItemFifo::push_back(const BufferItem& item) {
+    if (size() == mItems.size()) {
+        grow();
+    }
+    mItems[mTail & (mItems.size() - 1)] = item;
+    ++mTail;
+}
+
+void BufferItemFifo::pop_front() {
+    if (empty()) {
+        return;
+    }
+    // Drop the references of the item, as erasing it from a vector would.
+    mItems[mHead & (mItems.size() - 1)] = BufferItem();
+    ++mHead;
+}
+
+void BufferItemFifo::clear() {
+    for (BufferItem& item : *this) {
+        item = BufferItem();
+    }
+    mHead = mTail;
+}
+
+void BufferItemFifo::grow() {
+    // Items keep their positions, so that the head and tail stay valid.
+    const size_t count = size();
+    std::vector<BufferItem> items(mItems.empty() ? kInitialCapacity : mItems.size() * 2);
+    for (size_t i = 0; i < count; i++) {
+        items[(mHead + i) & (items.size() - 1)] = (*this)[i];
+    }
+    mItems = std::move(items);
+}
+
+} // namespace android
@@ -206,7 +206,7 @@ status_t BufferQueueConsumer::acquireBuffer(BufferItem* outBuffer,
                     ++numDroppedBuffers;
                 }
 
-                mCore->mQueue.erase(front);
+                mCore->mQueue.pop_front();
                 front = mCore->mQueue.begin();
             }
 
@@ -297,7 +297,7 @@ status_t BufferQueueConsumer::acquireBuffer(BufferItem* outBuffer,
             outBuffer->mGraphicBuffer = nullptr;
         }
 
-        mCore->mQueue.erase(front);
+        mCore->mQueue.pop_front();
 
         // We might have freed a slot while dropping old buffers, or the producer
         // may be blocked waiting for the number of buffers in the queue to
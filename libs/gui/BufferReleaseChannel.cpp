@@ -17,12 +17,19 @@
 #define LOG_TAG "BufferReleaseChannel"
 
 #include <fcntl.h>
+#include <unistd.h>
+#include <inttypes.h>
 #include <sys/socket.h>
 #include <sys/uio.h>
 
+#include <algorithm>
+#include <array>
+#include <iterator>
+
 #include <android-base/result.h>
 #include <android/binder_status.h>
 #include <binder/Parcel.h>
+#include <ftl/finalizer.h>
 #include <utils/Flattenable.h>
 
 #include <gui/BufferReleaseChannel.h>
@@ -67,6 +74,11 @@ inline constexpr T to64(const uint32_t lo, const uint32_t hi) {
     return static_cast<T>(static_cast<uint64_t>(hi) << 32 | lo);
 }
 
+// Packets written by writeReleaseFences start with this magic value and the number of messages
+// in the batch.
+constexpr uint32_t kBatchMagic = 0x42524342; // 'BRCB'
+constexpr size_t kBatchHeaderSize = 2 * sizeof(uint32_t);
+
 } // namespace
 
 size_t BufferReleaseChannel::Message::getPodSize() const {
@@ -137,9 +149,46 @@ status_t BufferReleaseChannel::ConsumerEndpoint::readReleaseFence(
         ReleaseCallbackId& outReleaseCallbackId, sp<Fence>& outReleaseFence,
         uint32_t& outMaxAcquiredBufferCount) {
     std::lock_guard lock{mMutex};
-    Message message;
-    mFlattenedBuffer.resize(message.getFlattenedSize());
-    std::array<uint8_t, CMSG_SPACE(sizeof(int))> controlMessageBuffer{};
+    if (mNextPendingMessage == mPendingMessages.size()) {
+        mPendingMessages.clear();
+        mNextPendingMessage = 0;
+        if (status_t err = receiveLocked(mPendingMessages); err != OK) {
+            return err;
+        }
+    }
+
+    Message& message = mPendingMessages[mNextPendingMessage++];
+    outReleaseCallbackId = message.releaseCallbackId;
+    outReleaseFence = std::move(message.releaseFence);
+    outMaxAcquiredBufferCount = message.maxAcquiredBufferCount;
+
+    return OK;
+}
+
+status_t BufferReleaseChannel::ConsumerEndpoint::readReleaseFences(
+        std::vector<Message>& outMessages) {
+    std::lock_guard lock{mMutex};
+    const size_t initialSize = outMessages.size();
+    outMessages.insert(outMessages.end(),
+                       std::make_move_iterator(mPendingMessages.begin() + mNextPendingMessage),
+                       std::make_move_iterator(mPendingMessages.end()));
+    mPendingMessages.clear();
+    mNextPendingMessage = 0;
+
+    status_t err;
+    do {
+        err = receiveLocked(outMessages);
+    } while (err == OK);
+
+    if (outMessages.size() > initialSize) {
+        return OK;
+    }
+    return err;
+}
+
+status_t BufferReleaseChannel::ConsumerEndpoint::receiveLocked(std::vector<Message>& outMessages) {
+    mFlattenedBuffer.resize(kBatchHeaderSize + kMaxBatchSize * Message().getFlattenedSize());
+    std::array<uint8_t, CMSG_SPACE(sizeof(int) * kMaxBatchSize)> controlMessageBuffer{};
 
     iovec iov{
             .iov_base = mFlattenedBuffer.data(),
@@ -164,38 +213,65 @@ status_t BufferReleaseChannel::ConsumerEndpoint::readReleaseFence(
         return UNKNOWN_ERROR;
     }
 
-    if (msg.msg_iovlen != 1) {
+    // Unflattening a message takes its fd off the front. Whatever is left once the packet is
+    // handled, because it was rejected partway through or carried extra fds, is closed.
+    size_t fdCount = 0;
+    const int* fdData = nullptr;
+    if (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg)) {
+        fdData = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+        fdCount = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    }
+    const auto closeUnusedFds = ftl::Finalizer([&fdData, &fdCount] {
+        for (size_t i = 0; i < fdCount; i++) {
+            close(fdData[i]);
+        }
+    });
+
+    if (msg.msg_iovlen != 1 || (msg.msg_flags & MSG_TRUNC)) {
         ALOGE("Error reading release fence from socket: bad data length");
         return UNKNOWN_ERROR;
     }
 
-    if (msg.msg_controllen % sizeof(int) != 0) {
+    if (msg.msg_controllen % sizeof(int) != 0 || (msg.msg_flags & MSG_CTRUNC)) {
         ALOGE("Error reading release fence from socket: bad fd length");
         return UNKNOWN_ERROR;
     }
 
-    size_t dataLen = msg.msg_iov->iov_len;
+    size_t dataLen = static_cast<size_t>(result);
     const void* data = static_cast<const void*>(msg.msg_iov->iov_base);
     if (!data) {
         ALOGE("Error reading release fence from socket: no buffer data");
         return UNKNOWN_ERROR;
     }
 
-    size_t fdCount = 0;
-    const int* fdData = nullptr;
-    if (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg)) {
-        fdData = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
-        fdCount = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    // A packet holds either a single message, written by writeReleaseFence, or a batch header
+    // followed by the messages of the batch. A single message starts with the fd count of its
+    // fence, which can't be mistaken for the batch magic.
+    uint32_t messageCount = 1;
+    if (dataLen >= kBatchHeaderSize &&
+        *static_cast<const uint32_t*>(data) == kBatchMagic) {
+        uint32_t magic;
+        readAligned(data, dataLen, magic);
+        readAligned(data, dataLen, messageCount);
+        if (messageCount == 0 || messageCount > kMaxBatchSize) {
+            ALOGE("Error reading release fence from socket: bad batch size %" PRIu32,
+                  messageCount);
+            return UNKNOWN_ERROR;
+        }
     }
 
-    if (status_t err = message.unflatten(data, dataLen, fdData, fdCount); err != OK) {
-        return err;
+    for (uint32_t i = 0; i < messageCount; i++) {
+        Message message;
+        if (dataLen < message.getFlattenedSize()) {
+            ALOGE("Error reading release fence from socket: truncated batch");
+            return UNKNOWN_ERROR;
+        }
+        if (status_t err = message.unflatten(data, dataLen, fdData, fdCount); err != OK) {
+            return err;
+        }
+        outMessages.push_back(std::move(message));
     }
 
-    outReleaseCallbackId = message.releaseCallbackId;
-    outReleaseFence = std::move(message.releaseFence);
-    outMaxAcquiredBufferCount = message.maxAcquiredBufferCount;
-
     return OK;
 }
 
@@ -250,6 +326,80 @@ status_t BufferReleaseChannel::ProducerEndpoint::writeReleaseFence(
     return OK;
 }
 
+status_t BufferReleaseChannel::ProducerEndpoint::writeReleaseFences(
+        const std::vector<Message>& messages) {
+    for (size_t first = 0; first < messages.size(); first += kMaxBatchSize) {
+        const size_t count = std::min(kMaxBatchSize, messages.size() - first);
+        if (status_t status = writeBatch(&messages[first], count); status != OK) {
+            return status;
+        }
+    }
+    return OK;
+}
+
+status_t BufferReleaseChannel::ProducerEndpoint::writeBatch(const Message* messages,
+                                                           size_t count) {
+    if (count == 1) {
+        return writeReleaseFence(messages[0].releaseCallbackId, messages[0].releaseFence,
+                                 messages[0].maxAcquiredBufferCount);
+    }
+
+    size_t size = kBatchHeaderSize;
+    for (size_t i = 0; i < count; i++) {
+        size += messages[i].getFlattenedSize();
+    }
+    mFlattenedBuffer.resize(size);
+
+    std::array<int, kMaxBatchSize> flattenedFds;
+    size_t fdCount = 0;
+    {
+        void* flattenedBufferPtr = mFlattenedBuffer.data();
+        size_t flattenedBufferSize = mFlattenedBuffer.size();
+        int* flattenedFdPtr = flattenedFds.data();
+        size_t flattenedFdCount = flattenedFds.size();
+        writeAligned(flattenedBufferPtr, flattenedBufferSize, kBatchMagic);
+        writeAligned(flattenedBufferPtr, flattenedBufferSize, static_cast<uint32_t>(count));
+        for (size_t i = 0; i < count; i++) {
+            if (status_t status = messages[i].flatten(flattenedBufferPtr, flattenedBufferSize,
+                                                      flattenedFdPtr, flattenedFdCount);
+                status != OK) {
+                return status;
+            }
+        }
+        fdCount = flattenedFds.size() - flattenedFdCount;
+    }
+
+    iovec iov{};
+    iov.iov_base = mFlattenedBuffer.data();
+    iov.iov_len = mFlattenedBuffer.size();
+
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    std::array<uint8_t, CMSG_SPACE(sizeof(int) * kMaxBatchSize)> controlMessageBuffer{};
+    if (fdCount > 0) {
+        msg.msg_control = controlMessageBuffer.data();
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * fdCount);
+
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fdCount);
+        memcpy(CMSG_DATA(cmsg), flattenedFds.data(), sizeof(int) * fdCount);
+    }
+
+    ssize_t result;
+    do {
+        result = sendmsg(mFd, &msg, 0);
+    } while (result == -1 && errno == EINTR);
+    if (result == -1) {
+        return -errno;
+    }
+
+    return OK;
+}
+
 status_t BufferReleaseChannel::ProducerEndpoint::readFromParcel(const android::Parcel* parcel) {
     if (!parcel) return STATUS_BAD_VALUE;
     SAFE_PARCEL(parcel->readUtf8FromUtf16, &mName);
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gui/BufferSlotList.h>
+
+#include <algorithm>
+
+#include <ui/BufferQueueDefs.h>
+
+namespace android {
+
+BufferSlotList::BufferSlotList()
+      : mNext(BufferQueueDefs::NUM_BUFFER_SLOTS, kNone),
+        mPrev(BufferQueueDefs::NUM_BUFFER_SLOTS, kUnlisted) {}
+
+void BufferSlotList::push_front(int slot) {
+    if (contains(slot)) {
+        return;
+    }
+    prepare(slot);
+    mNext[slot] = mHead;
+    mPrev[slot] = kNone;
+    if (mHead != kNone) {
+        mPrev[mHead] = slot;
+    } else {
+        mTail = slot;
+    }
+    mHead = slot;
+    mSize++;
+}
+
+void BufferSlotList::push_back(int slot) {
+    if (contains(slot)) {
+        return;
+    }
+    prepare(slot);
+    mNext[slot] = kNone;
+    mPrev[slot] = mTail;
+    if (mTail != kNone) {
+        mNext[mTail] = slot;
+    } else {
+        mHead = slot;
+    }
+    mTail = slot;
+    mSize++;
+}
+
+void BufferSlotList::remove(int slot) {
+    if (!contains(slot)) {
+        return;
+    }
+    const int next = mNext[slot];
+    const int prev = mPrev[slot];
+    if (prev != kNone) {
+        mNext[prev] = next;
+    } else {
+        mHead = next;
+    }
+    if (next != kNone) {
+        mPrev[next] = prev;
+    } else {
+        mTail = prev;
+    }
+    mNext[slot] = kNone;
+    mPrev[slot] = kUnlisted;
+    mSize--;
+}
+
+void BufferSlotList::clear() {
+    std::fill(mNext.begin(), mNext.end(), kNone);
+    std::fill(mPrev.begin(), mPrev.end(), kUnlisted);
+    mHead = kNone;
+    mTail = kNone;
+    mSize = 0;
+}
+
+void BufferSlotList::prepare(int slot) {
+    if (static_cast<size_t>(slot) >= mPrev.size()) {
+        mNext.resize(slot + 1, kNone);
+        mPrev.resize(slot + 1, kUnlisted);
+    }
+}
+
+} // namespace android
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gui/BufferSlotSet.h>
+
+#include <algorithm>
+
+#include <ui/BufferQueueDefs.h>
+
+namespace android {
+
+BufferSlotSet::BufferSlotSet()
+      : mWords((BufferQueueDefs::NUM_BUFFER_SLOTS + kBitsPerWord - 1) / kBitsPerWord) {}
+
+size_t BufferSlotSet::count(int slot) const {
+    const size_t word = static_cast<size_t>(slot) / kBitsPerWord;
+    if (slot < 0 || word >= mWords.size()) {
+        return 0;
+    }
+    return (mWords[word] >> (slot % kBitsPerWord)) & 1;
+}
+
+void BufferSlotSet::insert(int slot) {
+    const size_t word = static_cast<size_t>(slot) / kBitsPerWord;
+    if (word >= mWords.size()) {
+        mWords.resize(word + 1);
+    }
+    const Word bit = Word(1) << (slot % kBitsPerWord);
+    if (!(mWords[word] & bit)) {
+        mWords[word] |= bit;
+        mSize++;
+    }
+}
+
+void BufferSlotSet::erase(int slot) {
+    const size_t word = static_cast<size_t>(slot) / kBitsPerWord;
+    if (slot < 0 || word >= mWords.size()) {
+        return;
+    }
+    const Word bit = Word(1) << (slot % kBitsPerWord);
+    if (mWords[word] & bit) {
+        mWords[word] &= ~bit;
+        mSize--;
+    }
+}
+
+void BufferSlotSet::clear() {
+    std::fill(mWords.begin(), mWords.end(), 0);
+    mSize = 0;
+}
+
+int BufferSlotSet::next(int from) const {
+    size_t word = static_cast<size_t>(from) / kBitsPerWord;
+    if (word >= mWords.size()) {
+        return kEnd;
+    }
+    // Drop the bits below from in its word, then look for the first set bit.
+    Word bits = mWords[word] & (~Word(0) << (from % kBitsPerWord));
+    while (bits == 0) {
+        if (++word == mWords.size()) {
+            return kEnd;
+        }
+        bits = mWords[word];
+    }
+    return static_cast<int>(word) * kBitsPerWord + __builtin_ctzll(bits);
+}
+
+} // namespace android
@@ -17,6 +17,7 @@
 // #define LOG_NDEBUG 0
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 
+#include <com_android_graphics_libgui_flags.h>
 #include <gui/Choreographer.h>
 #include <gui/TraceUtils.h>
 #include <jni.h>
@@ -72,6 +73,13 @@ Choreographer::Context Choreographer::gChoreographers;
 
 static thread_local sp<Choreographer> gChoreographer;
 
+static EventRegistrationFlags eventRegistration() {
+    if (com::android::graphics::libgui::flags::vsync_broadcast()) {
+        return {gui::ISurfaceComposer::EventRegistration::vsyncBroadcast};
+    }
+    return {};
+}
+
 void Choreographer::initJVM(JNIEnv* env) {
     env->GetJavaVM(&gJni.jvm);
     // Now we need to find the java classes.
@@ -105,8 +113,8 @@ sp<Choreographer> Choreographer::getForThread() {
 }
 
 Choreographer::Choreographer(const sp<Looper>& looper, const sp<IBinder>& layerHandle)
-      : DisplayEventDispatcher(looper, gui::ISurfaceComposer::VsyncSource::eVsyncSourceApp, {},
-                               layerHandle),
+      : DisplayEventDispatcher(looper, gui::ISurfaceComposer::VsyncSource::eVsyncSourceApp,
+                               eventRegistration(), layerHandle),
         mLooper(looper),
         mThreadId(std::this_thread::get_id()) {
     std::lock_guard<std::mutex> _l(gChoreographers.lock);
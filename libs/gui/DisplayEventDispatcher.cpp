@@ -63,6 +63,13 @@ status_t DisplayEventDispatcher::initialize() {
         if (rc < 0) {
             return UNKNOWN_ERROR;
         }
+        if (mReceiver.getVsyncFd() >= 0) {
+            rc = mLooper->addFd(mReceiver.getVsyncFd(), 0, Looper::EVENT_INPUT, this, NULL);
+            if (rc < 0) {
+                mLooper->removeFd(mReceiver.getFd());
+                return UNKNOWN_ERROR;
+            }
+        }
     }
 
     return OK;
@@ -73,6 +80,9 @@ void DisplayEventDispatcher::dispose() {
 
     if (!mReceiver.initCheck() && mLooper != nullptr) {
         mLooper->removeFd(mReceiver.getFd());
+        if (mReceiver.getVsyncFd() >= 0) {
+            mLooper->removeFd(mReceiver.getVsyncFd());
+        }
     }
 }
 
@@ -21,6 +21,7 @@
 #include <utils/Errors.h>
 
 #include <gui/DisplayEventReceiver.h>
+#include <gui/VsyncBroadcast.h>
 #include <gui/VsyncEventData.h>
 
 #include <private/gui/ComposerServiceAIDL.h>
@@ -53,6 +54,9 @@ DisplayEventReceiver::DisplayEventReceiver(gui::ISurfaceComposer::VsyncSource vs
                 mInitError = std::make_optional<status_t>(status.transactionError());
                 mDataChannel.reset();
                 mEventConnection.clear();
+            } else if (eventRegistration.test(
+                               gui::ISurfaceComposer::EventRegistration::vsyncBroadcast)) {
+                openVsyncBroadcast();
             }
         } else {
             ALOGE("DisplayEventConnection creation failed: status=%s", status.toString8().c_str());
@@ -63,6 +67,25 @@ DisplayEventReceiver::DisplayEventReceiver(gui::ISurfaceComposer::VsyncSource vs
 DisplayEventReceiver::~DisplayEventReceiver() {
 }
 
+void DisplayEventReceiver::openVsyncBroadcast() {
+    gui::VsyncBroadcastChannel channel;
+    binder::Status status = mEventConnection->getVsyncBroadcast(&channel);
+    if (!status.isOk()) {
+        // Vsync events keep being delivered through the data channel.
+        ALOGW("getVsyncBroadcast failed: %s", status.toString8().c_str());
+        return;
+    }
+    // Vsync events are no longer delivered through the data channel, so the receiver is unusable
+    // without the broadcast.
+    status_t err = gui::VsyncBroadcastReceiver::open(std::move(channel), mVsyncBroadcast);
+    if (err != NO_ERROR) {
+        ALOGE("Failed to open the vsync broadcast: %d", err);
+        mInitError = std::make_optional<status_t>(err);
+        mDataChannel.reset();
+        mEventConnection.clear();
+    }
+}
+
 status_t DisplayEventReceiver::initCheck() const {
     if (mDataChannel != nullptr)
         return NO_ERROR;
@@ -75,6 +98,10 @@ int DisplayEventReceiver::getFd() const {
     return mDataChannel->getFd();
 }
 
+int DisplayEventReceiver::getVsyncFd() const {
+    return mVsyncBroadcast != nullptr ? mVsyncBroadcast->getFd() : -1;
+}
+
 status_t DisplayEventReceiver::setVsyncRate(uint32_t count) {
     if (int32_t(count) < 0)
         return BAD_VALUE;
@@ -109,7 +136,27 @@ status_t DisplayEventReceiver::getLatestVsyncEventData(
 
 ssize_t DisplayEventReceiver::getEvents(DisplayEventReceiver::Event* events,
         size_t count) {
-    return DisplayEventReceiver::getEvents(mDataChannel.get(), events, count);
+    if (mVsyncBroadcast == nullptr || count == 0) {
+        return DisplayEventReceiver::getEvents(mDataChannel.get(), events, count);
+    }
+
+    // The broadcast holds the latest vsync event, so it goes after the events of the data channel.
+    // The data channel is not read without room for an event, as a zero length read would drop
+    // the next one.
+    ssize_t n = 0;
+    if (count > 1) {
+        n = DisplayEventReceiver::getEvents(mDataChannel.get(), events, count - 1);
+        if (n < 0) {
+            return n;
+        }
+    }
+    if (mVsyncBroadcast->readVsync(events[n]) == NO_ERROR) {
+        return n + 1;
+    }
+    if (count == 1) {
+        return DisplayEventReceiver::getEvents(mDataChannel.get(), events, count);
+    }
+    return n;
 }
 
 ssize_t DisplayEventReceiver::getEvents(gui::BitTube* dataChannel,
@@ -199,9 +199,13 @@ FrameEvents* FrameEventHistory::getFrame(uint64_t frameNumber, size_t* iHint) {
 }
 
 void FrameEventHistory::checkFencesForCompletion() {
-    for (auto& frame : mFrames) {
-        frame.checkFencesForCompletion();
+    for (const auto& frame : mFrames) {
+        mFenceTimeBatch.add(frame.acquireFence);
+        mFenceTimeBatch.add(frame.gpuCompositionDoneFence);
+        mFenceTimeBatch.add(frame.displayPresentFence);
+        mFenceTimeBatch.add(frame.releaseFence);
     }
+    mFenceTimeBatch.updateSignalTimes();
 }
 
 // Uses !|valid| as the MSB.
@@ -319,10 +323,9 @@ void ProducerFrameEventHistory::applyDelta(
 }
 
 void ProducerFrameEventHistory::updateSignalTimes() {
-    mAcquireTimeline.updateSignalTimes();
-    mGpuCompositionDoneTimeline.updateSignalTimes();
-    mPresentTimeline.updateSignalTimes();
-    mReleaseTimeline.updateSignalTimes();
+    FenceTimeline::updateSignalTimes({&mAcquireTimeline, &mGpuCompositionDoneTimeline,
+                                      &mPresentTimeline, &mReleaseTimeline},
+                                     mFenceTimeBatch);
 }
 
 void ProducerFrameEventHistory::applyFenceDelta(FenceTimeline* timeline,
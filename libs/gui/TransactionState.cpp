@@ -88,6 +88,7 @@ status_t TransactionState::readFromParcel(const Parcel* parcel) {
 
     SAFE_PARCEL_READ_SIZE(parcel->readUint32, &count, parcel->dataSize())
     mComposerStates.clear();
+    mComposerStateIndex.clear();
     mComposerStates.reserve(count);
     for (size_t i = 0; i < count; i++) {
         ComposerState composerState;
@@ -153,18 +154,17 @@ void TransactionState::merge(TransactionState&& other,
     }
     mMergedTransactionIds.insert(mMergedTransactionIds.begin(), other.mId);
 
+    mComposerStates.reserve(mComposerStates.size() + other.mComposerStates.size());
     for (auto const& otherState : other.mComposerStates) {
-        if (auto it = std::find_if(mComposerStates.begin(), mComposerStates.end(),
-                                   [&otherState](const auto& composerState) {
-                                       return composerState.state.surface ==
-                                               otherState.state.surface;
-                                   });
-            it != mComposerStates.end()) {
+        const sp<IBinder>& surface = otherState.state.surface;
+        if (const auto index = mComposerStateIndex.find(mComposerStates, surface)) {
+            layer_state_t& state = mComposerStates[*index].state;
             if (otherState.state.what & layer_state_t::eBufferChanged) {
-                onBufferOverwrite(it->state);
+                onBufferOverwrite(state);
             }
-            it->state.merge(otherState.state);
+            state.merge(otherState.state);
         } else {
+            mComposerStateIndex.add(surface, mComposerStates.size());
             mComposerStates.push_back(otherState);
         }
     }
@@ -212,6 +212,7 @@ void TransactionState::mergeFrameTimelineInfo(const FrameTimelineInfo& other) {
 
 void TransactionState::clear() {
     mComposerStates.clear();
+    mComposerStateIndex.clear();
     mDisplayStates.clear();
     mListenerCallbacks.clear();
     mHasListenerCallbacks = false;
@@ -229,23 +230,49 @@ void TransactionState::clear() {
 
 layer_state_t* TransactionState::getLayerState(const sp<SurfaceControl>& sc) {
     auto handle = sc->getLayerStateHandle();
-    if (auto it = std::find_if(mComposerStates.begin(), mComposerStates.end(),
-                               [&handle](const auto& composerState) {
-                                   return composerState.state.surface == handle;
-                               });
-        it != mComposerStates.end()) {
-        return &it->state;
+    if (const auto index = mComposerStateIndex.find(mComposerStates, handle)) {
+        return &mComposerStates[*index].state;
     }
 
     // we don't have it, add an initialized layer_state to our list
     ComposerState s;
     s.state.surface = handle;
     s.state.layerId = sc->getLayerId();
+    mComposerStateIndex.add(handle, mComposerStates.size());
     mComposerStates.push_back(s);
 
     return &mComposerStates.back().state;
 }
 
+std::optional<size_t> TransactionState::ComposerStateIndex::find(
+        const std::vector<ComposerState>& composerStates, const sp<IBinder>& surface) {
+    if (mIndexedCount != composerStates.size()) {
+        rebuild(composerStates);
+    }
+    auto it = mIndices.find(surface);
+    if (it != mIndices.end() &&
+        (it->second >= composerStates.size() ||
+         composerStates[it->second].state.surface != surface)) {
+        rebuild(composerStates);
+        it = mIndices.find(surface);
+    }
+    if (it == mIndices.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void TransactionState::ComposerStateIndex::rebuild(
+        const std::vector<ComposerState>& composerStates) {
+    mIndices.clear();
+    mIndices.reserve(composerStates.size());
+    for (size_t i = 0; i < composerStates.size(); i++) {
+        // Like a scan of composerStates, the first state of a layer wins.
+        mIndices.emplace(composerStates[i].state.surface, i);
+    }
+    mIndexedCount = composerStates.size();
+}
+
 DisplayState& TransactionState::getDisplayState(const sp<IBinder>& token) {
     if (auto it = std::find_if(mDisplayStates.begin(), mDisplayStates.end(),
                                [token](const auto& display) { return display.token == token; });
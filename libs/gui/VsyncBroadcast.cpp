@@ -0,0 +1,216 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "VsyncBroadcast"
+
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <binder/ParcelFileDescriptor.h>
+#include <gui/VsyncBroadcast.h>
+#include <log/log.h>
+
+namespace android::gui {
+
+struct VsyncBroadcastMemory {
+    struct Record {
+        // Odd while the record is being written.
+        std::atomic<uint32_t> sequence;
+        // The version that the record was published with.
+        std::atomic<uint64_t> version;
+        DisplayEventReceiver::Event event;
+    };
+
+    // The version of the last published record, or 0 if none was.
+    std::atomic<uint64_t> latestVersion;
+    Record records[VsyncBroadcastPublisher::kRecordCount];
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(std::is_trivially_copyable_v<DisplayEventReceiver::Event>);
+
+namespace {
+
+// Number of times a receiver retries reading the latest record while it is being written or
+// overwritten, before giving up on it. The record being written is never the latest one, so this
+// is only reached if the publisher died in the middle of a write.
+constexpr int kMaxReadAttempts = 1000;
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+
+VsyncBroadcastPublisher::VsyncBroadcastPublisher(base::unique_fd wakeupFd,
+                                                 VsyncBroadcastMemory* memory)
+      : mWakeupFd(std::move(wakeupFd)), mMemory(memory) {}
+
+VsyncBroadcastPublisher::~VsyncBroadcastPublisher() {
+    munmap(mMemory, sizeof(VsyncBroadcastMemory));
+}
+
+status_t VsyncBroadcastPublisher::create(std::unique_ptr<VsyncBroadcastPublisher>& outPublisher,
+                                         VsyncBroadcastChannel& outChannel) {
+    base::unique_fd memoryFd(memfd_create("vsync broadcast", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+    if (!memoryFd.ok()) {
+        const int error = errno;
+        ALOGE("Failed to create the shared memory: %s", strerror(error));
+        return -error;
+    }
+    if (ftruncate(memoryFd.get(), sizeof(VsyncBroadcastMemory)) < 0) {
+        const int error = errno;
+        ALOGE("Failed to size the shared memory: %s", strerror(error));
+        return -error;
+    }
+    base::unique_fd wakeupFd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK));
+    base::unique_fd receiverWakeupFd;
+    if (wakeupFd.ok()) {
+        receiverWakeupFd.reset(fcntl(wakeupFd.get(), F_DUPFD_CLOEXEC, 0));
+    }
+    if (!receiverWakeupFd.ok()) {
+        const int error = errno;
+        ALOGE("Failed to create the wakeup eventfd: %s", strerror(error));
+        return -error;
+    }
+
+    void* address = mmap(nullptr, sizeof(VsyncBroadcastMemory), PROT_READ | PROT_WRITE,
+                         MAP_SHARED, memoryFd.get(), 0);
+    if (address == MAP_FAILED) {
+        const int error = errno;
+        ALOGE("Failed to map the shared memory: %s", strerror(error));
+        return -error;
+    }
+    // The mapping above stays writable, but no other one can be, so that the receiver cannot
+    // tamper with the records.
+    if (fcntl(memoryFd.get(), F_ADD_SEALS,
+              F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_FUTURE_WRITE | F_SEAL_SEAL) < 0) {
+        const int error = errno;
+        ALOGE("Failed to seal the shared memory: %s", strerror(error));
+        munmap(address, sizeof(VsyncBroadcastMemory));
+        return -error;
+    }
+
+    // The memory is zero filled, which is the initial state of every record.
+    auto* memory = new (address) VsyncBroadcastMemory;
+    outChannel.memory = os::ParcelFileDescriptor(std::move(memoryFd));
+    outChannel.wakeup = os::ParcelFileDescriptor(std::move(receiverWakeupFd));
+    outPublisher.reset(new VsyncBroadcastPublisher(std::move(wakeupFd), memory));
+    return OK;
+}
+
+status_t VsyncBroadcastPublisher::publish(const DisplayEventReceiver::Event& event) {
+    const uint64_t version = ++mVersion;
+    VsyncBroadcastMemory::Record& record = mMemory->records[version % kRecordCount];
+
+    const uint32_t sequence = record.sequence.load(std::memory_order_relaxed);
+    record.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    record.version.store(version, std::memory_order_relaxed);
+    std::memcpy(&record.event, &event, sizeof(event));
+    record.sequence.store(sequence + 2, std::memory_order_release);
+    mMemory->latestVersion.store(version, std::memory_order_release);
+
+    const uint64_t wakeup = 1;
+    ssize_t size;
+    do {
+        size = ::write(mWakeupFd.get(), &wakeup, sizeof(wakeup));
+    } while (size < 0 && errno == EINTR);
+    return size < 0 ? -errno : OK;
+}
+
+// ---------------------------------------------------------------------------
+
+VsyncBroadcastReceiver::VsyncBroadcastReceiver(base::unique_fd wakeupFd,
+                                               const VsyncBroadcastMemory* memory)
+      : mWakeupFd(std::move(wakeupFd)), mMemory(memory) {}
+
+VsyncBroadcastReceiver::~VsyncBroadcastReceiver() {
+    munmap(const_cast<VsyncBroadcastMemory*>(mMemory), sizeof(VsyncBroadcastMemory));
+}
+
+status_t VsyncBroadcastReceiver::open(VsyncBroadcastChannel&& channel,
+                                      std::unique_ptr<VsyncBroadcastReceiver>& outReceiver) {
+    base::unique_fd memoryFd = channel.memory.release();
+    base::unique_fd wakeupFd = channel.wakeup.release();
+    if (!memoryFd.ok() || !wakeupFd.ok()) {
+        ALOGE("Invalid vsync broadcast channel");
+        return BAD_VALUE;
+    }
+
+    struct stat st;
+    if (fstat(memoryFd.get(), &st) < 0 ||
+        static_cast<size_t>(st.st_size) < sizeof(VsyncBroadcastMemory)) {
+        ALOGE("Invalid vsync broadcast memory");
+        return BAD_VALUE;
+    }
+    // The mapping outlives the file descriptor.
+    void* address =
+            mmap(nullptr, sizeof(VsyncBroadcastMemory), PROT_READ, MAP_SHARED, memoryFd.get(), 0);
+    if (address == MAP_FAILED) {
+        const int error = errno;
+        ALOGE("Failed to map the shared memory: %s", strerror(error));
+        return -error;
+    }
+
+    const auto* memory = static_cast<const VsyncBroadcastMemory*>(address);
+    outReceiver.reset(new VsyncBroadcastReceiver(std::move(wakeupFd), memory));
+    return OK;
+}
+
+status_t VsyncBroadcastReceiver::readVsync(DisplayEventReceiver::Event& outEvent) {
+    // Only the latest record is read, however many wakeups were coalesced before this call.
+    uint64_t wakeups;
+    ssize_t size;
+    do {
+        size = ::read(mWakeupFd.get(), &wakeups, sizeof(wakeups));
+    } while (size < 0 && errno == EINTR);
+
+    for (int attempt = 0; attempt < kMaxReadAttempts; attempt++) {
+        const uint64_t version = mMemory->latestVersion.load(std::memory_order_acquire);
+        if (version == 0 || version == mLastVersion) {
+            return WOULD_BLOCK;
+        }
+
+        const VsyncBroadcastMemory::Record& record =
+                mMemory->records[version % VsyncBroadcastPublisher::kRecordCount];
+        const uint32_t sequence = record.sequence.load(std::memory_order_acquire);
+        if (sequence & 1) {
+            continue;
+        }
+        const uint64_t recordVersion = record.version.load(std::memory_order_relaxed);
+        std::memcpy(&outEvent, &record.event, sizeof(outEvent));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (record.sequence.load(std::memory_order_relaxed) != sequence ||
+            recordVersion != version) {
+            // The record was reused for a later vsync event, which is read instead.
+            continue;
+        }
+        mLastVersion = version;
+        return OK;
+    }
+    ALOGE("Failed to read a consistent vsync event");
+    return NOT_ENOUGH_DATA;
+}
+
+} // namespace android::gui
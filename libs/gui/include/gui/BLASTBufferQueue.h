@@ -348,7 +348,9 @@ private:
     std::shared_ptr<gui::BufferReleaseChannel::ProducerEndpoint> mBufferReleaseProducer;
 
     void updateBufferReleaseProducer() REQUIRES(mMutex);
+    // Reads all pending buffer releases at once and handles them under a single lock.
     void drainBufferReleaseConsumer();
+    void releaseBufferCallbacks(const std::vector<gui::BufferReleaseChannel::Message>& messages);
 
     // BufferReleaseReader is used to do blocking but interruptible reads from the buffer
     // release channel. To implement this, BufferReleaseReader owns an epoll file descriptor that
@@ -362,15 +364,15 @@ private:
         BufferReleaseReader(const BufferReleaseReader&) = delete;
         BufferReleaseReader& operator=(const BufferReleaseReader&) = delete;
 
-        // Block until we can read a buffer release message.
+        // Block until we can read buffer release messages, then read all of them.
         //
         // Returns:
-        // * OK if a ReleaseCallbackId and Fence were successfully read.
+        // * OK if at least one message was successfully read.
         // * WOULD_BLOCK if the blocking read was interrupted by interruptBlockingRead.
         // * TIMED_OUT if the blocking read timed out.
         // * UNKNOWN_ERROR if something went wrong.
-        status_t readBlocking(ReleaseCallbackId& outId, sp<Fence>& outReleaseFence,
-                              uint32_t& outMaxAcquiredBufferCount, nsecs_t timeout);
+        status_t readBlocking(std::vector<gui::BufferReleaseChannel::Message>& outMessages,
+                              nsecs_t timeout);
 
         void interruptBlockingRead();
         void clearInterrupts();
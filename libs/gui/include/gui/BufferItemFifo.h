@@ -0,0 +1,105 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_GUI_BUFFERITEMFIFO_H
+#define ANDROID_GUI_BUFFERITEMFIFO_H
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include <gui/BufferItem.h>
+
+namespace android {
+
+// BufferItemFifo is the FIFO of queued buffers of a BufferQueue. It is a ring
+// buffer, so that acquiring the oldest buffer does not move the buffers queued
+// behind it, and its storage is reused once it has grown to the depth of the
+// queue.
+//
+// The FIFO is guarded by the BufferQueue mutex.
+class BufferItemFifo {
+public:
+    template <typename Fifo, typename Item>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = BufferItem;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Item*;
+        using reference = Item&;
+
+        Iterator(Fifo* fifo, size_t index) : mFifo(fifo), mIndex(index) {}
+
+        reference operator*() const { return (*mFifo)[mIndex]; }
+        pointer operator->() const { return &(*mFifo)[mIndex]; }
+        Iterator& operator++() {
+            ++mIndex;
+            return *this;
+        }
+        bool operator==(const Iterator& other) const = default;
+
+    private:
+        Fifo* mFifo;
+        size_t mIndex;
+    };
+
+    using iterator = Iterator<BufferItemFifo, BufferItem>;
+    using const_iterator = Iterator<const BufferItemFifo, const BufferItem>;
+
+    BufferItemFifo() = default;
+    BufferItemFifo(const BufferItemFifo&) = delete;
+    BufferItemFifo& operator=(const BufferItemFifo&) = delete;
+
+    size_t size() const { return mTail - mHead; }
+    bool empty() const { return size() == 0; }
+
+    BufferItem& operator[](size_t index) { return mItems[position(index)]; }
+    const BufferItem& operator[](size_t index) const { return mItems[position(index)]; }
+    BufferItem& front() { return (*this)[0]; }
+    BufferItem& back() { return (*this)[size() - 1]; }
+    const BufferItem& back() const { return (*this)[size() - 1]; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    void push_back(const BufferItem& item);
+
+    // Removes the oldest buffer, if any.
+    void pop_front();
+
+    void clear();
+
+private:
+    // The capacity is a power of two, so that positions wrap with a mask.
+    size_t position(size_t index) const {
+        return (mHead + index) & (mItems.size() - 1);
+    }
+
+    void grow();
+
+    std::vector<BufferItem> mItems;
+    // Positions of the oldest buffer and past the newest buffer. Both only
+    // ever increase.
+    size_t mHead = 0;
+    size_t mTail = 0;
+};
+
+} // namespace android
+
+#endif // ANDROID_GUI_BUFFERITEMFIFO_H
@@ -21,8 +21,11 @@
 
 #include <gui/AdditionalOptions.h>
 #include <gui/BufferItem.h>
+#include <gui/BufferItemFifo.h>
 #include <gui/BufferQueueDefs.h>
 #include <gui/BufferSlot.h>
+#include <gui/BufferSlotList.h>
+#include <gui/BufferSlotSet.h>
 #include <gui/OccupancyTracker.h>
 
 #include <utils/NativeHandle.h>
@@ -33,9 +36,7 @@
 #include <utils/Vector.h>
 
 #include <condition_variable>
-#include <list>
 #include <mutex>
-#include <set>
 #include <vector>
 
 #define ATRACE_BUFFER_INDEX(index)                                                        \
@@ -74,7 +75,7 @@ public:
         NO_CONNECTED_API        = 0,
     };
 
-    typedef Vector<BufferItem> Fifo;
+    typedef BufferItemFifo Fifo;
 
     // BufferQueueCore manages a pool of gralloc memory slots to be used by
     // producers and consumers.
@@ -220,23 +221,26 @@ private:
     // allocated for a slot when requestBuffer is called with that slot's index.
     BufferQueueDefs::SlotsType mSlots;
 
-    // mQueue is a FIFO of queued buffers used in synchronous mode.
+    // mQueue is a FIFO of queued buffers used in synchronous mode. It is
+    // guarded by mMutex like the slots: queueing and acquiring a buffer also
+    // moves its slot between states and free lists and notifies listeners,
+    // so a lock-free FIFO would not take the lock off these paths.
     Fifo mQueue;
 
     // mFreeSlots contains all of the slots which are FREE and do not currently
     // have a buffer attached.
-    std::set<int> mFreeSlots;
+    BufferSlotSet mFreeSlots;
 
     // mFreeBuffers contains all of the slots which are FREE and currently have
-    // a buffer attached.
-    std::list<int> mFreeBuffers;
+    // a buffer attached, the least recently freed first.
+    BufferSlotList mFreeBuffers;
 
     // mUnusedSlots contains all slots that are currently unused. They should be
     // free and not have a buffer attached.
-    std::list<int> mUnusedSlots;
+    BufferSlotList mUnusedSlots;
 
     // mActiveBuffers contains all slots which have a non-FREE buffer attached.
-    std::set<int> mActiveBuffers;
+    BufferSlotSet mActiveBuffers;
 
     // mDequeueCondition is a condition variable used for dequeueBuffer in
     // synchronous mode.
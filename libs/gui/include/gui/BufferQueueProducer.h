@@ -22,6 +22,9 @@
 
 #include <gui/IGraphicBufferProducer.h>
 
+#include <optional>
+#include <vector>
+
 namespace android {
 
 class IBinder;
@@ -45,6 +48,10 @@ public:
     // flags indicating that previously-returned buffers are no longer valid.
     virtual status_t requestBuffer(int slot, sp<GraphicBuffer>* buf);
 
+    // Batched version of requestBuffer, run under a single lock acquisition.
+    status_t requestBuffers(const std::vector<int32_t>& slots,
+                            std::vector<RequestBufferOutput>* outputs) override;
+
 #if COM_ANDROID_GRAPHICS_LIBGUI_FLAGS(WB_UNLIMITED_SLOTS)
     // see IGraphicsBufferProducer::extendSlotCount
     virtual status_t extendSlotCount(int size) override;
@@ -131,6 +138,11 @@ public:
     // will usually be the one obtained from dequeueBuffer.
     virtual status_t cancelBuffer(int slot, const sp<Fence>& fence);
 
+    // Batched version of cancelBuffer, run under a single lock acquisition.
+    // Threads waiting for a free buffer are woken up once for the batch.
+    status_t cancelBuffers(const std::vector<CancelBufferInput>& inputs,
+                           std::vector<status_t>* results) override;
+
     // Query native window attributes.  The "what" values are enumerated in
     // window.h (e.g. NATIVE_WINDOW_FORMAT).
     virtual int query(int what, int* outValue);
@@ -236,6 +248,14 @@ private:
     // This is required by the IBinder::DeathRecipient interface
     virtual void binderDied(const wp<IBinder>& who);
 
+    // The bodies of requestBuffer and cancelBuffer, shared with their batched
+    // versions. mCore->mMutex must be held. cancelBufferLocked neither
+    // wakes up waiters nor notifies the consumer; it returns the id of the
+    // cancelled buffer, if the slot has one, for onFrameCancelled.
+    status_t requestBufferLocked(int slot, sp<GraphicBuffer>* buf);
+    status_t cancelBufferLocked(int slot, const sp<Fence>& fence,
+                                std::optional<uint64_t>* outCancelledBufferId);
+
     // Returns the slot of the next free buffer if one is available or
     // BufferQueueCore::INVALID_BUFFER_SLOT otherwise
     int getFreeBufferLocked() const;
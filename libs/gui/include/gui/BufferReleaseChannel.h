@@ -53,6 +53,12 @@ private:
     };
 
 public:
+    struct Message;
+
+    // Release fences written together with writeReleaseFences are sent in batches of at most this
+    // many messages, each batch in a single packet.
+    static constexpr size_t kMaxBatchSize = 32;
+
     class ConsumerEndpoint : public Endpoint {
     public:
         ConsumerEndpoint(std::string name, android::base::unique_fd fd)
@@ -68,9 +74,25 @@ public:
         status_t readReleaseFence(ReleaseCallbackId& outReleaseCallbackId,
                                   sp<Fence>& outReleaseFence, uint32_t& maxAcquiredBufferCount);
 
+        /**
+         * Reads all release fences present in the BufferReleaseChannel and appends them to
+         * outMessages, in the order they were written.
+         *
+         * Returns OK if at least one fence was read.
+         * Returns WOULD_BLOCK if there is no fence present.
+         * Other errors probably indicate that the channel is broken.
+         */
+        status_t readReleaseFences(std::vector<Message>& outMessages);
+
     private:
+        // Receives one packet and appends the messages it holds to outMessages.
+        status_t receiveLocked(std::vector<Message>& outMessages) REQUIRES(mMutex);
+
         std::mutex mMutex;
         std::vector<uint8_t> mFlattenedBuffer GUARDED_BY(mMutex);
+        // Messages of a batch that readReleaseFence has not returned yet.
+        std::vector<Message> mPendingMessages GUARDED_BY(mMutex);
+        size_t mNextPendingMessage GUARDED_BY(mMutex) = 0;
     };
 
     class ProducerEndpoint : public Endpoint, public Parcelable {
@@ -85,7 +107,15 @@ public:
         status_t writeReleaseFence(const ReleaseCallbackId&, const sp<Fence>& releaseFence,
                                    uint32_t maxAcquiredBufferCount);
 
+        /**
+         * Writes several release fences with one sendmsg call per kMaxBatchSize messages, rather
+         * than one per fence. The release fences of the messages must not be null.
+         */
+        status_t writeReleaseFences(const std::vector<Message>& messages);
+
     private:
+        status_t writeBatch(const Message* messages, size_t count);
+
         std::vector<uint8_t> mFlattenedBuffer;
     };
 
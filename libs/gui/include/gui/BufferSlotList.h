@@ -0,0 +1,107 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_GUI_BUFFERSLOTLIST_H
+#define ANDROID_GUI_BUFFERSLOTLIST_H
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace android {
+
+// BufferSlotList is an ordered list of BufferQueue slot indices, each of which
+// is in the list at most once. It replaces a std::list<int>, keeping its order,
+// but links the slots through arrays indexed by slot, so that pushing, popping
+// and removing a slot is O(1) and does not allocate, unless the list grows past
+// the slots it was sized for.
+class BufferSlotList {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = const int&;
+
+        const_iterator(const BufferSlotList* list, int slot) : mList(list), mSlot(slot) {}
+
+        reference operator*() const { return mSlot; }
+        pointer operator->() const { return &mSlot; }
+        const_iterator& operator++() {
+            mSlot = mList->mNext[mSlot];
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        bool operator==(const const_iterator& other) const { return mSlot == other.mSlot; }
+        bool operator!=(const const_iterator& other) const { return mSlot != other.mSlot; }
+
+    private:
+        const BufferSlotList* mList;
+        int mSlot;
+    };
+
+    using iterator = const_iterator;
+
+    BufferSlotList();
+
+    bool empty() const { return mSize == 0; }
+    size_t size() const { return mSize; }
+    int front() const { return mHead; }
+    int back() const { return mTail; }
+
+    const_iterator begin() const { return const_iterator(this, mHead); }
+    const_iterator end() const { return const_iterator(this, kNone); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    // Adding a slot that is already in the list leaves the list unchanged.
+    void push_front(int slot);
+    void push_back(int slot);
+    void pop_front() { remove(mHead); }
+    void pop_back() { remove(mTail); }
+    // Removes the slot if it is in the list.
+    void remove(int slot);
+    void clear();
+
+private:
+    // End of the list.
+    static constexpr int kNone = -1;
+    // Value of mPrev for the slots that are not in the list.
+    static constexpr int kUnlisted = -2;
+
+    bool contains(int slot) const {
+        return slot >= 0 && static_cast<size_t>(slot) < mPrev.size() && mPrev[slot] != kUnlisted;
+    }
+    // Makes room for the slot, which must not be in the list, and marks it as
+    // listed.
+    void prepare(int slot);
+
+    std::vector<int> mNext;
+    std::vector<int> mPrev;
+    int mHead = kNone;
+    int mTail = kNone;
+    size_t mSize = 0;
+};
+
+} // namespace android
+
+#endif // ANDROID_GUI_BUFFERSLOTLIST_H
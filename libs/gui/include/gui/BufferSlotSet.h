@@ -0,0 +1,93 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_GUI_BUFFERSLOTSET_H
+#define ANDROID_GUI_BUFFERSLOTSET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace android {
+
+// BufferSlotSet is a set of BufferQueue slot indices, stored as a bitset. It
+// iterates in ascending order like the std::set<int> it replaces, but finding
+// the lowest slot is a find-first-set and inserting or erasing a slot does not
+// allocate, unless the set grows past the slots it was sized for.
+class BufferSlotSet {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = const int&;
+
+        const_iterator(const BufferSlotSet* set, int slot) : mSet(set), mSlot(slot) {}
+
+        reference operator*() const { return mSlot; }
+        pointer operator->() const { return &mSlot; }
+        const_iterator& operator++() {
+            mSlot = mSet->next(mSlot + 1);
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        bool operator==(const const_iterator& other) const { return mSlot == other.mSlot; }
+        bool operator!=(const const_iterator& other) const { return mSlot != other.mSlot; }
+
+    private:
+        const BufferSlotSet* mSet;
+        int mSlot;
+    };
+
+    using iterator = const_iterator;
+
+    BufferSlotSet();
+
+    bool empty() const { return mSize == 0; }
+    size_t size() const { return mSize; }
+    size_t count(int slot) const;
+
+    const_iterator begin() const { return const_iterator(this, next(0)); }
+    const_iterator end() const { return const_iterator(this, kEnd); }
+
+    void insert(int slot);
+    void erase(int slot);
+    void erase(const_iterator it) { erase(*it); }
+    void clear();
+
+private:
+    using Word = uint64_t;
+    static constexpr int kBitsPerWord = 64;
+    // Past the last slot, whatever the size of the set.
+    static constexpr int kEnd = -1;
+
+    // Returns the lowest slot of the set that is not below from, or kEnd.
+    int next(int from) const;
+
+    std::vector<Word> mWords;
+    size_t mSize = 0;
+};
+
+} // namespace android
+
+#endif // ANDROID_GUI_BUFFERSLOTSET_H
@@ -46,6 +46,7 @@ using gui::VsyncEventData;
 
 namespace gui {
 class BitTube;
+class VsyncBroadcastReceiver;
 } // namespace gui
 
 static inline constexpr uint32_t fourcc(char c1, char c2, char c3, char c4) {
@@ -159,11 +160,22 @@ public:
      */
     int getFd() const;
 
+    /*
+     * getVsyncFd returns the file descriptor that signals vsync events, if they
+     * are delivered through a vsync broadcast rather than through getFd(), or
+     * -1. Vsync events are still read with getEvents.
+     * OWNERSHIP IS RETAINED by DisplayEventReceiver. DO NOT CLOSE this
+     * file-descriptor.
+     */
+    int getVsyncFd() const;
+
     /*
      * getEvents reads events from the queue and returns how many events were
      * read. Returns 0 if there are no more events or a negative error code.
      * If NOT_ENOUGH_DATA is returned, the object has become invalid forever, it
      * should be destroyed and getEvents() shouldn't be called again.
+     * When vsync events are broadcast, the latest one is read after the other
+     * events, so a slot of events is kept for it.
      */
     ssize_t getEvents(Event* events, size_t count);
     static ssize_t getEvents(gui::BitTube* dataChannel, Event* events, size_t count);
@@ -195,8 +207,11 @@ public:
     status_t getLatestVsyncEventData(ParcelableVsyncEventData* outVsyncEventData) const;
 
 private:
+    void openVsyncBroadcast();
+
     sp<IDisplayEventConnection> mEventConnection;
     std::unique_ptr<gui::BitTube> mDataChannel;
+    std::unique_ptr<gui::VsyncBroadcastReceiver> mVsyncBroadcast;
     std::optional<status_t> mInitError;
 };
 
@@ -105,6 +105,9 @@ protected:
     std::vector<FrameEvents> mFrames;
 
     CompositorTiming mCompositorTiming;
+
+    // Checks the fences of all the frames at once.
+    FenceTimeBatch mFenceTimeBatch;
 };
 
 
@@ -254,10 +254,19 @@ struct layer_state_t {
         eBorderSettingsChanged = 0x400000'00000000,
     };
 
+    // Wire format of a layer_state_t, written after what. A sparse parcel only holds the fields
+    // selected by what, along with the listeners and the nullable buffer, buffer release channel
+    // and luts. A full parcel holds every field.
+    enum class ParcelFormat : uint32_t {
+        Full = 0,
+        Sparse = 1,
+    };
+
     layer_state_t();
 
     void merge(const layer_state_t& other);
-    status_t write(Parcel& output) const;
+    status_t write(Parcel& output) const { return write(output, ParcelFormat::Sparse); }
+    status_t write(Parcel& output, ParcelFormat format) const;
     status_t read(const Parcel& input);
     // Compares two layer_state_t structs and returns a set of change flags describing all the
     // states that are different.
@@ -20,6 +20,9 @@
 #include <binder/Parcelable.h>
 #include <gui/LayerState.h>
 
+#include <optional>
+#include <unordered_map>
+
 namespace android {
 
 // Class to store all the transaction data and the parcelling logic
@@ -87,12 +90,46 @@ public:
     std::vector<ListenerCallbacks> mListenerCallbacks;
 
 private:
+    // Index of mComposerStates by layer handle, so that finding the state of a layer does not
+    // scan all of them. mComposerStates may be changed directly, so a hit is checked against it
+    // and the index is rebuilt when it does not cover mComposerStates. A layer may have several
+    // states, so the number of states covered is tracked apart from the number of layers.
+    class ComposerStateIndex {
+    public:
+        std::optional<size_t> find(const std::vector<ComposerState>& composerStates,
+                                   const sp<IBinder>& surface);
+        void add(const sp<IBinder>& surface, size_t index) {
+            mIndices.emplace(surface, index);
+            mIndexedCount = index + 1;
+        }
+        void clear() {
+            mIndices.clear();
+            mIndexedCount = 0;
+        }
+
+        // The index is derived from mComposerStates, so it takes no part in comparisons.
+        bool operator==(const ComposerStateIndex&) const { return true; }
+
+    private:
+        void rebuild(const std::vector<ComposerState>& composerStates);
+
+        struct IBinderHash {
+            std::size_t operator()(const sp<IBinder>& binder) const {
+                return std::hash<IBinder*>{}(binder.get());
+            }
+        };
+        std::unordered_map<sp<IBinder>, size_t, IBinderHash> mIndices;
+        size_t mIndexedCount = 0;
+    };
+
     explicit TransactionState(TransactionState const& other) = default;
     friend class TransactionApplicationTest;
     friend class SurfaceComposerClient;
     // We keep track of the last MAX_MERGE_HISTORY_LENGTH merged transaction ids.
     // Ordered most recently merged to least recently merged.
     static constexpr size_t MAX_MERGE_HISTORY_LENGTH = 10u;
+
+    ComposerStateIndex mComposerStateIndex;
 };
 
 }; // namespace android
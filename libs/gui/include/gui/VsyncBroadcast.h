@@ -0,0 +1,117 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include <android-base/unique_fd.h>
+
+#include <android/gui/VsyncBroadcastChannel.h>
+#include <gui/DisplayEventReceiver.h>
+#include <utils/Errors.h>
+
+namespace android::gui {
+
+struct VsyncBroadcastMemory;
+
+/**
+ * Shared memory that an EventThread publishes the vsync events of one display event connection
+ * to, for the connections registered with ISurfaceComposer::EventRegistration::vsyncBroadcast.
+ *
+ * Each vsync event is written into a small ring of records, and the connection is woken up
+ * through its eventfd, instead of having the whole event written to its BitTube. Records are
+ * versioned, so that a receiver never uses a torn record, and only reads the latest one however
+ * many vsync events were published since it last read.
+ *
+ * Every connection has its own memory, so that it only sees its own vsync events. The memory is
+ * sealed against writes once the publisher has mapped it, so that the receiver can only map it
+ * read-only.
+ */
+class VsyncBroadcastPublisher {
+public:
+    // Number of records that are published before one is reused.
+    static constexpr size_t kRecordCount = 4;
+
+    /**
+     * Creates and maps the shared memory, and fills in the channel that its receiver opens.
+     *
+     * Return OK on success.
+     */
+    static status_t create(std::unique_ptr<VsyncBroadcastPublisher>& outPublisher,
+                           VsyncBroadcastChannel& outChannel);
+
+    ~VsyncBroadcastPublisher();
+
+    VsyncBroadcastPublisher(const VsyncBroadcastPublisher&) = delete;
+    void operator=(const VsyncBroadcastPublisher&) = delete;
+
+    /**
+     * Writes the event to the next record and wakes up the receiver. Must not be called
+     * concurrently.
+     */
+    status_t publish(const DisplayEventReceiver::Event& event);
+
+private:
+    VsyncBroadcastPublisher(base::unique_fd wakeupFd, VsyncBroadcastMemory* memory);
+
+    const base::unique_fd mWakeupFd;
+    VsyncBroadcastMemory* const mMemory;
+    uint64_t mVersion = 0;
+};
+
+/**
+ * The receiving end of a VsyncBroadcastChannel.
+ */
+class VsyncBroadcastReceiver {
+public:
+    /**
+     * Maps the shared memory of a channel returned by IDisplayEventConnection.
+     *
+     * Return OK on success.
+     */
+    static status_t open(VsyncBroadcastChannel&& channel,
+                         std::unique_ptr<VsyncBroadcastReceiver>& outReceiver);
+
+    ~VsyncBroadcastReceiver();
+
+    VsyncBroadcastReceiver(const VsyncBroadcastReceiver&) = delete;
+    void operator=(const VsyncBroadcastReceiver&) = delete;
+
+    /**
+     * Returns the eventfd to poll for vsync events.
+     */
+    int getFd() const { return mWakeupFd.get(); }
+
+    /**
+     * Consumes the pending wakeups and reads the latest vsync event.
+     *
+     * Returns OK if an event was read.
+     * Returns WOULD_BLOCK if no event was published since the last call.
+     * Returns NOT_ENOUGH_DATA if no consistent record could be read.
+     */
+    status_t readVsync(DisplayEventReceiver::Event& outEvent);
+
+private:
+    VsyncBroadcastReceiver(base::unique_fd wakeupFd, const VsyncBroadcastMemory* memory);
+
+    const base::unique_fd mWakeupFd;
+    const VsyncBroadcastMemory* const mMemory;
+    uint64_t mLastVersion = 0;
+};
+
+} // namespace android::gui
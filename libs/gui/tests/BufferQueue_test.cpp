@@ -49,6 +49,7 @@
 #include <csignal>
 #include <future>
 #include <optional>
+#include <set>
 #include <thread>
 #include <unordered_map>
 
@@ -1452,6 +1453,109 @@ TEST_F(BufferQueueTest, TestProducerConnectDisconnect) {
     ASSERT_EQ(NO_INIT, mProducer->disconnect(NATIVE_WINDOW_API_CPU));
 }
 
+TEST_F(BufferQueueTest, TestQueueWrapsAround) {
+    createBufferQueue();
+    sp<MockConsumer> mc(new MockConsumer);
+    ASSERT_EQ(OK, mConsumer->consumerConnect(mc, false));
+    IGraphicBufferProducer::QueueBufferOutput output;
+    ASSERT_EQ(OK,
+              mProducer->connect(new StubProducerListener, NATIVE_WINDOW_API_CPU, false, &output));
+    ASSERT_EQ(OK, mProducer->setMaxDequeuedBufferCount(3));
+
+    BufferItem item;
+    ASSERT_EQ(IGraphicBufferConsumer::NO_BUFFER_AVAILABLE, mConsumer->acquireBuffer(&item, 0));
+
+    IGraphicBufferProducer::QueueBufferInput input(0, false, HAL_DATASPACE_UNKNOWN,
+                                                   Rect(0, 0, 1, 1),
+                                                   NATIVE_WINDOW_SCALING_MODE_FREEZE, 0,
+                                                   Fence::NO_FENCE);
+    // Keep up to three buffers queued, so that the FIFO wraps around.
+    uint64_t acquiredFrameNumber = 0;
+    for (int frame = 0; frame < 20; frame++) {
+        int slot;
+        sp<Fence> fence;
+        status_t result = mProducer->dequeueBuffer(&slot, &fence, 1, 1, 0,
+                                                   TEST_PRODUCER_USAGE_BITS, nullptr, nullptr);
+        if (result == IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION) {
+            sp<GraphicBuffer> buffer;
+            ASSERT_EQ(OK, mProducer->requestBuffer(slot, &buffer));
+        } else {
+            ASSERT_EQ(OK, result);
+        }
+        ASSERT_EQ(OK, mProducer->queueBuffer(slot, input, &output));
+
+        if (frame >= 2) {
+            ASSERT_EQ(OK, mConsumer->acquireBuffer(&item, 0));
+            EXPECT_EQ(++acquiredFrameNumber, item.mFrameNumber);
+            ASSERT_EQ(OK, mConsumer->releaseBuffer(item.mSlot, item.mFrameNumber,
+                                                   Fence::NO_FENCE));
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        ASSERT_EQ(OK, mConsumer->acquireBuffer(&item, 0));
+        EXPECT_EQ(++acquiredFrameNumber, item.mFrameNumber);
+        ASSERT_EQ(OK, mConsumer->releaseBuffer(item.mSlot, item.mFrameNumber, Fence::NO_FENCE));
+    }
+    ASSERT_EQ(IGraphicBufferConsumer::NO_BUFFER_AVAILABLE, mConsumer->acquireBuffer(&item, 0));
+}
+
+TEST_F(BufferQueueTest, TestBatchedRequestAndCancelReportEachResult) {
+    createBufferQueue();
+    sp<MockConsumer> mc(new MockConsumer);
+    ASSERT_EQ(OK, mConsumer->consumerConnect(mc, false));
+    IGraphicBufferProducer::QueueBufferOutput output;
+    ASSERT_EQ(OK,
+              mProducer->connect(new StubProducerListener, NATIVE_WINDOW_API_CPU, false, &output));
+    ASSERT_EQ(OK, mProducer->setMaxDequeuedBufferCount(2));
+
+    std::vector<int32_t> slots;
+    std::vector<sp<Fence>> fences;
+    for (int i = 0; i < 2; i++) {
+        int slot;
+        sp<Fence> fence;
+        ASSERT_EQ(IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION,
+                  mProducer->dequeueBuffer(&slot, &fence, 1, 1, 0, TEST_PRODUCER_USAGE_BITS,
+                                           nullptr, nullptr));
+        slots.push_back(slot);
+        fences.push_back(fence);
+    }
+
+    // An invalid slot fails on its own, without failing the rest of the batch.
+    std::vector<int32_t> requestSlots = {slots[0], -1, slots[1]};
+    std::vector<IGraphicBufferProducer::RequestBufferOutput> requestOutputs;
+    ASSERT_EQ(OK, mProducer->requestBuffers(requestSlots, &requestOutputs));
+    ASSERT_EQ(3u, requestOutputs.size());
+    EXPECT_EQ(OK, requestOutputs[0].result);
+    EXPECT_NE(nullptr, requestOutputs[0].buffer.get());
+    EXPECT_EQ(BAD_VALUE, requestOutputs[1].result);
+    EXPECT_EQ(OK, requestOutputs[2].result);
+    EXPECT_NE(nullptr, requestOutputs[2].buffer.get());
+
+    std::vector<IGraphicBufferProducer::CancelBufferInput> cancelInputs(3);
+    cancelInputs[0].slot = slots[0];
+    cancelInputs[0].fence = fences[0];
+    cancelInputs[1].slot = slots[1];
+    cancelInputs[1].fence = fences[1];
+    // Already cancelled by the first input.
+    cancelInputs[2].slot = slots[0];
+    cancelInputs[2].fence = fences[0];
+    std::vector<status_t> cancelResults;
+    ASSERT_EQ(OK, mProducer->cancelBuffers(cancelInputs, &cancelResults));
+    ASSERT_EQ(3u, cancelResults.size());
+    EXPECT_EQ(OK, cancelResults[0]);
+    EXPECT_EQ(OK, cancelResults[1]);
+    EXPECT_EQ(BAD_VALUE, cancelResults[2]);
+
+    // Both buffers are free again.
+    for (int i = 0; i < 2; i++) {
+        int slot;
+        sp<Fence> fence;
+        ASSERT_EQ(OK,
+                  mProducer->dequeueBuffer(&slot, &fence, 1, 1, 0, TEST_PRODUCER_USAGE_BITS,
+                                           nullptr, nullptr));
+    }
+}
+
 struct BufferItemConsumerSetFrameRateListener : public BufferItemConsumer {
     BufferItemConsumerSetFrameRateListener() : BufferItemConsumer(GRALLOC_USAGE_SW_READ_OFTEN, 1) {}
 
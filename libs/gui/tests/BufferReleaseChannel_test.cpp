@@ -14,6 +14,11 @@
  * limitations under the License.
  */
 
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
 #include <string>
 #include <vector>
 
@@ -138,6 +143,97 @@ TEST_F(BufferReleaseChannelTest, ProduceAndConsume) {
     }
 }
 
+// Verify that a batch of messages, some without a fence, is read back in order with either the
+// batched or the single message read.
+TEST_F(BufferReleaseChannelTest, ProduceAndConsumeBatch) {
+    sp<Fence> fence = sp<Fence>::make(memfd_create("fake-fence-fd", 0));
+
+    // More than a batch, so that the messages are split over several packets.
+    const uint64_t messageCount = BufferReleaseChannel::kMaxBatchSize * 2 + 3;
+    std::vector<BufferReleaseChannel::Message> producerMessages;
+    for (uint64_t i = 0; i < messageCount; i++) {
+        producerMessages.emplace_back(ReleaseCallbackId{i, i + 1},
+                                      i % 2 == 0 ? fence : Fence::NO_FENCE, i + 2);
+    }
+    ASSERT_EQ(OK, mProducer->writeReleaseFences(producerMessages));
+
+    ReleaseCallbackId consumerId;
+    sp<Fence> consumerFence;
+    uint32_t maxAcquiredBufferCount;
+    ASSERT_EQ(OK, mConsumer->readReleaseFence(consumerId, consumerFence, maxAcquiredBufferCount));
+    ASSERT_EQ((ReleaseCallbackId{0, 1}), consumerId);
+    ASSERT_TRUE(is_same_file(fence->get(), consumerFence->get()));
+    ASSERT_EQ(2u, maxAcquiredBufferCount);
+
+    std::vector<BufferReleaseChannel::Message> consumerMessages;
+    ASSERT_EQ(OK, mConsumer->readReleaseFences(consumerMessages));
+    ASSERT_EQ(messageCount - 1, consumerMessages.size());
+    for (uint64_t i = 1; i < messageCount; i++) {
+        const auto& message = consumerMessages[i - 1];
+        ASSERT_EQ((ReleaseCallbackId{i, i + 1}), message.releaseCallbackId);
+        if (i % 2 == 0) {
+            ASSERT_TRUE(is_same_file(fence->get(), message.releaseFence->get()));
+        } else {
+            ASSERT_FALSE(message.releaseFence->isValid());
+        }
+        ASSERT_EQ(i + 2, message.maxAcquiredBufferCount);
+    }
+
+    consumerMessages.clear();
+    ASSERT_EQ(WOULD_BLOCK, mConsumer->readReleaseFences(consumerMessages));
+    ASSERT_TRUE(consumerMessages.empty());
+}
+
+// Verify that the fds of a batch are closed if a message of the batch can't be read.
+TEST_F(BufferReleaseChannelTest, ConsumeBadBatchClosesFds) {
+    int pipeFds[2];
+    ASSERT_EQ(0, pipe2(pipeFds, O_NONBLOCK));
+    base::unique_fd readEnd(pipeFds[0]);
+    base::unique_fd writeEnd(pipeFds[1]);
+
+    // A batch of two messages, where the second claims more fds than a fence can have.
+    const BufferReleaseChannel::Message message{ReleaseCallbackId{1, 2},
+                                                sp<Fence>::make(memfd_create("fake-fence-fd", 0)),
+                                                3};
+    const size_t messageSize = message.getFlattenedSize();
+    std::vector<uint8_t> packet(2 * sizeof(uint32_t) + 2 * messageSize);
+    const uint32_t header[] = {0x42524342, 2}; // The batch magic and message count.
+    memcpy(packet.data(), header, sizeof(header));
+    for (size_t i = 0; i < 2; i++) {
+        void* buffer = packet.data() + sizeof(header) + i * messageSize;
+        size_t size = messageSize;
+        int fd;
+        int* fds = &fd;
+        size_t fdCount = 1;
+        ASSERT_EQ(OK, message.flatten(buffer, size, fds, fdCount));
+    }
+    const uint32_t badFdCount = 2;
+    memcpy(packet.data() + sizeof(header) + messageSize, &badFdCount, sizeof(badFdCount));
+
+    const int fds[] = {message.releaseFence->get(), writeEnd.get()};
+    iovec iov{.iov_base = packet.data(), .iov_len = packet.size()};
+    std::array<uint8_t, CMSG_SPACE(sizeof(fds))> control{};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+    ASSERT_EQ(static_cast<ssize_t>(packet.size()), sendmsg(mProducer->getFd().get(), &msg, 0));
+    writeEnd.reset();
+
+    std::vector<BufferReleaseChannel::Message> consumerMessages;
+    mConsumer->readReleaseFences(consumerMessages);
+
+    // The received copy of the write end was closed, so the pipe reads as closed.
+    char data;
+    EXPECT_EQ(0, read(readEnd.get(), &data, sizeof(data)));
+}
+
 // Verify that BufferReleaseChannel::ConsumerEndpoint's socket can't be written to.
 TEST_F(BufferReleaseChannelTest, ConsumerSocketReadOnly) {
     uint64_t data = 0;
@@ -204,6 +204,33 @@ TEST(TransactionStateTest, parcelLayerState) {
     EXPECT_EQ(state, parcelledState);
 };
 
+TEST(TransactionStateTest, parcelLayerStateOnlyHoldsChangedFields) {
+    ComposerState state = createComposerStateForTest(0);
+    // Not selected by what, so not parcelled.
+    state.state.cornerRadius = 5.f;
+    state.state.color.a = 0.5f;
+
+    Parcel sparse;
+    state.state.write(sparse, layer_state_t::ParcelFormat::Sparse);
+    sparse.setDataPosition(0);
+    ComposerState sparseState;
+    ASSERT_EQ(OK, sparseState.read(sparse));
+    EXPECT_EQ(state.state.flags, sparseState.state.flags);
+    EXPECT_EQ(0.f, sparseState.state.cornerRadius);
+    EXPECT_EQ(0.f, sparseState.state.color.a);
+
+    Parcel full;
+    state.state.write(full, layer_state_t::ParcelFormat::Full);
+    full.setDataPosition(0);
+    ComposerState fullState;
+    ASSERT_EQ(OK, fullState.read(full));
+    EXPECT_EQ(state.state.flags, fullState.state.flags);
+    EXPECT_EQ(5.f, fullState.state.cornerRadius);
+    EXPECT_EQ(0.5f, fullState.state.color.a);
+
+    EXPECT_LT(sparse.dataSize(), full.dataSize());
+};
+
 TEST(TransactionStateTest, parcelEmptyState) {
     TransactionState state;
     Parcel p;
@@ -274,6 +301,87 @@ TEST(TransactionStateTest, merge) {
     EXPECT_EQ(state, expectedMergedState);
 };
 
+TEST(TransactionStateTest, mergeManyLayers) {
+    static constexpr size_t kLayerCount = 300;
+    std::vector<sp<IBinder>> surfaces;
+    for (size_t i = 0; i < kLayerCount; i++) {
+        surfaces.push_back(sp<BBinder>::make());
+    }
+
+    TransactionState state;
+    for (size_t i = 0; i < kLayerCount; i += 2) {
+        ComposerState composerState;
+        composerState.state.surface = surfaces[i];
+        composerState.state.what = layer_state_t::eAlphaChanged;
+        composerState.state.color.a = .5;
+        state.mComposerStates.push_back(composerState);
+    }
+
+    TransactionState update;
+    for (size_t i = 0; i < kLayerCount; i++) {
+        ComposerState composerState;
+        composerState.state.surface = surfaces[i];
+        composerState.state.what = layer_state_t::eCornerRadiusChanged;
+        composerState.state.cornerRadius = static_cast<float>(i);
+        update.mComposerStates.push_back(composerState);
+    }
+    state.merge(std::move(update), [](layer_state_t&) {});
+
+    // States of layers in both transactions are merged, and the others are appended in order.
+    ASSERT_EQ(kLayerCount, state.mComposerStates.size());
+    for (size_t i = 0; i < kLayerCount / 2; i++) {
+        const layer_state_t& merged = state.mComposerStates[i].state;
+        EXPECT_EQ(surfaces[2 * i], merged.surface);
+        EXPECT_EQ(static_cast<uint64_t>(layer_state_t::eAlphaChanged |
+                                        layer_state_t::eCornerRadiusChanged),
+                  merged.what);
+        EXPECT_EQ(static_cast<float>(2 * i), merged.cornerRadius);
+        const layer_state_t& appended = state.mComposerStates[kLayerCount / 2 + i].state;
+        EXPECT_EQ(surfaces[2 * i + 1], appended.surface);
+        EXPECT_EQ(static_cast<uint64_t>(layer_state_t::eCornerRadiusChanged), appended.what);
+    }
+
+    // States added directly are found by later merges.
+    const sp<IBinder> surface = sp<BBinder>::make();
+    ComposerState composerState;
+    composerState.state.surface = surface;
+    state.mComposerStates.push_back(composerState);
+    TransactionState lastUpdate;
+    composerState.state.what = layer_state_t::eAlphaChanged;
+    lastUpdate.mComposerStates.push_back(composerState);
+    state.merge(std::move(lastUpdate), [](layer_state_t&) {});
+    ASSERT_EQ(kLayerCount + 1, state.mComposerStates.size());
+    EXPECT_EQ(static_cast<uint64_t>(layer_state_t::eAlphaChanged),
+              state.mComposerStates.back().state.what);
+};
+
+TEST(TransactionStateTest, mergeIntoFirstStateOfLayer) {
+    const sp<IBinder> surface = sp<BBinder>::make();
+    TransactionState state;
+    for (int i = 0; i < 2; i++) {
+        ComposerState composerState;
+        composerState.state.surface = surface;
+        state.mComposerStates.push_back(composerState);
+    }
+
+    // The index covers both states of the layer, and keeps doing so as other layers are added.
+    for (int i = 0; i < 3; i++) {
+        TransactionState update;
+        ComposerState composerState;
+        composerState.state.surface = surface;
+        composerState.state.what = layer_state_t::eAlphaChanged;
+        update.mComposerStates.push_back(composerState);
+        composerState.state.surface = sp<BBinder>::make();
+        update.mComposerStates.push_back(composerState);
+        state.merge(std::move(update), [](layer_state_t&) {});
+    }
+
+    ASSERT_EQ(5u, state.mComposerStates.size());
+    EXPECT_EQ(static_cast<uint64_t>(layer_state_t::eAlphaChanged),
+              state.mComposerStates[0].state.what);
+    EXPECT_EQ(0u, state.mComposerStates[1].state.what);
+};
+
 TEST(TransactionStateTest, clear) {
     TransactionState state = createTransactionStateForTest();
     state.clear();
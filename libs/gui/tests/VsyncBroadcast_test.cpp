@@ -0,0 +1,121 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+
+#include <gtest/gtest.h>
+#include <gui/VsyncBroadcast.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using android::gui::VsyncBroadcastChannel;
+using android::gui::VsyncBroadcastPublisher;
+using android::gui::VsyncBroadcastReceiver;
+
+namespace android {
+
+namespace {
+
+DisplayEventReceiver::Event makeVsync(nsecs_t timestamp) {
+    DisplayEventReceiver::Event event{};
+    event.header.type = DisplayEventType::DISPLAY_EVENT_VSYNC;
+    event.header.timestamp = timestamp;
+    event.vsync.count = static_cast<uint32_t>(timestamp);
+    return event;
+}
+
+bool hasWakeup(const VsyncBroadcastReceiver& receiver) {
+    pollfd fd{.fd = receiver.getFd(), .events = POLLIN, .revents = 0};
+    return poll(&fd, 1, 0) == 1;
+}
+
+} // namespace
+
+class VsyncBroadcastTest : public testing::Test {
+protected:
+    std::unique_ptr<VsyncBroadcastPublisher> mPublisher;
+    std::unique_ptr<VsyncBroadcastReceiver> mReceiver;
+
+    void SetUp() override {
+        VsyncBroadcastChannel channel;
+        ASSERT_EQ(OK, VsyncBroadcastPublisher::create(mPublisher, channel));
+        ASSERT_EQ(OK, VsyncBroadcastReceiver::open(std::move(channel), mReceiver));
+    }
+};
+
+TEST_F(VsyncBroadcastTest, ReadsPublishedVsync) {
+    DisplayEventReceiver::Event event;
+    EXPECT_FALSE(hasWakeup(*mReceiver));
+    EXPECT_EQ(WOULD_BLOCK, mReceiver->readVsync(event));
+
+    ASSERT_EQ(OK, mPublisher->publish(makeVsync(1)));
+    EXPECT_TRUE(hasWakeup(*mReceiver));
+    ASSERT_EQ(OK, mReceiver->readVsync(event));
+    EXPECT_EQ(DisplayEventType::DISPLAY_EVENT_VSYNC, event.header.type);
+    EXPECT_EQ(1, event.header.timestamp);
+
+    // The wakeup was consumed, and the same vsync is not read twice.
+    EXPECT_FALSE(hasWakeup(*mReceiver));
+    EXPECT_EQ(WOULD_BLOCK, mReceiver->readVsync(event));
+}
+
+TEST_F(VsyncBroadcastTest, ReadsLatestVsync) {
+    ASSERT_EQ(OK, mPublisher->publish(makeVsync(1)));
+    ASSERT_EQ(OK, mPublisher->publish(makeVsync(2)));
+
+    DisplayEventReceiver::Event event;
+    ASSERT_EQ(OK, mReceiver->readVsync(event));
+    EXPECT_EQ(2, event.header.timestamp);
+    EXPECT_EQ(WOULD_BLOCK, mReceiver->readVsync(event));
+}
+
+TEST_F(VsyncBroadcastTest, ReadsLatestVsyncAfterRecordsAreReused) {
+    for (size_t i = 1; i <= 3 * VsyncBroadcastPublisher::kRecordCount + 1; i++) {
+        ASSERT_EQ(OK, mPublisher->publish(makeVsync(static_cast<nsecs_t>(i))));
+    }
+
+    DisplayEventReceiver::Event event;
+    ASSERT_EQ(OK, mReceiver->readVsync(event));
+    EXPECT_EQ(static_cast<nsecs_t>(3 * VsyncBroadcastPublisher::kRecordCount + 1),
+              event.header.timestamp);
+}
+
+TEST_F(VsyncBroadcastTest, ChannelsDoNotShareVsyncs) {
+    std::unique_ptr<VsyncBroadcastPublisher> otherPublisher;
+    VsyncBroadcastChannel otherChannel;
+    ASSERT_EQ(OK, VsyncBroadcastPublisher::create(otherPublisher, otherChannel));
+    ASSERT_EQ(OK, otherPublisher->publish(makeVsync(1)));
+
+    DisplayEventReceiver::Event event;
+    EXPECT_FALSE(hasWakeup(*mReceiver));
+    EXPECT_EQ(WOULD_BLOCK, mReceiver->readVsync(event));
+}
+
+TEST_F(VsyncBroadcastTest, MemoryIsReadOnlyForReceivers) {
+    std::unique_ptr<VsyncBroadcastPublisher> publisher;
+    VsyncBroadcastChannel channel;
+    ASSERT_EQ(OK, VsyncBroadcastPublisher::create(publisher, channel));
+
+    void* address = mmap(nullptr, getpagesize(), PROT_READ | PROT_WRITE, MAP_SHARED,
+                         channel.memory.get(), 0);
+    EXPECT_EQ(MAP_FAILED, address);
+    if (address != MAP_FAILED) {
+        munmap(address, getpagesize());
+    }
+}
+
+} // namespace android
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <thread>
+
+#include <gui/BufferItem.h>
+#include <gui/BufferQueueConsumer.h>
+#include <gui/BufferQueueCore.h>
+#include <gui/BufferQueueProducer.h>
+#include <gui/IConsumerListener.h>
+#include <gui/IProducerListener.h>
+#include <log/log_main.h>
+#include <ui/GraphicBuffer.h>
+
+namespace android {
+namespace {
+
+struct StubConsumerListener : public IConsumerListener {
+    void onFrameAvailable(const BufferItem& /* item */) override {}
+    void onBuffersReleased() override {}
+    void onSidebandStreamChanged() override {}
+};
+
+// Frames go from a producer thread to a consumer thread that polls the queue,
+// as in a video pipeline.
+void queueThroughput(benchmark::State& state) {
+    auto core = sp<BufferQueueCore>::make();
+    auto producer = sp<BufferQueueProducer>::make(core);
+    auto consumer = sp<BufferQueueConsumer>::make(core);
+    consumer->consumerConnect(sp<StubConsumerListener>::make(), false);
+    IGraphicBufferProducer::QueueBufferOutput output;
+    producer->connect(sp<StubProducerListener>::make(), NATIVE_WINDOW_API_CPU, false, &output);
+    producer->setMaxDequeuedBufferCount(3);
+
+    std::atomic<bool> done = false;
+    std::thread consumerThread([&] {
+        BufferItem item;
+        while (!done.load(std::memory_order_relaxed)) {
+            if (consumer->acquireBuffer(&item, 0) == OK) {
+                consumer->releaseBuffer(item.mSlot, item.mFrameNumber, Fence::NO_FENCE);
+            }
+        }
+    });
+
+    const IGraphicBufferProducer::QueueBufferInput input(0, false, HAL_DATASPACE_UNKNOWN,
+                                                         Rect(0, 0, 1, 1),
+                                                         NATIVE_WINDOW_SCALING_MODE_FREEZE, 0,
+                                                         Fence::NO_FENCE);
+    for (auto _ : state) {
+        int slot;
+        sp<Fence> fence;
+        const status_t result = producer->dequeueBuffer(&slot, &fence, 1, 1, 0,
+                                                        GRALLOC_USAGE_SW_READ_RARELY, nullptr,
+                                                        nullptr);
+        if (result == IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION) {
+            sp<GraphicBuffer> buffer;
+            producer->requestBuffer(slot, &buffer);
+        }
+        producer->queueBuffer(slot, input, &output);
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    done = true;
+    consumerThread.join();
+    producer->disconnect(NATIVE_WINDOW_API_CPU);
+    consumer->consumerDisconnect();
+}
+BENCHMARK(queueThroughput)->UseRealTime();
+
+// Dequeues, queues, acquires and releases buffers on one thread, so that the
+// cost of the slot bookkeeping isn't hidden behind thread handoffs. The buffer
+// is allocated before the measured loop.
+void dequeueQueueLoop(benchmark::State& state) {
+    auto core = sp<BufferQueueCore>::make();
+    auto producer = sp<BufferQueueProducer>::make(core);
+    auto consumer = sp<BufferQueueConsumer>::make(core);
+    consumer->consumerConnect(sp<StubConsumerListener>::make(), false);
+    IGraphicBufferProducer::QueueBufferOutput output;
+    producer->connect(sp<StubProducerListener>::make(), NATIVE_WINDOW_API_CPU, false, &output);
+    producer->setMaxDequeuedBufferCount(3);
+
+    const IGraphicBufferProducer::QueueBufferInput input(0, false, HAL_DATASPACE_UNKNOWN,
+                                                         Rect(0, 0, 1, 1),
+                                                         NATIVE_WINDOW_SCALING_MODE_FREEZE, 0,
+                                                         Fence::NO_FENCE);
+    auto dequeueQueueAcquireRelease = [&] {
+        int slot;
+        sp<Fence> fence;
+        const status_t result = producer->dequeueBuffer(&slot, &fence, 1, 1, 0,
+                                                        GRALLOC_USAGE_SW_READ_RARELY, nullptr,
+                                                        nullptr);
+        if (result == IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION) {
+            sp<GraphicBuffer> buffer;
+            producer->requestBuffer(slot, &buffer);
+        }
+        producer->queueBuffer(slot, input, &output);
+        BufferItem item;
+        LOG_ALWAYS_FATAL_IF(consumer->acquireBuffer(&item, 0) != OK);
+        consumer->releaseBuffer(item.mSlot, item.mFrameNumber, Fence::NO_FENCE);
+    };
+    dequeueQueueAcquireRelease();
+
+    for (auto _ : state) {
+        dequeueQueueAcquireRelease();
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    producer->disconnect(NATIVE_WINDOW_API_CPU);
+    consumer->consumerDisconnect();
+}
+BENCHMARK(dequeueQueueLoop);
+
+} // namespace
+} // namespace android
@@ -19,6 +19,7 @@
 #include <optional>
 #include <vector>
 #include "binder/Parcel.h"
+#include "gui/LayerState.h"
 #include "gui/SurfaceComposerClient.h"
 #include "gui/SurfaceControl.h"
 #include "log/log_main.h"
@@ -41,6 +42,7 @@ std::vector<sp<SurfaceControl>> createSurfaceControl(const char* name, size_t nu
 
 void applyTransaction(benchmark::State& state) {
     std::vector<sp<SurfaceControl>> surfaceControls = createSurfaceControl(__func__, 5 /* num */);
+    size_t parcelSize = 0;
     for (auto _ : state) {
         SurfaceComposerClient::Transaction t;
         for (auto& sc : surfaceControls) {
@@ -52,9 +54,11 @@ void applyTransaction(benchmark::State& state) {
         }
         Parcel p;
         t.writeToParcel(&p);
+        parcelSize = p.dataSize();
         t.clear();
         benchmark::DoNotOptimize(t);
     }
+    state.counters["parcelBytes"] = static_cast<double>(parcelSize);
 }
 BENCHMARK(applyTransaction);
 
@@ -87,8 +91,10 @@ void applyBufferTransaction(benchmark::State& state) {
 }
 BENCHMARK(applyBufferTransaction);
 
+// Merges two transactions that touch the given number of layers, as SystemUI and WM do.
 void mergeTransaction(benchmark::State& state) {
-    std::vector<sp<SurfaceControl>> surfaceControls = createSurfaceControl(__func__, 5 /* num */);
+    std::vector<sp<SurfaceControl>> surfaceControls =
+            createSurfaceControl(__func__, static_cast<size_t>(state.range(0)));
     for (auto _ : state) {
         SurfaceComposerClient::Transaction t1;
         for (auto& sc : surfaceControls) {
@@ -110,7 +116,7 @@ void mergeTransaction(benchmark::State& state) {
         benchmark::DoNotOptimize(t1);
     }
 }
-BENCHMARK(mergeTransaction);
+BENCHMARK(mergeTransaction)->ArgName("layers")->Arg(5)->Arg(100)->Arg(500);
 
 void readTransactionFromParcel(benchmark::State& state) {
     std::vector<sp<SurfaceControl>> surfaceControls = createSurfaceControl(__func__, 5 /* num */);
@@ -132,8 +138,36 @@ void readTransactionFromParcel(benchmark::State& state) {
         p.setDataPosition(0);
         benchmark::DoNotOptimize(t2);
     }
+    state.counters["parcelBytes"] = static_cast<double>(p.dataSize());
 }
 BENCHMARK(readTransactionFromParcel);
 
+// Writes and reads back the layer state of an animation frame, which only moves the layer, in
+// the full and the sparse parcel format.
+void parcelLayerState(benchmark::State& state) {
+    const auto format = static_cast<layer_state_t::ParcelFormat>(state.range(0));
+    layer_state_t layerState;
+    layerState.what = layer_state_t::ePositionChanged | layer_state_t::eAlphaChanged;
+    layerState.x = 10;
+    layerState.y = 20;
+    layerState.color.a = 0.5;
+
+    Parcel p;
+    for (auto _ : state) {
+        p.setDataSize(0);
+        p.setDataPosition(0);
+        layerState.write(p, format);
+        p.setDataPosition(0);
+        layer_state_t parcelledState;
+        parcelledState.read(p);
+        benchmark::DoNotOptimize(parcelledState);
+    }
+    state.counters["parcelBytes"] = static_cast<double>(p.dataSize());
+}
+BENCHMARK(parcelLayerState)
+        ->ArgName("sparse")
+        ->Arg(static_cast<int64_t>(layer_state_t::ParcelFormat::Full))
+        ->Arg(static_cast<int64_t>(layer_state_t::ParcelFormat::Sparse));
+
 } // namespace
 } // namespace android
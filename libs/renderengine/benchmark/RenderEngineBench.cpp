@@ -77,7 +77,8 @@ std::pair<uint32_t, uint32_t> getDisplaySize() {
 
 static std::unique_ptr<RenderEngine> createRenderEngine(
         RenderEngine::Threaded threaded, RenderEngine::GraphicsApi graphicsApi,
-        RenderEngine::BlurAlgorithm blurAlgorithm = RenderEngine::BlurAlgorithm::KAWASE) {
+        RenderEngine::BlurAlgorithm blurAlgorithm = RenderEngine::BlurAlgorithm::KAWASE,
+        std::string shaderManifestPath = {}) {
     auto args = RenderEngineCreationArgs::Builder()
                         .setPixelFormat(static_cast<int>(ui::PixelFormat::RGBA_8888))
                         .setImageCacheSize(1)
@@ -87,6 +88,7 @@ static std::unique_ptr<RenderEngine> createRenderEngine(
                         .setContextPriority(RenderEngine::ContextPriority::REALTIME)
                         .setThreaded(threaded)
                         .setGraphicsApi(graphicsApi)
+                        .setShaderManifestPath(std::move(shaderManifestPath))
                         .build();
     return RenderEngine::create(args);
 }
@@ -310,6 +312,75 @@ void BM_homescreen_edgeExtension(benchmark::State& benchState, Args&&... args) {
     benchDrawLayers(*re, layers, benchState, "homescreen_edge_extension");
 }
 
+/**
+ * Measures how long the calling thread takes to submit bursts of buffer maps and unmaps, as
+ * happens when SurfaceFlinger latches new buffers. The RenderEngine thread handles them meanwhile.
+ */
+template <class... Args>
+void BM_mapUnmapBuffers(benchmark::State& benchState, Args&&... args) {
+    auto args_tuple = std::make_tuple(std::move(args)...);
+    auto re = createRenderEngine(static_cast<RenderEngine::Threaded>(std::get<0>(args_tuple)),
+                                 static_cast<RenderEngine::GraphicsApi>(std::get<1>(args_tuple)));
+
+    constexpr size_t kBurstSize = 16;
+    std::vector<sp<GraphicBuffer>> buffers;
+    for (size_t i = 0; i < kBurstSize; i++) {
+        buffers.push_back(sp<GraphicBuffer>::make(64u, 64u, HAL_PIXEL_FORMAT_RGBA_8888, 1u,
+                                                  GRALLOC_USAGE_HW_TEXTURE, "mapUnmap"));
+    }
+
+    std::vector<std::shared_ptr<ExternalTexture>> textures;
+    textures.reserve(kBurstSize);
+    for (auto _ : benchState) {
+        for (const auto& buffer : buffers) {
+            textures.push_back(
+                    std::make_shared<impl::ExternalTexture>(buffer, *re,
+                                                            impl::ExternalTexture::Usage::
+                                                                    READABLE));
+        }
+        textures.clear();
+    }
+
+    // Wait for the RenderEngine thread to catch up.
+    re->getContextPriority();
+    benchState.SetItemsProcessed(benchState.iterations() * kBurstSize);
+}
+
+/**
+ * Measures how long a new RenderEngine takes to prime its shader cache, either by drawing the
+ * built-in set of layers, or from the manifest of shaders compiled by a previous RenderEngine.
+ */
+template <class... Args>
+void BM_primeCache(benchmark::State& benchState, Args&&... args) {
+    auto args_tuple = std::make_tuple(std::move(args)...);
+    const auto threaded = static_cast<RenderEngine::Threaded>(std::get<0>(args_tuple));
+    const auto graphicsApi = static_cast<RenderEngine::GraphicsApi>(std::get<1>(args_tuple));
+    const bool useManifest = std::get<2>(args_tuple);
+
+    TemporaryDir dir;
+    const std::string shaderManifestPath = useManifest ? std::string(dir.path) + "/shaders" : "";
+    PrimeCacheConfig config;
+    if (useManifest) {
+        // The manifest is saved when the RenderEngine is destroyed.
+        auto re = createRenderEngine(threaded, graphicsApi, RenderEngine::BlurAlgorithm::KAWASE,
+                                     shaderManifestPath);
+        re->primeCache(config).wait();
+    }
+
+    for (auto _ : benchState) {
+        benchState.PauseTiming();
+        auto re = createRenderEngine(threaded, graphicsApi, RenderEngine::BlurAlgorithm::KAWASE,
+                                     shaderManifestPath);
+        benchState.ResumeTiming();
+
+        re->primeCache(config).wait();
+
+        benchState.PauseTiming();
+        re.reset();
+        benchState.ResumeTiming();
+    }
+}
+
 BENCHMARK_CAPTURE(BM_homescreen_blur, gaussian, RenderEngine::Threaded::YES,
                   RenderEngine::GraphicsApi::GL, RenderEngine::BlurAlgorithm::GAUSSIAN);
 
@@ -326,3 +397,12 @@ BENCHMARK_CAPTURE(BM_homescreen, SkiaGLThreaded, RenderEngine::Threaded::YES,
 BENCHMARK_CAPTURE(BM_homescreen_edgeExtension, SkiaGLThreaded, RenderEngine::Threaded::YES,
                   RenderEngine::GraphicsApi::GL);
 #endif
+
+BENCHMARK_CAPTURE(BM_mapUnmapBuffers, SkiaGLThreaded, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::GL);
+
+BENCHMARK_CAPTURE(BM_primeCache, SkiaGLThreaded, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::GL, /* useManifest */ false);
+
+BENCHMARK_CAPTURE(BM_primeCache, SkiaGLThreadedManifest, RenderEngine::Threaded::YES,
+                  RenderEngine::GraphicsApi::GL, /* useManifest */ true);
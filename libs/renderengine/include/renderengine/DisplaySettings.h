@@ -105,6 +105,11 @@ struct DisplaySettings {
 
     // For now, meaningful primarily when the TonemappingStrategy is Local
     float targetHdrSdrRatio = 1.f;
+
+    // If valid, only this rectangle of the output buffer, in buffer coordinates, is cleared and
+    // drawn to, and the rest of the buffer keeps its previous contents. Ignored when a layer
+    // requires blurring through an offscreen buffer.
+    Rect scissor = Rect::INVALID_RECT;
 };
 
 static inline bool operator==(const DisplaySettings& lhs, const DisplaySettings& rhs) {
@@ -116,7 +121,8 @@ static inline bool operator==(const DisplaySettings& lhs, const DisplaySettings&
             lhs.deviceHandlesColorTransform == rhs.deviceHandlesColorTransform &&
             lhs.orientation == rhs.orientation &&
             lhs.targetLuminanceNits == rhs.targetLuminanceNits &&
-            lhs.dimmingStage == rhs.dimmingStage && lhs.renderIntent == rhs.renderIntent;
+            lhs.dimmingStage == rhs.dimmingStage && lhs.renderIntent == rhs.renderIntent &&
+            lhs.scissor == rhs.scissor;
 }
 
 static const char* orientation_to_string(uint32_t orientation) {
@@ -161,6 +167,8 @@ static inline void PrintTo(const DisplaySettings& settings, ::std::ostream* os)
         << aidl::android::hardware::graphics::composer3::toString(settings.dimmingStage).c_str();
     *os << "\n    .renderIntent = "
         << aidl::android::hardware::graphics::composer3::toString(settings.renderIntent).c_str();
+    *os << "\n    .scissor = ";
+    PrintTo(settings.scissor, os);
     *os << "\n}";
 }
 
@@ -333,6 +333,9 @@ struct RenderEngineCreationArgs {
     RenderEngine::Threaded threaded;
     RenderEngine::GraphicsApi graphicsApi;
     RenderEngine::SkiaBackend skiaBackend;
+    // If set, the shaders compiled after primeCache are recorded to this file, and the next
+    // primeCache precompiles them instead of drawing the layers of PrimeCacheConfig.
+    std::string shaderManifestPath;
 
     struct Builder;
 
@@ -344,7 +347,8 @@ private:
                              RenderEngine::ContextPriority _contextPriority,
                              RenderEngine::Threaded _threaded,
                              RenderEngine::GraphicsApi _graphicsApi,
-                             RenderEngine::SkiaBackend _skiaBackend)
+                             RenderEngine::SkiaBackend _skiaBackend,
+                             std::string _shaderManifestPath)
           : pixelFormat(_pixelFormat),
             imageCacheSize(_imageCacheSize),
             enableProtectedContext(_enableProtectedContext),
@@ -353,7 +357,8 @@ private:
             contextPriority(_contextPriority),
             threaded(_threaded),
             graphicsApi(_graphicsApi),
-            skiaBackend(_skiaBackend) {}
+            skiaBackend(_skiaBackend),
+            shaderManifestPath(std::move(_shaderManifestPath)) {}
     RenderEngineCreationArgs() = delete;
 };
 
@@ -396,10 +401,15 @@ struct RenderEngineCreationArgs::Builder {
         this->skiaBackend = skiaBackend;
         return *this;
     }
+    Builder& setShaderManifestPath(std::string shaderManifestPath) {
+        this->shaderManifestPath = std::move(shaderManifestPath);
+        return *this;
+    }
     RenderEngineCreationArgs build() const {
         return RenderEngineCreationArgs(pixelFormat, imageCacheSize, enableProtectedContext,
                                         precacheToneMapperShaderOnly, blurAlgorithm,
-                                        contextPriority, threaded, graphicsApi, skiaBackend);
+                                        contextPriority, threaded, graphicsApi, skiaBackend,
+                                        shaderManifestPath);
     }
 
 private:
@@ -413,6 +423,7 @@ private:
     RenderEngine::Threaded threaded = RenderEngine::Threaded::YES;
     RenderEngine::GraphicsApi graphicsApi = RenderEngine::GraphicsApi::GL;
     RenderEngine::SkiaBackend skiaBackend = RenderEngine::SkiaBackend::GANESH;
+    std::string shaderManifestPath;
 };
 
 } // namespace renderengine
@@ -56,7 +56,7 @@ static void unref_semaphore(void* semaphore) {
 std::unique_ptr<SkiaGpuContext> GaneshVkRenderEngine::createContext(
         VulkanInterface& vulkanInterface) {
     return SkiaGpuContext::MakeVulkan_Ganesh(vulkanInterface.getGaneshBackendContext(),
-                                             mSkSLCacheMonitor);
+                                             mSkSLCacheMonitor, shaderCacheStrategy());
 }
 
 void GaneshVkRenderEngine::waitFence(SkiaGpuContext* context, base::borrowed_fd fenceFd) {
@@ -0,0 +1,242 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "RenderEngine"
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+
+#include "ShaderManifest.h"
+
+#include <android-base/file.h>
+#include <common/trace.h>
+#include <log/log.h>
+
+#include <sched.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+
+namespace android::renderengine::skia {
+
+namespace {
+
+// The file holds the header, followed by the size of the key, the size of the data, the key and
+// the data of each entry. All integers are native endian uint32_t.
+constexpr uint32_t kMagic = 0x4d534653; // "SFSM"
+constexpr uint32_t kVersion = 1;
+
+void appendUint32(std::string& out, uint32_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendBytes(std::string& out, const void* bytes, size_t size) {
+    out.append(static_cast<const char*>(bytes), size);
+}
+
+class Reader {
+public:
+    explicit Reader(const std::string& in) : mIn(in) {}
+
+    bool readUint32(uint32_t& value) {
+        if (mIn.size() - mOffset < sizeof(value)) {
+            return false;
+        }
+        std::memcpy(&value, mIn.data() + mOffset, sizeof(value));
+        mOffset += sizeof(value);
+        return true;
+    }
+
+    const char* readBytes(size_t size) {
+        if (mIn.size() - mOffset < size) {
+            return nullptr;
+        }
+        const char* bytes = mIn.data() + mOffset;
+        mOffset += size;
+        return bytes;
+    }
+
+    bool atEnd() const { return mOffset == mIn.size(); }
+
+private:
+    const std::string& mIn;
+    size_t mOffset = 0;
+};
+
+std::string toString(const SkData& data) {
+    return std::string(static_cast<const char*>(data.data()), data.size());
+}
+
+bool write(const std::string& path, const std::string& buildId,
+           const std::vector<ShaderManifest::Entry>& entries) {
+    SFTRACE_CALL();
+    std::string contents;
+    size_t size = buildId.size() + 4 * sizeof(uint32_t);
+    for (const auto& entry : entries) {
+        size += 2 * sizeof(uint32_t) + entry.key->size() + entry.data->size();
+    }
+    contents.reserve(size);
+    appendUint32(contents, kMagic);
+    appendUint32(contents, kVersion);
+    appendUint32(contents, static_cast<uint32_t>(buildId.size()));
+    appendBytes(contents, buildId.data(), buildId.size());
+    appendUint32(contents, static_cast<uint32_t>(entries.size()));
+    for (const auto& entry : entries) {
+        appendUint32(contents, static_cast<uint32_t>(entry.key->size()));
+        appendUint32(contents, static_cast<uint32_t>(entry.data->size()));
+        appendBytes(contents, entry.key->data(), entry.key->size());
+        appendBytes(contents, entry.data->data(), entry.data->size());
+    }
+
+    // Write a temporary file first, so that a crash cannot leave a partial manifest behind.
+    const std::string tempPath = path + ".tmp";
+    if (!base::WriteStringToFile(contents, tempPath) ||
+        std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        ALOGE("Failed to write shader manifest %s: %s", path.c_str(), strerror(errno));
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+ShaderManifest::ShaderManifest(std::string path, std::string buildId)
+      : mPath(std::move(path)), mBuildId(std::move(buildId)) {}
+
+bool ShaderManifest::load() {
+    SFTRACE_CALL();
+    waitForPendingSave();
+    clear();
+
+    std::string contents;
+    if (!base::ReadFileToString(mPath, &contents)) {
+        return false;
+    }
+
+    Reader reader(contents);
+    uint32_t magic, version, buildIdSize, count;
+    const char* buildId;
+    if (!reader.readUint32(magic) || magic != kMagic || !reader.readUint32(version) ||
+        version != kVersion || !reader.readUint32(buildIdSize) ||
+        !(buildId = reader.readBytes(buildIdSize)) ||
+        std::string_view(buildId, buildIdSize) != mBuildId || !reader.readUint32(count)) {
+        ALOGI("Ignoring shader manifest %s from another build", mPath.c_str());
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t keySize, dataSize;
+        const char* key;
+        const char* data;
+        if (!reader.readUint32(keySize) || !reader.readUint32(dataSize) ||
+            !(key = reader.readBytes(keySize)) || !(data = reader.readBytes(dataSize))) {
+            ALOGW("Ignoring truncated shader manifest %s", mPath.c_str());
+            clear();
+            return false;
+        }
+        if (mEntries.size() == kMaxEntries || mBytes + keySize + dataSize > kMaxBytes ||
+            !mKeys.emplace(key, keySize).second) {
+            continue;
+        }
+        mEntries.push_back({SkData::MakeWithCopy(key, keySize),
+                            SkData::MakeWithCopy(data, dataSize)});
+        mBytes += keySize + dataSize;
+    }
+
+    if (!reader.atEnd()) {
+        ALOGW("Ignoring corrupt shader manifest %s", mPath.c_str());
+        clear();
+        return false;
+    }
+    return true;
+}
+
+bool ShaderManifest::save() {
+    waitForPendingSave();
+    if (!mDirty) {
+        return true;
+    }
+    if (!write(mPath, mBuildId, mEntries)) {
+        return false;
+    }
+    mDirty = false;
+    return true;
+}
+
+void ShaderManifest::saveAsync(nsecs_t now) {
+    if (!mDirty || isSavePending()) {
+        return;
+    }
+    if (!waitForPendingSave() || !mDirty) {
+        return;
+    }
+
+    // The entries are immutable and reference counted, so the snapshot only copies pointers.
+    mPendingSave = std::async(std::launch::async,
+                              [path = mPath, buildId = mBuildId, entries = mEntries] {
+                                  // Do not inherit the real-time policy of RenderEngine.
+                                  const sched_param param = {.sched_priority = 0};
+                                  sched_setscheduler(0, SCHED_OTHER, &param);
+                                  return write(path, buildId, entries);
+                              });
+    mPendingSaveCount = mEntries.size();
+    mPendingSaveTime = now;
+}
+
+bool ShaderManifest::isSavePending() const {
+    return mPendingSave.valid() &&
+            mPendingSave.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+bool ShaderManifest::waitForPendingSave() {
+    if (!mPendingSave.valid()) {
+        return true;
+    }
+    if (!mPendingSave.get()) {
+        // The entries are still dirty. Retry after the save delay, rather than on every check.
+        mLastRecordTime = std::max(mLastRecordTime, mPendingSaveTime);
+        return false;
+    }
+    // Entries recorded since the snapshot are left for the next save.
+    mDirty = mEntries.size() != mPendingSaveCount;
+    return true;
+}
+
+void ShaderManifest::record(const SkData& key, const SkData& data, nsecs_t now) {
+    if (mEntries.size() == kMaxEntries || mBytes + key.size() + data.size() > kMaxBytes ||
+        !mKeys.insert(toString(key)).second) {
+        return;
+    }
+
+    mEntries.push_back({SkData::MakeWithCopy(key.data(), key.size()),
+                        SkData::MakeWithCopy(data.data(), data.size())});
+    mBytes += key.size() + data.size();
+    mDirty = true;
+    mLastRecordTime = now;
+}
+
+void ShaderManifest::clear() {
+    mEntries.clear();
+    mKeys.clear();
+    mBytes = 0;
+    mDirty = false;
+}
+
+} // namespace android::renderengine::skia
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <SkData.h>
+#include <SkRefCnt.h>
+#include <utils/Timers.h>
+
+#include <future>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace android::renderengine::skia {
+
+/**
+ * Records the Skia programs that RenderEngine compiles on this device, so that the next boot can
+ * precompile those instead of drawing a fixed set of layers.
+ *
+ * Each entry is the key and data that Skia hands to GrContextOptions::PersistentCache::store,
+ * which GrDirectContext::precompileShader accepts as is. Entries are kept in the order they were
+ * first compiled, so that the programs needed for the first frames after boot come first.
+ *
+ * The manifest is stored in a single file tagged with a build id, since the data depends on the
+ * Skia version and the driver. A file from another build is ignored.
+ */
+class ShaderManifest {
+public:
+    struct Entry {
+        sk_sp<SkData> key;
+        sk_sp<SkData> data;
+    };
+
+    // Programs past these limits are not recorded.
+    static constexpr size_t kMaxEntries = 512;
+    static constexpr size_t kMaxBytes = 4 * 1024 * 1024;
+
+    // Time without new programs to wait for before saving, so that a burst of compilations, as
+    // when an app starts, is saved once.
+    static constexpr nsecs_t kSaveDelay = ms2ns(2000);
+
+    ShaderManifest(std::string path, std::string buildId);
+
+    // Replaces the entries with those on disk. Returns false if the file is missing, corrupt, or
+    // from another build, in which case the manifest is left empty.
+    bool load();
+
+    // Writes the entries to disk if they changed since they were loaded or last saved. Waits for
+    // a pending saveAsync first.
+    bool save();
+
+    // Like save, but writes a snapshot of the entries from a background thread, so that the
+    // caller does not block on file I/O. Does nothing while a previous save is in progress, or if
+    // the previous one failed, in which case it is retried once kSaveDelay passed again. The
+    // entries stay dirty until a save succeeds.
+    void saveAsync(nsecs_t now);
+
+    // Adds a program, unless it is already recorded or the manifest is full.
+    void record(const SkData& key, const SkData& data, nsecs_t now);
+
+    bool needsSave(nsecs_t now) const {
+        return mDirty && !isSavePending() && now - mLastRecordTime >= kSaveDelay;
+    }
+
+    // Waits for a pending saveAsync, if any. Returns false if it failed.
+    bool waitForPendingSave();
+
+    // Entries in the order they should be precompiled.
+    const std::vector<Entry>& getEntries() const { return mEntries; }
+
+private:
+    bool isSavePending() const;
+    void clear();
+
+    const std::string mPath;
+    const std::string mBuildId;
+
+    std::vector<Entry> mEntries;
+    std::unordered_set<std::string> mKeys;
+    size_t mBytes = 0;
+
+    bool mDirty = false;
+    nsecs_t mLastRecordTime = 0;
+
+    std::future<bool> mPendingSave;
+    // The number of entries in the snapshot being saved, and when the save started.
+    size_t mPendingSaveCount = 0;
+    nsecs_t mPendingSaveTime = 0;
+};
+
+} // namespace android::renderengine::skia
@@ -49,6 +49,7 @@
 #include <SkString.h>
 #include <SkSurface.h>
 #include <SkTileMode.h>
+#include <android-base/properties.h>
 #include <android-base/stringprintf.h>
 #include <common/FlagManager.h>
 #include <common/trace.h>
@@ -258,10 +259,38 @@ void trace(sp<Fence> fence) {
 using base::StringAppendF;
 
 std::future<void> SkiaRenderEngine::primeCache(PrimeCacheConfig config) {
+    if (mShaderManifest) {
+        const bool prewarmed = mShaderManifest->load() && prewarmShaders(*mShaderManifest);
+        mSkSLCacheMonitor.setManifest(mShaderManifest.get());
+        if (prewarmed) {
+            return {};
+        }
+    }
     Cache::primeShaderCache(this, config);
     return {};
 }
 
+bool SkiaRenderEngine::prewarmShaders(const ShaderManifest& manifest) {
+    SFTRACE_CALL();
+    const sk_sp<GrDirectContext> grContext = mContext->grDirectContext();
+    if (!grContext) {
+        return false;
+    }
+
+    const nsecs_t timeBefore = systemTime();
+    size_t prewarmed = 0;
+    for (const auto& entry : manifest.getEntries()) {
+        if (grContext->precompileShader(*entry.key, *entry.data)) {
+            prewarmed++;
+        }
+    }
+    mShadersPrewarmed = static_cast<int>(prewarmed);
+    const float prewarmTimeMs = static_cast<float>(systemTime() - timeBefore) / 1.0E6;
+    ALOGD("Prewarmed %zu of %zu shaders from manifest in %f ms", prewarmed,
+          manifest.getEntries().size(), prewarmTimeMs);
+    return prewarmed > 0 || manifest.getEntries().empty();
+}
+
 sk_sp<SkData> SkiaRenderEngine::SkSLCacheMonitor::load(const SkData& key) {
     // This "cache" does not actually cache anything. It just allows us to
     // monitor Skia's internal cache. So this method always returns null.
@@ -273,18 +302,27 @@ void SkiaRenderEngine::SkSLCacheMonitor::store(const SkData& key, const SkData&
     mShadersCachedSinceLastCall++;
     mTotalShadersCompiled++;
     SFTRACE_FORMAT("SF cache: %i shaders", mTotalShadersCompiled);
+    if (mManifest) {
+        mManifest->record(key, data, systemTime());
+    }
 }
 
 int SkiaRenderEngine::reportShadersCompiled() {
     return mSkSLCacheMonitor.totalShadersCompiled();
 }
 
+GrContextOptions::ShaderCacheStrategy SkiaRenderEngine::shaderCacheStrategy() const {
+    // Otherwise keep Skia's default of handing out backend binaries.
+    return mShaderManifest ? GrContextOptions::ShaderCacheStrategy::kSkSL
+                           : GrContextOptions::ShaderCacheStrategy::kBackendBinary;
+}
+
 void SkiaRenderEngine::setEnableTracing(bool tracingEnabled) {
     SkAndroidFrameworkTraceUtil::setEnableTracing(tracingEnabled);
 }
 
 SkiaRenderEngine::SkiaRenderEngine(Threaded threaded, PixelFormat pixelFormat,
-                                   BlurAlgorithm blurAlgorithm)
+                                   BlurAlgorithm blurAlgorithm, std::string shaderManifestPath)
       : RenderEngine(threaded), mDefaultPixelFormat(pixelFormat) {
     switch (blurAlgorithm) {
         case BlurAlgorithm::GAUSSIAN: {
@@ -309,9 +347,20 @@ SkiaRenderEngine::SkiaRenderEngine(Threaded threaded, PixelFormat pixelFormat,
     }
 
     mCapture = std::make_unique<SkiaCapture>();
+
+    if (!shaderManifestPath.empty()) {
+        mShaderManifest =
+                std::make_unique<ShaderManifest>(std::move(shaderManifestPath),
+                                                 base::GetProperty("ro.build.fingerprint", ""));
+    }
 }
 
-SkiaRenderEngine::~SkiaRenderEngine() { }
+SkiaRenderEngine::~SkiaRenderEngine() {
+    if (mShaderManifest) {
+        mSkSLCacheMonitor.setManifest(nullptr);
+        mShaderManifest->save();
+    }
+}
 
 // To be called from backend dtors. Used to clean up Skia objects before GPU API contexts are
 // destroyed by subclasses.
@@ -511,13 +560,17 @@ std::shared_ptr<AutoBackendTexture::LocalRef> SkiaRenderEngine::getOrCreateBacke
 
 bool SkiaRenderEngine::canSkipPostRenderCleanup() const {
     std::lock_guard<std::mutex> lock(mRenderingMutex);
-    return mTextureCleanupMgr.isEmpty();
+    return mTextureCleanupMgr.isEmpty() &&
+            !(mShaderManifest && mShaderManifest->needsSave(systemTime()));
 }
 
 void SkiaRenderEngine::cleanupPostRender() {
     SFTRACE_CALL();
     std::lock_guard<std::mutex> lock(mRenderingMutex);
     mTextureCleanupMgr.cleanup();
+    if (const nsecs_t now = systemTime(); mShaderManifest && mShaderManifest->needsSave(now)) {
+        mShaderManifest->saveAsync(now);
+    }
 }
 
 sk_sp<SkShader> SkiaRenderEngine::createRuntimeEffectShader(
@@ -820,6 +873,12 @@ void SkiaRenderEngine::drawLayersInternal(
     }
 
     AutoSaveRestore surfaceAutoSaveRestore(canvas);
+    // Partial redraws rely on the rest of the output buffer being kept, which the offscreen buffer
+    // used for blurring does not do.
+    const bool useScissor = display.scissor.isValid() && blurCompositionLayer == nullptr;
+    if (useScissor) {
+        canvas->clipRect(getSkRect(display.scissor));
+    }
     // Clear the entire canvas with a transparent black to prevent ghost images.
     canvas->clear(SK_ColorTRANSPARENT);
     initCanvas(canvas, display);
@@ -1381,6 +1440,10 @@ void SkiaRenderEngine::dump(std::string& result) {
     StringAppendF(&result, "RenderEngine is in protected context: %d\n", mInProtectedContext);
     StringAppendF(&result, "RenderEngine shaders cached since last dump/primeCache: %d\n",
                   mSkSLCacheMonitor.shadersCachedSinceLastCall());
+    if (mShaderManifest) {
+        StringAppendF(&result, "RenderEngine shader manifest: %zu shaders\n",
+                      mShaderManifest->getEntries().size());
+    }
 
     std::vector<ResourcePair> cpuResourceMap = {
             {"skia/sk_resource_cache/bitmap_", "Bitmaps"},
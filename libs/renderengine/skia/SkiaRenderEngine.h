@@ -33,6 +33,7 @@
 #include <unordered_map>
 
 #include "AutoBackendTexture.h"
+#include "ShaderManifest.h"
 #include "android-base/macros.h"
 #include "compat/SkiaGpuContext.h"
 #include "debug/SkiaCapture.h"
@@ -60,7 +61,8 @@ class BlurFilter;
 class SkiaRenderEngine : public RenderEngine {
 public:
     static std::unique_ptr<SkiaRenderEngine> create(const RenderEngineCreationArgs& args);
-    SkiaRenderEngine(Threaded, PixelFormat pixelFormat, BlurAlgorithm);
+    SkiaRenderEngine(Threaded, PixelFormat pixelFormat, BlurAlgorithm,
+                     std::string shaderManifestPath);
     ~SkiaRenderEngine() override;
 
     std::future<void> primeCache(PrimeCacheConfig config) override final;
@@ -70,6 +72,8 @@ public:
     }
     void onActiveDisplaySizeChanged(ui::Size size) override final;
     int reportShadersCompiled();
+    // Number of shaders that primeCache precompiled from the shader manifest.
+    int reportShadersPrewarmed() const { return mShadersPrewarmed; }
 
     virtual void setEnableTracing(bool tracingEnabled) override final;
 
@@ -101,6 +105,10 @@ protected:
 
     bool isProtected() const { return mInProtectedContext; }
 
+    // The form in which Ganesh contexts hand compiled programs to mSkSLCacheMonitor. The shader
+    // manifest needs SkSL, which is what GrDirectContext::precompileShader accepts.
+    GrContextOptions::ShaderCacheStrategy shaderCacheStrategy() const;
+
     // Implements PersistentCache as a way to monitor what SkSL shaders Skia has
     // cached.
     class SkSLCacheMonitor : public GrContextOptions::PersistentCache {
@@ -120,9 +128,13 @@ protected:
 
         int totalShadersCompiled() const { return mTotalShadersCompiled; }
 
+        // Records the shaders compiled from now on into the manifest, if not null.
+        void setManifest(ShaderManifest* manifest) { mManifest = manifest; }
+
     private:
         int mShadersCachedSinceLastCall = 0;
         int mTotalShadersCompiled = 0;
+        ShaderManifest* mManifest = nullptr;
     };
 
     SkSLCacheMonitor mSkSLCacheMonitor;
@@ -133,6 +145,8 @@ private:
     void unmapExternalTextureBuffer(sp<GraphicBuffer>&& buffer) override final;
     bool canSkipPostRenderCleanup() const override final;
 
+    // Precompiles the shaders of the manifest. Returns false if the context does not support it.
+    bool prewarmShaders(const ShaderManifest& manifest);
     std::shared_ptr<AutoBackendTexture::LocalRef> getOrCreateBackendTexture(
             const sp<GraphicBuffer>& buffer, bool isOutputBuffer) REQUIRES(mRenderingMutex);
     void initCanvas(SkCanvas* canvas, const DisplaySettings& display);
@@ -193,6 +207,10 @@ private:
     // Object to capture commands send to Skia.
     std::unique_ptr<SkiaCapture> mCapture;
 
+    // Shaders compiled on this device, if enabled by RenderEngineCreationArgs::shaderManifestPath.
+    std::unique_ptr<ShaderManifest> mShaderManifest;
+    int mShadersPrewarmed = 0;
+
     // Mutex guarding rendering operations, so that internal state related to
     // rendering that is potentially modified by multiple threads is guaranteed thread-safe.
     mutable std::mutex mRenderingMutex;
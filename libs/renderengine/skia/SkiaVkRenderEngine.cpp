@@ -109,7 +109,7 @@ using base::StringAppendF;
 
 SkiaVkRenderEngine::SkiaVkRenderEngine(const RenderEngineCreationArgs& args)
       : SkiaRenderEngine(args.threaded, static_cast<PixelFormat>(args.pixelFormat),
-                         args.blurAlgorithm) {}
+                         args.blurAlgorithm, args.shaderManifestPath) {}
 
 SkiaVkRenderEngine::~SkiaVkRenderEngine() {
     finishRenderingAndAbandonContexts();
@@ -38,28 +38,34 @@
 namespace android::renderengine::skia {
 
 namespace {
-static GrContextOptions ganeshOptions(GrContextOptions::PersistentCache& skSLCacheMonitor) {
+static GrContextOptions ganeshOptions(GrContextOptions::PersistentCache& skSLCacheMonitor,
+                                      GrContextOptions::ShaderCacheStrategy shaderCacheStrategy) {
     GrContextOptions options;
     options.fDisableDriverCorrectnessWorkarounds = true;
     options.fDisableDistanceFieldPaths = true;
     options.fReducedShaderVariations = true;
     options.fPersistentCache = &skSLCacheMonitor;
+    options.fShaderCacheStrategy = shaderCacheStrategy;
     return options;
 }
 } // namespace
 
 std::unique_ptr<SkiaGpuContext> SkiaGpuContext::MakeGL_Ganesh(
         sk_sp<const GrGLInterface> glInterface,
-        GrContextOptions::PersistentCache& skSLCacheMonitor) {
+        GrContextOptions::PersistentCache& skSLCacheMonitor,
+        GrContextOptions::ShaderCacheStrategy shaderCacheStrategy) {
     return std::make_unique<GaneshGpuContext>(
-            GrDirectContexts::MakeGL(glInterface, ganeshOptions(skSLCacheMonitor)));
+            GrDirectContexts::MakeGL(glInterface,
+                                     ganeshOptions(skSLCacheMonitor, shaderCacheStrategy)));
 }
 
 std::unique_ptr<SkiaGpuContext> SkiaGpuContext::MakeVulkan_Ganesh(
         const skgpu::VulkanBackendContext& vkBackendContext,
-        GrContextOptions::PersistentCache& skSLCacheMonitor) {
+        GrContextOptions::PersistentCache& skSLCacheMonitor,
+        GrContextOptions::ShaderCacheStrategy shaderCacheStrategy) {
     return std::make_unique<GaneshGpuContext>(
-            GrDirectContexts::MakeVulkan(vkBackendContext, ganeshOptions(skSLCacheMonitor)));
+            GrDirectContexts::MakeVulkan(vkBackendContext,
+                                         ganeshOptions(skSLCacheMonitor, shaderCacheStrategy)));
 }
 
 GaneshGpuContext::GaneshGpuContext(sk_sp<GrDirectContext> grContext) : mGrContext(grContext) {
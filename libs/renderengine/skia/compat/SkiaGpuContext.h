@@ -45,17 +45,21 @@ class SkiaGpuContext {
 public:
     /**
      * glInterface must remain valid until after SkiaGpuContext is destroyed.
+     * shaderCacheStrategy is the form in which programs are handed to skSLCacheMonitor. Only SkSL
+     * can be passed back to GrDirectContext::precompileShader.
      */
     static std::unique_ptr<SkiaGpuContext> MakeGL_Ganesh(
             sk_sp<const GrGLInterface> glInterface,
-            GrContextOptions::PersistentCache& skSLCacheMonitor);
+            GrContextOptions::PersistentCache& skSLCacheMonitor,
+            GrContextOptions::ShaderCacheStrategy shaderCacheStrategy);
 
     /**
      * vkBackendContext must remain valid until after SkiaGpuContext is destroyed.
      */
     static std::unique_ptr<SkiaGpuContext> MakeVulkan_Ganesh(
             const skgpu::VulkanBackendContext& vkBackendContext,
-            GrContextOptions::PersistentCache& skSLCacheMonitor);
+            GrContextOptions::PersistentCache& skSLCacheMonitor,
+            GrContextOptions::ShaderCacheStrategy shaderCacheStrategy);
 
     // TODO: b/293371537 - Need shader / pipeline monitoring support in Graphite.
     /**
@@ -22,6 +22,7 @@
 #pragma clang diagnostic ignored "-Wconversion"
 #pragma clang diagnostic ignored "-Wextra"
 
+#include <android-base/file.h>
 #include <com_android_graphics_surfaceflinger_flags.h>
 #include <cutils/properties.h>
 #include <gtest/gtest.h>
@@ -121,7 +122,8 @@ public:
     virtual renderengine::RenderEngine::GraphicsApi graphicsApi() = 0;
     virtual renderengine::RenderEngine::SkiaBackend skiaBackend() = 0;
     bool apiSupported() { return renderengine::RenderEngine::canSupport(graphicsApi()); }
-    std::unique_ptr<renderengine::RenderEngine> createRenderEngine() {
+    std::unique_ptr<renderengine::RenderEngine> createRenderEngine(
+            std::string shaderManifestPath = {}) {
         renderengine::RenderEngineCreationArgs reCreationArgs =
                 renderengine::RenderEngineCreationArgs::Builder()
                         .setPixelFormat(static_cast<int>(ui::PixelFormat::RGBA_8888))
@@ -133,6 +135,7 @@ public:
                         .setThreaded(renderengine::RenderEngine::Threaded::NO)
                         .setGraphicsApi(graphicsApi())
                         .setSkiaBackend(skiaBackend())
+                        .setShaderManifestPath(std::move(shaderManifestPath))
                         .build();
         return renderengine::RenderEngine::create(reCreationArgs);
     }
@@ -1587,6 +1590,41 @@ TEST_P(RenderEngineTest, drawLayers_fillRedBufferAndEmptyBuffer) {
     expectBufferColor(fullscreenRect(), 0, 0, 0, 0);
 }
 
+TEST_P(RenderEngineTest, drawLayers_scissorKeepsContentOutsideOfIt) {
+    if (!GetParam()->apiSupported()) {
+        GTEST_SKIP();
+    }
+    initializeRenderEngine();
+    renderengine::DisplaySettings settings;
+    settings.physicalDisplay = fullscreenRect();
+    settings.clip = fullscreenRect();
+    settings.outputDataspace = ui::Dataspace::V0_SRGB_LINEAR;
+
+    renderengine::LayerSettings redLayer{
+            .geometry.boundaries = fullscreenRect().toFloatRect(),
+            .source.solidColor = half3(1.0f, 0.0f, 0.0f),
+            .alpha = 1.f,
+    };
+    std::vector<renderengine::LayerSettings> redLayers{redLayer};
+    invokeDraw(settings, redLayers);
+    expectBufferColor(fullscreenRect(), 255, 0, 0, 255);
+
+    // Only the scissored half of the buffer is redrawn in blue.
+    const Rect scissor(DEFAULT_DISPLAY_WIDTH / 2, DEFAULT_DISPLAY_HEIGHT);
+    settings.scissor = scissor;
+    renderengine::LayerSettings blueLayer{
+            .geometry.boundaries = fullscreenRect().toFloatRect(),
+            .source.solidColor = half3(0.0f, 0.0f, 1.0f),
+            .alpha = 1.f,
+    };
+    std::vector<renderengine::LayerSettings> blueLayers{blueLayer};
+    invokeDraw(settings, blueLayers);
+    expectBufferColor(scissor, 0, 0, 255, 255);
+    expectBufferColor(Rect(DEFAULT_DISPLAY_WIDTH / 2, 0, DEFAULT_DISPLAY_WIDTH,
+                           DEFAULT_DISPLAY_HEIGHT),
+                      255, 0, 0, 255);
+}
+
 TEST_P(RenderEngineTest, drawLayers_withoutBuffers_withColorTransform) {
     if (!GetParam()->apiSupported()) {
         GTEST_SKIP();
@@ -3410,6 +3448,43 @@ TEST_P(RenderEngineTest, primeShaderCache) {
     ASSERT_GT(static_cast<skia::SkiaGLRenderEngine*>(mRE.get())->reportShadersCompiled(),
               kMinimumExpectedShadersCompiled);
 }
+
+TEST_P(RenderEngineTest, primeShaderCacheFromManifest) {
+    if (GetParam()->skiaBackend() == renderengine::RenderEngine::SkiaBackend::GRAPHITE) {
+        GTEST_SKIP();
+    }
+
+    if (!GetParam()->apiSupported()) {
+        GTEST_SKIP();
+    }
+
+    TemporaryDir dir;
+    const std::string shaderManifestPath = std::string(dir.path) + "/shaders";
+    PrimeCacheConfig config;
+    config.cacheUltraHDR = false;
+
+    // Without a manifest, the layers are drawn, and the shaders they compile are recorded. The
+    // manifest is saved when the RenderEngine is destroyed.
+    mRE = GetParam()->createRenderEngine(shaderManifestPath);
+    auto fut = mRE->primeCache(config);
+    if (fut.valid()) {
+        fut.wait();
+    }
+    const int shadersCompiled =
+            static_cast<skia::SkiaRenderEngine*>(mRE.get())->reportShadersCompiled();
+    ASSERT_GT(shadersCompiled, 0);
+    EXPECT_EQ(0, static_cast<skia::SkiaRenderEngine*>(mRE.get())->reportShadersPrewarmed());
+    mRE.reset();
+
+    // The next RenderEngine precompiles every recorded shader instead.
+    mRE = GetParam()->createRenderEngine(shaderManifestPath);
+    fut = mRE->primeCache(config);
+    if (fut.valid()) {
+        fut.wait();
+    }
+    EXPECT_EQ(shadersCompiled,
+              static_cast<skia::SkiaRenderEngine*>(mRE.get())->reportShadersPrewarmed());
+}
 } // namespace renderengine
 } // namespace android
 
@@ -73,6 +73,36 @@ TEST_F(RenderEngineThreadedTest, primeCache) {
     mThreadedRE->getContextPriority();
 }
 
+TEST_F(RenderEngineThreadedTest, runsWorkInOrderPastQueueCapacity) {
+    // Blocks the thread so that the work queued below overflows the ring.
+    std::promise<void> blocked;
+    std::promise<void> unblock;
+    EXPECT_CALL(*mRenderEngine, dump(_)).WillOnce([&](std::string&) {
+        blocked.set_value();
+        unblock.get_future().wait();
+    });
+    {
+        testing::InSequence seq;
+        for (int32_t i = 0; i < 1000; i++) {
+            EXPECT_CALL(*mRenderEngine, onActiveDisplaySizeChanged(ui::Size(i, i)));
+        }
+    }
+
+    std::thread dumpThread([this] {
+        std::string result;
+        mThreadedRE->dump(result);
+    });
+    blocked.get_future().wait();
+    for (int32_t i = 0; i < 1000; i++) {
+        mThreadedRE->onActiveDisplaySizeChanged(ui::Size(i, i));
+    }
+    unblock.set_value();
+    dumpThread.join();
+
+    // call ANY synchronous function to ensure that all of the work has completed.
+    mThreadedRE->getContextPriority();
+}
+
 TEST_F(RenderEngineThreadedTest, getMaxTextureSize_returns20) {
     size_t size = 20;
     EXPECT_CALL(*mRenderEngine, getMaxTextureSize()).WillOnce(Return(size));
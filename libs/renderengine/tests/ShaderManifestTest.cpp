@@ -0,0 +1,185 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <android-base/file.h>
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+
+#include <string>
+
+#include "../skia/ShaderManifest.h"
+
+namespace android::renderengine::skia {
+namespace {
+
+constexpr char kBuildId[] = "build";
+
+sk_sp<SkData> makeData(const std::string& string) {
+    return SkData::MakeWithCopy(string.data(), string.size());
+}
+
+std::string toString(const sk_sp<SkData>& data) {
+    return std::string(static_cast<const char*>(data->data()), data->size());
+}
+
+class ShaderManifestTest : public testing::Test {
+protected:
+    std::string getPath() const { return std::string(mDir.path) + "/shaders"; }
+
+    void record(ShaderManifest& manifest, const std::string& key, const std::string& data) {
+        manifest.record(*makeData(key), *makeData(data), mNow);
+    }
+
+    TemporaryDir mDir;
+    nsecs_t mNow = 0;
+};
+
+TEST_F(ShaderManifestTest, loadFailsWithoutFile) {
+    ShaderManifest manifest(getPath(), kBuildId);
+    EXPECT_FALSE(manifest.load());
+    EXPECT_TRUE(manifest.getEntries().empty());
+}
+
+TEST_F(ShaderManifestTest, savesAndLoadsEntriesInOrder) {
+    ShaderManifest manifest(getPath(), kBuildId);
+    record(manifest, "key2", "data2");
+    record(manifest, "key1", "data1");
+    record(manifest, "key2", "other data");
+    ASSERT_TRUE(manifest.save());
+
+    ShaderManifest loaded(getPath(), kBuildId);
+    ASSERT_TRUE(loaded.load());
+    const auto& entries = loaded.getEntries();
+    ASSERT_EQ(2u, entries.size());
+    EXPECT_EQ("key2", toString(entries[0].key));
+    EXPECT_EQ("data2", toString(entries[0].data));
+    EXPECT_EQ("key1", toString(entries[1].key));
+    EXPECT_EQ("data1", toString(entries[1].data));
+
+    // Loaded entries are not recorded again.
+    record(loaded, "key1", "data1");
+    EXPECT_EQ(2u, loaded.getEntries().size());
+    EXPECT_FALSE(loaded.needsSave(mNow + ShaderManifest::kSaveDelay));
+}
+
+TEST_F(ShaderManifestTest, ignoresOtherBuild) {
+    ShaderManifest manifest(getPath(), kBuildId);
+    record(manifest, "key", "data");
+    ASSERT_TRUE(manifest.save());
+
+    ShaderManifest loaded(getPath(), "other build");
+    EXPECT_FALSE(loaded.load());
+    EXPECT_TRUE(loaded.getEntries().empty());
+}
+
+TEST_F(ShaderManifestTest, ignoresTruncatedFile) {
+    ShaderManifest manifest(getPath(), kBuildId);
+    record(manifest, "key", "data");
+    ASSERT_TRUE(manifest.save());
+
+    std::string contents;
+    ASSERT_TRUE(base::ReadFileToString(getPath(), &contents));
+    contents.pop_back();
+    ASSERT_TRUE(base::WriteStringToFile(contents, getPath()));
+
+    ShaderManifest loaded(getPath(), kBuildId);
+    EXPECT_FALSE(loaded.load());
+    EXPECT_TRUE(loaded.getEntries().empty());
+}
+
+TEST_F(ShaderManifestTest, savesAfterDelay) {
+    ShaderManifest manifest(getPath(), kBuildId);
+    EXPECT_FALSE(manifest.needsSave(mNow));
+
+    record(manifest, "key1", "data1");
+    mNow += ShaderManifest::kSaveDelay / 2;
+    record(manifest, "key2", "data2");
+    EXPECT_FALSE(manifest.needsSave(mNow + ShaderManifest::kSaveDelay / 2));
+    EXPECT_TRUE(manifest.needsSave(mNow + ShaderManifest::kSaveDelay));
+
+    ASSERT_TRUE(manifest.save());
+    EXPECT_FALSE(manifest.needsSave(mNow + ShaderManifest::kSaveDelay));
+}
+
+TEST_F(ShaderManifestTest, savesSnapshotAsync) {
+    ShaderManifest manifest(getPath(), kBuildId);
+    record(manifest, "key1", "data1");
+    manifest.saveAsync(mNow);
+
+    // Entries recorded while saving are left for the next save.
+    record(manifest, "key2", "data2");
+    ASSERT_TRUE(manifest.waitForPendingSave());
+
+    ShaderManifest loaded(getPath(), kBuildId);
+    ASSERT_TRUE(loaded.load());
+    ASSERT_EQ(1u, loaded.getEntries().size());
+    EXPECT_EQ("key1", toString(loaded.getEntries()[0].key));
+
+    EXPECT_TRUE(manifest.needsSave(mNow + ShaderManifest::kSaveDelay));
+    ASSERT_TRUE(manifest.save());
+    ASSERT_TRUE(loaded.load());
+    EXPECT_EQ(2u, loaded.getEntries().size());
+}
+
+TEST_F(ShaderManifestTest, savesAsyncUntilSnapshotIsSaved) {
+    ShaderManifest manifest(getPath(), kBuildId);
+    record(manifest, "key1", "data1");
+    mNow += ShaderManifest::kSaveDelay;
+    manifest.saveAsync(mNow);
+    ASSERT_TRUE(manifest.waitForPendingSave());
+    EXPECT_FALSE(manifest.needsSave(mNow + ShaderManifest::kSaveDelay));
+}
+
+TEST_F(ShaderManifestTest, retriesFailedAsyncSave) {
+    const std::string dir = std::string(mDir.path) + "/missing";
+    ShaderManifest manifest(dir + "/shaders", kBuildId);
+    record(manifest, "key1", "data1");
+    mNow += ShaderManifest::kSaveDelay;
+    manifest.saveAsync(mNow);
+    EXPECT_FALSE(manifest.waitForPendingSave());
+
+    // The entries stay dirty, and the save is retried after the save delay.
+    EXPECT_FALSE(manifest.needsSave(mNow + ShaderManifest::kSaveDelay / 2));
+    EXPECT_TRUE(manifest.needsSave(mNow + ShaderManifest::kSaveDelay));
+
+    ASSERT_EQ(0, mkdir(dir.c_str(), 0700));
+    mNow += ShaderManifest::kSaveDelay;
+    manifest.saveAsync(mNow);
+    ASSERT_TRUE(manifest.waitForPendingSave());
+    EXPECT_FALSE(manifest.needsSave(mNow + ShaderManifest::kSaveDelay));
+
+    ShaderManifest loaded(dir + "/shaders", kBuildId);
+    ASSERT_TRUE(loaded.load());
+    EXPECT_EQ(1u, loaded.getEntries().size());
+}
+
+TEST_F(ShaderManifestTest, stopsRecordingWhenFull) {
+    ShaderManifest manifest(getPath(), kBuildId);
+    for (size_t i = 0; i <= ShaderManifest::kMaxEntries; i++) {
+        record(manifest, std::to_string(i), "data");
+    }
+    EXPECT_EQ(ShaderManifest::kMaxEntries, manifest.getEntries().size());
+
+    ShaderManifest large(getPath(), kBuildId);
+    record(large, "key1", std::string(ShaderManifest::kMaxBytes / 2, 'a'));
+    record(large, "key2", std::string(ShaderManifest::kMaxBytes / 2, 'b'));
+    record(large, "key3", "data");
+    ASSERT_EQ(2u, large.getEntries().size());
+    EXPECT_EQ("key3", toString(large.getEntries()[1].key));
+}
+
+} // namespace
+} // namespace android::renderengine::skia
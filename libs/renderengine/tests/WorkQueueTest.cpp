@@ -0,0 +1,109 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <future>
+#include <thread>
+#include <utility>
+#include "../threaded/WorkQueue.h"
+
+namespace android {
+namespace {
+
+// Blocks the producer filling a slot of the ring with the work holding it.
+struct Gate {
+    std::promise<void> entered;
+    std::promise<void> released;
+};
+
+struct TestWork {
+    int id = 0;
+    Gate* gate = nullptr;
+
+    TestWork() = default;
+    explicit TestWork(int id, Gate* gate = nullptr) : id(id), gate(gate) {}
+
+    TestWork(TestWork&& other) noexcept
+          : id(std::exchange(other.id, 0)), gate(std::exchange(other.gate, nullptr)) {}
+
+    // Only the ring fills its slots by assignment.
+    TestWork& operator=(TestWork&& other) noexcept {
+        if (Gate* gate = std::exchange(other.gate, nullptr)) {
+            gate->entered.set_value();
+            gate->released.get_future().wait();
+        }
+        id = std::exchange(other.id, 0);
+        return *this;
+    }
+
+    explicit operator bool() const { return id != 0; }
+};
+
+using TestWorkQueue = renderengine::threaded::WorkQueue<TestWork, 2>;
+
+int popId(TestWorkQueue& queue) {
+    return queue.pop().id;
+}
+
+TEST(WorkQueueTest, popsInPushOrder) {
+    TestWorkQueue queue;
+    EXPECT_TRUE(queue.empty());
+
+    // The last two spill into the overflow.
+    for (int id = 1; id <= 4; id++) {
+        queue.push(TestWork(id));
+    }
+    EXPECT_FALSE(queue.empty());
+    EXPECT_EQ(1, popId(queue));
+
+    // The overflow is drained before the ring is used again.
+    queue.push(TestWork(5));
+    for (int id = 2; id <= 5; id++) {
+        EXPECT_EQ(id, popId(queue));
+    }
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(0, popId(queue));
+}
+
+TEST(WorkQueueTest, overflowWaitsForStalledProducer) {
+    TestWorkQueue queue;
+
+    // The stalled producer claims the first slot of the ring, but does not fill it yet.
+    Gate gate;
+    auto entered = gate.entered.get_future();
+    std::thread stalledProducer([&] { queue.push(TestWork(1, &gate)); });
+    entered.wait();
+
+    // The other producer fills the second slot, and spills into the overflow.
+    queue.push(TestWork(2));
+    queue.push(TestWork(3));
+
+    // Work 3 must not be popped before work 2, which is behind the stalled slot.
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(0, popId(queue));
+
+    gate.released.set_value();
+    stalledProducer.join();
+
+    EXPECT_FALSE(queue.empty());
+    EXPECT_EQ(1, popId(queue));
+    EXPECT_EQ(2, popId(queue));
+    EXPECT_EQ(3, popId(queue));
+    EXPECT_TRUE(queue.empty());
+}
+
+} // namespace
+} // namespace android
@@ -48,6 +48,10 @@ RenderEngineThreaded::RenderEngineThreaded(CreateInstanceFactory factory)
 
 RenderEngineThreaded::~RenderEngineThreaded() {
     mRunning = false;
+    {
+        std::lock_guard lock(mThreadMutex);
+        mWakeupRequested = true;
+    }
     mCondition.notify_one();
 
     if (mThread.joinable()) {
@@ -98,32 +102,47 @@ void RenderEngineThreaded::threadMain(CreateInstanceFactory factory) NO_THREAD_S
     mInitializedCondition.notify_all();
 
     while (mRunning) {
-        const auto getNextTask = [this]() -> std::optional<Work> {
-            std::scoped_lock lock(mThreadMutex);
-            if (!mFunctionCalls.empty()) {
-                Work task = mFunctionCalls.front();
-                mFunctionCalls.pop();
-                return std::make_optional<Work>(task);
-            }
-            return std::nullopt;
-        };
-
-        const auto task = getNextTask();
-
-        if (task) {
-            (*task)(*mRenderEngine);
+        while (Work work = mWorkQueue.pop()) {
+            work(*mRenderEngine);
         }
 
         std::unique_lock<std::mutex> lock(mThreadMutex);
-        mCondition.wait(lock, [this]() REQUIRES(mThreadMutex) {
-            return !mRunning || !mFunctionCalls.empty();
-        });
+        mThreadSleeping.store(true, std::memory_order_relaxed);
+        // Pairs with the fence in submit: either this thread sees the new work, or the submitting
+        // thread sees that this one is going to sleep.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (mWorkQueue.empty()) {
+            mCondition.wait(lock, [this] {
+                return !mRunning || mWakeupRequested.load(std::memory_order_relaxed);
+            });
+        }
+        mThreadSleeping.store(false, std::memory_order_relaxed);
+        mWakeupRequested.store(false, std::memory_order_relaxed);
+    }
+
+    // Drop the work that did not get to run while the RenderEngine is still around, since
+    // destroying it may release textures.
+    while (mWorkQueue.pop()) {
     }
 
     // we must release the RenderEngine on the thread that created it
     mRenderEngine.reset();
 }
 
+void RenderEngineThreaded::submit(Work&& work) const {
+    mWorkQueue.push(std::move(work));
+
+    // Only wake the thread if it is asleep, and only once until it wakes up, so that bursts of
+    // work like buffer maps and unmaps are handled in one go.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mThreadSleeping.load(std::memory_order_relaxed) &&
+        !mWakeupRequested.exchange(true, std::memory_order_relaxed)) {
+        // Taking the lock orders this wakeup after the thread started waiting.
+        std::lock_guard lock(mThreadMutex);
+        mCondition.notify_one();
+    }
+}
+
 void RenderEngineThreaded::waitUntilInitialized() const {
     if (!mIsInitialized) {
         std::unique_lock<std::mutex> lock(mInitializedMutex);
@@ -137,23 +156,19 @@ std::future<void> RenderEngineThreaded::primeCache(PrimeCacheConfig config) {
     SFTRACE_CALL();
     // This function is designed so it can run asynchronously, so we do not need to wait
     // for the futures.
-    {
-        std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([resultPromise, config](renderengine::RenderEngine& instance) {
-            SFTRACE_NAME("REThreaded::primeCache");
-            if (setSchedFifo(false) != NO_ERROR) {
-                ALOGW("Couldn't set SCHED_OTHER for primeCache");
-            }
-
-            instance.primeCache(config);
-            resultPromise->set_value();
-
-            if (setSchedFifo(true) != NO_ERROR) {
-                ALOGW("Couldn't set SCHED_FIFO for primeCache");
-            }
-        });
-    }
-    mCondition.notify_one();
+    submit([resultPromise, config](renderengine::RenderEngine& instance) {
+        SFTRACE_NAME("REThreaded::primeCache");
+        if (setSchedFifo(false) != NO_ERROR) {
+            ALOGW("Couldn't set SCHED_OTHER for primeCache");
+        }
+
+        instance.primeCache(config);
+        resultPromise->set_value();
+
+        if (setSchedFifo(true) != NO_ERROR) {
+            ALOGW("Couldn't set SCHED_FIFO for primeCache");
+        }
+    });
 
     return resultFuture;
 }
@@ -161,16 +176,12 @@ std::future<void> RenderEngineThreaded::primeCache(PrimeCacheConfig config) {
 void RenderEngineThreaded::dump(std::string& result) {
     std::promise<std::string> resultPromise;
     std::future<std::string> resultFuture = resultPromise.get_future();
-    {
-        std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([&resultPromise, &result](renderengine::RenderEngine& instance) {
-            SFTRACE_NAME("REThreaded::dump");
-            std::string localResult = result;
-            instance.dump(localResult);
-            resultPromise.set_value(std::move(localResult));
-        });
-    }
-    mCondition.notify_one();
+    submit([&resultPromise, &result](renderengine::RenderEngine& instance) {
+        SFTRACE_NAME("REThreaded::dump");
+        std::string localResult = result;
+        instance.dump(localResult);
+        resultPromise.set_value(std::move(localResult));
+    });
     // Note: This is an rvalue.
     result.assign(resultFuture.get());
 }
@@ -180,29 +191,20 @@ void RenderEngineThreaded::mapExternalTextureBuffer(const sp<GraphicBuffer>& buf
     SFTRACE_CALL();
     // This function is designed so it can run asynchronously, so we do not need to wait
     // for the futures.
-    {
-        std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([=](renderengine::RenderEngine& instance) {
-            SFTRACE_NAME("REThreaded::mapExternalTextureBuffer");
-            instance.mapExternalTextureBuffer(buffer, isRenderable);
-        });
-    }
-    mCondition.notify_one();
+    submit([=](renderengine::RenderEngine& instance) {
+        SFTRACE_NAME("REThreaded::mapExternalTextureBuffer");
+        instance.mapExternalTextureBuffer(buffer, isRenderable);
+    });
 }
 
 void RenderEngineThreaded::unmapExternalTextureBuffer(sp<GraphicBuffer>&& buffer) {
     SFTRACE_CALL();
     // This function is designed so it can run asynchronously, so we do not need to wait
     // for the futures.
-    {
-        std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push(
-                [=, buffer = std::move(buffer)](renderengine::RenderEngine& instance) mutable {
-                    SFTRACE_NAME("REThreaded::unmapExternalTextureBuffer");
-                    instance.unmapExternalTextureBuffer(std::move(buffer));
-                });
-    }
-    mCondition.notify_one();
+    submit([=, buffer = std::move(buffer)](renderengine::RenderEngine& instance) mutable {
+        SFTRACE_NAME("REThreaded::unmapExternalTextureBuffer");
+        instance.unmapExternalTextureBuffer(std::move(buffer));
+    });
 }
 
 size_t RenderEngineThreaded::getMaxTextureSize() const {
@@ -227,15 +229,11 @@ void RenderEngineThreaded::cleanupPostRender() {
 
     // This function is designed so it can run asynchronously, so we do not need to wait
     // for the futures.
-    {
-        std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([=](renderengine::RenderEngine& instance) {
-            SFTRACE_NAME("REThreaded::cleanupPostRender");
-            instance.cleanupPostRender();
-        });
-        mNeedsPostRenderCleanup = false;
-    }
-    mCondition.notify_one();
+    submit([=](renderengine::RenderEngine& instance) {
+        SFTRACE_NAME("REThreaded::cleanupPostRender");
+        instance.cleanupPostRender();
+    });
+    mNeedsPostRenderCleanup = false;
 }
 
 bool RenderEngineThreaded::canSkipPostRenderCleanup() const {
@@ -266,18 +264,13 @@ ftl::Future<FenceResult> RenderEngineThreaded::drawLayers(
     const auto resultPromise = std::make_shared<std::promise<FenceResult>>();
     std::future<FenceResult> resultFuture = resultPromise->get_future();
     int fd = bufferFence.release();
-    {
-        std::lock_guard lock(mThreadMutex);
-        mNeedsPostRenderCleanup = true;
-        mFunctionCalls.push(
-                [resultPromise, display, layers, buffer, fd](renderengine::RenderEngine& instance) {
-                    SFTRACE_NAME("REThreaded::drawLayers");
-                    instance.updateProtectedContext(layers, {buffer.get()});
-                    instance.drawLayersInternal(std::move(resultPromise), display, layers, buffer,
-                                                base::unique_fd(fd));
-                });
-    }
-    mCondition.notify_one();
+    mNeedsPostRenderCleanup = true;
+    submit([resultPromise, display, layers, buffer, fd](renderengine::RenderEngine& instance) {
+        SFTRACE_NAME("REThreaded::drawLayers");
+        instance.updateProtectedContext(layers, {buffer.get()});
+        instance.drawLayersInternal(std::move(resultPromise), display, layers, buffer,
+                                    base::unique_fd(fd));
+    });
     return resultFuture;
 }
 
@@ -288,35 +281,25 @@ ftl::Future<FenceResult> RenderEngineThreaded::tonemapAndDrawGainmap(
     SFTRACE_CALL();
     const auto resultPromise = std::make_shared<std::promise<FenceResult>>();
     std::future<FenceResult> resultFuture = resultPromise->get_future();
-    {
-        std::lock_guard lock(mThreadMutex);
-        mNeedsPostRenderCleanup = true;
-        mFunctionCalls.push([resultPromise, hdr, hdrFence = std::move(hdrFence), hdrSdrRatio,
-                             dataspace, sdr,
-                             gainmap](renderengine::RenderEngine& instance) mutable {
-            SFTRACE_NAME("REThreaded::tonemapAndDrawGainmap");
-            instance.updateProtectedContext({}, {hdr.get(), sdr.get(), gainmap.get()});
-            instance.tonemapAndDrawGainmapInternal(std::move(resultPromise), hdr,
-                                                   std::move(hdrFence), hdrSdrRatio, dataspace, sdr,
-                                                   gainmap);
-        });
-    }
-    mCondition.notify_one();
+    mNeedsPostRenderCleanup = true;
+    submit([resultPromise, hdr, hdrFence = std::move(hdrFence), hdrSdrRatio, dataspace, sdr,
+            gainmap](renderengine::RenderEngine& instance) mutable {
+        SFTRACE_NAME("REThreaded::tonemapAndDrawGainmap");
+        instance.updateProtectedContext({}, {hdr.get(), sdr.get(), gainmap.get()});
+        instance.tonemapAndDrawGainmapInternal(std::move(resultPromise), hdr, std::move(hdrFence),
+                                               hdrSdrRatio, dataspace, sdr, gainmap);
+    });
     return resultFuture;
 }
 
 int RenderEngineThreaded::getContextPriority() {
     std::promise<int> resultPromise;
     std::future<int> resultFuture = resultPromise.get_future();
-    {
-        std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([&resultPromise](renderengine::RenderEngine& instance) {
-            SFTRACE_NAME("REThreaded::getContextPriority");
-            int priority = instance.getContextPriority();
-            resultPromise.set_value(priority);
-        });
-    }
-    mCondition.notify_one();
+    submit([&resultPromise](renderengine::RenderEngine& instance) {
+        SFTRACE_NAME("REThreaded::getContextPriority");
+        int priority = instance.getContextPriority();
+        resultPromise.set_value(priority);
+    });
     return resultFuture.get();
 }
 
@@ -328,41 +311,26 @@ bool RenderEngineThreaded::supportsBackgroundBlur() {
 void RenderEngineThreaded::onActiveDisplaySizeChanged(ui::Size size) {
     // This function is designed so it can run asynchronously, so we do not need to wait
     // for the futures.
-    {
-        std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([size](renderengine::RenderEngine& instance) {
-            SFTRACE_NAME("REThreaded::onActiveDisplaySizeChanged");
-            instance.onActiveDisplaySizeChanged(size);
-        });
-    }
-    mCondition.notify_one();
+    submit([size](renderengine::RenderEngine& instance) {
+        SFTRACE_NAME("REThreaded::onActiveDisplaySizeChanged");
+        instance.onActiveDisplaySizeChanged(size);
+    });
 }
 
 std::optional<pid_t> RenderEngineThreaded::getRenderEngineTid() const {
     std::promise<pid_t> tidPromise;
     std::future<pid_t> tidFuture = tidPromise.get_future();
-    {
-        std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([&tidPromise](renderengine::RenderEngine& instance) {
-            tidPromise.set_value(gettid());
-        });
-    }
-
-    mCondition.notify_one();
+    submit([&tidPromise](renderengine::RenderEngine& instance) { tidPromise.set_value(gettid()); });
     return std::make_optional(tidFuture.get());
 }
 
 void RenderEngineThreaded::setEnableTracing(bool tracingEnabled) {
     // This function is designed so it can run asynchronously, so we do not need to wait
     // for the futures.
-    {
-        std::lock_guard lock(mThreadMutex);
-        mFunctionCalls.push([tracingEnabled](renderengine::RenderEngine& instance) {
-            SFTRACE_NAME("REThreaded::setEnableTracing");
-            instance.setEnableTracing(tracingEnabled);
-        });
-    }
-    mCondition.notify_one();
+    submit([tracingEnabled](renderengine::RenderEngine& instance) {
+        SFTRACE_NAME("REThreaded::setEnableTracing");
+        instance.setEnableTracing(tracingEnabled);
+    });
 }
 } // namespace threaded
 } // namespace renderengine
@@ -19,9 +19,9 @@
 #include <android-base/thread_annotations.h>
 #include <condition_variable>
 #include <mutex>
-#include <queue>
 #include <thread>
 
+#include "WorkQueue.h"
 #include "renderengine/RenderEngine.h"
 
 namespace android {
@@ -34,6 +34,8 @@ using CreateInstanceFactory = std::function<std::unique_ptr<renderengine::Render
  * This class extends a basic RenderEngine class. It contains a thread. Each time a function of
  * this class is called, we create a lambda function that is put on a queue. The main thread then
  * executes the functions in order.
+ *
+ * The queue is lock-free unless it overflows, and small lambdas are stored without allocating.
  */
 class RenderEngineThreaded : public RenderEngine {
 public:
@@ -82,7 +84,11 @@ protected:
             const std::shared_ptr<ExternalTexture>& gainmap) override;
 
 private:
+    using Work = InlineWork<renderengine::RenderEngine&>;
+
     void threadMain(CreateInstanceFactory factory);
+    // Queues work for the RenderEngine thread, and wakes it up if needed.
+    void submit(Work&& work) const;
     void waitUntilInitialized() const;
     static status_t setSchedFifo(bool enabled);
 
@@ -93,15 +99,17 @@ private:
      * Threading
      */
     const char* const mThreadName = "RenderEngine";
-    // Protects the creation and destruction of mThread.
+    // Protects the creation and destruction of mThread, and the thread going to sleep.
     mutable std::mutex mThreadMutex;
     std::thread mThread GUARDED_BY(mThreadMutex);
     std::atomic<bool> mRunning = true;
     std::atomic<bool> mNeedsPostRenderCleanup = false;
 
-    using Work = std::function<void(renderengine::RenderEngine&)>;
-    mutable std::queue<Work> mFunctionCalls GUARDED_BY(mThreadMutex);
+    mutable WorkQueue<Work> mWorkQueue;
     mutable std::condition_variable mCondition;
+    // Set by the thread before it waits for work, and by submitters to request a single wakeup.
+    mutable std::atomic<bool> mThreadSleeping = false;
+    mutable std::atomic<bool> mWakeupRequested = false;
 
     // Used to allow select thread safe methods to be accessed without requiring the
     // method to be invoked on the RenderEngine thread
@@ -0,0 +1,261 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <android-base/thread_annotations.h>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace android {
+namespace renderengine {
+namespace threaded {
+
+/**
+ * A move-only, type-erased callable taking Args. Callables of up to kInlineSize bytes are stored
+ * inline, so that submitting them does not allocate. Larger ones are moved to the heap.
+ */
+template <typename... Args>
+class InlineWork {
+public:
+    static constexpr size_t kInlineSize = 64;
+
+    InlineWork() = default;
+
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InlineWork>>>
+    InlineWork(F&& f) { // NOLINT(google-explicit-constructor)
+        using Callable = std::decay_t<F>;
+        if constexpr (fitsInline<Callable>()) {
+            new (mStorage) Callable(std::forward<F>(f));
+            mOps = &kInlineOps<Callable>;
+        } else {
+            *reinterpret_cast<Callable**>(mStorage) = new Callable(std::forward<F>(f));
+            mOps = &kHeapOps<Callable>;
+        }
+    }
+
+    InlineWork(InlineWork&& other) noexcept { *this = std::move(other); }
+
+    InlineWork& operator=(InlineWork&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.mOps) {
+                other.mOps->relocate(other.mStorage, mStorage);
+                mOps = std::exchange(other.mOps, nullptr);
+            }
+        }
+        return *this;
+    }
+
+    InlineWork(const InlineWork&) = delete;
+    InlineWork& operator=(const InlineWork&) = delete;
+
+    ~InlineWork() { reset(); }
+
+    explicit operator bool() const { return mOps != nullptr; }
+
+    void operator()(Args... args) { mOps->invoke(mStorage, std::forward<Args>(args)...); }
+
+    void reset() {
+        if (mOps) {
+            std::exchange(mOps, nullptr)->destroy(mStorage);
+        }
+    }
+
+    // Whether submitting a callable of type F avoids a heap allocation.
+    template <typename F>
+    static constexpr bool fitsInline() {
+        return sizeof(F) <= kInlineSize && alignof(F) <= alignof(std::max_align_t) &&
+                std::is_nothrow_move_constructible_v<F>;
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage, Args...);
+        // Moves the callable from one storage to the other, and destroys the moved-from one.
+        void (*relocate)(void* from, void* to);
+        void (*destroy)(void* storage);
+    };
+
+    template <typename F>
+    static constexpr Ops kInlineOps = {
+            .invoke = [](void* storage,
+                         Args... args) { (*static_cast<F*>(storage))(std::forward<Args>(args)...); },
+            .relocate =
+                    [](void* from, void* to) {
+                        F* source = static_cast<F*>(from);
+                        new (to) F(std::move(*source));
+                        source->~F();
+                    },
+            .destroy = [](void* storage) { static_cast<F*>(storage)->~F(); },
+    };
+
+    template <typename F>
+    static constexpr Ops kHeapOps = {
+            .invoke = [](void* storage,
+                         Args... args) { (**static_cast<F**>(storage))(std::forward<Args>(args)...); },
+            .relocate =
+                    [](void* from, void* to) {
+                        *static_cast<F**>(to) = std::exchange(*static_cast<F**>(from), nullptr);
+                    },
+            .destroy = [](void* storage) { delete *static_cast<F**>(storage); },
+    };
+
+    alignas(std::max_align_t) std::byte mStorage[kInlineSize];
+    const Ops* mOps = nullptr;
+};
+
+/**
+ * A FIFO of InlineWork for any number of producer threads and a single consumer thread.
+ *
+ * Work is pushed without locking into a bounded ring of preallocated slots. If the ring is full,
+ * for instance because the consumer is busy with a long draw, work spills into a locked overflow
+ * list. Producers keep spilling until the consumer has drained the overflow, and the overflow is
+ * only drained once the ring is, so the work of each producer is consumed in the order it was
+ * pushed.
+ */
+template <typename Work, size_t kCapacity = 256>
+class WorkQueue {
+    static_assert((kCapacity & (kCapacity - 1)) == 0, "kCapacity must be a power of two");
+
+public:
+    WorkQueue() {
+        for (size_t i = 0; i < kCapacity; i++) {
+            mSlots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Callable from any thread.
+    void push(Work&& work) {
+        if (!mOverflowing.load(std::memory_order_acquire) && tryPushToRing(work)) {
+            return;
+        }
+
+        std::lock_guard lock(mOverflowMutex);
+        mOverflow.push_back(std::move(work));
+        mOverflowing.store(true, std::memory_order_release);
+    }
+
+    // Returns empty work if there is none. Only callable from the consumer thread.
+    Work pop() {
+        if (Work work = tryPopFromRing()) {
+            return work;
+        }
+        if (!mOverflowing.load(std::memory_order_acquire)) {
+            return {};
+        }
+
+        std::lock_guard lock(mOverflowMutex);
+        // A producer may have pushed to the ring before seeing the overflow, in which case that
+        // work precedes anything it pushed to the overflow.
+        if (Work work = tryPopFromRing()) {
+            return work;
+        }
+        // A producer has claimed the next slot of the ring but not filled it yet. Work pushed to
+        // the overflow since may come from a producer which filled a later slot, so it waits.
+        if (mTail.load(std::memory_order_relaxed) != mHead) {
+            return {};
+        }
+        if (mOverflow.empty()) {
+            mOverflowing.store(false, std::memory_order_release);
+            return {};
+        }
+        Work work = std::move(mOverflow.front());
+        mOverflow.pop_front();
+        if (mOverflow.empty()) {
+            mOverflowing.store(false, std::memory_order_release);
+        }
+        return work;
+    }
+
+    // Whether pop() would return empty work, which is also the case while the next slot of the
+    // ring is claimed but not filled yet. The push filling it is still to come, so the consumer
+    // may wait for it like for any other push. Only callable from the consumer thread.
+    bool empty() const {
+        const Slot& slot = mSlots[mHead & kMask];
+        if (slot.sequence.load(std::memory_order_acquire) == mHead + 1) {
+            return false;
+        }
+        return mTail.load(std::memory_order_relaxed) != mHead ||
+                !mOverflowing.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr size_t kMask = kCapacity - 1;
+
+    struct Slot {
+        // Equals the position of the slot while it is free to be pushed to, and the position plus
+        // one once it holds work.
+        std::atomic<size_t> sequence;
+        Work work;
+    };
+
+    bool tryPushToRing(Work& work) {
+        size_t position = mTail.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &mSlots[position & kMask];
+            const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto difference =
+                    static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (difference == 0) {
+                if (mTail.compare_exchange_weak(position, position + 1,
+                                                std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                // The slot still holds work from a lap ago.
+                return false;
+            } else {
+                position = mTail.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->work = std::move(work);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    Work tryPopFromRing() {
+        Slot& slot = mSlots[mHead & kMask];
+        if (slot.sequence.load(std::memory_order_acquire) != mHead + 1) {
+            return {};
+        }
+        Work work = std::move(slot.work);
+        slot.sequence.store(mHead + kCapacity, std::memory_order_release);
+        mHead++;
+        return work;
+    }
+
+    std::array<Slot, kCapacity> mSlots;
+    // Separate cache lines, since the producers contend on mTail.
+    alignas(64) std::atomic<size_t> mTail = 0;
+    alignas(64) size_t mHead = 0;
+
+    std::atomic<bool> mOverflowing = false;
+    std::mutex mOverflowMutex;
+    std::deque<Work> mOverflow GUARDED_BY(mOverflowMutex);
+};
+
+} // namespace threaded
+} // namespace renderengine
+} // namespace android
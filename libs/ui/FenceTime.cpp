@@ -20,8 +20,10 @@
 
 #include <cutils/compiler.h>  // For CC_[UN]LIKELY
 #include <utils/Log.h>
+#include <errno.h>
 #include <inttypes.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <memory>
 
@@ -310,9 +312,9 @@ void FenceTimeline::push(const std::shared_ptr<FenceTime>& fence) {
             // we are removing it from the timeline.
             front->getSignalTime();
         }
-        mQueue.pop();
+        mQueue.pop_front();
     }
-    mQueue.push(fence);
+    mQueue.push_back(fence);
 }
 
 void FenceTimeline::updateSignalTimes() {
@@ -322,11 +324,11 @@ void FenceTimeline::updateSignalTimes() {
         if (!fence) {
             // The shared_ptr no longer exists and no one cares about the
             // timestamp anymore.
-            mQueue.pop();
+            mQueue.pop_front();
             continue;
         } else if (fence->getSignalTime() != Fence::SIGNAL_TIME_PENDING) {
             // The fence has signaled and we've removed the sp<Fence> ref.
-            mQueue.pop();
+            mQueue.pop_front();
             continue;
         } else {
             // The fence didn't signal yet. Break since the later ones
@@ -336,6 +338,91 @@ void FenceTimeline::updateSignalTimes() {
     }
 }
 
+void FenceTimeline::updateSignalTimes(std::initializer_list<FenceTimeline*> timelines,
+                                      FenceTimeBatch& batch) {
+    for (FenceTimeline* timeline : timelines) {
+        std::lock_guard<std::mutex> lock(timeline->mMutex);
+        timeline->popSignaledLocked();
+        for (const auto& weakFence : timeline->mQueue) {
+            batch.add(weakFence.lock());
+        }
+    }
+
+    // Fences pushed in the meantime are left for the next update.
+    batch.updateSignalTimes();
+
+    for (FenceTimeline* timeline : timelines) {
+        std::lock_guard<std::mutex> lock(timeline->mMutex);
+        timeline->popSignaledLocked();
+    }
+}
+
+void FenceTimeline::popSignaledLocked() {
+    // Only the cached signal times are checked, since the batch has already
+    // polled the fences.
+    while (!mQueue.empty()) {
+        std::shared_ptr<FenceTime> fence = mQueue.front().lock();
+        if (fence && fence->getCachedSignalTime() == Fence::SIGNAL_TIME_PENDING) {
+            break;
+        }
+        mQueue.pop_front();
+    }
+}
+
+// ============================================================================
+// FenceTimeBatch
+// ============================================================================
+void FenceTimeBatch::add(const FenceTimePtr& fenceTime) {
+    if (fenceTime && fenceTime->getCachedSignalTime() == Fence::SIGNAL_TIME_PENDING) {
+        mFenceTimes.push_back(fenceTime);
+    }
+}
+
+size_t FenceTimeBatch::updateSignalTimes() {
+    for (const FenceTimePtr& fenceTime : mFenceTimes) {
+        sp<Fence> fence;
+        {
+            std::lock_guard<std::mutex> lock(fenceTime->mMutex);
+            fence = fenceTime->mFence;
+        }
+        if (!fence || !fence->isValid()) {
+            // Either the signal time was set in the meantime, or there is no
+            // fd to poll. getSignalTime() settles both without a syscall.
+            fenceTime->getSignalTime();
+            mFences.push_back(nullptr);
+            mPollFds.push_back({.fd = -1, .events = 0, .revents = 0});
+            continue;
+        }
+        mPollFds.push_back({.fd = fence->get(), .events = POLLIN, .revents = 0});
+        mFences.push_back(std::move(fence));
+    }
+
+    int result;
+    do {
+        result = poll(mPollFds.data(), mPollFds.size(), 0);
+    } while (result == -1 && errno == EINTR);
+    if (result == -1) {
+        ALOGE("FenceTimeBatch: poll failed. errno=%d (%s)", errno, strerror(errno));
+    }
+
+    size_t pendingCount = 0;
+    for (size_t i = 0; i < mFenceTimes.size(); i++) {
+        // A fence that signaled or hit an error is queried as getSignalTime()
+        // would. If poll() failed, fall back to querying every fence.
+        if (mPollFds[i].fd != -1 && (result == -1 || mPollFds[i].revents != 0)) {
+            mFenceTimes[i]->getSignalTime();
+        }
+        if (mFenceTimes[i]->getCachedSignalTime() == Fence::SIGNAL_TIME_PENDING) {
+            pendingCount++;
+        }
+    }
+
+    mFenceTimes.clear();
+    mFences.clear();
+    mPollFds.clear();
+    return pendingCount;
+}
+
 // ============================================================================
 // FenceToFenceTimeMap
 // ============================================================================
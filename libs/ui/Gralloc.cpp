@@ -22,6 +22,41 @@ namespace android {
 
 GrallocMapper::~GrallocMapper() {}
 
+status_t GrallocMapper::getMetadata(buffer_handle_t bufferHandle, ui::BufferMetadataTypes types,
+                                    ui::BufferMetadata* outMetadata) const {
+    using ui::BufferMetadataType;
+
+    status_t error = NO_ERROR;
+    const auto read = [&](BufferMetadataType type, status_t status) {
+        if (status == NO_ERROR) {
+            outMetadata->types |= static_cast<ui::BufferMetadataTypes>(type);
+        } else if (error == NO_ERROR) {
+            error = status;
+        }
+    };
+
+    if (ui::contains(types, BufferMetadataType::DATASPACE)) {
+        read(BufferMetadataType::DATASPACE, getDataspace(bufferHandle, &outMetadata->dataspace));
+    }
+    if (ui::contains(types, BufferMetadataType::CROP)) {
+        read(BufferMetadataType::CROP, INVALID_OPERATION);
+    }
+    if (ui::contains(types, BufferMetadataType::SMPTE2086)) {
+        read(BufferMetadataType::SMPTE2086, getSmpte2086(bufferHandle, &outMetadata->smpte2086));
+    }
+    if (ui::contains(types, BufferMetadataType::CTA861_3)) {
+        read(BufferMetadataType::CTA861_3, getCta861_3(bufferHandle, &outMetadata->cta861_3));
+    }
+    if (ui::contains(types, BufferMetadataType::STRIDE)) {
+        read(BufferMetadataType::STRIDE, INVALID_OPERATION);
+    }
+    if (ui::contains(types, BufferMetadataType::PLANE_LAYOUTS)) {
+        read(BufferMetadataType::PLANE_LAYOUTS,
+             getPlaneLayouts(bufferHandle, &outMetadata->planeLayouts));
+    }
+    return error;
+}
+
 GrallocAllocator::~GrallocAllocator() {}
 
 } // namespace android
@@ -127,12 +127,15 @@ static const Gralloc5 &getInstance() {
     return instance;
 }
 
-template <StandardMetadataType T>
-static auto getStandardMetadata(AIMapper *mapper, buffer_handle_t bufferHandle)
+// Reads the metadata into buffer, which is grown as needed and can be reused across reads.
+template <StandardMetadataType T, size_t N>
+static auto getStandardMetadata(AIMapper *mapper, buffer_handle_t bufferHandle,
+                                FatVector<uint8_t, N> &buffer)
         -> decltype(StandardMetadata<T>::value::decode(nullptr, 0)) {
     using Value = typename StandardMetadata<T>::value;
-    // TODO: Tune for common-case better
-    FatVector<uint8_t, 128> buffer;
+    // Offer all the space already allocated, so that the common case takes a single call
+    // rather than one to query the size and one to read.
+    buffer.resize(buffer.capacity());
     int32_t sizeRequired = mapper->v5.getStandardMetadata(bufferHandle, static_cast<int64_t>(T),
                                                           buffer.data(), buffer.size());
     if (sizeRequired < 0) {
@@ -154,6 +157,13 @@ static auto getStandardMetadata(AIMapper *mapper, buffer_handle_t bufferHandle)
     return Value::decode(buffer.data(), sizeRequired);
 }
 
+template <StandardMetadataType T>
+static auto getStandardMetadata(AIMapper *mapper, buffer_handle_t bufferHandle)
+        -> decltype(StandardMetadata<T>::value::decode(nullptr, 0)) {
+    FatVector<uint8_t, 128> buffer;
+    return getStandardMetadata<T>(mapper, bufferHandle, buffer);
+}
+
 template <StandardMetadataType T>
 static AIMapper_Error setStandardMetadata(AIMapper *mapper, buffer_handle_t bufferHandle,
                                           const typename StandardMetadata<T>::value_type &value) {
@@ -1025,4 +1035,72 @@ status_t Gralloc5Mapper::setSmpte2094_10(buffer_handle_t bufferHandle,
                                                                    smpte2094_10);
 }
 
+status_t Gralloc5Mapper::getMetadata(buffer_handle_t bufferHandle, ui::BufferMetadataTypes types,
+                                     ui::BufferMetadata *outMetadata) const {
+    using ui::BufferMetadataType;
+
+    // One buffer for all the reads, large enough for most plane layouts.
+    FatVector<uint8_t, 512> buffer;
+    status_t error = OK;
+    const auto read = [&](BufferMetadataType type, bool found) {
+        if (found) {
+            outMetadata->types |= static_cast<ui::BufferMetadataTypes>(type);
+        } else if (error == OK) {
+            error = UNKNOWN_TRANSACTION;
+        }
+    };
+
+    if (ui::contains(types, BufferMetadataType::DATASPACE)) {
+        auto value = getStandardMetadata<StandardMetadataType::DATASPACE>(mMapper, bufferHandle,
+                                                                          buffer);
+        if (value.has_value()) {
+            outMetadata->dataspace = static_cast<ui::Dataspace>(*value);
+        }
+        read(BufferMetadataType::DATASPACE, value.has_value());
+    }
+    if (ui::contains(types, BufferMetadataType::CROP)) {
+        auto value = getStandardMetadata<StandardMetadataType::CROP>(mMapper, bufferHandle, buffer);
+        if (value.has_value()) {
+            outMetadata->crop.clear();
+            for (const auto &rect : *value) {
+                outMetadata->crop.emplace_back(rect.left, rect.top, rect.right, rect.bottom);
+            }
+        }
+        read(BufferMetadataType::CROP, value.has_value());
+    }
+    if (ui::contains(types, BufferMetadataType::SMPTE2086)) {
+        auto value = getStandardMetadata<StandardMetadataType::SMPTE2086>(mMapper, bufferHandle,
+                                                                          buffer);
+        if (value.has_value()) {
+            outMetadata->smpte2086 = *value;
+        }
+        read(BufferMetadataType::SMPTE2086, value.has_value());
+    }
+    if (ui::contains(types, BufferMetadataType::CTA861_3)) {
+        auto value = getStandardMetadata<StandardMetadataType::CTA861_3>(mMapper, bufferHandle,
+                                                                         buffer);
+        if (value.has_value()) {
+            outMetadata->cta861_3 = *value;
+        }
+        read(BufferMetadataType::CTA861_3, value.has_value());
+    }
+    if (ui::contains(types, BufferMetadataType::STRIDE)) {
+        auto value = getStandardMetadata<StandardMetadataType::STRIDE>(mMapper, bufferHandle,
+                                                                       buffer);
+        if (value.has_value()) {
+            outMetadata->stride = *value;
+        }
+        read(BufferMetadataType::STRIDE, value.has_value());
+    }
+    if (ui::contains(types, BufferMetadataType::PLANE_LAYOUTS)) {
+        auto value = getStandardMetadata<StandardMetadataType::PLANE_LAYOUTS>(mMapper,
+                                                                              bufferHandle, buffer);
+        if (value.has_value()) {
+            outMetadata->planeLayouts = std::move(*value);
+        }
+        read(BufferMetadataType::PLANE_LAYOUTS, value.has_value());
+    }
+    return error;
+}
+
 } // namespace android
\ No newline at end of file
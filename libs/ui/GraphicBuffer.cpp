@@ -183,6 +183,7 @@ void GraphicBuffer::free_handle()
         allocator.free(handle);
     }
     handle = nullptr;
+    mMetadataCache.clear();
 }
 
 status_t GraphicBuffer::initCheck() const {
@@ -204,6 +205,12 @@ status_t GraphicBuffer::getDataspace(ui::Dataspace* outDataspace) const {
     return mBufferMapper.getDataspace(handle, outDataspace);
 }
 
+status_t GraphicBuffer::getMetadata(std::initializer_list<ui::BufferMetadataType> types,
+                                    ui::BufferMetadata* outMetadata) const {
+    return mMetadataCache.getMetadata(mBufferMapper.getGrallocMapper(), handle,
+                                      ui::toBufferMetadataTypes(types), outMetadata);
+}
+
 status_t GraphicBuffer::reallocate(uint32_t inWidth, uint32_t inHeight,
         PixelFormat inFormat, uint32_t inLayerCount, uint64_t inUsage)
 {
@@ -222,6 +229,7 @@ status_t GraphicBuffer::reallocate(uint32_t inWidth, uint32_t inHeight,
         GraphicBufferAllocator& allocator(GraphicBufferAllocator::get());
         allocator.free(handle);
         handle = nullptr;
+        mMetadataCache.clear();
     }
     return initWithSize(inWidth, inHeight, inFormat, inLayerCount, inUsage, "[Reallocation]");
 }
@@ -388,9 +396,14 @@ status_t GraphicBuffer::lockAsync(uint64_t inProducerUsage, uint64_t inConsumerU
                 legacyBpp = -1;
             }
         } else if (mapperVersion >= GraphicBufferMapper::GRALLOC_4) {
-            auto planeLayout = getBufferMapper().getPlaneLayouts(handle);
-            if (!planeLayout.has_value()) return planeLayout.asStatus();
-            resolveLegacyByteLayoutFromPlaneLayout(planeLayout.value(), &legacyBpp, &legacyBps);
+            // The plane layouts are fixed at allocation, so only the first lock reads them from
+            // the mapper.
+            ui::BufferMetadata metadata;
+            if (status_t error = getMetadata({ui::BufferMetadataType::PLANE_LAYOUTS}, &metadata);
+                error != OK) {
+                return error;
+            }
+            resolveLegacyByteLayoutFromPlaneLayout(metadata.planeLayouts, &legacyBpp, &legacyBps);
         }
     }
 
@@ -596,8 +609,9 @@ status_t GraphicBuffer::unflatten(void const*& buffer, size_t& size, int const*&
 
     if (handle != nullptr) {
         buffer_handle_t importedHandle;
-        status_t err = mBufferMapper.importBuffer(handle, uint32_t(width), uint32_t(height),
-                uint32_t(layerCount), format, usage, uint32_t(stride), &importedHandle);
+        status_t err = mBufferMapper.importBuffer(mId, mGenerationNumber, handle, uint32_t(width),
+                uint32_t(height), uint32_t(layerCount), format, usage, uint32_t(stride),
+                &importedHandle);
         if (err != NO_ERROR) {
             width = height = stride = format = usage_deprecated = 0;
             layerCount = 0;
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "GraphicBufferImportCache"
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+
+#include <ui/GraphicBufferImportCache.h>
+
+#include <inttypes.h>
+#include <sys/stat.h>
+
+#include <ui/Gralloc.h>
+#include <utils/Log.h>
+#include <utils/Trace.h>
+
+namespace android {
+
+bool GraphicBufferImportCache::getFileIds(const native_handle_t* rawHandle,
+                                          std::vector<FileId>* outFileIds) {
+    if (rawHandle->numFds <= 0) {
+        return false;
+    }
+    outFileIds->clear();
+    outFileIds->reserve(static_cast<size_t>(rawHandle->numFds));
+    for (int i = 0; i < rawHandle->numFds; i++) {
+        struct stat st;
+        if (fstat(rawHandle->data[i], &st) != 0) {
+            return false;
+        }
+        outFileIds->push_back({st.st_dev, st.st_ino});
+    }
+    return true;
+}
+
+status_t GraphicBufferImportCache::importBuffer(const GrallocMapper& mapper, uint64_t bufferId,
+                                                uint32_t generationNumber,
+                                                const native_handle_t* rawHandle, uint32_t width,
+                                                uint32_t height, uint32_t layerCount,
+                                                PixelFormat format, uint64_t usage,
+                                                uint32_t stride, buffer_handle_t* outHandle) {
+    const Key key{bufferId, generationNumber};
+    std::vector<FileId> files;
+    const bool cacheable = getFileIds(rawHandle, &files);
+    const auto matches = [&](const Entry& entry) {
+        return entry.files == files && entry.width == width && entry.height == height &&
+                entry.layerCount == layerCount && entry.format == format &&
+                entry.usage == usage && entry.stride == stride;
+    };
+
+    if (cacheable) {
+        std::lock_guard lock(mMutex);
+        const auto it = mEntries.find(key);
+        if (it != mEntries.end()) {
+            if (matches(it->second)) {
+                it->second.refCount++;
+                *outHandle = it->second.handle;
+                return NO_ERROR;
+            }
+            ALOGW_IF(it->second.files != files,
+                     "importBuffer(%p): buffer %" PRIu64 " (generation %u) has other files than "
+                     "the one already imported",
+                     rawHandle, bufferId, generationNumber);
+        }
+    }
+
+    ATRACE_CALL();
+    // Import without the lock, so that importing other buffers doesn't wait on the mapper.
+    buffer_handle_t handle;
+    status_t error = mapper.importBuffer(rawHandle, &handle);
+    if (error != NO_ERROR) {
+        ALOGW("importBuffer(%p) failed: %d", rawHandle, error);
+        return error;
+    }
+    error = mapper.validateBufferSize(handle, width, height, format, layerCount, usage, stride);
+    if (error != NO_ERROR) {
+        ALOGE("validateBufferSize(%p) failed: %d", rawHandle, error);
+        mapper.freeBuffer(handle);
+        return error;
+    }
+
+    if (cacheable) {
+        std::lock_guard lock(mMutex);
+        // If the buffer was imported meanwhile, from other files or against another size, the
+        // new handle stays out of the cache and is freed on its own.
+        const auto [it, inserted] =
+                mEntries.try_emplace(key,
+                                     Entry{handle, std::move(files), width, height, layerCount,
+                                           format, usage, stride, 1});
+        if (inserted) {
+            mKeys.emplace(handle, key);
+            mSize.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    *outHandle = handle;
+    return NO_ERROR;
+}
+
+bool GraphicBufferImportCache::freeBuffer(const GrallocMapper& mapper, buffer_handle_t handle) {
+    if (size() == 0) {
+        return false;
+    }
+
+    {
+        std::lock_guard lock(mMutex);
+        const auto keyIt = mKeys.find(handle);
+        if (keyIt == mKeys.end()) {
+            return false;
+        }
+        const auto entryIt = mEntries.find(keyIt->second);
+        if (--entryIt->second.refCount > 0) {
+            return true;
+        }
+        mEntries.erase(entryIt);
+        mKeys.erase(keyIt);
+        mSize.fetch_sub(1, std::memory_order_relaxed);
+    }
+    mapper.freeBuffer(handle);
+    return true;
+}
+
+} // namespace android
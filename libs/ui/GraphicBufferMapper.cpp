@@ -119,6 +119,19 @@ status_t GraphicBufferMapper::importBuffer(const native_handle_t* rawHandle, uin
     return NO_ERROR;
 }
 
+status_t GraphicBufferMapper::importBuffer(uint64_t bufferId, uint32_t generationNumber,
+                                           const native_handle_t* rawHandle, uint32_t width,
+                                           uint32_t height, uint32_t layerCount, PixelFormat format,
+                                           uint64_t usage, uint32_t stride,
+                                           buffer_handle_t* outHandle) {
+    if (!mImportCacheEnabled.load(std::memory_order_relaxed)) {
+        return importBuffer(rawHandle, width, height, layerCount, format, usage, stride,
+                            outHandle);
+    }
+    return mImportCache.importBuffer(*mMapper, bufferId, generationNumber, rawHandle, width,
+                                     height, layerCount, format, usage, stride, outHandle);
+}
+
 status_t GraphicBufferMapper::importBufferNoValidate(const native_handle_t* rawHandle,
                                                      buffer_handle_t* outHandle) {
     return mMapper->importBuffer(rawHandle, outHandle);
@@ -134,7 +147,10 @@ status_t GraphicBufferMapper::freeBuffer(buffer_handle_t handle)
 {
     ATRACE_CALL();
 
-    mMapper->freeBuffer(handle);
+    // The cache stays in use after it is disabled, for the handles it still holds.
+    if (!mImportCache.freeBuffer(*mMapper, handle)) {
+        mMapper->freeBuffer(handle);
+    }
 
     return NO_ERROR;
 }
@@ -361,6 +377,12 @@ status_t GraphicBufferMapper::setCta861_3(buffer_handle_t bufferHandle,
     return mMapper->setCta861_3(bufferHandle, cta861_3);
 }
 
+status_t GraphicBufferMapper::getMetadata(buffer_handle_t bufferHandle,
+                                          std::initializer_list<ui::BufferMetadataType> types,
+                                          ui::BufferMetadata* outMetadata) {
+    return mMapper->getMetadata(bufferHandle, ui::toBufferMetadataTypes(types), outMetadata);
+}
+
 status_t GraphicBufferMapper::getSmpte2094_40(
         buffer_handle_t bufferHandle, std::optional<std::vector<uint8_t>>* outSmpte2094_40) {
     return mMapper->getSmpte2094_40(bufferHandle, outSmpte2094_40);
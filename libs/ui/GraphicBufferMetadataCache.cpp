@@ -0,0 +1,92 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "GraphicBufferMetadataCache"
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+
+#include <ui/GraphicBufferMetadataCache.h>
+
+#include <ui/Gralloc.h>
+#include <utils/Trace.h>
+
+namespace android {
+
+using ui::BufferMetadata;
+using ui::BufferMetadataType;
+using ui::BufferMetadataTypes;
+
+// Copies the metadata of the given types that is set in from.
+static void copyMetadata(const BufferMetadata& from, BufferMetadataTypes types,
+                         BufferMetadata* to) {
+    types &= from.types;
+    if (ui::contains(types, BufferMetadataType::DATASPACE)) {
+        to->dataspace = from.dataspace;
+    }
+    if (ui::contains(types, BufferMetadataType::CROP)) {
+        to->crop = from.crop;
+    }
+    if (ui::contains(types, BufferMetadataType::SMPTE2086)) {
+        to->smpte2086 = from.smpte2086;
+    }
+    if (ui::contains(types, BufferMetadataType::CTA861_3)) {
+        to->cta861_3 = from.cta861_3;
+    }
+    if (ui::contains(types, BufferMetadataType::STRIDE)) {
+        to->stride = from.stride;
+    }
+    if (ui::contains(types, BufferMetadataType::PLANE_LAYOUTS)) {
+        to->planeLayouts = from.planeLayouts;
+    }
+    to->types |= types;
+}
+
+status_t GraphicBufferMetadataCache::getMetadata(const GrallocMapper& mapper,
+                                                 buffer_handle_t handle, BufferMetadataTypes types,
+                                                 BufferMetadata* outMetadata) {
+    BufferMetadataTypes missing;
+    uint64_t generation;
+    {
+        std::lock_guard lock(mMutex);
+        copyMetadata(mMetadata, types, outMetadata);
+        missing = types & ~mMetadata.types;
+        generation = mGeneration;
+    }
+    if (missing == 0) {
+        return NO_ERROR;
+    }
+
+    ATRACE_CALL();
+    // Read without the lock, so that a concurrent reader of cached types doesn't wait on the
+    // mapper.
+    BufferMetadata metadata;
+    const status_t error = mapper.getMetadata(handle, missing, &metadata);
+    copyMetadata(metadata, missing, outMetadata);
+
+    std::lock_guard lock(mMutex);
+    // Unless the cache was cleared meanwhile, which may make what was read stale.
+    if (mGeneration == generation) {
+        copyMetadata(metadata, missing & kCachedTypes, &mMetadata);
+    }
+    return error;
+}
+
+void GraphicBufferMetadataCache::clear() {
+    std::lock_guard lock(mMutex);
+    mMetadata = {};
+    mGeneration++;
+}
+
+} // namespace android
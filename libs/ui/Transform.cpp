@@ -23,6 +23,7 @@
 #include <cutils/compiler.h>
 #include <ui/Region.h>
 #include <ui/Transform.h>
+#include <utils/Log.h>
 #include <utils/String8.h>
 
 namespace android::ui {
@@ -43,6 +44,10 @@ Transform::~Transform() = default;
 
 static const float EPSILON = 0.0f;
 
+// Four lanes, mapped by a single vector instruction where the target has them.
+typedef float Float4 __attribute__((vector_size(4 * sizeof(float))));
+typedef int32_t Int4 __attribute__((vector_size(4 * sizeof(int32_t))));
+
 bool Transform::isZero(float f) {
     return fabs(f) <= EPSILON;
 }
@@ -67,10 +72,31 @@ Transform Transform::operator*(const Transform& rhs) const {
     if (rhs.mType == IDENTITY)
         return r;
 
-    // TODO: we could use mType to optimize the matrix multiply
     const mat33& A(mMatrix);
     const mat33& B(rhs.mMatrix);
           mat33& D(r.mMatrix);
+
+    const auto isAffine = [](const mat33& M) {
+        return M[0][2] == 0.0f && M[1][2] == 0.0f && M[2][2] == 1.0f;
+    };
+    const uint32_t orientations = getOrientation() | rhs.getOrientation();
+    if (!(orientations & (ROT_90 | ROT_INVALID)) && isAffine(A) && isAffine(B)) {
+        // Both 2x2 parts are diagonal, so only the scales and the translation are left
+        // to compute, and the terms the full multiply would add are all zero.
+        if (getType() <= TRANSLATE && rhs.getType() <= TRANSLATE) {
+            D[2][0] = B[2][0] + A[2][0];
+            D[2][1] = B[2][1] + A[2][1];
+            r.mType = (isZero(D[2][0]) && isZero(D[2][1])) ? IDENTITY : TRANSLATE;
+            return r;
+        }
+        D[0][0] = A[0][0] * B[0][0];
+        D[1][1] = A[1][1] * B[1][1];
+        D[2][0] = A[0][0] * B[2][0] + A[2][0];
+        D[2][1] = A[1][1] * B[2][1] + A[2][1];
+        r.mType = UNKNOWN_TYPE;
+        return r;
+    }
+
     for (size_t i = 0; i < 3; i++) {
         const float v0 = A[0][i];
         const float v1 = A[1][i];
@@ -257,34 +283,62 @@ Rect Transform::makeBounds(int w, int h) const {
     return transform( Rect(w, h) );
 }
 
-Rect Transform::transform(const Rect& bounds, bool roundOutwards) const {
+static inline Rect roundRect(const FloatRect& bounds, bool roundOutwards) {
     Rect r;
-    vec2 lt( bounds.left,  bounds.top    );
-    vec2 rt( bounds.right, bounds.top    );
-    vec2 lb( bounds.left,  bounds.bottom );
-    vec2 rb( bounds.right, bounds.bottom );
-
-    lt = transform(lt);
-    rt = transform(rt);
-    lb = transform(lb);
-    rb = transform(rb);
-
     if (roundOutwards) {
-        r.left   = static_cast<int32_t>(floorf(std::min({lt[0], rt[0], lb[0], rb[0]})));
-        r.top    = static_cast<int32_t>(floorf(std::min({lt[1], rt[1], lb[1], rb[1]})));
-        r.right  = static_cast<int32_t>(ceilf(std::max({lt[0], rt[0], lb[0], rb[0]})));
-        r.bottom = static_cast<int32_t>(ceilf(std::max({lt[1], rt[1], lb[1], rb[1]})));
+        r.left   = static_cast<int32_t>(floorf(bounds.left));
+        r.top    = static_cast<int32_t>(floorf(bounds.top));
+        r.right  = static_cast<int32_t>(ceilf(bounds.right));
+        r.bottom = static_cast<int32_t>(ceilf(bounds.bottom));
     } else {
-        r.left   = static_cast<int32_t>(floorf(std::min({lt[0], rt[0], lb[0], rb[0]}) + 0.5f));
-        r.top    = static_cast<int32_t>(floorf(std::min({lt[1], rt[1], lb[1], rb[1]}) + 0.5f));
-        r.right  = static_cast<int32_t>(floorf(std::max({lt[0], rt[0], lb[0], rb[0]}) + 0.5f));
-        r.bottom = static_cast<int32_t>(floorf(std::max({lt[1], rt[1], lb[1], rb[1]}) + 0.5f));
+        r.left   = static_cast<int32_t>(floorf(bounds.left + 0.5f));
+        r.top    = static_cast<int32_t>(floorf(bounds.top + 0.5f));
+        r.right  = static_cast<int32_t>(floorf(bounds.right + 0.5f));
+        r.bottom = static_cast<int32_t>(floorf(bounds.bottom + 0.5f));
     }
-
     return r;
 }
 
+Rect Transform::transform(const Rect& bounds, bool roundOutwards) const {
+    return roundRect(transform(bounds.toFloatRect()), roundOutwards);
+}
+
+bool Transform::transformEdges(const FloatRect& bounds, FloatRect* outBounds) const {
+    const mat33& M(mMatrix);
+    float x0, x1, y0, y1;
+    // Keyed on the matrix rather than on type(), which would have to be recomputed for
+    // each freshly composed transform.
+    if (!(mType & UNKNOWN_TYPE) && mType <= TRANSLATE) {
+        x0 = bounds.left + M[2][0];
+        x1 = bounds.right + M[2][0];
+        y0 = bounds.top + M[2][1];
+        y1 = bounds.bottom + M[2][1];
+    } else if (isZero(M[1][0]) && isZero(M[0][1])) {
+        x0 = M[0][0] * bounds.left + M[2][0];
+        x1 = M[0][0] * bounds.right + M[2][0];
+        y0 = M[1][1] * bounds.top + M[2][1];
+        y1 = M[1][1] * bounds.bottom + M[2][1];
+    } else if (isZero(M[0][0]) && isZero(M[1][1])) {
+        // Rotated by 90 degrees: x only depends on the top and bottom edges, and y on the
+        // left and right ones.
+        x0 = M[1][0] * bounds.top + M[2][0];
+        x1 = M[1][0] * bounds.bottom + M[2][0];
+        y0 = M[0][1] * bounds.left + M[2][1];
+        y1 = M[0][1] * bounds.right + M[2][1];
+    } else {
+        return false;
+    }
+    *outBounds = FloatRect(std::min(x0, x1), std::min(y0, y1), std::max(x0, x1),
+                           std::max(y0, y1));
+    return true;
+}
+
 FloatRect Transform::transform(const FloatRect& bounds) const {
+    FloatRect r;
+    if (CC_LIKELY(transformEdges(bounds, &r))) {
+        return r;
+    }
+
     vec2 lt(bounds.left, bounds.top);
     vec2 rt(bounds.right, bounds.top);
     vec2 lb(bounds.left, bounds.bottom);
@@ -295,7 +349,6 @@ FloatRect Transform::transform(const FloatRect& bounds) const {
     lb = transform(lb);
     rb = transform(rb);
 
-    FloatRect r;
     r.left = std::min({lt[0], rt[0], lb[0], rb[0]});
     r.top = std::min({lt[1], rt[1], lb[1], rb[1]});
     r.right = std::max({lt[0], rt[0], lb[0], rb[0]});
@@ -304,6 +357,101 @@ FloatRect Transform::transform(const FloatRect& bounds) const {
     return r;
 }
 
+struct Transform::EdgeMap {
+    Float4 scale;
+    Float4 translation;
+    // Set for the rotations by 90 degrees, where x depends on the top and bottom edges.
+    bool swapAxes;
+};
+
+bool Transform::getEdgeMap(EdgeMap* map) const {
+    const mat33& M(mMatrix);
+    if (isZero(M[1][0]) && isZero(M[0][1])) {
+        map->scale = Float4{M[0][0], M[1][1], M[0][0], M[1][1]};
+        map->swapAxes = false;
+    } else if (isZero(M[0][0]) && isZero(M[1][1])) {
+        map->scale = Float4{M[1][0], M[0][1], M[1][0], M[0][1]};
+        map->swapAxes = true;
+    } else {
+        return false;
+    }
+    map->translation = Float4{M[2][0], M[2][1], M[2][0], M[2][1]};
+    return true;
+}
+
+// Maps the (left, top, right, bottom) edges of a rect, each to a single output edge, and
+// returns them in the same order, unsorted.
+static inline Float4 mapEdges(Float4 edges, Float4 scale, Float4 translation, bool swapAxes) {
+    if (swapAxes) {
+        edges = Float4{edges[1], edges[0], edges[3], edges[2]};
+    }
+    return edges * scale + translation;
+}
+
+static inline FloatRect sortEdges(Float4 edges) {
+    return FloatRect(std::min(edges[0], edges[2]), std::min(edges[1], edges[3]),
+                     std::max(edges[0], edges[2]), std::max(edges[1], edges[3]));
+}
+
+void Transform::transform(std::span<const Rect> in, std::span<Rect> out,
+                          bool roundOutwards) const {
+    LOG_ALWAYS_FATAL_IF(out.size() < in.size(), "Mapping %zu rects into %zu", in.size(),
+                        out.size());
+    EdgeMap map;
+    if (CC_UNLIKELY(!getEdgeMap(&map))) {
+        for (size_t i = 0; i < in.size(); i++) {
+            out[i] = transform(in[i], roundOutwards);
+        }
+        return;
+    }
+    // One rect per vector.
+    for (size_t i = 0; i < in.size(); i++) {
+        const Rect& r = in[i];
+        const Int4 intEdges = {r.left, r.top, r.right, r.bottom};
+        const Float4 edges = __builtin_convertvector(intEdges, Float4);
+        out[i] = roundRect(sortEdges(mapEdges(edges, map.scale, map.translation, map.swapAxes)),
+                           roundOutwards);
+    }
+}
+
+void Transform::transform(std::span<const FloatRect> in, std::span<FloatRect> out) const {
+    LOG_ALWAYS_FATAL_IF(out.size() < in.size(), "Mapping %zu rects into %zu", in.size(),
+                        out.size());
+    EdgeMap map;
+    if (CC_UNLIKELY(!getEdgeMap(&map))) {
+        for (size_t i = 0; i < in.size(); i++) {
+            out[i] = transform(in[i]);
+        }
+        return;
+    }
+    for (size_t i = 0; i < in.size(); i++) {
+        const FloatRect& r = in[i];
+        const Float4 edges = {r.left, r.top, r.right, r.bottom};
+        out[i] = sortEdges(mapEdges(edges, map.scale, map.translation, map.swapAxes));
+    }
+}
+
+void Transform::transform(std::span<const vec2> in, std::span<vec2> out) const {
+    LOG_ALWAYS_FATAL_IF(out.size() < in.size(), "Mapping %zu points into %zu", in.size(),
+                        out.size());
+    // Two points per vector: (x0, y0, x1, y1).
+    const mat33& M(mMatrix);
+    const Float4 xScale = {M[0][0], M[0][1], M[0][0], M[0][1]};
+    const Float4 yScale = {M[1][0], M[1][1], M[1][0], M[1][1]};
+    const Float4 translation = {M[2][0], M[2][1], M[2][0], M[2][1]};
+    size_t i = 0;
+    for (; i + 2 <= in.size(); i += 2) {
+        const Float4 x = {in[i].x, in[i].x, in[i + 1].x, in[i + 1].x};
+        const Float4 y = {in[i].y, in[i].y, in[i + 1].y, in[i + 1].y};
+        const Float4 mapped = x * xScale + y * yScale + translation;
+        out[i] = vec2(mapped[0], mapped[1]);
+        out[i + 1] = vec2(mapped[2], mapped[3]);
+    }
+    for (; i < in.size(); i++) {
+        out[i] = transform(in[i]);
+    }
+}
+
 Region Transform::transform(const Region& reg) const {
     Region out;
     if (CC_UNLIKELY(type() > TRANSLATE)) {
@@ -17,6 +17,7 @@
 #ifndef ANDROID_FENCE_TIME_H
 #define ANDROID_FENCE_TIME_H
 
+#include <poll.h>
 #include <stddef.h>
 #include <ui/Fence.h>
 #include <utils/Flattenable.h>
@@ -24,14 +25,18 @@
 #include <utils/Timers.h>
 
 #include <atomic>
+#include <deque>
+#include <initializer_list>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <unordered_map>
+#include <vector>
 
 namespace android {
 
 class FenceToFenceTimeMap;
 class FenceTime;
+class FenceTimeBatch;
 using FenceTimePtr = std::shared_ptr<FenceTime>;
 
 // A wrapper around fence that only implements isValid and getSignalTime.
@@ -39,6 +44,7 @@ using FenceTimePtr = std::shared_ptr<FenceTime>;
 // time is known.
 class FenceTime {
 friend class FenceToFenceTimeMap;
+friend class FenceTimeBatch;
 public:
     // An atomic snapshot of the FenceTime that is flattenable.
     //
@@ -170,9 +176,43 @@ public:
     void push(const std::shared_ptr<FenceTime>& fence);
     void updateSignalTimes();
 
+    // Same as updateSignalTimes() on each of the timelines, except that their
+    // fences are checked together through the batch.
+    static void updateSignalTimes(std::initializer_list<FenceTimeline*> timelines,
+                                  FenceTimeBatch& batch);
+
 private:
+    void popSignaledLocked() REQUIRES(mMutex);
+
     mutable std::mutex mMutex;
-    std::queue<std::weak_ptr<FenceTime>> mQueue GUARDED_BY(mMutex);
+    std::deque<std::weak_ptr<FenceTime>> mQueue GUARDED_BY(mMutex);
+};
+
+// Checks whether many FenceTimes have signaled in one pass.
+//
+// Calling getSignalTime() on each pending FenceTime makes a sync_file_info
+// query per fence. Instead, updateSignalTimes() polls the fences of all the
+// added FenceTimes with a single poll() call, and only queries the signal time
+// of the ones that have signaled. As with getSignalTime(), the results are
+// cached in the FenceTimes, so that every user of a signaled FenceTime sees its
+// signal time without another syscall.
+//
+// Not thread safe. Keep a FenceTimeBatch around to reuse its storage.
+class FenceTimeBatch {
+public:
+    // Adds a FenceTime to check in the next updateSignalTimes(). Null
+    // FenceTimes and those whose signal time is already known are skipped.
+    void add(const FenceTimePtr& fence);
+
+    // Updates the signal times of the added FenceTimes, then empties the batch.
+    // Returns the number of those that are still pending.
+    size_t updateSignalTimes();
+
+private:
+    std::vector<FenceTimePtr> mFenceTimes;
+    // The fences being polled, held so that their fds stay open while polling.
+    std::vector<sp<Fence>> mFences;
+    std::vector<pollfd> mPollFds;
 };
 
 // Used by test code to create or get FenceTimes for a given Fence.
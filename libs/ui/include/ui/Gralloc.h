@@ -19,6 +19,7 @@
 
 #include <gralloctypes/Gralloc4.h>
 #include <hidl/HidlSupport.h>
+#include <ui/GraphicBufferMetadata.h>
 #include <ui/GraphicTypes.h>
 #include <ui/PixelFormat.h>
 #include <ui/Rect.h>
@@ -201,6 +202,12 @@ public:
                                      std::optional<std::vector<uint8_t>> /*smpte2094_10*/) const {
         return INVALID_OPERATION;
     }
+
+    // Reads the metadata of each of the given types. Each type that is read is added to
+    // outMetadata->types, and the error of the first one that isn't is returned. By default
+    // this reads each type with its getter above, which doesn't cover CROP and STRIDE.
+    virtual status_t getMetadata(buffer_handle_t bufferHandle, ui::BufferMetadataTypes types,
+                                 ui::BufferMetadata* outMetadata) const;
 };
 
 // A wrapper to IAllocator
@@ -156,6 +156,10 @@ public:
             buffer_handle_t bufferHandle,
             std::optional<std::vector<uint8_t>> smpte2094_10) const override;
 
+    [[nodiscard]] status_t getMetadata(buffer_handle_t bufferHandle,
+                                       ui::BufferMetadataTypes types,
+                                       ui::BufferMetadata *outMetadata) const override;
+
 private:
     void unlockBlocking(buffer_handle_t bufferHandle) const;
 
@@ -29,6 +29,7 @@
 #include <ui/ANativeObjectBase.h>
 #include <ui/GraphicBufferAllocator.h>
 #include <ui/GraphicBufferMapper.h>
+#include <ui/GraphicBufferMetadataCache.h>
 #include <ui/PixelFormat.h>
 #include <ui/Rect.h>
 #include <ui/GraphicTypes.h>
@@ -180,6 +181,13 @@ public:
 
     status_t getDataspace(ui::Dataspace* outDataspace) const;
 
+    // Gets several kinds of standard metadata at once, as GraphicBufferMapper::getMetadata.
+    // The types fixed at allocation, such as the plane layouts, are only read from the mapper
+    // the first time; the others, which the producer may set for each frame, are read every
+    // time.
+    status_t getMetadata(std::initializer_list<ui::BufferMetadataType> types,
+                         ui::BufferMetadata* outMetadata) const;
+
     // This function is privileged.  It requires access to the allocator
     // device or service, which usually involves adding suitable selinux
     // rules.
@@ -305,6 +313,8 @@ private:
             mDeathCallbacks;
 
     DependencyMonitor mDependencyMonitor;
+
+    mutable GraphicBufferMetadataCache mMetadataCache;
 };
 
 } // namespace android
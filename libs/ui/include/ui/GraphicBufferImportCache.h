@@ -0,0 +1,115 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <android-base/thread_annotations.h>
+#include <cutils/native_handle.h>
+#include <ui/PixelFormat.h>
+#include <utils/Errors.h>
+
+namespace android {
+
+class GrallocMapper;
+
+// Shares the handles a process imports for the same buffer. A buffer is looked up by its id
+// and generation number, which are unique to an allocation, so a buffer that arrives again,
+// through another parcel or another path, reuses the handle imported the first time instead
+// of going through the mapper again.
+//
+// The id and generation number come from the sender, who could pass those of a buffer it
+// doesn't hold. So a handle is only shared with a raw handle whose fds refer to the same
+// files as the ones it was imported from, and a raw handle without fds isn't cached.
+//
+// The handles are refcounted: each import must be matched by a freeBuffer, and the last
+// one frees the handle with the mapper. The cache never keeps a buffer alive on its own.
+class GraphicBufferImportCache {
+public:
+    // Imports rawHandle with mapper and validates it against the given size, or returns the
+    // handle already imported for the same buffer and validated against the same size.
+    // rawHandle is owned by the caller.
+    status_t importBuffer(const GrallocMapper& mapper, uint64_t bufferId,
+                          uint32_t generationNumber, const native_handle_t* rawHandle,
+                          uint32_t width, uint32_t height, uint32_t layerCount,
+                          PixelFormat format, uint64_t usage, uint32_t stride,
+                          buffer_handle_t* outHandle);
+
+    // Drops a reference to a handle returned by importBuffer, and frees it with mapper after
+    // the last one. Returns false, and does nothing, if the handle isn't in the cache.
+    bool freeBuffer(const GrallocMapper& mapper, buffer_handle_t handle);
+
+    // The number of buffers in the cache.
+    size_t size() const { return mSize.load(std::memory_order_relaxed); }
+
+private:
+    struct Key {
+        uint64_t bufferId;
+        uint32_t generationNumber;
+
+        bool operator==(const Key& other) const {
+            return bufferId == other.bufferId && generationNumber == other.generationNumber;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<uint64_t>()(key.bufferId ^ (uint64_t(key.generationNumber) << 48));
+        }
+    };
+
+    // Identifies the file an fd refers to, whichever process or fd number it is received as.
+    struct FileId {
+        dev_t dev;
+        ino_t ino;
+
+        bool operator==(const FileId& other) const {
+            return dev == other.dev && ino == other.ino;
+        }
+    };
+
+    // Returns false if the handle has no fds, or one of them can't be identified.
+    static bool getFileIds(const native_handle_t* rawHandle, std::vector<FileId>* outFileIds);
+
+    struct Entry {
+        buffer_handle_t handle;
+        // The files of the raw handle it was imported from.
+        std::vector<FileId> files;
+        // What the handle was validated against.
+        uint32_t width;
+        uint32_t height;
+        uint32_t layerCount;
+        PixelFormat format;
+        uint64_t usage;
+        uint32_t stride;
+        size_t refCount;
+    };
+
+    std::mutex mMutex;
+    std::unordered_map<Key, Entry, KeyHash> mEntries GUARDED_BY(mMutex);
+    std::unordered_map<buffer_handle_t, Key> mKeys GUARDED_BY(mMutex);
+    // Lets freeBuffer skip the lock while the cache is empty, as when it is not enabled.
+    std::atomic<size_t> mSize = 0;
+};
+
+} // namespace android
@@ -20,9 +20,12 @@
 #include <stdint.h>
 #include <sys/types.h>
 
+#include <atomic>
 #include <memory>
 
 #include <android-base/unique_fd.h>
+#include <ui/GraphicBufferImportCache.h>
+#include <ui/GraphicBufferMetadata.h>
 #include <ui/GraphicTypes.h>
 #include <ui/PixelFormat.h>
 #include <ui/Rect.h>
@@ -67,8 +70,23 @@ public:
                           uint32_t layerCount, PixelFormat format, uint64_t usage, uint32_t stride,
                           buffer_handle_t* outHandle);
 
+    // Same as above, for a buffer whose id and generation number are known, as when it is
+    // unflattened. With the import cache enabled, a buffer that this process already holds
+    // an imported handle for shares that handle instead of being imported again.
+    status_t importBuffer(uint64_t bufferId, uint32_t generationNumber,
+                          const native_handle_t* rawHandle, uint32_t width, uint32_t height,
+                          uint32_t layerCount, PixelFormat format, uint64_t usage,
+                          uint32_t stride, buffer_handle_t* outHandle);
+
     status_t importBufferNoValidate(const native_handle_t* rawHandle, buffer_handle_t* outHandle);
 
+    // Enables the import cache, which is off by default. The buffers sharing a handle then
+    // share its lock state as well, so a process should only enable it if it doesn't lock
+    // the same buffer through different GraphicBuffers at once.
+    void setImportCacheEnabled(bool enabled) {
+        mImportCacheEnabled.store(enabled, std::memory_order_relaxed);
+    }
+
     status_t freeBuffer(buffer_handle_t handle);
 
     void getTransportSize(buffer_handle_t handle,
@@ -170,6 +188,19 @@ public:
     status_t setSmpte2094_10(buffer_handle_t bufferHandle,
                              std::optional<std::vector<uint8_t>> smpte2094_10);
 
+    /**
+     * Gets several kinds of standard metadata at once, as in
+     *
+     *     getMetadata(handle, {ui::BufferMetadataType::DATASPACE,
+     *                          ui::BufferMetadataType::PLANE_LAYOUTS}, &metadata);
+     *
+     * Nothing is cached here, since a handle doesn't say when it is freed or when another
+     * process sets its metadata; GraphicBuffer::getMetadata caches what can be.
+     */
+    status_t getMetadata(buffer_handle_t bufferHandle,
+                         std::initializer_list<ui::BufferMetadataType> types,
+                         ui::BufferMetadata* outMetadata);
+
     const GrallocMapper& getGrallocMapper() const {
         return reinterpret_cast<const GrallocMapper&>(*mMapper);
     }
@@ -184,6 +215,9 @@ private:
     std::unique_ptr<const GrallocMapper> mMapper;
 
     Version mMapperVersion;
+
+    std::atomic<bool> mImportCacheEnabled = false;
+    GraphicBufferImportCache mImportCache;
 };
 
 // ---------------------------------------------------------------------------
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <initializer_list>
+#include <optional>
+#include <vector>
+
+#include <ui/GraphicTypes.h>
+#include <ui/Rect.h>
+
+namespace android::ui {
+
+// The standard metadata that can be read for a buffer in one getMetadata call.
+enum class BufferMetadataType : uint32_t {
+    DATASPACE = 1 << 0,
+    CROP = 1 << 1,
+    SMPTE2086 = 1 << 2,
+    CTA861_3 = 1 << 3,
+    STRIDE = 1 << 4,
+    PLANE_LAYOUTS = 1 << 5,
+};
+
+// A set of BufferMetadataType, as a mask of their values.
+using BufferMetadataTypes = uint32_t;
+
+constexpr BufferMetadataTypes toBufferMetadataTypes(
+        std::initializer_list<BufferMetadataType> types) {
+    BufferMetadataTypes mask = 0;
+    for (const BufferMetadataType type : types) {
+        mask |= static_cast<BufferMetadataTypes>(type);
+    }
+    return mask;
+}
+
+constexpr bool contains(BufferMetadataTypes types, BufferMetadataType type) {
+    return (types & static_cast<BufferMetadataTypes>(type)) != 0;
+}
+
+// The metadata read for a buffer. Only the fields whose type is in types are set.
+struct BufferMetadata {
+    BufferMetadataTypes types = 0;
+
+    Dataspace dataspace = Dataspace::UNKNOWN;
+    std::vector<Rect> crop;
+    std::optional<Smpte2086> smpte2086;
+    std::optional<Cta861_3> cta861_3;
+    int32_t stride = 0;
+    std::vector<PlaneLayout> planeLayouts;
+
+    bool has(BufferMetadataType type) const { return contains(types, type); }
+};
+
+} // namespace android::ui
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <mutex>
+
+#include <android-base/thread_annotations.h>
+#include <cutils/native_handle.h>
+#include <ui/GraphicBufferMetadata.h>
+#include <utils/Errors.h>
+
+namespace android {
+
+class GrallocMapper;
+
+// Keeps the standard metadata of one buffer that is fixed when the buffer is allocated, so
+// that reading it again, as for each lock or frame, doesn't go back to the mapper. The other
+// types, which a producer may set for each frame, are read every time, together with the
+// missing fixed types in one mapper call.
+//
+// The cache belongs to the owner of the handle, and must be cleared when the handle changes.
+class GraphicBufferMetadataCache {
+public:
+    // The types that are cached.
+    static constexpr ui::BufferMetadataTypes kCachedTypes =
+            ui::toBufferMetadataTypes({ui::BufferMetadataType::STRIDE,
+                                       ui::BufferMetadataType::PLANE_LAYOUTS});
+
+    // Sets the metadata of the given types in outMetadata, reading with mapper those that
+    // aren't cached. Returns the error of the first type that couldn't be read; the types in
+    // outMetadata->types are set either way.
+    status_t getMetadata(const GrallocMapper& mapper, buffer_handle_t handle,
+                         ui::BufferMetadataTypes types, ui::BufferMetadata* outMetadata);
+
+    // Drops the cached metadata, when the handle is freed or replaced.
+    void clear();
+
+private:
+    std::mutex mMutex;
+    ui::BufferMetadata mMetadata GUARDED_BY(mMutex);
+    // Changes when the cache is cleared, so that a read that raced with it isn't cached.
+    uint64_t mGeneration GUARDED_BY(mMutex) = 0;
+};
+
+} // namespace android
@@ -20,6 +20,7 @@
 #include <sys/types.h>
 #include <array>
 #include <ostream>
+#include <span>
 #include <string>
 
 #include <math/mat4.h>
@@ -103,6 +104,14 @@ public:
     vec2 transform(const vec2& v) const;
     vec3 transform(const vec3& v) const;
 
+    // Maps each element of in to the element of out at the same index; out must be at least
+    // as large as in, and may be in. The elements are mapped several lanes at a time, which
+    // is cheaper than one transform() call each when mapping the bounds of many layers.
+    void transform(std::span<const Rect> in, std::span<Rect> out,
+                   bool roundOutwards = false) const;
+    void transform(std::span<const FloatRect> in, std::span<FloatRect> out) const;
+    void transform(std::span<const vec2> in, std::span<vec2> out) const;
+
     // Expands from the internal 3x3 matrix to an equivalent 4x4 matrix
     mat4 asMatrix4() const;
 
@@ -128,6 +137,15 @@ private:
     static bool absIsOne(float f);
     static bool isZero(float f);
 
+    // Maps the edges of a rect if this transform preserves rects, and returns whether it
+    // does. Each output edge then depends on a single input edge, so two corners are
+    // enough instead of four.
+    bool transformEdges(const FloatRect& bounds, FloatRect* outBounds) const;
+    // The coefficients that map the edges of a rect, all in one vector, to its new edges.
+    struct EdgeMap;
+    // Returns whether this transform preserves rects, and if so sets the map of its edges.
+    bool getEdgeMap(EdgeMap* map) const;
+
     mat33               mMatrix;
     mutable uint32_t    mType;
 };
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "FenceTimeTest"
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+#include <ui/FenceTime.h>
+
+namespace android {
+namespace {
+
+TEST(FenceTimeBatchTest, skipsKnownSignalTimes) {
+    FenceTimeBatch batch;
+    batch.add(nullptr);
+    batch.add(FenceTime::NO_FENCE);
+    batch.add(std::make_shared<FenceTime>(nsecs_t(10)));
+    EXPECT_EQ(0u, batch.updateSignalTimes());
+}
+
+TEST(FenceTimeBatchTest, updatesSignaledFences) {
+    FenceToFenceTimeMap fenceMap;
+    const auto [fence1, fenceTime1] = fenceMap.makePendingFenceForTest();
+    const auto [fence2, fenceTime2] = fenceMap.makePendingFenceForTest();
+
+    FenceTimeBatch batch;
+    batch.add(fenceTime1);
+    batch.add(fenceTime2);
+    EXPECT_EQ(2u, batch.updateSignalTimes());
+
+    fenceMap.signalAllForTest(fence2, 20);
+    batch.add(fenceTime1);
+    batch.add(fenceTime2);
+    EXPECT_EQ(1u, batch.updateSignalTimes());
+    EXPECT_EQ(Fence::SIGNAL_TIME_PENDING, fenceTime1->getCachedSignalTime());
+    EXPECT_EQ(20, fenceTime2->getCachedSignalTime());
+}
+
+// Only the fds that poll() reports as ready are queried for their signal time.
+TEST(FenceTimeBatchTest, onlyQueriesReadyFds) {
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    const auto fenceTime = std::make_shared<FenceTime>(sp<Fence>::make(fds[0]));
+
+    FenceTimeBatch batch;
+    batch.add(fenceTime);
+    EXPECT_EQ(1u, batch.updateSignalTimes());
+    EXPECT_EQ(Fence::SIGNAL_TIME_PENDING, fenceTime->getCachedSignalTime());
+
+    // A pipe isn't a sync file, so querying it once it is ready fails.
+    ASSERT_EQ(1, write(fds[1], "x", 1));
+    batch.add(fenceTime);
+    EXPECT_EQ(0u, batch.updateSignalTimes());
+    EXPECT_EQ(Fence::SIGNAL_TIME_INVALID, fenceTime->getCachedSignalTime());
+    close(fds[1]);
+}
+
+TEST(FenceTimelineTest, updateSignalTimesOfSeveralTimelines) {
+    FenceToFenceTimeMap fenceMap;
+    FenceTimeline timeline1;
+    FenceTimeline timeline2;
+    const auto [fence1, fenceTime1] = fenceMap.makePendingFenceForTest();
+    const auto [fence2, fenceTime2] = fenceMap.makePendingFenceForTest();
+    const auto [fence3, fenceTime3] = fenceMap.makePendingFenceForTest();
+    timeline1.push(fenceTime1);
+    timeline1.push(fenceTime2);
+    timeline2.push(fenceTime3);
+
+    FenceTimeBatch batch;
+    fenceMap.signalAllForTest(fence1, 10);
+    fenceMap.signalAllForTest(fence3, 30);
+    FenceTimeline::updateSignalTimes({&timeline1, &timeline2}, batch);
+    EXPECT_EQ(10, fenceTime1->getCachedSignalTime());
+    EXPECT_EQ(Fence::SIGNAL_TIME_PENDING, fenceTime2->getCachedSignalTime());
+    EXPECT_EQ(30, fenceTime3->getCachedSignalTime());
+
+    fenceMap.signalAllForTest(fence2, 20);
+    FenceTimeline::updateSignalTimes({&timeline1, &timeline2}, batch);
+    EXPECT_EQ(20, fenceTime2->getCachedSignalTime());
+}
+
+} // namespace
+} // namespace android
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "GraphicBufferImportCacheTest"
+
+#include <ui/GraphicBufferImportCache.h>
+
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+
+#include "mock/FakeGrallocMapper.h"
+
+namespace android {
+namespace {
+
+constexpr uint32_t kWidth = 64;
+constexpr uint32_t kHeight = 32;
+
+class GraphicBufferImportCacheTest : public testing::Test {
+protected:
+    GraphicBufferImportCacheTest() : mRawHandle(createRawHandle()) {}
+    ~GraphicBufferImportCacheTest() override { deleteRawHandle(mRawHandle); }
+
+    // Creates the raw handle of a buffer backed by its own file.
+    static native_handle_t* createRawHandle() {
+        native_handle_t* rawHandle = native_handle_create(1, 1);
+        rawHandle->data[0] = memfd_create("buffer", MFD_CLOEXEC);
+        return rawHandle;
+    }
+
+    static void deleteRawHandle(native_handle_t* rawHandle) {
+        native_handle_close(rawHandle);
+        native_handle_delete(rawHandle);
+    }
+
+    status_t import(uint64_t bufferId, uint32_t generationNumber, buffer_handle_t* outHandle,
+                    uint32_t width = kWidth, const native_handle_t* rawHandle = nullptr) {
+        return mCache.importBuffer(mMapper, bufferId, generationNumber,
+                                   rawHandle ? rawHandle : mRawHandle, width, kHeight, 1,
+                                   PIXEL_FORMAT_RGBA_8888, 0, width, outHandle);
+    }
+
+    mock::FakeGrallocMapper mMapper;
+    GraphicBufferImportCache mCache;
+    native_handle_t* const mRawHandle;
+};
+
+TEST_F(GraphicBufferImportCacheTest, sharesHandleOfSameBuffer) {
+    buffer_handle_t first;
+    buffer_handle_t second;
+    ASSERT_EQ(NO_ERROR, import(1, 0, &first));
+    ASSERT_EQ(NO_ERROR, import(1, 0, &second));
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(1u, mMapper.importCount);
+    EXPECT_EQ(1u, mMapper.validateCount);
+    EXPECT_EQ(1u, mCache.size());
+
+    // The handle is freed with the last reference.
+    EXPECT_TRUE(mCache.freeBuffer(mMapper, first));
+    EXPECT_EQ(0u, mMapper.freeCount);
+    EXPECT_TRUE(mCache.freeBuffer(mMapper, second));
+    EXPECT_EQ(1u, mMapper.freeCount);
+    EXPECT_EQ(0u, mCache.size());
+
+    buffer_handle_t third;
+    ASSERT_EQ(NO_ERROR, import(1, 0, &third));
+    EXPECT_EQ(2u, mMapper.importCount);
+    EXPECT_TRUE(mCache.freeBuffer(mMapper, third));
+}
+
+TEST_F(GraphicBufferImportCacheTest, sharesHandleWithOtherFdsOfSameFiles) {
+    native_handle_t* const received = native_handle_clone(mRawHandle);
+    buffer_handle_t first;
+    buffer_handle_t second;
+    ASSERT_EQ(NO_ERROR, import(1, 0, &first));
+    ASSERT_EQ(NO_ERROR, import(1, 0, &second, kWidth, received));
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(1u, mMapper.importCount);
+    EXPECT_TRUE(mCache.freeBuffer(mMapper, first));
+    EXPECT_TRUE(mCache.freeBuffer(mMapper, second));
+    deleteRawHandle(received);
+}
+
+TEST_F(GraphicBufferImportCacheTest, doesNotShareHandleWithOtherFilesOfSameId) {
+    // A sender passes the id of a buffer it doesn't hold with the files of another one.
+    native_handle_t* const forged = createRawHandle();
+    buffer_handle_t first;
+    buffer_handle_t second;
+    ASSERT_EQ(NO_ERROR, import(1, 0, &first));
+    ASSERT_EQ(NO_ERROR, import(1, 0, &second, kWidth, forged));
+    EXPECT_NE(first, second);
+    EXPECT_EQ(2u, mMapper.importCount);
+    EXPECT_EQ(1u, mCache.size());
+
+    EXPECT_FALSE(mCache.freeBuffer(mMapper, second));
+    mMapper.freeBuffer(second);
+    EXPECT_TRUE(mCache.freeBuffer(mMapper, first));
+    deleteRawHandle(forged);
+}
+
+TEST_F(GraphicBufferImportCacheTest, doesNotCacheHandlesWithoutFds) {
+    native_handle_t* const rawHandle = native_handle_create(0, 1);
+    buffer_handle_t first;
+    buffer_handle_t second;
+    ASSERT_EQ(NO_ERROR, import(1, 0, &first, kWidth, rawHandle));
+    ASSERT_EQ(NO_ERROR, import(1, 0, &second, kWidth, rawHandle));
+    EXPECT_NE(first, second);
+    EXPECT_EQ(0u, mCache.size());
+    mMapper.freeBuffer(first);
+    mMapper.freeBuffer(second);
+    native_handle_delete(rawHandle);
+}
+
+TEST_F(GraphicBufferImportCacheTest, importsOtherGenerationsSeparately) {
+    buffer_handle_t first;
+    buffer_handle_t second;
+    ASSERT_EQ(NO_ERROR, import(1, 0, &first));
+    ASSERT_EQ(NO_ERROR, import(1, 1, &second));
+    EXPECT_NE(first, second);
+    EXPECT_EQ(2u, mMapper.importCount);
+    EXPECT_TRUE(mCache.freeBuffer(mMapper, first));
+    EXPECT_TRUE(mCache.freeBuffer(mMapper, second));
+    EXPECT_EQ(2u, mMapper.freeCount);
+}
+
+TEST_F(GraphicBufferImportCacheTest, doesNotShareHandleValidatedAgainstOtherSize) {
+    buffer_handle_t first;
+    buffer_handle_t second;
+    ASSERT_EQ(NO_ERROR, import(1, 0, &first));
+    ASSERT_EQ(NO_ERROR, import(1, 0, &second, kWidth / 2));
+    EXPECT_NE(first, second);
+    EXPECT_EQ(2u, mMapper.validateCount);
+    EXPECT_EQ(1u, mCache.size());
+
+    // The second handle isn't in the cache, so its owner frees it with the mapper.
+    EXPECT_FALSE(mCache.freeBuffer(mMapper, second));
+    mMapper.freeBuffer(second);
+    EXPECT_TRUE(mCache.freeBuffer(mMapper, first));
+}
+
+TEST_F(GraphicBufferImportCacheTest, doesNotCacheInvalidBuffers) {
+    mMapper.maxWidth = kWidth - 1;
+    buffer_handle_t handle;
+    EXPECT_EQ(BAD_VALUE, import(1, 0, &handle));
+    EXPECT_EQ(1u, mMapper.freeCount);
+    EXPECT_EQ(0u, mCache.size());
+
+    mMapper.maxWidth = kWidth;
+    ASSERT_EQ(NO_ERROR, import(1, 0, &handle));
+    EXPECT_EQ(2u, mMapper.importCount);
+    EXPECT_TRUE(mCache.freeBuffer(mMapper, handle));
+}
+
+TEST_F(GraphicBufferImportCacheTest, ignoresHandlesImportedElsewhere) {
+    buffer_handle_t cached;
+    ASSERT_EQ(NO_ERROR, import(1, 0, &cached));
+    buffer_handle_t other;
+    ASSERT_EQ(NO_ERROR, mMapper.importBuffer(mRawHandle, &other));
+    EXPECT_FALSE(mCache.freeBuffer(mMapper, other));
+    EXPECT_EQ(0u, mMapper.freeCount);
+    mMapper.freeBuffer(other);
+    EXPECT_TRUE(mCache.freeBuffer(mMapper, cached));
+}
+
+} // namespace
+} // namespace android
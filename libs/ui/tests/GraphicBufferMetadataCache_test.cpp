@@ -0,0 +1,195 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "GraphicBufferMetadataCacheTest"
+
+#include <ui/GraphicBufferMetadataCache.h>
+
+#include <array>
+
+#include <gtest/gtest.h>
+
+#include "mock/FakeGrallocMapper.h"
+
+namespace android {
+namespace {
+
+using ui::BufferMetadata;
+using ui::BufferMetadataType;
+
+constexpr ui::BufferMetadataTypes kCompositionTypes =
+        ui::toBufferMetadataTypes({BufferMetadataType::DATASPACE, BufferMetadataType::SMPTE2086,
+                                   BufferMetadataType::CTA861_3,
+                                   BufferMetadataType::PLANE_LAYOUTS});
+
+constexpr ui::BufferMetadataTypes kDataspace =
+        ui::toBufferMetadataTypes({BufferMetadataType::DATASPACE});
+
+class GraphicBufferMetadataCacheTest : public testing::Test {
+protected:
+    GraphicBufferMetadataCacheTest() {
+        for (auto& buffer : mBuffers) {
+            buffer = native_handle_create(0, 0);
+        }
+        mMapper.dataspace = ui::Dataspace::BT2020_ITU_PQ;
+        mMapper.cta861_3 = ui::Cta861_3{.maxContentLightLevel = 1000.f,
+                                        .maxFrameAverageLightLevel = 200.f};
+        mMapper.planeLayouts.resize(2);
+    }
+
+    ~GraphicBufferMetadataCacheTest() override {
+        for (auto* buffer : mBuffers) {
+            native_handle_delete(buffer);
+        }
+    }
+
+    status_t getMetadata(size_t buffer, ui::BufferMetadataTypes types, BufferMetadata* metadata) {
+        return mCaches[buffer].getMetadata(mMapper, mBuffers[buffer], types, metadata);
+    }
+
+    mock::FakeGrallocMapper mMapper;
+    std::array<native_handle_t*, 4> mBuffers;
+    // One cache for each buffer, as held by its GraphicBuffer.
+    std::array<GraphicBufferMetadataCache, 4> mCaches;
+};
+
+TEST_F(GraphicBufferMetadataCacheTest, readsFixedTypesOnce) {
+    BufferMetadata metadata;
+    ASSERT_EQ(NO_ERROR, getMetadata(0, kCompositionTypes, &metadata));
+    EXPECT_EQ(kCompositionTypes, metadata.types);
+    EXPECT_EQ(ui::Dataspace::BT2020_ITU_PQ, metadata.dataspace);
+    EXPECT_FALSE(metadata.smpte2086.has_value());
+    EXPECT_EQ(mMapper.cta861_3, metadata.cta861_3);
+    EXPECT_EQ(2u, metadata.planeLayouts.size());
+    EXPECT_EQ(4u, mMapper.metadataReadCount);
+
+    // Only the plane layouts are cached.
+    BufferMetadata cached;
+    ASSERT_EQ(NO_ERROR, getMetadata(0, kCompositionTypes, &cached));
+    EXPECT_EQ(kCompositionTypes, cached.types);
+    EXPECT_EQ(metadata.dataspace, cached.dataspace);
+    EXPECT_EQ(metadata.cta861_3, cached.cta861_3);
+    EXPECT_EQ(metadata.planeLayouts, cached.planeLayouts);
+    EXPECT_EQ(7u, mMapper.metadataReadCount);
+}
+
+TEST_F(GraphicBufferMetadataCacheTest, readsOnlyMissingTypes) {
+    BufferMetadata metadata;
+    ASSERT_EQ(NO_ERROR,
+              getMetadata(0, ui::toBufferMetadataTypes({BufferMetadataType::PLANE_LAYOUTS}),
+                          &metadata));
+    EXPECT_EQ(1u, mMapper.metadataReadCount);
+
+    metadata = {};
+    ASSERT_EQ(NO_ERROR,
+              getMetadata(0,
+                          ui::toBufferMetadataTypes({BufferMetadataType::DATASPACE,
+                                                     BufferMetadataType::PLANE_LAYOUTS}),
+                          &metadata));
+    EXPECT_TRUE(metadata.has(BufferMetadataType::DATASPACE));
+    EXPECT_TRUE(metadata.has(BufferMetadataType::PLANE_LAYOUTS));
+    EXPECT_FALSE(metadata.has(BufferMetadataType::CTA861_3));
+    EXPECT_EQ(2u, mMapper.metadataReadCount);
+}
+
+TEST_F(GraphicBufferMetadataCacheTest, rereadsMetadataSetForEachFrame) {
+    BufferMetadata metadata;
+    ASSERT_EQ(NO_ERROR, getMetadata(0, kDataspace, &metadata));
+    EXPECT_EQ(ui::Dataspace::BT2020_ITU_PQ, metadata.dataspace);
+
+    // As a producer in another process would, without telling the cache.
+    ASSERT_EQ(NO_ERROR, mMapper.setDataspace(mBuffers[0], ui::Dataspace::SRGB));
+
+    metadata = {};
+    ASSERT_EQ(NO_ERROR, getMetadata(0, kDataspace, &metadata));
+    EXPECT_EQ(ui::Dataspace::SRGB, metadata.dataspace);
+    EXPECT_EQ(2u, mMapper.metadataReadCount);
+}
+
+TEST_F(GraphicBufferMetadataCacheTest, rereadsAfterClear) {
+    BufferMetadata metadata;
+    ASSERT_EQ(NO_ERROR, getMetadata(0, kCompositionTypes, &metadata));
+    mCaches[0].clear();
+
+    metadata = {};
+    ASSERT_EQ(NO_ERROR, getMetadata(0, kCompositionTypes, &metadata));
+    EXPECT_EQ(kCompositionTypes, metadata.types);
+    EXPECT_EQ(8u, mMapper.metadataReadCount);
+}
+
+TEST_F(GraphicBufferMetadataCacheTest, doesNotCacheTypesThatFailToRead) {
+    // The fake mapper, like the mappers before gralloc 5, can't read the stride.
+    const auto types = ui::toBufferMetadataTypes({BufferMetadataType::STRIDE,
+                                                  BufferMetadataType::PLANE_LAYOUTS});
+    BufferMetadata metadata;
+    EXPECT_EQ(INVALID_OPERATION, getMetadata(0, types, &metadata));
+    EXPECT_EQ(ui::toBufferMetadataTypes({BufferMetadataType::PLANE_LAYOUTS}), metadata.types);
+
+    metadata = {};
+    EXPECT_EQ(INVALID_OPERATION, getMetadata(0, types, &metadata));
+    EXPECT_EQ(ui::toBufferMetadataTypes({BufferMetadataType::PLANE_LAYOUTS}), metadata.types);
+    EXPECT_EQ(1u, mMapper.metadataReadCount);
+}
+
+// Reads the metadata that composition needs for each buffer on each frame, one type at a time
+// from the mapper as the getters do, then through the caches, and compares the mapper calls.
+TEST_F(GraphicBufferMetadataCacheTest, readsFixedTypesFromMapperOncePerBuffer) {
+    constexpr size_t kFrameCount = 60;
+    constexpr size_t kReadsPerBuffer = 4;
+    constexpr size_t kFixedReadsPerBuffer = 1;
+
+    for (size_t frame = 0; frame < kFrameCount; frame++) {
+        for (auto* buffer : mBuffers) {
+            BufferMetadata metadata;
+            ASSERT_EQ(NO_ERROR, mMapper.getMetadata(buffer, kCompositionTypes, &metadata));
+        }
+    }
+    const size_t uncachedReadCount = mMapper.metadataReadCount;
+    EXPECT_EQ(kFrameCount * mBuffers.size() * kReadsPerBuffer, uncachedReadCount);
+
+    mMapper.metadataReadCount = 0;
+    for (size_t frame = 0; frame < kFrameCount; frame++) {
+        for (size_t buffer = 0; buffer < mBuffers.size(); buffer++) {
+            BufferMetadata metadata;
+            ASSERT_EQ(NO_ERROR, getMetadata(buffer, kCompositionTypes, &metadata));
+            ASSERT_EQ(kCompositionTypes, metadata.types);
+        }
+    }
+    EXPECT_EQ(mBuffers.size() *
+                      (kFrameCount * (kReadsPerBuffer - kFixedReadsPerBuffer) +
+                       kFixedReadsPerBuffer),
+              mMapper.metadataReadCount);
+}
+
+// Reads the plane layouts as GraphicBuffer::lockAsync does to report the bytes per pixel and
+// stride, for each buffer locked on each frame by a CPU producer or consumer.
+TEST_F(GraphicBufferMetadataCacheTest, readsPlaneLayoutsForLocksOncePerBuffer) {
+    constexpr size_t kFrameCount = 60;
+    const ui::BufferMetadataTypes planeLayouts =
+            ui::toBufferMetadataTypes({BufferMetadataType::PLANE_LAYOUTS});
+
+    for (size_t frame = 0; frame < kFrameCount; frame++) {
+        for (size_t buffer = 0; buffer < mBuffers.size(); buffer++) {
+            BufferMetadata metadata;
+            ASSERT_EQ(NO_ERROR, getMetadata(buffer, planeLayouts, &metadata));
+            ASSERT_EQ(2u, metadata.planeLayouts.size());
+        }
+    }
+    EXPECT_EQ(mBuffers.size(), mMapper.metadataReadCount);
+}
+
+} // namespace
+} // namespace android
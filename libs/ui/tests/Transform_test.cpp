@@ -18,6 +18,9 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace android::ui {
 
 TEST(TransformTest, inverseRotation_hasCorrectType) {
@@ -46,4 +49,112 @@ TEST(TransformTest, inverseRotation_hasCorrectType) {
     testRotationFlagsForInverse(Transform::FLIP_V, Transform::FLIP_V, false);
 }
 
+namespace {
+
+// Maps the four corners of the rect, as the transforms that don't preserve rects do.
+FloatRect transformCorners(const Transform& t, const FloatRect& r) {
+    const vec2 corners[] = {t.transform(r.left, r.top), t.transform(r.right, r.top),
+                            t.transform(r.left, r.bottom), t.transform(r.right, r.bottom)};
+    FloatRect result(corners[0].x, corners[0].y, corners[0].x, corners[0].y);
+    for (const vec2& corner : corners) {
+        result.left = std::min(result.left, corner.x);
+        result.top = std::min(result.top, corner.y);
+        result.right = std::max(result.right, corner.x);
+        result.bottom = std::max(result.bottom, corner.y);
+    }
+    return result;
+}
+
+std::vector<Transform> rectPreservingTransforms() {
+    std::vector<Transform> transforms;
+    Transform translate;
+    translate.set(12.f, -7.f);
+    transforms.push_back(translate);
+    Transform scale;
+    scale.set(2.f, 0.f, 0.f, 0.5f);
+    scale.set(30.f, 40.f);
+    transforms.push_back(scale);
+    for (const auto flags : {Transform::ROT_90, Transform::ROT_180, Transform::ROT_270,
+                             Transform::FLIP_H, Transform::FLIP_V}) {
+        transforms.push_back(Transform(flags, 1080, 2340));
+        transforms.push_back(Transform(flags, 1080, 2340) * scale);
+    }
+    return transforms;
+}
+
+} // namespace
+
+TEST(TransformTest, rectFastPathsMatchCorners) {
+    const FloatRect bounds(10.f, 20.f, 110.f, 420.f);
+    for (const Transform& t : rectPreservingTransforms()) {
+        SCOPED_TRACE(testing::PrintToString(t));
+        ASSERT_TRUE(t.preserveRects());
+        EXPECT_EQ(transformCorners(t, bounds), t.transform(bounds));
+        EXPECT_EQ(Rect(transformCorners(t, bounds)), t.transform(Rect(10, 20, 110, 420)));
+        EXPECT_EQ(Rect(transformCorners(t, FloatRect(0.f, 0.f, 64.f, 32.f))),
+                  t.makeBounds(64, 32));
+    }
+}
+
+TEST(TransformTest, composeDiagonalTransforms) {
+    Transform translate;
+    translate.set(5.f, 6.f);
+    Transform scale;
+    scale.set(2.f, 0.f, 0.f, 3.f);
+    scale.set(1.f, 1.f);
+
+    const Transform translated = translate * translate;
+    EXPECT_EQ(Transform::TRANSLATE, translated.getType());
+    EXPECT_EQ(10.f, translated.tx());
+    EXPECT_EQ(12.f, translated.ty());
+
+    Transform inverseTranslate;
+    inverseTranslate.set(-5.f, -6.f);
+    EXPECT_EQ(Transform::IDENTITY, (translate * inverseTranslate).getType());
+
+    // Scales the translation of the rhs, then translates.
+    const Transform scaled = scale * translate;
+    EXPECT_EQ(Transform::SCALE | Transform::TRANSLATE, scaled.getType());
+    EXPECT_EQ(2.f, scaled.dsdx());
+    EXPECT_EQ(3.f, scaled.dsdy());
+    EXPECT_EQ(11.f, scaled.tx());
+    EXPECT_EQ(19.f, scaled.ty());
+    EXPECT_EQ(vec2(13.f, 25.f), scaled.transform(vec2(1.f, 2.f)));
+}
+
+TEST(TransformTest, batchMatchesSingleTransforms) {
+    const std::vector<Rect> rects = {Rect(0, 0, 10, 10), Rect(-5, 3, 17, 40),
+                                     Rect(100, 200, 300, 250)};
+    const std::vector<vec2> points = {vec2(0.f, 0.f), vec2(1.5f, -2.f), vec2(300.f, 7.f)};
+    Transform skew;
+    skew.set(1.f, 0.5f, 0.25f, 1.f);
+    std::vector<Transform> transforms = rectPreservingTransforms();
+    transforms.push_back(skew);
+
+    for (const Transform& t : transforms) {
+        SCOPED_TRACE(testing::PrintToString(t));
+        std::vector<Rect> mappedRects(rects.size());
+        t.transform(rects, mappedRects);
+        std::vector<Rect> roundedOutRects(rects.size());
+        t.transform(rects, roundedOutRects, true);
+        std::vector<FloatRect> floatRects;
+        for (const Rect& rect : rects) {
+            floatRects.push_back(rect.toFloatRect());
+        }
+        std::vector<FloatRect> mappedFloatRects(rects.size());
+        t.transform(floatRects, mappedFloatRects);
+        for (size_t i = 0; i < rects.size(); i++) {
+            EXPECT_EQ(t.transform(rects[i]), mappedRects[i]);
+            EXPECT_EQ(t.transform(rects[i], true), roundedOutRects[i]);
+            EXPECT_EQ(t.transform(floatRects[i]), mappedFloatRects[i]);
+        }
+
+        std::vector<vec2> mappedPoints(points.size());
+        t.transform(points, mappedPoints);
+        for (size_t i = 0; i < points.size(); i++) {
+            EXPECT_EQ(t.transform(points[i]), mappedPoints[i]);
+        }
+    }
+}
+
 } // namespace android::ui
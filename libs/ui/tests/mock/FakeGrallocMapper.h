@@ -0,0 +1,114 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cutils/native_handle.h>
+#include <ui/Gralloc.h>
+
+namespace android::mock {
+
+// A mapper that imports a buffer by cloning its handle, holds the same metadata for all the
+// buffers, and counts the calls made to it.
+class FakeGrallocMapper : public GrallocMapper {
+public:
+    bool isLoaded() const override { return true; }
+
+    status_t importBuffer(const native_handle_t* rawHandle,
+                          buffer_handle_t* outBufferHandle) const override {
+        importCount++;
+        *outBufferHandle = native_handle_clone(rawHandle);
+        return *outBufferHandle ? NO_ERROR : NO_MEMORY;
+    }
+
+    void freeBuffer(buffer_handle_t bufferHandle) const override {
+        freeCount++;
+        native_handle_close(bufferHandle);
+        native_handle_delete(const_cast<native_handle_t*>(bufferHandle));
+    }
+
+    status_t validateBufferSize(buffer_handle_t /*bufferHandle*/, uint32_t width,
+                                uint32_t /*height*/, PixelFormat /*format*/,
+                                uint32_t /*layerCount*/, uint64_t /*usage*/,
+                                uint32_t /*stride*/) const override {
+        validateCount++;
+        return width <= maxWidth ? NO_ERROR : BAD_VALUE;
+    }
+
+    void getTransportSize(buffer_handle_t bufferHandle, uint32_t* outNumFds,
+                          uint32_t* outNumInts) const override {
+        *outNumFds = static_cast<uint32_t>(bufferHandle->numFds);
+        *outNumInts = static_cast<uint32_t>(bufferHandle->numInts);
+    }
+
+    status_t lock(buffer_handle_t, uint64_t, const Rect&, int, void**, int32_t*,
+                  int32_t*) const override {
+        return INVALID_OPERATION;
+    }
+
+    status_t lock(buffer_handle_t, uint64_t, const Rect&, int, android_ycbcr*) const override {
+        return INVALID_OPERATION;
+    }
+
+    int unlock(buffer_handle_t) const override { return -1; }
+
+    status_t getDataspace(buffer_handle_t, ui::Dataspace* outDataspace) const override {
+        metadataReadCount++;
+        *outDataspace = dataspace;
+        return NO_ERROR;
+    }
+
+    status_t setDataspace(buffer_handle_t, ui::Dataspace value) const override {
+        dataspace = value;
+        return NO_ERROR;
+    }
+
+    status_t getSmpte2086(buffer_handle_t,
+                          std::optional<ui::Smpte2086>* outSmpte2086) const override {
+        metadataReadCount++;
+        *outSmpte2086 = smpte2086;
+        return NO_ERROR;
+    }
+
+    status_t getCta861_3(buffer_handle_t, std::optional<ui::Cta861_3>* outCta861_3) const override {
+        metadataReadCount++;
+        *outCta861_3 = cta861_3;
+        return NO_ERROR;
+    }
+
+    status_t getPlaneLayouts(buffer_handle_t,
+                             std::vector<ui::PlaneLayout>* outPlaneLayouts) const override {
+        metadataReadCount++;
+        *outPlaneLayouts = planeLayouts;
+        return NO_ERROR;
+    }
+
+    // Buffers wider than this fail validation.
+    uint32_t maxWidth = UINT32_MAX;
+
+    // The metadata of every buffer.
+    mutable ui::Dataspace dataspace = ui::Dataspace::UNKNOWN;
+    std::optional<ui::Smpte2086> smpte2086;
+    std::optional<ui::Cta861_3> cta861_3;
+    std::vector<ui::PlaneLayout> planeLayouts;
+
+    mutable size_t importCount = 0;
+    mutable size_t validateCount = 0;
+    mutable size_t freeCount = 0;
+    mutable size_t metadataReadCount = 0;
+};
+
+} // namespace android::mock
@@ -33,20 +33,26 @@ ANDROID_SINGLETON_STATIC_INSTANCE(ClientCache);
 
 ClientCache::ClientCache() : mDeathRecipient(sp<CacheDeathRecipient>::make()) {}
 
-bool ClientCache::getBuffer(const client_cache_t& cacheId,
+ClientCache::Shard& ClientCache::getShard(const wp<IBinder>& processToken) {
+    // Binder objects are heap allocated, so the low bits of their address are always the same.
+    const uint64_t address = reinterpret_cast<uintptr_t>(processToken.unsafe_get()) >> 4;
+    return mShards[(address * 0x9e3779b97f4a7c15) >> (64 - kShardBits)];
+}
+
+bool ClientCache::getBuffer(Shard& shard, const client_cache_t& cacheId,
                             ClientCacheBuffer** outClientCacheBuffer) {
     auto& [processToken, id] = cacheId;
     if (processToken == nullptr) {
         ALOGE_AND_TRACE("ClientCache::getBuffer - invalid (nullptr) process token");
         return false;
     }
-    auto it = mBuffers.find(processToken);
-    if (it == mBuffers.end()) {
+    auto it = shard.processes.find(processToken);
+    if (it == shard.processes.end()) {
         ALOGE_AND_TRACE("ClientCache::getBuffer - invalid process token");
         return false;
     }
 
-    auto& processBuffers = it->second.second;
+    auto& processBuffers = it->second.buffers;
 
     auto bufItr = processBuffers.find(id);
     if (bufItr == processBuffers.end()) {
@@ -72,13 +78,14 @@ ClientCache::add(const client_cache_t& cacheId, const sp<GraphicBuffer>& buffer)
         return base::unexpected(AddError::Unspecified);
     }
 
-    std::lock_guard lock(mMutex);
+    Shard& shard = getShard(processToken);
+    std::lock_guard lock(shard.mutex);
     sp<IBinder> token;
 
     // If this is a new process token, set a death recipient. If the client process dies, we will
     // get a callback through binderDied.
-    auto it = mBuffers.find(processToken);
-    if (it == mBuffers.end()) {
+    auto it = shard.processes.find(processToken);
+    if (it == shard.processes.end()) {
         token = processToken.promote();
         if (!token) {
             ALOGE_AND_TRACE("ClientCache::add - invalid token");
@@ -94,14 +101,12 @@ ClientCache::add(const client_cache_t& cacheId, const sp<GraphicBuffer>& buffer)
             }
         }
         auto [itr, success] =
-                mBuffers.emplace(processToken,
-                                 std::make_pair(token,
-                                                std::unordered_map<uint64_t, ClientCacheBuffer>()));
+                shard.processes.emplace(processToken, ProcessBuffers{.token = std::move(token)});
         LOG_ALWAYS_FATAL_IF(!success, "failed to insert new process into client cache");
         it = itr;
     }
 
-    auto& processBuffers = it->second.second;
+    auto& processBuffers = it->second.buffers;
 
     if (processBuffers.size() > BUFFER_CACHE_MAX_SIZE) {
         ALOGE_AND_TRACE("ClientCache::add - cache is full");
@@ -123,9 +128,10 @@ sp<GraphicBuffer> ClientCache::erase(const client_cache_t& cacheId) {
     auto& [processToken, id] = cacheId;
     std::vector<sp<ErasedRecipient>> pendingErase;
     {
-        std::lock_guard lock(mMutex);
+        Shard& shard = getShard(processToken);
+        std::lock_guard lock(shard.mutex);
         ClientCacheBuffer* buf = nullptr;
-        if (!getBuffer(cacheId, &buf)) {
+        if (!getBuffer(shard, cacheId, &buf)) {
             ALOGE("failed to erase buffer, could not retrieve buffer");
             return nullptr;
         }
@@ -139,7 +145,7 @@ sp<GraphicBuffer> ClientCache::erase(const client_cache_t& cacheId) {
             }
         }
 
-        mBuffers[processToken].second.erase(id);
+        shard.processes[processToken].buffers.erase(id);
     }
 
     for (auto& recipient : pendingErase) {
@@ -149,10 +155,11 @@ sp<GraphicBuffer> ClientCache::erase(const client_cache_t& cacheId) {
 }
 
 std::shared_ptr<renderengine::ExternalTexture> ClientCache::get(const client_cache_t& cacheId) {
-    std::lock_guard lock(mMutex);
+    Shard& shard = getShard(cacheId.token);
+    std::lock_guard lock(shard.mutex);
 
     ClientCacheBuffer* buf = nullptr;
-    if (!getBuffer(cacheId, &buf)) {
+    if (!getBuffer(shard, cacheId, &buf)) {
         ALOGE("failed to get buffer, could not retrieve buffer");
         return nullptr;
     }
@@ -162,10 +169,11 @@ std::shared_ptr<renderengine::ExternalTexture> ClientCache::get(const client_cac
 
 bool ClientCache::registerErasedRecipient(const client_cache_t& cacheId,
                                           const wp<ErasedRecipient>& recipient) {
-    std::lock_guard lock(mMutex);
+    Shard& shard = getShard(cacheId.token);
+    std::lock_guard lock(shard.mutex);
 
     ClientCacheBuffer* buf = nullptr;
-    if (!getBuffer(cacheId, &buf)) {
+    if (!getBuffer(shard, cacheId, &buf)) {
         ALOGV("failed to register erased recipient, could not retrieve buffer");
         return false;
     }
@@ -175,10 +183,11 @@ bool ClientCache::registerErasedRecipient(const client_cache_t& cacheId,
 
 void ClientCache::unregisterErasedRecipient(const client_cache_t& cacheId,
                                             const wp<ErasedRecipient>& recipient) {
-    std::lock_guard lock(mMutex);
+    Shard& shard = getShard(cacheId.token);
+    std::lock_guard lock(shard.mutex);
 
     ClientCacheBuffer* buf = nullptr;
-    if (!getBuffer(cacheId, &buf)) {
+    if (!getBuffer(shard, cacheId, &buf)) {
         ALOGE("failed to unregister erased recipient");
         return;
     }
@@ -193,14 +202,15 @@ void ClientCache::removeProcess(const wp<IBinder>& processToken) {
             ALOGE("failed to remove process, invalid (nullptr) process token");
             return;
         }
-        std::lock_guard lock(mMutex);
-        auto itr = mBuffers.find(processToken);
-        if (itr == mBuffers.end()) {
+        Shard& shard = getShard(processToken);
+        std::lock_guard lock(shard.mutex);
+        auto itr = shard.processes.find(processToken);
+        if (itr == shard.processes.end()) {
             ALOGE("failed to remove process, could not find process");
             return;
         }
 
-        for (auto& [id, clientCacheBuffer] : itr->second.second) {
+        for (auto& [id, clientCacheBuffer] : itr->second.buffers) {
             client_cache_t cacheId = {processToken, id};
             for (auto& recipient : clientCacheBuffer.recipients) {
                 sp<ErasedRecipient> erasedRecipient = recipient.promote();
@@ -209,7 +219,7 @@ void ClientCache::removeProcess(const wp<IBinder>& processToken) {
                 }
             }
         }
-        mBuffers.erase(itr);
+        shard.processes.erase(itr);
     }
 
     for (auto& [recipient, cacheId] : pendingErase) {
@@ -222,14 +232,16 @@ void ClientCache::CacheDeathRecipient::binderDied(const wp<IBinder>& who) {
 }
 
 void ClientCache::dump(std::string& result) {
-    std::lock_guard lock(mMutex);
-    for (const auto& [_, cache] : mBuffers) {
-        base::StringAppendF(&result, " Cache owner: %p\n", cache.first.get());
-
-        for (const auto& [id, entry] : cache.second) {
-            const auto& buffer = entry.buffer->getBuffer();
-            base::StringAppendF(&result, "\tID: %" PRIu64 ", size: %ux%u\n", id, buffer->getWidth(),
-                                buffer->getHeight());
+    for (Shard& shard : mShards) {
+        std::lock_guard lock(shard.mutex);
+        for (const auto& [_, cache] : shard.processes) {
+            base::StringAppendF(&result, " Cache owner: %p\n", cache.token.get());
+
+            for (const auto& [id, entry] : cache.buffers) {
+                const auto& buffer = entry.buffer->getBuffer();
+                base::StringAppendF(&result, "\tID: %" PRIu64 ", size: %ux%u\n", id,
+                                    buffer->getWidth(), buffer->getHeight());
+            }
         }
     }
 }
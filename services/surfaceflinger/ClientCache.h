@@ -24,11 +24,13 @@
 #include <utils/RefBase.h>
 #include <utils/Singleton.h>
 
-#include <map>
+#include <array>
 #include <mutex>
 #include <set>
 #include <unordered_map>
 
+#include "WpHash.h"
+
 // 4096 is based on 64 buffers * 64 layers. Once this limit is reached, the least recently used
 // buffer is uncached before the new buffer is cached.
 #define BUFFER_CACHE_MAX_SIZE 4096
@@ -78,16 +80,27 @@ public:
     void dump(std::string& result);
 
 private:
-    std::mutex mMutex;
-
     struct ClientCacheBuffer {
         std::shared_ptr<renderengine::ExternalTexture> buffer;
         std::set<wp<ErasedRecipient>> recipients;
     };
-    std::map<wp<IBinder> /*caching process*/,
-             std::pair<sp<IBinder> /*strong ref to caching process*/,
-                       std::unordered_map<uint64_t /*cache id*/, ClientCacheBuffer>>>
-            mBuffers GUARDED_BY(mMutex);
+
+    struct ProcessBuffers {
+        sp<IBinder> token; // strong ref to caching process
+        std::unordered_map<uint64_t /*cache id*/, ClientCacheBuffer> buffers;
+    };
+
+    // The caching processes are spread over shards by their token, each with its own lock, so
+    // that binder threads of different processes do not contend for the cache.
+    static constexpr size_t kShardBits = 4;
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<wp<IBinder> /*caching process*/, ProcessBuffers, WpHash> processes
+                GUARDED_BY(mutex);
+    };
+    std::array<Shard, 1 << kShardBits> mShards;
+
+    Shard& getShard(const wp<IBinder>& processToken);
 
     class CacheDeathRecipient : public IBinder::DeathRecipient {
     public:
@@ -97,8 +110,8 @@ private:
     sp<CacheDeathRecipient> mDeathRecipient;
     renderengine::RenderEngine* mRenderEngine = nullptr;
 
-    bool getBuffer(const client_cache_t& cacheId, ClientCacheBuffer** outClientCacheBuffer)
-            REQUIRES(mMutex);
+    bool getBuffer(Shard& shard, const client_cache_t& cacheId,
+                   ClientCacheBuffer** outClientCacheBuffer) REQUIRES(shard.mutex);
 };
 
 }; // namespace android
@@ -97,6 +97,10 @@ struct CompositionRefreshArgs {
 
     bool hasTrustedPresentationListener = false;
 
+    // If true, the per-output composition state of the outputs which support it
+    // is prepared concurrently before any output is presented.
+    bool parallelComposition = false;
+
     ICEPowerCallback* powerCallback = nullptr;
 
     // System time for when frame refresh starts. Used for stats.
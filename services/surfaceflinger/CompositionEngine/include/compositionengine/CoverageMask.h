@@ -0,0 +1,84 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include <ui/Rect.h>
+
+namespace android::compositionengine {
+
+// A coarse grid of tiles over a rectangle of layer stack space, tracking which
+// tiles are fully and which are partially covered by opaque rectangles.
+//
+// It is a conservative summary of the exact opaque coverage: a rectangle is
+// only reported as occluded if every tile it touches is fully covered, and only
+// reported as unoccluded if none of those tiles is touched at all. Anything in
+// between needs exact Region math.
+//
+// A default constructed mask has no bounds, and answers every query with the
+// conservative result.
+class CoverageMask {
+public:
+    // The grid is at most kGridSize x kGridSize tiles.
+    static constexpr int32_t kGridSize = 64;
+
+    // Clears the mask, and sets the area covered by the grid.
+    void reset(const Rect& bounds);
+
+    // Marks the tiles covered by an opaque rectangle.
+    void addOpaqueRect(const Rect&);
+
+    // Returns true if the rectangle is known to be completely covered by the
+    // opaque rectangles added so far.
+    bool isOccluded(const Rect&) const;
+
+    // Returns false if the rectangle is known not to intersect any of the
+    // opaque rectangles added so far.
+    bool mayBeOccluded(const Rect&) const;
+
+private:
+    struct TileRange {
+        int32_t left;
+        int32_t top;
+        int32_t right;
+        int32_t bottom;
+    };
+
+    // Returns the range of tiles a non-empty rectangle within mBounds touches.
+    TileRange touchedTiles(const Rect&) const;
+
+    bool contains(const Rect&) const;
+
+    Rect mBounds = Rect::EMPTY_RECT;
+    int32_t mTileWidth = 1;
+    int32_t mTileHeight = 1;
+    int32_t mColumns = 0;
+    int32_t mRows = 0;
+
+    // Bit c of row r is set if tile (c, r) is fully / partially covered.
+    std::array<uint64_t, kGridSize> mCovered{};
+    std::array<uint64_t, kGridSize> mTouched{};
+
+    // Bit r is set if every tile of row r is fully covered, or if any tile of
+    // row r is touched. These let most queries skip the per-row checks.
+    uint64_t mCoveredRows = 0;
+    uint64_t mTouchedRows = 0;
+};
+
+} // namespace android::compositionengine
@@ -27,6 +27,7 @@
 #include <utility>
 #include <vector>
 
+#include <compositionengine/CoverageMask.h>
 #include <compositionengine/LayerFE.h>
 #include <renderengine/LayerSettings.h>
 #include <ui/DisplayIdentification.h>
@@ -159,6 +160,10 @@ public:
         // only has a value if there's something needing it, like when a TrustedPresentationListener
         // is set
         std::optional<Region> aboveCoveredLayersExcludingOverlays;
+        // A coarse summary of aboveOpaqueLayers, used to skip the exact Region
+        // math for layers which are fully occluded or not occluded at all. It
+        // only has bounds if it has tracked aboveOpaqueLayers from the start.
+        CoverageMask aboveOpaqueLayersMask;
     };
 
     virtual ~Output();
@@ -277,6 +282,16 @@ public:
     // Make the next call to `present` run asynchronously.
     virtual void offloadPresentNextFrame() = 0;
 
+    // Whether the stages run by `prepareCompositionState` can run on another
+    // thread, concurrently with those of other outputs.
+    virtual bool supportsParallelComposition() const = 0;
+
+    // Runs the stages of `present` which only update the composition state of
+    // this output and its layers: picking the color profile, updating the
+    // OutputLayer composition state and planning layer caching. The next call
+    // to `present` skips these stages.
+    virtual void prepareCompositionState(const CompositionRefreshArgs&) = 0;
+
     // Enables predicting composition strategy to run client composition earlier
     virtual void setPredictCompositionStrategy(bool) = 0;
 
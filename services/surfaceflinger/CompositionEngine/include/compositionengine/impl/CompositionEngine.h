@@ -17,6 +17,7 @@
 #pragma once
 
 #include <compositionengine/CompositionEngine.h>
+#include <compositionengine/impl/CompositionWorkerPool.h>
 
 namespace android::compositionengine::impl {
 
@@ -59,11 +60,14 @@ public:
     void setNeedsAnotherUpdateForTest(bool);
 
 private:
+    void prepareCompositionStateInParallel(const CompositionRefreshArgs&);
+
     HWComposer* mHwComposer;
     renderengine::RenderEngine* mRenderEngine;
     std::shared_ptr<TimeStats> mTimeStats;
     bool mNeedsAnotherUpdate = false;
     nsecs_t mRefreshStartTime = 0;
+    std::unique_ptr<CompositionWorkerPool> mWorkerPool;
 };
 
 std::unique_ptr<compositionengine::CompositionEngine> createCompositionEngine();
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <android-base/thread_annotations.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace android::compositionengine::impl {
+
+// A small pool of real time threads used to run the per-output composition
+// stages of several outputs concurrently. The calling thread takes part in the
+// work, so a pool of N threads runs up to N + 1 tasks at once.
+//
+// Each task is expected to be coarse (an entire output), so tasks are handed
+// out one at a time under a lock.
+class CompositionWorkerPool final {
+public:
+    explicit CompositionWorkerPool(size_t threadCount);
+    ~CompositionWorkerPool();
+
+    // Runs task(i) for every i in [0, taskCount), and returns once all of them
+    // have completed. Must not be called concurrently.
+    void run(size_t taskCount, const std::function<void(size_t)>& task);
+
+    size_t getThreadCount() const { return mThreads.size(); }
+
+private:
+    void loop();
+
+    std::mutex mMutex;
+    std::condition_variable mWorkCv GUARDED_BY(mMutex);
+    std::condition_variable mDoneCv GUARDED_BY(mMutex);
+    bool mDone GUARDED_BY(mMutex) = false;
+    const std::function<void(size_t)>* mTask GUARDED_BY(mMutex) = nullptr;
+    size_t mTaskCount GUARDED_BY(mMutex) = 0;
+    size_t mNextTask GUARDED_BY(mMutex) = 0;
+    size_t mPendingTasks GUARDED_BY(mMutex) = 0;
+    std::vector<std::thread> mThreads;
+};
+
+} // namespace android::compositionengine::impl
@@ -65,6 +65,7 @@ public:
     void setExpensiveRenderingExpected(bool) override;
     void finishFrame(GpuCompositionResult&&) override;
     bool supportsOffloadPresent() const override;
+    bool supportsParallelComposition() const override;
 
     // compositionengine::Display overrides
     DisplayId getId() const override;
@@ -85,6 +85,8 @@ public:
     ftl::Future<std::monostate> present(const CompositionRefreshArgs&) override;
     bool supportsOffloadPresent() const override { return false; }
     void offloadPresentNextFrame() override;
+    bool supportsParallelComposition() const override { return true; }
+    void prepareCompositionState(const CompositionRefreshArgs&) override;
 
     void rebuildLayerStacks(const CompositionRefreshArgs&, LayerFESet&) override;
     void collectVisibleLayers(const CompositionRefreshArgs&,
@@ -193,11 +195,16 @@ private:
     OutputLayer* mLayerRequestingBackgroundBlur = nullptr;
     std::unique_ptr<ClientCompositionRequestCache> mClientCompositionRequestCache;
     std::unique_ptr<planner::Planner> mPlanner;
+    // The present fence of the last frame, which is reported to the planner with the next one.
+    sp<Fence> mPreviousPresentFence;
     std::unique_ptr<HwcAsyncWorker> mHwComposerAsyncWorker;
 
     bool mPredictCompositionStrategy = false;
     bool mOffloadPresent = false;
 
+    // Whether prepareCompositionState has already run for the next frame.
+    bool mCompositionStatePrepared = false;
+
     // Whether the content must be recomposed this frame.
     bool mMustRecompose = false;
 };
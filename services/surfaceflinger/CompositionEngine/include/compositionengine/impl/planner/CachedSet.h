@@ -20,9 +20,11 @@
 #include <compositionengine/ProjectionSpace.h>
 #include <compositionengine/impl/planner/LayerState.h>
 #include <compositionengine/impl/planner/TexturePool.h>
+#include <renderengine/DisplaySettings.h>
 #include <renderengine/RenderEngine.h>
 
 #include <chrono>
+#include <optional>
 
 namespace android {
 
@@ -65,9 +67,9 @@ public:
     size_t getLayerCount() const { return mLayers.size(); }
     const Layer& getFirstLayer() const { return mLayers[0]; }
     const Rect& getBounds() const { return mBounds; }
-    Rect getTextureBounds() const {
-        return mTexture ? mTexture->get()->getBuffer()->getBounds() : Rect::INVALID_RECT;
-    }
+    // The part of the framebuffer the texture covers, which is all of it unless the texture pool
+    // hands out textures smaller than the display.
+    Rect getTextureBounds() const { return mTexture ? mTextureWindow : Rect::INVALID_RECT; }
     const Region& getVisibleRegion() const { return mVisibleRegion; }
     size_t getAge() const { return mAge; }
     std::shared_ptr<renderengine::ExternalTexture> getBuffer() const {
@@ -96,6 +98,11 @@ public:
     void setLastUpdate(std::chrono::steady_clock::time_point now) { mLastUpdate = now; }
     void append(const CachedSet& other) {
         mTexture.reset();
+        mDisplaySettings.reset();
+        mRenderedSourceCrops.clear();
+        mPartialRenderSource.reset();
+        mPartialRenderSourceReleaseFence = nullptr;
+        mDamage.clear();
         mOutputDataspace = ui::Dataspace::UNKNOWN;
         mDrawFence = nullptr;
         mBlurLayer = nullptr;
@@ -114,9 +121,28 @@ public:
     size_t getSkipCount() { return mSkipCount; }
 
     // Renders the cached set with the supplied output composition state.
+    // If the set was prepared with prepareForPartialRender() and the output state still matches
+    // the last render, only the damaged area of the previous buffer is redrawn, in place. That
+    // render is deferred until the release fence of the previous buffer signals.
     void render(renderengine::RenderEngine& re, TexturePool& texturePool,
                 const OutputCompositionState& outputState, bool deviceHandlesColorTransform);
 
+    // True if this set has a rendered buffer that can be brought up to date by only redrawing the
+    // display frames of the layers that changed since.
+    bool canRenderPartially() const;
+
+    // Takes the rendered buffer off screen, so that the display frames of the layers that changed
+    // since can be redrawn into it.
+    // Must only be called if canRenderPartially() is true.
+    void prepareForPartialRender();
+
+    // Reports the present fence of a frame which was composed after prepareForPartialRender(),
+    // and so no longer showed the previous buffer. The buffer is released once it signals.
+    void setPartialRenderSourceReleaseFence(const sp<Fence>& presentFence);
+
+    // The area, in display space, that will be redrawn by a partial render.
+    const Region& getDamage() const { return mDamage; }
+
     void dump(std::string& result) const;
 
     // Whether this represents a single layer with a buffer and rounded corners.
@@ -151,6 +177,9 @@ public:
     bool cachingHintExcludesLayers() const;
 
 private:
+    // The union of the display frames of the layers which changed since the last render.
+    Region computeDamage() const;
+
     const NonBufferHash mFingerprint;
     std::chrono::steady_clock::time_point mLastUpdate = std::chrono::steady_clock::now();
     std::vector<Layer> mLayers;
@@ -167,6 +196,16 @@ private:
     // containers in the Flattener. Logically this should have unique ownership otherwise.
     std::shared_ptr<TexturePool::AutoTexture> mTexture;
     sp<Fence> mDrawFence;
+    Rect mTextureWindow = Rect::INVALID_RECT;
+    // The settings mTexture was last rendered with, which a partial render must match, and the
+    // source crop of each layer at that time.
+    std::optional<renderengine::DisplaySettings> mDisplaySettings;
+    std::vector<FloatRect> mRenderedSourceCrops;
+    // The previous buffer to redraw the damaged area of, the fence which signals once it is no
+    // longer scanned out, or null until it is known, and the area which must be redrawn.
+    std::shared_ptr<TexturePool::AutoTexture> mPartialRenderSource;
+    sp<Fence> mPartialRenderSourceReleaseFence;
+    Region mDamage;
     ProjectionSpace mOutputSpace;
     ui::Dataspace mOutputDataspace;
     ui::Transform::RotationFlags mOrientation = ui::Transform::ROT_0;
@@ -74,6 +74,10 @@ public:
 
         static const constexpr bool kDefaultEnableHolePunch = true;
 
+        static const constexpr bool kDefaultEnablePartialRender = false;
+        static const constexpr bool kDefaultEnableSizedTextures = false;
+        static const constexpr size_t kDefaultTexturePoolMemoryBudget = 0;
+
         // Threshold for determing whether a layer is active. A layer whose properties, including
         // the buffer, have not changed in at least this time is considered inactive and is
         // therefore a candidate for flattening.
@@ -85,6 +89,18 @@ public:
 
         // True if the hole punching feature should be enabled.
         const bool mEnableHolePunch;
+
+        // True if a flattened cached set whose layers mostly did not change should be re-rendered
+        // right away by only redrawing the changed layers' display frames, instead of waiting
+        // for its layers to become inactive again.
+        const bool mEnablePartialRender = kDefaultEnablePartialRender;
+
+        // True if cached sets should be rendered into textures sized to the set, instead of the
+        // whole display.
+        const bool mEnableSizedTextures = kDefaultEnableSizedTextures;
+
+        // The bytes the textures of cached sets may take up, or 0 for no limit.
+        const size_t mTexturePoolMemoryBudget = kDefaultTexturePoolMemoryBudget;
     };
 
     // Constants not yet backed by a sysprop
@@ -104,6 +120,9 @@ public:
     NonBufferHash flattenLayers(const std::vector<const LayerState*>& layers, NonBufferHash,
                                 std::chrono::steady_clock::time_point now);
 
+    // Reports the present fence of the last frame, which releases the buffers it stopped showing.
+    void reportPresentFence(const sp<Fence>& presentFence);
+
     // Renders the newest cached sets with the supplied output composition state
     void renderCachedSets(const OutputCompositionState& outputState,
                           std::optional<std::chrono::steady_clock::time_point> renderDeadline,
@@ -253,6 +272,7 @@ private:
     std::unordered_map<size_t, size_t> mFinalLayerCounts;
     size_t mCachedSetCreationCount = 0;
     size_t mCachedSetCreationCost = 0;
+    size_t mCachedSetPartialRenderCount = 0;
 };
 
 } // namespace compositionengine::impl::planner
@@ -61,6 +61,12 @@ public:
     void reportFinalPlan(
             compositionengine::Output::OutputLayersEnumerator<compositionengine::Output>&& layers);
 
+    // Reports the present fence of the last frame, which releases the override buffers that frame
+    // no longer showed. Must be called before planning the next frame.
+    void reportPresentFence(const sp<Fence>& presentFence) {
+        mFlattener.reportPresentFence(presentFence);
+    }
+
     // The planner will call to the Flattener to render any pending cached set.
     // Rendering a pending cached set is optional: if the renderDeadline is not far enough in the
     // future then the planner may opt to skip rendering the cached set.
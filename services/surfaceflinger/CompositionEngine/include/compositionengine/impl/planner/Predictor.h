@@ -17,6 +17,9 @@
 #pragma once
 
 #include <ftl/flags.h>
+#include <ftl/small_vector.h>
+#include <inttypes.h>
+#include <log/log.h>
 
 #include <compositionengine/impl/planner/LayerState.h>
 
@@ -51,6 +54,13 @@ public:
     std::optional<ApproximateMatch> getApproximateMatch(
             const std::vector<const LayerState*>& other) const;
 
+    // Returns one key per layer, where the key at index i identifies the stack with layer i left
+    // out. getApproximateMatch can only return a match with a differingIndex of i if both stacks
+    // have the same key at index i, so these can be used to index layer stacks by their potential
+    // approximate matches.
+    std::vector<size_t> getApproximateMatchKeys() const;
+    static std::vector<size_t> getApproximateMatchKeys(const std::vector<const LayerState*>&);
+
     void compare(const LayerStack& other, std::string& result) const {
         if (mLayers.size() != other.mLayers.size()) {
             base::StringAppendF(&result, "Cannot compare stacks of different sizes (%zd vs. %zd)\n",
@@ -106,19 +116,50 @@ private:
     constexpr static int kMaxDifferingFields = 6;
 };
 
+// The composition type of each layer in a layer stack, packed into 4 bits per layer.
 class Plan {
 public:
     static std::optional<Plan> fromString(const std::string&);
 
-    void reset() { mLayerTypes.clear(); }
+    void reset() {
+        mLayerCount = 0;
+        mPackedLayerTypes.clear();
+    }
+
     void addLayerType(aidl::android::hardware::graphics::composer3::Composition type) {
-        mLayerTypes.emplace_back(type);
+        const auto value = static_cast<uint64_t>(type);
+        LOG_ALWAYS_FATAL_IF(value > kLayerTypeMask, "Composition type %" PRIu64 " cannot be packed",
+                            value);
+
+        const size_t shift = (mLayerCount % kLayersPerWord) * kBitsPerLayer;
+        if (shift == 0) {
+            mPackedLayerTypes.push_back(0);
+        }
+        mPackedLayerTypes.back() |= value << shift;
+        ++mLayerCount;
+    }
+
+    size_t getLayerCount() const { return mLayerCount; }
+
+    aidl::android::hardware::graphics::composer3::Composition getLayerType(size_t index) const {
+        const size_t shift = (index % kLayersPerWord) * kBitsPerLayer;
+        return static_cast<aidl::android::hardware::graphics::composer3::Composition>(
+                (mPackedLayerTypes[index / kLayersPerWord] >> shift) & kLayerTypeMask);
+    }
+
+    size_t hash() const {
+        size_t hash = mLayerCount;
+        for (const uint64_t word : mPackedLayerTypes) {
+            android::hashCombineSingleHashed(hash, static_cast<size_t>(word));
+        }
+        return hash;
     }
 
     friend std::string to_string(const Plan& plan);
 
     friend bool operator==(const Plan& lhs, const Plan& rhs) {
-        return lhs.mLayerTypes == rhs.mLayerTypes;
+        return lhs.mLayerCount == rhs.mLayerCount &&
+                lhs.mPackedLayerTypes == rhs.mPackedLayerTypes;
     }
     friend bool operator!=(const Plan& lhs, const Plan& rhs) { return !(lhs == rhs); }
 
@@ -127,7 +168,13 @@ public:
     }
 
 private:
-    std::vector<aidl::android::hardware::graphics::composer3::Composition> mLayerTypes;
+    static constexpr size_t kBitsPerLayer = 4;
+    static constexpr size_t kLayersPerWord = 64 / kBitsPerLayer;
+    static constexpr uint64_t kLayerTypeMask = (uint64_t{1} << kBitsPerLayer) - 1;
+
+    size_t mLayerCount = 0;
+    // Most layer stacks fit in a couple of words, so avoid allocating for them.
+    ftl::SmallVector<uint64_t, 2> mPackedLayerTypes;
 };
 
 } // namespace android::compositionengine::impl::planner
@@ -136,7 +183,7 @@ namespace std {
 template <>
 struct hash<android::compositionengine::impl::planner::Plan> {
     size_t operator()(const android::compositionengine::impl::planner::Plan& plan) const {
-        return std::hash<std::string>{}(to_string(plan));
+        return plan.hash();
     }
 };
 } // namespace std
@@ -265,6 +312,7 @@ private:
             const std::vector<const LayerState*>& layers) const;
 
     void promoteIfCandidate(NonBufferHash);
+    void addApproximateStack(NonBufferHash, LayerStack::ApproximateMatch);
     void recordPredictedResult(PredictedPlan, const std::vector<const LayerState*>& layers,
                                Plan result);
     bool findSimilarPrediction(const std::vector<const LayerState*>& layers, Plan result);
@@ -306,6 +354,10 @@ private:
 
     std::vector<ApproximateStack> mApproximateStacks;
 
+    // Indices into mApproximateStacks, keyed by the approximate match key of each stack at its
+    // differing index. See LayerStack::getApproximateMatchKeys.
+    std::unordered_map<size_t, std::vector<size_t>> mApproximateStackIndex;
+
     mutable size_t mExactHitCount = 0;
     mutable size_t mApproximateHitCount = 0;
     mutable size_t mMissCount = 0;
@@ -27,12 +27,16 @@
 
 namespace android::compositionengine::impl::planner {
 
-// A pool of textures that only manages textures of a single size.
-// While it is possible to define a texture pool supporting variable-sized textures to save on
-// memory, it is a simpler implementation to only manage screen-sized textures. The texture pool is
-// unbounded - there are a minimum number of textures preallocated. Under heavy system load, new
-// textures may be allocated, but only a maximum number of retained once those textures are no
-// longer necessary.
+// A pool of textures for rendering cached sets into.
+// Textures are sized in buckets of a fraction of the display size, so that a cached set covering a
+// small part of the display does not need a screen-sized texture. A borrowed texture is the
+// smallest pooled texture that fits the requested size, or a newly generated one if none does.
+// By default every texture is screen-sized, which is what borrowTexture() without a size asks for.
+//
+// There are a minimum number of textures preallocated. Under heavy system load, new textures may be
+// allocated, but only a bounded number are retained once those textures are no longer necessary.
+// That bound follows the demand the owner reports through setDemand, and the pool additionally
+// evicts its least recently used textures to stay within an optional memory budget.
 class TexturePool {
 public:
     // RAII class helping with managing textures from the texture pool
@@ -41,10 +45,14 @@ public:
     class AutoTexture {
     public:
         AutoTexture(TexturePool& texturePool,
-                    std::shared_ptr<renderengine::ExternalTexture> texture, const sp<Fence>& fence)
-              : mTexturePool(texturePool), mTexture(texture), mFence(fence) {}
+                    std::shared_ptr<renderengine::ExternalTexture> texture, const sp<Fence>& fence,
+                    uint32_t generation)
+              : mTexturePool(texturePool),
+                mTexture(texture),
+                mFence(fence),
+                mGeneration(generation) {}
 
-        ~AutoTexture() { mTexturePool.returnTexture(std::move(mTexture), mFence); }
+        ~AutoTexture() { mTexturePool.returnTexture(std::move(mTexture), mFence, mGeneration); }
 
         sp<Fence> getReadyFence() { return mFence; }
 
@@ -61,6 +69,9 @@ public:
         TexturePool& mTexturePool;
         std::shared_ptr<renderengine::ExternalTexture> mTexture;
         sp<Fence> mFence;
+        // The pool generation the texture was borrowed in, so that textures of a previous display
+        // size or enablement are not returned to the pool.
+        const uint32_t mGeneration;
     };
 
     TexturePool(renderengine::RenderEngine& renderEngine)
@@ -73,11 +84,34 @@ public:
     // setDisplaySize must be called for the texture pool to be used.
     void setDisplaySize(ui::Size size);
 
+    ui::Size getDisplaySize() const { return mSize; }
+
+    // Enables textures smaller than the display, and retaining as many textures as the reported
+    // demand. When disabled, every texture is display-sized, regardless of the size it is borrowed
+    // with, and at most kMaxPoolSize textures are retained.
+    void setSizedTexturesEnabled(bool enabled);
+
+    // Returns the size of the texture that would be generated for a borrow of the given size.
+    ui::Size getBucketSize(ui::Size size) const;
+
     // Borrows a new texture from the pool.
     // If the pool is currently starved of textures, then a new texture is generated.
     // When the AutoTexture object is destroyed, the scratch texture is automatically returned
     // to the pool.
-    std::shared_ptr<AutoTexture> borrowTexture();
+    std::shared_ptr<AutoTexture> borrowTexture() { return borrowTexture(mSize); }
+
+    // Borrows a texture that is at least the given size, which is clamped to the display size.
+    std::shared_ptr<AutoTexture> borrowTexture(ui::Size size);
+
+    // Limits the bytes of all textures generated by the pool, including those that are borrowed,
+    // by evicting the least recently used pooled textures. 0 means no limit.
+    void setMemoryBudget(size_t bytes);
+
+    // Reports how many textures the pool's owner currently holds. The pool retains about as many
+    // textures as were held at the peak of the recent frames, so that the owner can replace each
+    // of them without generating new ones. Only used when sized textures are enabled. Expected to
+    // be called once per frame.
+    void setDemand(size_t texturesInUse);
 
     // Enables or disables the pool. When the pool is disabled, no buffers will
     // be held by the pool. This is useful when the active display changes.
@@ -89,23 +123,55 @@ protected:
     // Proteted visibility so that they can be used for testing
     const static constexpr size_t kMinPoolSize = 3;
     const static constexpr size_t kMaxPoolSize = 4;
+    // Upper bound of the number of pooled textures, however high the demand is.
+    const static constexpr size_t kMaxDemandPoolSize = 2 * kMaxPoolSize;
+    // Number of setDemand calls over which the peak demand is taken.
+    const static constexpr size_t kDemandWindow = 300;
+    // Textures are sized in multiples of 1/kBucketsPerDimension of the display size.
+    const static constexpr int32_t kBucketsPerDimension = 8;
+    // A pooled texture is not handed out for a request smaller than this fraction of its area.
+    const static constexpr size_t kMaxBestFitAreaRatio = 2;
 
     struct Entry {
         std::shared_ptr<renderengine::ExternalTexture> texture;
         sp<Fence> fence;
     };
 
+    // Ordered from least to most recently returned.
     std::deque<Entry> mPool;
 
+    // The number of textures the pool retains, following the demand.
+    size_t mMaxPoolSize = kMaxPoolSize;
+
 private:
-    std::shared_ptr<renderengine::ExternalTexture> genTexture();
+    std::shared_ptr<renderengine::ExternalTexture> genTexture(ui::Size size);
     // Returns a previously borrowed texture to the pool.
     void returnTexture(std::shared_ptr<renderengine::ExternalTexture>&& texture,
-                       const sp<Fence>& fence);
+                       const sp<Fence>& fence, uint32_t generation);
     void allocatePool();
+    // Evicts the least recently used pooled textures until the pool is within its bounds.
+    void trimPool();
+    static size_t getTextureBytes(const renderengine::ExternalTexture&);
+
     renderengine::RenderEngine& mRenderEngine;
     ui::Size mSize;
     bool mEnabled;
+    bool mSizedTexturesEnabled = false;
+    uint32_t mGeneration = 0;
+
+    size_t mMemoryBudget = 0;
+    // Bytes of the pooled and borrowed textures of the current generation.
+    size_t mPooledBytes = 0;
+    size_t mBorrowedBytes = 0;
+    size_t mBorrowedCount = 0;
+
+    size_t mDemandPeak = 0;
+    size_t mDemandFrames = 0;
+
+    // Statistics for dumpsys.
+    size_t mBorrowCount = 0;
+    size_t mHitCount = 0;
+    size_t mEvictionCount = 0;
 };
 
 } // namespace android::compositionengine::impl::planner
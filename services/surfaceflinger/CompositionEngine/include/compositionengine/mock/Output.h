@@ -85,6 +85,8 @@ public:
                  ftl::Future<std::monostate>(const compositionengine::CompositionRefreshArgs&));
     MOCK_CONST_METHOD0(supportsOffloadPresent, bool());
     MOCK_METHOD(void, offloadPresentNextFrame, ());
+    MOCK_METHOD(bool, supportsParallelComposition, (), (const));
+    MOCK_METHOD(void, prepareCompositionState, (const CompositionRefreshArgs&));
 
     MOCK_METHOD1(uncacheBuffers, void(const std::vector<uint64_t>&));
     MOCK_METHOD2(rebuildLayerStacks,
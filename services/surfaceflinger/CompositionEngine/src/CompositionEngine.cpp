@@ -90,6 +90,10 @@ nsecs_t CompositionEngine::getLastFrameRefreshTimestamp() const {
 }
 
 namespace {
+// Along with the calling thread, enough to prepare the internal display, two
+// external displays and a virtual display at once.
+constexpr size_t kCompositionWorkerCount = 3;
+
 void offloadOutputs(Outputs& outputs) {
     if (outputs.size() < 2) {
         return;
@@ -144,6 +148,10 @@ void CompositionEngine::present(CompositionRefreshArgs& args) {
         }
     }
 
+    if (args.parallelComposition) {
+        prepareCompositionStateInParallel(args);
+    }
+
     // Offloading the HWC call for `present` allows us to simultaneously call it
     // on multiple displays. This is desirable because these calls block and can
     // be slow.
@@ -165,6 +173,31 @@ void CompositionEngine::present(CompositionRefreshArgs& args) {
     postComposition(args);
 }
 
+void CompositionEngine::prepareCompositionStateInParallel(const CompositionRefreshArgs& args) {
+    ui::DisplayVector<compositionengine::Output*> outputs;
+    for (const auto& output : args.outputs) {
+        // Disabled outputs have little to do, so leave them to `present`.
+        if (output->getState().isEnabled && output->supportsParallelComposition()) {
+            outputs.push_back(output.get());
+        }
+    }
+
+    if (outputs.size() < 2) {
+        return;
+    }
+
+    SFTRACE_CALL();
+
+    if (!mWorkerPool) {
+        mWorkerPool = std::make_unique<CompositionWorkerPool>(kCompositionWorkerCount);
+    }
+
+    // Each output only writes its own state and that of its OutputLayers, so
+    // the result does not depend on how the outputs are spread across threads.
+    mWorkerPool->run(outputs.size(),
+                     [&](size_t index) { outputs[index]->prepareCompositionState(args); });
+}
+
 void CompositionEngine::updateCursorAsync(CompositionRefreshArgs& args) {
 
     for (const auto& output : args.outputs) {
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <compositionengine/impl/CompositionWorkerPool.h>
+#include <processgroup/sched_policy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <system/thread_defs.h>
+
+#include <android-base/stringprintf.h>
+#include <android-base/thread_annotations.h>
+#include <cutils/sched_policy.h>
+#include <ftl/fake_guard.h>
+
+namespace android::compositionengine::impl {
+
+CompositionWorkerPool::CompositionWorkerPool(size_t threadCount) {
+    mThreads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        mThreads.emplace_back(&CompositionWorkerPool::loop, this);
+        pthread_setname_np(mThreads.back().native_handle(),
+                           base::StringPrintf("CompWorker%zu", i).c_str());
+    }
+}
+
+CompositionWorkerPool::~CompositionWorkerPool() {
+    {
+        std::scoped_lock lock(mMutex);
+        mDone = true;
+        mWorkCv.notify_all();
+    }
+    for (auto& thread : mThreads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void CompositionWorkerPool::run(size_t taskCount, const std::function<void(size_t)>& task) {
+    if (taskCount == 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    android::base::ScopedLockAssertion assumeLock(mMutex);
+    mTask = &task;
+    mTaskCount = taskCount;
+    mNextTask = 0;
+    mPendingTasks = taskCount;
+    mWorkCv.notify_all();
+
+    while (mNextTask < mTaskCount) {
+        const size_t index = mNextTask++;
+        lock.unlock();
+        task(index);
+        lock.lock();
+        mPendingTasks--;
+    }
+
+    mDoneCv.wait(lock, [this]() FTL_FAKE_GUARD(mMutex) { return mPendingTasks == 0; });
+    mTask = nullptr;
+    mTaskCount = 0;
+    mNextTask = 0;
+}
+
+void CompositionWorkerPool::loop() {
+    set_sched_policy(0, SP_FOREGROUND);
+    struct sched_param param = {0};
+    param.sched_priority = 2;
+    sched_setscheduler(gettid(), SCHED_FIFO, &param);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    android::base::ScopedLockAssertion assumeLock(mMutex);
+    while (true) {
+        mWorkCv.wait(lock,
+                     [this]() FTL_FAKE_GUARD(mMutex) { return mDone || mNextTask < mTaskCount; });
+        if (mDone) {
+            break;
+        }
+
+        const size_t index = mNextTask++;
+        const auto& task = *mTask;
+        lock.unlock();
+        task(index);
+        lock.lock();
+        if (--mPendingTasks == 0) {
+            mDoneCv.notify_one();
+        }
+    }
+}
+
+} // namespace android::compositionengine::impl
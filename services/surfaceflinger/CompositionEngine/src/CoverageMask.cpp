@@ -0,0 +1,152 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <compositionengine/CoverageMask.h>
+
+namespace android::compositionengine {
+
+namespace {
+
+int32_t divideRoundingUp(int64_t numerator, int64_t denominator) {
+    return static_cast<int32_t>((numerator + denominator - 1) / denominator);
+}
+
+// Returns a mask with bits [first, last] set.
+uint64_t bitRange(int32_t first, int32_t last) {
+    const int32_t count = last - first + 1;
+    return (count == 64 ? ~uint64_t{0} : (uint64_t{1} << count) - 1) << first;
+}
+
+} // namespace
+
+void CoverageMask::reset(const Rect& bounds) {
+    mCovered.fill(0);
+    mTouched.fill(0);
+    mCoveredRows = 0;
+    mTouchedRows = 0;
+
+    if (bounds.isEmpty()) {
+        mBounds = Rect::EMPTY_RECT;
+        mColumns = 0;
+        mRows = 0;
+        return;
+    }
+
+    const int64_t width = int64_t{bounds.right} - bounds.left;
+    const int64_t height = int64_t{bounds.bottom} - bounds.top;
+    mBounds = bounds;
+    mTileWidth = divideRoundingUp(width, kGridSize);
+    mTileHeight = divideRoundingUp(height, kGridSize);
+    mColumns = divideRoundingUp(width, mTileWidth);
+    mRows = divideRoundingUp(height, mTileHeight);
+}
+
+void CoverageMask::addOpaqueRect(const Rect& rect) {
+    Rect clipped;
+    if (mColumns == 0 || !rect.intersect(mBounds, &clipped)) {
+        return;
+    }
+
+    const TileRange touched = touchedTiles(clipped);
+    const uint64_t touchedColumns = bitRange(touched.left, touched.right);
+    for (int32_t row = touched.top; row <= touched.bottom; row++) {
+        mTouched[row] |= touchedColumns;
+    }
+    mTouchedRows |= bitRange(touched.top, touched.bottom);
+
+    // A tile is fully covered if the rectangle spans it, where the last tile in
+    // each direction may be cut short by the bounds.
+    const int64_t left = int64_t{clipped.left} - mBounds.left;
+    const int64_t top = int64_t{clipped.top} - mBounds.top;
+    const int64_t right = int64_t{clipped.right} - mBounds.left;
+    const int64_t bottom = int64_t{clipped.bottom} - mBounds.top;
+
+    const int32_t firstColumn = divideRoundingUp(left, mTileWidth);
+    const int32_t lastColumn = clipped.right == mBounds.right
+            ? mColumns - 1
+            : static_cast<int32_t>(right / mTileWidth) - 1;
+    const int32_t firstRow = divideRoundingUp(top, mTileHeight);
+    const int32_t lastRow = clipped.bottom == mBounds.bottom
+            ? mRows - 1
+            : static_cast<int32_t>(bottom / mTileHeight) - 1;
+    if (firstColumn > lastColumn || firstRow > lastRow) {
+        return;
+    }
+
+    const uint64_t coveredColumns = bitRange(firstColumn, lastColumn);
+    const uint64_t fullRow = bitRange(0, mColumns - 1);
+    for (int32_t row = firstRow; row <= lastRow; row++) {
+        mCovered[row] |= coveredColumns;
+        if (mCovered[row] == fullRow) {
+            mCoveredRows |= uint64_t{1} << row;
+        }
+    }
+}
+
+bool CoverageMask::isOccluded(const Rect& rect) const {
+    if (!contains(rect)) {
+        return false;
+    }
+
+    const TileRange tiles = touchedTiles(rect);
+    const uint64_t rows = bitRange(tiles.top, tiles.bottom);
+    if ((mCoveredRows & rows) == rows) {
+        return true;
+    }
+
+    const uint64_t columns = bitRange(tiles.left, tiles.right);
+    for (int32_t row = tiles.top; row <= tiles.bottom; row++) {
+        if ((mCovered[row] & columns) != columns) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CoverageMask::mayBeOccluded(const Rect& rect) const {
+    if (!contains(rect)) {
+        return true;
+    }
+
+    const TileRange tiles = touchedTiles(rect);
+    if ((mTouchedRows & bitRange(tiles.top, tiles.bottom)) == 0) {
+        return false;
+    }
+
+    const uint64_t columns = bitRange(tiles.left, tiles.right);
+    for (int32_t row = tiles.top; row <= tiles.bottom; row++) {
+        if (mTouched[row] & columns) {
+            return true;
+        }
+    }
+    return false;
+}
+
+CoverageMask::TileRange CoverageMask::touchedTiles(const Rect& rect) const {
+    return {.left = static_cast<int32_t>((int64_t{rect.left} - mBounds.left) / mTileWidth),
+            .top = static_cast<int32_t>((int64_t{rect.top} - mBounds.top) / mTileHeight),
+            .right = static_cast<int32_t>((int64_t{rect.right} - 1 - mBounds.left) / mTileWidth),
+            .bottom =
+                    static_cast<int32_t>((int64_t{rect.bottom} - 1 - mBounds.top) / mTileHeight)};
+}
+
+bool CoverageMask::contains(const Rect& rect) const {
+    return mColumns > 0 && !rect.isEmpty() && rect.left >= mBounds.left &&
+            rect.top >= mBounds.top && rect.right <= mBounds.right &&
+            rect.bottom <= mBounds.bottom;
+}
+
+} // namespace android::compositionengine
@@ -506,4 +506,20 @@ bool Display::supportsOffloadPresent() const {
     return false;
 }
 
+bool Display::supportsParallelComposition() const {
+    // Picture profile commits are recorded on the LayerFE, which may be shared
+    // with another output on the same layer stack.
+    if (hasPictureProcessing()) {
+        return false;
+    }
+
+    // Picking the color profile may call into the HWC for this display.
+    if (auto halDisplayId = getDisplayIdVariant().and_then(asHalDisplayId<DisplayIdVariant>)) {
+        auto& hwc = getCompositionEngine().getHwComposer();
+        return hwc.hasDisplayCapability(*halDisplayId, DisplayCapability::MULTI_THREADED_PRESENT);
+    }
+
+    return true;
+}
+
 } // namespace android::compositionengine::impl
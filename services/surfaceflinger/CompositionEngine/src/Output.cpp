@@ -41,6 +41,7 @@
 
 #include <optional>
 #include <thread>
+#include <utility>
 
 #include "renderengine/ExternalTexture.h"
 
@@ -467,9 +468,11 @@ ftl::Future<std::monostate> Output::present(
                    stringifyExpectedPresentTime().c_str());
     ALOGV(__FUNCTION__);
 
-    updateColorProfile(refreshArgs);
-    updateCompositionState(refreshArgs);
-    planComposition();
+    if (!std::exchange(mCompositionStatePrepared, false)) {
+        updateColorProfile(refreshArgs);
+        updateCompositionState(refreshArgs);
+        planComposition();
+    }
     writeCompositionState(refreshArgs);
     setColorTransform(refreshArgs);
     beginFrame();
@@ -511,6 +514,16 @@ void Output::offloadPresentNextFrame() {
     updateHwcAsyncWorker();
 }
 
+void Output::prepareCompositionState(const compositionengine::CompositionRefreshArgs& refreshArgs) {
+    SFTRACE_FORMAT("%s for %s", __func__, mNamePlusId.c_str());
+    ALOGV(__FUNCTION__);
+
+    updateColorProfile(refreshArgs);
+    updateCompositionState(refreshArgs);
+    planComposition();
+    mCompositionStatePrepared = true;
+}
+
 void Output::rebuildLayerStacks(const compositionengine::CompositionRefreshArgs& refreshArgs,
                                 LayerFESet& layerFESet) {
     auto& outputState = editState();
@@ -527,6 +540,7 @@ void Output::rebuildLayerStacks(const compositionengine::CompositionRefreshArgs&
     coverage.aboveCoveredLayersExcludingOverlays = refreshArgs.hasTrustedPresentationListener
             ? std::make_optional<Region>()
             : std::nullopt;
+    coverage.aboveOpaqueLayersMask.reset(outputState.layerStackSpace.getContent());
     collectVisibleLayers(refreshArgs, coverage);
 
     // Compute the resulting coverage for this output, and store it for later
@@ -652,6 +666,17 @@ void Output::ensureOutputLayerIfVisible(sp<compositionengine::LayerFE>& layerFE,
         return;
     }
 
+    // Take an early out if the opaque layers above are known to cover this
+    // layer, as it would not be visible once they are subtracted below. The
+    // covered region above already contains the opaque region above, so only
+    // the region excluding overlays needs to be updated.
+    if (coverage.aboveOpaqueLayersMask.isOccluded(visibleRegion.getBounds())) {
+        if (CC_UNLIKELY(computeAboveCoveredExcludingOverlays)) {
+            coverage.aboveCoveredLayersExcludingOverlays->orSelf(visibleRegion);
+        }
+        return;
+    }
+
     // Remove the transparent area from the visible region
     if (!layerFEState->isOpaque) {
         if (tr.preserveRects()) {
@@ -709,7 +734,9 @@ void Output::ensureOutputLayerIfVisible(sp<compositionengine::LayerFE>& layerFE,
     }
 
     // subtract the opaque region covered by the layers above us
-    visibleRegion.subtractSelf(coverage.aboveOpaqueLayers);
+    if (coverage.aboveOpaqueLayersMask.mayBeOccluded(visibleRegion.getBounds())) {
+        visibleRegion.subtractSelf(coverage.aboveOpaqueLayers);
+    }
 
     if (visibleRegion.isEmpty()) {
         return;
@@ -761,6 +788,9 @@ void Output::ensureOutputLayerIfVisible(sp<compositionengine::LayerFE>& layerFE,
 
     // Update accumAboveOpaqueLayers for next (lower) layer
     coverage.aboveOpaqueLayers.orSelf(opaqueRegion);
+    if (!opaqueRegion.isEmpty()) {
+        coverage.aboveOpaqueLayersMask.addOpaqueRect(opaqueRegion.getBounds());
+    }
 
     // Compute the visible non-transparent region
     Region visibleNonTransparentRegion = visibleRegion.subtract(transparentRegion);
@@ -887,6 +917,8 @@ void Output::planComposition() {
     SFTRACE_CALL();
     ALOGV(__FUNCTION__);
 
+    // Any present of the last frame was waited for, even if it was offloaded.
+    mPlanner->reportPresentFence(std::exchange(mPreviousPresentFence, nullptr));
     mPlanner->plan(getOutputLayersOrderedByZ());
 }
 
@@ -1672,6 +1704,9 @@ void Output::presentFrameAndReleaseLayers(bool flushEvenWhenDisabled) {
     auto frame = presentFrame();
 
     mRenderSurface->onPresentDisplayCompleted();
+    if (mPlanner) {
+        mPreviousPresentFence = frame.presentFence;
+    }
 
     for (auto* layer : getOutputLayersOrderedByZ()) {
         // The layer buffer from the previous frame (if any) is released
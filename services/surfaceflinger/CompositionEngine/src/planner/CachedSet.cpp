@@ -35,6 +35,40 @@ namespace android::compositionengine::impl::planner {
 const bool CachedSet::sDebugHighlighLayers =
         base::GetBoolProperty(std::string("debug.sf.layer_caching_highlight"), false);
 
+namespace {
+
+// Returns the bounds of the set in framebuffer space, or the whole framebuffer if the display space
+// is not known.
+Rect getFramebufferBounds(const Rect& bounds, const OutputCompositionState& outputState) {
+    const Rect framebuffer = outputState.framebufferSpace.getBoundsAsRect();
+    if (outputState.displaySpace.getBoundsAsRect().isEmpty()) {
+        return framebuffer;
+    }
+    Rect framebufferBounds;
+    outputState.displaySpace.getTransform(outputState.framebufferSpace)
+            .transform(bounds)
+            .intersect(framebuffer, &framebufferBounds);
+    return framebufferBounds;
+}
+
+// Places a texture over the given framebuffer bounds, as far as the framebuffer allows. A
+// display-sized texture always covers the whole framebuffer.
+Rect getTextureWindow(const Rect& framebufferBounds, ui::Size textureSize, ui::Size displaySize,
+                      ui::Size framebufferSize) {
+    if (textureSize == displaySize) {
+        return Rect(textureSize);
+    }
+    const int32_t left = std::clamp(framebufferBounds.left, 0,
+                                    std::max(framebufferSize.getWidth() - textureSize.getWidth(),
+                                             0));
+    const int32_t top = std::clamp(framebufferBounds.top, 0,
+                                   std::max(framebufferSize.getHeight() - textureSize.getHeight(),
+                                            0));
+    return Rect(left, top, left + textureSize.getWidth(), top + textureSize.getHeight());
+}
+
+} // namespace
+
 std::string durationString(std::chrono::milliseconds duration) {
     using namespace std::chrono_literals;
 
@@ -161,6 +195,16 @@ void CachedSet::render(renderengine::RenderEngine& renderEngine, TexturePool& te
                        const OutputCompositionState& outputState,
                        bool deviceHandlesColorTransform) {
     SFTRACE_CALL();
+    // The previous buffer is scanned out until the frame which decomposed the set is shown, which
+    // may be several frames later if frames are pipelined, so it is only redrawn once that frame
+    // was presented.
+    if (mPartialRenderSource &&
+        (!mPartialRenderSourceReleaseFence ||
+         mPartialRenderSourceReleaseFence->getStatus() != Fence::Status::Signaled)) {
+        SFTRACE_NAME("PartialRenderSourceOnScreen");
+        return;
+    }
+
     if (outputState.powerCallback) {
         outputState.powerCallback->notifyCpuLoadUp();
     }
@@ -262,8 +306,35 @@ void CachedSet::render(renderengine::RenderEngine& renderEngine, TexturePool& te
         layerSettings.emplace_back(highlight);
     }
 
-    auto texture = texturePool.borrowTexture();
-    LOG_ALWAYS_FATAL_IF(texture->get()->getBuffer()->initCheck() != OK);
+    const Rect framebufferBounds = getFramebufferBounds(mBounds, outputState);
+    const auto getWindow = [&](const TexturePool::AutoTexture& texture) {
+        // Project onto the part of the framebuffer the texture covers.
+        return getTextureWindow(framebufferBounds,
+                                texture.get()->getBuffer()->getBounds().getSize(),
+                                texturePool.getDisplaySize(),
+                                outputState.framebufferSpace.getBounds());
+    };
+
+    // The previous buffer can only be redrawn in place if it was rendered the same way.
+    std::shared_ptr<TexturePool::AutoTexture> texture;
+    Rect textureWindow;
+    bool partialRender = false;
+    if (mPartialRenderSource) {
+        textureWindow = getWindow(*mPartialRenderSource);
+        renderengine::DisplaySettings partialDisplaySettings = displaySettings;
+        partialDisplaySettings.physicalDisplay.offsetBy(-textureWindow.left, -textureWindow.top);
+        if (mDisplaySettings == partialDisplaySettings && mTextureWindow == textureWindow) {
+            texture = mPartialRenderSource;
+            partialRender = true;
+        }
+    }
+
+    if (!texture) {
+        texture = texturePool.borrowTexture(framebufferBounds.getSize());
+        LOG_ALWAYS_FATAL_IF(texture->get()->getBuffer()->initCheck() != OK);
+        textureWindow = getWindow(*texture);
+    }
+    displaySettings.physicalDisplay.offsetBy(-textureWindow.left, -textureWindow.top);
 
     base::unique_fd bufferFence;
     if (texture->getReadyFence()) {
@@ -274,23 +345,101 @@ void CachedSet::render(renderengine::RenderEngine& renderEngine, TexturePool& te
         bufferFence.reset(texture->getReadyFence()->dup());
     }
 
+    const renderengine::DisplaySettings fullDisplaySettings = displaySettings;
+    if (partialRender) {
+        SFTRACE_NAME("PartialRender");
+
+        // Only redraw the damaged layers, allowing for filtering at their edges, and keep the
+        // rest of the buffer as is.
+        Rect scissor = outputState.displaySpace.getTransform(outputState.framebufferSpace)
+                               .transform(mDamage.getBounds());
+        scissor.offsetBy(-textureWindow.left, -textureWindow.top);
+        scissor.inset(-1, -1, -1, -1);
+        scissor.intersect(texture->get()->getBuffer()->getBounds(), &displaySettings.scissor);
+    }
+
     auto fenceResult = renderEngine
                                .drawLayers(displaySettings, layerSettings, texture->get(),
                                            std::move(bufferFence))
                                .get();
 
+    mPartialRenderSource.reset();
+    mPartialRenderSourceReleaseFence = nullptr;
+    mDamage.clear();
     if (fenceStatus(fenceResult) == NO_ERROR) {
         mDrawFence = std::move(fenceResult).value_or(Fence::NO_FENCE);
         mOutputSpace = outputState.framebufferSpace;
         mTexture = texture;
         mTexture->setReadyFence(mDrawFence);
+        mTextureWindow = textureWindow;
         mOutputSpace.setOrientation(outputState.framebufferSpace.getOrientation());
         mOutputDataspace = outputDataspace;
         mOrientation = orientation;
+        mDisplaySettings = fullDisplaySettings;
+        mRenderedSourceCrops.clear();
+        for (const Layer& layer : mLayers) {
+            mRenderedSourceCrops.push_back(
+                    layer.getState()->getOutputLayer()->getState().sourceCrop);
+        }
         mSkipCount = 0;
     } else {
         mTexture.reset();
+        mDisplaySettings.reset();
+    }
+}
+
+bool CachedSet::canRenderPartially() const {
+    if (mLayers.size() < 2 || !mTexture || !mDisplaySettings) {
+        return false;
+    }
+
+    // Whatever is behind the set shows through the hole punch and blur, so any damage there would
+    // need to be redrawn too.
+    if (mHolePunchLayer || mBlurLayer || hasBlurBehind()) {
+        return false;
+    }
+
+    const Region damage = computeDamage();
+
+    // Redrawing most of the set in place saves little, and it keeps the set off screen for a frame
+    // longer than rendering it into a new buffer, so only bother if most of the set is left alone.
+    const Rect damageBounds = damage.getBounds();
+    const auto damageArea = static_cast<size_t>(damageBounds.getWidth()) *
+            static_cast<size_t>(damageBounds.getHeight());
+    return !damage.isEmpty() && damageArea * 2 <= getDisplayCost();
+}
+
+void CachedSet::prepareForPartialRender() {
+    LOG_ALWAYS_FATAL_IF(!canRenderPartially(), "[%s] This set cannot be partially rendered",
+                        __func__);
+
+    mDamage = computeDamage();
+    mPartialRenderSource = std::move(mTexture);
+    mPartialRenderSourceReleaseFence = nullptr;
+    mDrawFence = nullptr;
+    mSkipCount = 0;
+}
+
+void CachedSet::setPartialRenderSourceReleaseFence(const sp<Fence>& presentFence) {
+    // The first frame presented without the buffer releases it, and later ones only signal later.
+    if (mPartialRenderSource && !mPartialRenderSourceReleaseFence) {
+        mPartialRenderSourceReleaseFence = presentFence;
+    }
+}
+
+Region CachedSet::computeDamage() const {
+    // Layers whose source crop moved without a buffer update also need to be redrawn.
+    Region damage;
+    for (size_t i = 0; i < mLayers.size(); ++i) {
+        const Layer& layer = mLayers[i];
+        const bool sourceCropMoved = i >= mRenderedSourceCrops.size() ||
+                !(layer.getState()->getOutputLayer()->getState().sourceCrop ==
+                  mRenderedSourceCrops[i]);
+        if (layer.getFramesSinceBufferUpdate() == 0 || sourceCropMoved) {
+            damage.orSelf(layer.getDisplayFrame());
+        }
     }
+    return damage;
 }
 
 bool CachedSet::requiresHolePunch() const {
@@ -72,7 +72,10 @@ bool isSameStack(const std::vector<const LayerState*>& incomingLayers,
 } // namespace
 
 Flattener::Flattener(renderengine::RenderEngine& renderEngine, const Tunables& tunables)
-      : mRenderEngine(renderEngine), mTunables(tunables), mTexturePool(mRenderEngine) {}
+      : mRenderEngine(renderEngine), mTunables(tunables), mTexturePool(mRenderEngine) {
+    mTexturePool.setSizedTexturesEnabled(mTunables.mEnableSizedTextures);
+    mTexturePool.setMemoryBudget(mTunables.mTexturePoolMemoryBudget);
+}
 
 NonBufferHash Flattener::flattenLayers(const std::vector<const LayerState*>& layers,
                                        NonBufferHash hash, time_point now) {
@@ -80,6 +83,16 @@ NonBufferHash Flattener::flattenLayers(const std::vector<const LayerState*>& lay
     const size_t unflattenedDisplayCost = calculateDisplayCost(layers);
     mUnflattenedDisplayCost += unflattenedDisplayCost;
 
+    // Each cached set holding a texture will eventually be replaced by one rendered into a new
+    // texture, so let the pool retain about as many.
+    const size_t texturesInUse =
+            static_cast<size_t>(std::count_if(mLayers.cbegin(), mLayers.cend(),
+                                              [](const CachedSet& cachedSet) {
+                                                  return cachedSet.hasRenderedBuffer();
+                                              })) +
+            (mNewCachedSet && mNewCachedSet->hasRenderedBuffer() ? 1 : 0);
+    mTexturePool.setDemand(texturesInUse);
+
     // We invalidate the layer cache if:
     // 1. We're not tracking any layers, or
     // 2. The last seen hashed geometry changed between frames, or
@@ -108,6 +121,12 @@ NonBufferHash Flattener::flattenLayers(const std::vector<const LayerState*>& lay
     return hash;
 }
 
+void Flattener::reportPresentFence(const sp<Fence>& presentFence) {
+    if (mNewCachedSet) {
+        mNewCachedSet->setPartialRenderSourceReleaseFence(presentFence);
+    }
+}
+
 void Flattener::renderCachedSets(
         const OutputCompositionState& outputState,
         std::optional<std::chrono::steady_clock::time_point> renderDeadline,
@@ -199,6 +218,8 @@ void Flattener::dump(std::string& result) const {
     base::StringAppendF(&result, "\n    Cached sets created: %zd\n", mCachedSetCreationCount);
     base::StringAppendF(&result, "    Cost: %.2f\n",
                         static_cast<float>(mCachedSetCreationCost) / displayArea);
+    base::StringAppendF(&result, "    Cached sets partially re-rendered: %zd\n",
+                        mCachedSetPartialRenderCount);
 
     const auto lastUpdate =
             std::chrono::duration_cast<std::chrono::milliseconds>(now - mLastGeometryUpdate);
@@ -368,6 +389,17 @@ bool Flattener::mergeWithCachedSets(const std::vector<const LayerState*>& layers
             }
             priorBlurLayer = currentLayerIter->getBlurLayer();
         } else if (currentLayerIter->getLayerCount() > 1) {
+            // If only a small part of the set changed, schedule a re-render which reuses the rest
+            // of its buffer. The constituent layers are shown on their own until it is ready.
+            if (mTunables.mEnablePartialRender && !mNewCachedSet &&
+                currentLayerIter->canRenderPartially()) {
+                ALOGV("[%s] Partially re-rendering cached set", __func__);
+                mNewCachedSet.emplace(*currentLayerIter);
+                mNewCachedSet->prepareForPartialRender();
+                mNewCachedSet->setLastUpdate(now);
+                ++mCachedSetPartialRenderCount;
+            }
+
             // Break the current layer into its constituent layers
             for (CachedSet& layer : currentLayerIter->decompose()) {
                 bool disableBlur =
@@ -61,10 +61,24 @@ Flattener::Tunables buildFlattenerTuneables() {
     const auto enableHolePunch =
             base::GetBoolProperty(std::string("debug.sf.enable_hole_punch_pip"),
                                   Flattener::Tunables::kDefaultEnableHolePunch);
+    const auto enablePartialRender =
+            base::GetBoolProperty(std::string("debug.sf.enable_cached_set_partial_render"),
+                                  Flattener::Tunables::kDefaultEnablePartialRender);
+    const auto enableSizedTextures =
+            base::GetBoolProperty(std::string("debug.sf.enable_cached_set_sized_textures"),
+                                  Flattener::Tunables::kDefaultEnableSizedTextures);
+    const auto texturePoolMemoryBudget =
+            base::GetUintProperty<size_t>(std::string("debug.sf.cached_set_texture_budget_kb"),
+                                          Flattener::Tunables::kDefaultTexturePoolMemoryBudget /
+                                                  1024) *
+            1024;
     return Flattener::Tunables{
             .mActiveLayerTimeout = activeLayerTimeout,
             .mRenderScheduling = buildRenderSchedulingTunables(),
             .mEnableHolePunch = enableHolePunch,
+            .mEnablePartialRender = enablePartialRender,
+            .mEnableSizedTextures = enableSizedTextures,
+            .mTexturePoolMemoryBudget = texturePoolMemoryBudget,
     };
 }
 
@@ -86,6 +86,55 @@ std::optional<LayerStack::ApproximateMatch> LayerStack::getApproximateMatch(
     };
 }
 
+namespace {
+
+// Stands in for the hash of client composited layers in approximate match keys, since
+// getApproximateMatch treats any two client composited layers as identical.
+constexpr size_t kClientCompositedToken = 0x434c49454e54;
+
+// Odd multiplier for the polynomial hash of a layer stack's tokens, so that the contribution of
+// any single layer can be subtracted out again.
+constexpr size_t kLayerTokenMultiplier = static_cast<size_t>(0x9e3779b97f4a7c15);
+
+template <typename LayerAccessor>
+std::vector<size_t> computeApproximateMatchKeys(size_t layerCount, LayerAccessor getLayer) {
+    std::vector<size_t> weightedTokens(layerCount);
+    size_t total = 0;
+    size_t weight = 1;
+    for (size_t i = 0; i < layerCount; ++i) {
+        const LayerState& layer = getLayer(i);
+        const size_t token = layer.getCompositionType() ==
+                        aidl::android::hardware::graphics::composer3::Composition::CLIENT
+                ? kClientCompositedToken
+                : layer.getHash();
+        weightedTokens[i] = token * weight;
+        total += weightedTokens[i];
+        weight *= kLayerTokenMultiplier;
+    }
+
+    std::vector<size_t> keys(layerCount);
+    for (size_t i = 0; i < layerCount; ++i) {
+        size_t key = total - weightedTokens[i];
+        hashCombineSingleHashed(key, i);
+        hashCombineSingleHashed(key, layerCount);
+        keys[i] = key;
+    }
+    return keys;
+}
+
+} // namespace
+
+std::vector<size_t> LayerStack::getApproximateMatchKeys() const {
+    return computeApproximateMatchKeys(mLayers.size(),
+                                       [&](size_t i) -> const LayerState& { return mLayers[i]; });
+}
+
+std::vector<size_t> LayerStack::getApproximateMatchKeys(
+        const std::vector<const LayerState*>& layers) {
+    return computeApproximateMatchKeys(layers.size(),
+                                       [&](size_t i) -> const LayerState& { return *layers[i]; });
+}
+
 std::optional<Plan> Plan::fromString(const std::string& string) {
     Plan plan;
     for (char c : string) {
@@ -127,8 +176,9 @@ std::optional<Plan> Plan::fromString(const std::string& string) {
 
 std::string to_string(const Plan& plan) {
     std::string result;
-    for (auto type : plan.mLayerTypes) {
-        switch (type) {
+    result.reserve(plan.getLayerCount());
+    for (size_t i = 0; i < plan.getLayerCount(); ++i) {
+        switch (plan.getLayerType(i)) {
             case aidl::android::hardware::graphics::composer3::Composition::CLIENT:
                 result.append("C");
                 break;
@@ -342,6 +392,29 @@ std::optional<NonBufferHash> Predictor::getApproximateMatch(
         return false;
     };
 
+    // A stored approximate stack can only match if it agrees with the layers everywhere except at
+    // its differing index, so only the stacks indexed under one of the keys of the layers need to
+    // be compared. Of those, pick the earliest one to match, as a linear search would.
+    std::optional<size_t> approximateStackIndex;
+    if (!mApproximateStackIndex.empty()) {
+        for (const size_t key : LayerStack::getApproximateMatchKeys(layers)) {
+            const auto indexEntry = mApproximateStackIndex.find(key);
+            if (indexEntry == mApproximateStackIndex.end()) {
+                continue;
+            }
+
+            for (const size_t index : indexEntry->second) {
+                if (approximateStackIndex && index >= *approximateStackIndex) {
+                    break;
+                }
+                if (approximateStackMatches(mApproximateStacks[index])) {
+                    approximateStackIndex = index;
+                    break;
+                }
+            }
+        }
+    }
+
     const auto candidateMatches = [&](const PromotionCandidate& candidate) {
         ALOGV("[getApproximateMatch] checking against %zx", candidate.hash);
         return candidate.prediction.getExampleLayerStack().getApproximateMatch(layers) !=
@@ -350,12 +423,9 @@ std::optional<NonBufferHash> Predictor::getApproximateMatch(
 
     const Prediction* match = nullptr;
     NonBufferHash hash;
-    if (const auto approximateStackIter =
-                std::find_if(mApproximateStacks.cbegin(), mApproximateStacks.cend(),
-                             approximateStackMatches);
-        approximateStackIter != mApproximateStacks.cend()) {
-        match = &mPredictions.at(approximateStackIter->hash);
-        hash = approximateStackIter->hash;
+    if (approximateStackIndex) {
+        hash = mApproximateStacks[*approximateStackIndex].hash;
+        match = &mPredictions.at(hash);
     } else if (const auto candidateEntry =
                        std::find_if(mCandidates.cbegin(), mCandidates.cend(), candidateMatches);
                candidateEntry != mCandidates.cend()) {
@@ -430,7 +500,7 @@ void Predictor::recordPredictedResult(PredictedPlan predictedPlan,
             const auto approximateMatchOpt =
                     prediction.getExampleLayerStack().getApproximateMatch(layers);
             ALOGE_IF(!approximateMatchOpt, "Expected an approximate match");
-            mApproximateStacks.emplace_back(predictedPlan.hash, *approximateMatchOpt);
+            addApproximateStack(predictedPlan.hash, *approximateMatchOpt);
         }
     }
 
@@ -465,10 +535,20 @@ bool Predictor::findSimilarPrediction(const std::vector<const LayerState*>& laye
 
     ALOGV("[%s] Adding %zx to approximate stacks", __func__, bestMatch->hash);
 
-    mApproximateStacks.emplace_back(*bestMatch);
+    addApproximateStack(bestMatch->hash, bestMatch->match);
     return true;
 }
 
+void Predictor::addApproximateStack(NonBufferHash hash, LayerStack::ApproximateMatch match) {
+    // The example stack of a prediction never changes, so neither does its key.
+    const std::vector<size_t> keys =
+            getPrediction(hash).getExampleLayerStack().getApproximateMatchKeys();
+    if (match.differingIndex < keys.size()) {
+        mApproximateStackIndex[keys[match.differingIndex]].push_back(mApproximateStacks.size());
+    }
+    mApproximateStacks.emplace_back(hash, match);
+}
+
 void Predictor::dumpPredictionsByFrequency(std::string& result) const {
     struct HashFrequency {
         HashFrequency(NonBufferHash hash, size_t totalAttempts)
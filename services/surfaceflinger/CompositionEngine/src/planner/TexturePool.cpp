@@ -23,15 +23,34 @@
 #include <renderengine/impl/ExternalTexture.h>
 #include <utils/Log.h>
 
+#include <algorithm>
+#include <limits>
+
 namespace android::compositionengine::impl::planner {
 
+namespace {
+
+int32_t roundUp(int32_t value, int32_t step) {
+    return (value + step - 1) / step * step;
+}
+
+} // namespace
+
 void TexturePool::allocatePool() {
+    // Textures that are still borrowed are dropped when they are returned.
+    ++mGeneration;
     mPool.clear();
+    mPooledBytes = 0;
+    mBorrowedBytes = 0;
+    mBorrowedCount = 0;
     if (mEnabled && mSize.isValid()) {
-        mPool.resize(kMinPoolSize);
-        std::generate_n(mPool.begin(), kMinPoolSize, [&]() {
-            return Entry{genTexture(), nullptr};
-        });
+        const size_t poolSize = std::min(kMinPoolSize, mMaxPoolSize);
+        for (size_t i = 0; i < poolSize; i++) {
+            auto texture = genTexture(mSize);
+            mPooledBytes += getTextureBytes(*texture);
+            mPool.push_back({std::move(texture), nullptr});
+        }
+        trimPool();
     }
 }
 
@@ -43,50 +62,145 @@ void TexturePool::setDisplaySize(ui::Size size) {
     allocatePool();
 }
 
-std::shared_ptr<TexturePool::AutoTexture> TexturePool::borrowTexture() {
-    if (mPool.empty()) {
-        return std::make_shared<AutoTexture>(*this, genTexture(), nullptr);
+void TexturePool::setSizedTexturesEnabled(bool enabled) {
+    mSizedTexturesEnabled = enabled;
+    if (!enabled) {
+        mMaxPoolSize = kMaxPoolSize;
+        mDemandPeak = 0;
+        mDemandFrames = 0;
+        trimPool();
+    }
+}
+
+ui::Size TexturePool::getBucketSize(ui::Size size) const {
+    if (!mSizedTexturesEnabled || !mSize.isValid()) {
+        return mSize;
+    }
+
+    const int32_t widthStep = roundUp(mSize.getWidth(), kBucketsPerDimension) / kBucketsPerDimension;
+    const int32_t heightStep =
+            roundUp(mSize.getHeight(), kBucketsPerDimension) / kBucketsPerDimension;
+    return ui::Size(std::min(roundUp(std::max(size.getWidth(), 1), widthStep), mSize.getWidth()),
+                    std::min(roundUp(std::max(size.getHeight(), 1), heightStep),
+                             mSize.getHeight()));
+}
+
+std::shared_ptr<TexturePool::AutoTexture> TexturePool::borrowTexture(ui::Size size) {
+    ++mBorrowCount;
+    const ui::Size bucketSize = getBucketSize(size);
+
+    // Hand out the smallest texture that fits. Among equally sized ones, the least recently
+    // returned is the most likely to be done with its pending GPU work.
+    auto bestFit = mPool.end();
+    size_t bestFitArea = std::numeric_limits<size_t>::max();
+    for (auto it = mPool.begin(); it != mPool.end(); ++it) {
+        const auto& buffer = it->texture->getBuffer();
+        if (static_cast<int32_t>(buffer->getWidth()) < bucketSize.getWidth() ||
+            static_cast<int32_t>(buffer->getHeight()) < bucketSize.getHeight()) {
+            continue;
+        }
+        const size_t area = static_cast<size_t>(buffer->getWidth()) * buffer->getHeight();
+        if (area < bestFitArea) {
+            bestFit = it;
+            bestFitArea = area;
+        }
     }
 
-    const auto entry = mPool.front();
-    mPool.pop_front();
-    return std::make_shared<AutoTexture>(*this, entry.texture, entry.fence);
+    // Rather generate a texture than use one much larger than needed, which would leave the
+    // larger texture unavailable for a request that needs it.
+    const size_t bucketArea = static_cast<size_t>(bucketSize.getWidth()) * bucketSize.getHeight();
+    Entry entry;
+    if (bestFit != mPool.end() && bestFitArea <= kMaxBestFitAreaRatio * bucketArea) {
+        ++mHitCount;
+        entry = std::move(*bestFit);
+        mPool.erase(bestFit);
+        mPooledBytes -= getTextureBytes(*entry.texture);
+    } else {
+        entry.texture = genTexture(bucketSize);
+    }
+
+    if (mEnabled) {
+        mBorrowedBytes += getTextureBytes(*entry.texture);
+        ++mBorrowedCount;
+        trimPool();
+    }
+
+    return std::make_shared<AutoTexture>(*this, std::move(entry.texture), entry.fence,
+                                         mGeneration);
 }
 
 void TexturePool::returnTexture(std::shared_ptr<renderengine::ExternalTexture>&& texture,
-                                const sp<Fence>& fence) {
+                                const sp<Fence>& fence, uint32_t generation) {
     // Drop the texture on the floor if the pool is not enabled
     if (!mEnabled) {
         return;
     }
 
-    // Or the texture on the floor if the pool is no longer tracking textures of the same size.
-    if (static_cast<int32_t>(texture->getBuffer()->getWidth()) != mSize.getWidth() ||
-        static_cast<int32_t>(texture->getBuffer()->getHeight()) != mSize.getHeight()) {
-        ALOGV("Deallocating texture from Planner's pool - display size changed (previous: (%dx%d), "
-              "current: (%dx%d))",
+    // Or the texture on the floor if the pool was reallocated since it was borrowed, e.g. because
+    // the display size changed.
+    if (generation != mGeneration) {
+        ALOGV("Deallocating texture from Planner's pool - pool was reallocated (texture: (%dx%d), "
+              "current display: (%dx%d))",
               texture->getBuffer()->getWidth(), texture->getBuffer()->getHeight(), mSize.getWidth(),
               mSize.getHeight());
         return;
     }
 
-    // Also ensure the pool does not grow beyond a maximum size.
-    if (mPool.size() == kMaxPoolSize) {
-        ALOGD("Deallocating texture from Planner's pool - max size [%" PRIu64 "] reached",
-              static_cast<uint64_t>(kMaxPoolSize));
+    const size_t bytes = getTextureBytes(*texture);
+    mBorrowedBytes -= bytes;
+    --mBorrowedCount;
+
+    mPool.push_back({std::move(texture), fence});
+    mPooledBytes += bytes;
+
+    // Also ensure the pool does not grow beyond its bounds.
+    trimPool();
+}
+
+void TexturePool::trimPool() {
+    const auto overBudget = [this] {
+        return mMemoryBudget != 0 && mPooledBytes + mBorrowedBytes > mMemoryBudget;
+    };
+
+    while (!mPool.empty() && (mPool.size() > mMaxPoolSize || overBudget())) {
+        ALOGV("Deallocating texture from Planner's pool - %s",
+              mPool.size() > mMaxPoolSize ? "max size reached" : "memory budget exceeded");
+        mPooledBytes -= getTextureBytes(*mPool.front().texture);
+        mPool.pop_front();
+        ++mEvictionCount;
+    }
+}
+
+void TexturePool::setMemoryBudget(size_t bytes) {
+    mMemoryBudget = bytes;
+    trimPool();
+}
+
+void TexturePool::setDemand(size_t texturesInUse) {
+    if (!mSizedTexturesEnabled) {
         return;
     }
 
-    mPool.push_back({std::move(texture), fence});
+    mDemandPeak = std::max(mDemandPeak, texturesInUse);
+    const size_t poolSize = std::clamp(mDemandPeak, size_t{1}, kMaxDemandPoolSize);
+
+    // Grow as soon as the demand rises, but only shrink once it stayed low for a while.
+    mMaxPoolSize = std::max(mMaxPoolSize, poolSize);
+    if (++mDemandFrames >= kDemandWindow) {
+        mMaxPoolSize = poolSize;
+        mDemandPeak = texturesInUse;
+        mDemandFrames = 0;
+        trimPool();
+    }
 }
 
-std::shared_ptr<renderengine::ExternalTexture> TexturePool::genTexture() {
-    LOG_ALWAYS_FATAL_IF(!mSize.isValid(), "Attempted to generate texture with invalid size");
+std::shared_ptr<renderengine::ExternalTexture> TexturePool::genTexture(ui::Size size) {
+    LOG_ALWAYS_FATAL_IF(!size.isValid(), "Attempted to generate texture with invalid size");
     return std::make_shared<
             renderengine::impl::
                     ExternalTexture>(sp<GraphicBuffer>::
-                                             make(static_cast<uint32_t>(mSize.getWidth()),
-                                                  static_cast<uint32_t>(mSize.getHeight()),
+                                             make(static_cast<uint32_t>(size.getWidth()),
+                                                  static_cast<uint32_t>(size.getHeight()),
                                                   HAL_PIXEL_FORMAT_RGBA_8888, 1U,
                                                   static_cast<uint64_t>(
                                                           GraphicBuffer::USAGE_HW_RENDER |
@@ -98,6 +212,13 @@ std::shared_ptr<renderengine::ExternalTexture> TexturePool::genTexture() {
                                              renderengine::impl::ExternalTexture::Usage::WRITEABLE);
 }
 
+size_t TexturePool::getTextureBytes(const renderengine::ExternalTexture& texture) {
+    // Textures are always RGBA_8888.
+    const auto& buffer = texture.getBuffer();
+    return static_cast<size_t>(std::max(buffer->getStride(), buffer->getWidth())) *
+            buffer->getHeight() * 4;
+}
+
 void TexturePool::setEnabled(bool enabled) {
     mEnabled = enabled;
     allocatePool();
@@ -107,6 +228,34 @@ void TexturePool::dump(std::string& out) const {
     base::StringAppendF(&out,
                         "TexturePool (%s) has %zu buffers of size [%" PRId32 ", %" PRId32 "]\n",
                         mEnabled ? "enabled" : "disabled", mPool.size(), mSize.width, mSize.height);
+    base::StringAppendF(&out,
+                        "    Sized textures: %s, retains up to %zu buffers, %zu buffers borrowed\n",
+                        mSizedTexturesEnabled ? "enabled" : "disabled", mMaxPoolSize,
+                        mBorrowedCount);
+    base::StringAppendF(&out, "    Memory: %zu KiB pooled + %zu KiB borrowed", mPooledBytes / 1024,
+                        mBorrowedBytes / 1024);
+    if (mMemoryBudget != 0) {
+        base::StringAppendF(&out, " of %zu KiB budget (%.1f%%)\n", mMemoryBudget / 1024,
+                            100.f * static_cast<float>(mPooledBytes + mBorrowedBytes) /
+                                    static_cast<float>(mMemoryBudget));
+    } else {
+        out.append(", no budget\n");
+    }
+    base::StringAppendF(&out, "    Hits: %zu of %zu borrows (%.1f%%), %zu buffers evicted\n",
+                        mHitCount, mBorrowCount,
+                        mBorrowCount == 0 ? 0.f
+                                          : 100.f * static_cast<float>(mHitCount) /
+                                                    static_cast<float>(mBorrowCount),
+                        mEvictionCount);
+    if (!mPool.empty()) {
+        out.append("    Pooled sizes:");
+        for (const Entry& entry : mPool) {
+            base::StringAppendF(&out, " [%" PRIu32 ", %" PRIu32 "]",
+                                entry.texture->getBuffer()->getWidth(),
+                                entry.texture->getBuffer()->getHeight());
+        }
+        out.append("\n");
+    }
 }
 
-} // namespace android::compositionengine::impl::planner
\ No newline at end of file
+} // namespace android::compositionengine::impl::planner
@@ -41,6 +41,7 @@ using ::testing::Ref;
 using ::testing::Return;
 using ::testing::ReturnRef;
 using ::testing::SaveArg;
+using ::testing::Sequence;
 using ::testing::StrictMock;
 
 static constexpr PhysicalDisplayId kDisplayId1 = PhysicalDisplayId::fromPort(123u);
@@ -160,6 +161,73 @@ TEST_F(CompositionEnginePresentTest, threeOutputs) {
     mEngine.present(mRefreshArgs);
 }
 
+TEST_F(CompositionEnginePresentTest, parallelCompositionPreparesSupportingOutputs) {
+    // present() always calls preComposition()
+    EXPECT_CALL(mEngine, preComposition(Ref(mRefreshArgs)));
+
+    EXPECT_CALL(*mOutput1, prepare(Ref(mRefreshArgs), _));
+    EXPECT_CALL(*mOutput2, prepare(Ref(mRefreshArgs), _));
+    EXPECT_CALL(*mOutput3, prepare(Ref(mRefreshArgs), _));
+
+    // The outputs which support it have their composition state prepared
+    // before any of them is presented. The order across outputs is unspecified.
+    EXPECT_CALL(*mOutput1, supportsParallelComposition).WillOnce(Return(true));
+    EXPECT_CALL(*mOutput2, supportsParallelComposition).WillOnce(Return(false));
+    EXPECT_CALL(*mOutput3, supportsParallelComposition).WillOnce(Return(true));
+
+    Sequence seq1, seq3;
+    EXPECT_CALL(*mOutput1, prepareCompositionState(Ref(mRefreshArgs))).InSequence(seq1);
+    EXPECT_CALL(*mOutput2, prepareCompositionState(_)).Times(0);
+    EXPECT_CALL(*mOutput3, prepareCompositionState(Ref(mRefreshArgs))).InSequence(seq3);
+
+    EXPECT_CALL(*mOutput1, supportsOffloadPresent).WillOnce(Return(false));
+
+    EXPECT_CALL(*mOutput1, present(Ref(mRefreshArgs)))
+            .InSequence(seq1, seq3)
+            .WillOnce(Return(ftl::yield<std::monostate>({})));
+    EXPECT_CALL(*mOutput2, present(Ref(mRefreshArgs)))
+            .WillOnce(Return(ftl::yield<std::monostate>({})));
+    EXPECT_CALL(*mOutput3, present(Ref(mRefreshArgs)))
+            .InSequence(seq1, seq3)
+            .WillOnce(Return(ftl::yield<std::monostate>({})));
+
+    // present() always calls postComposition()
+    EXPECT_CALL(mEngine, postComposition(Ref(mRefreshArgs)));
+
+    mRefreshArgs.outputs = {mOutput1, mOutput2, mOutput3};
+    mRefreshArgs.parallelComposition = true;
+    mEngine.present(mRefreshArgs);
+}
+
+TEST_F(CompositionEnginePresentTest, parallelCompositionSkipsSingleOutput) {
+    EXPECT_CALL(mEngine, preComposition(Ref(mRefreshArgs)));
+
+    EXPECT_CALL(*mOutput1, prepare(Ref(mRefreshArgs), _));
+    EXPECT_CALL(*mOutput2, prepare(Ref(mRefreshArgs), _));
+
+    // Disabled outputs are left for present().
+    mOutputStates[1].isEnabled = false;
+    EXPECT_CALL(*mOutput1, supportsParallelComposition).WillOnce(Return(true));
+    EXPECT_CALL(*mOutput2, supportsParallelComposition).Times(0);
+
+    // With only one eligible output, there is nothing to run concurrently.
+    EXPECT_CALL(*mOutput1, prepareCompositionState(_)).Times(0);
+    EXPECT_CALL(*mOutput2, prepareCompositionState(_)).Times(0);
+
+    EXPECT_CALL(*mOutput1, supportsOffloadPresent).WillOnce(Return(false));
+
+    EXPECT_CALL(*mOutput1, present(Ref(mRefreshArgs)))
+            .WillOnce(Return(ftl::yield<std::monostate>({})));
+    EXPECT_CALL(*mOutput2, present(Ref(mRefreshArgs)))
+            .WillOnce(Return(ftl::yield<std::monostate>({})));
+
+    EXPECT_CALL(mEngine, postComposition(Ref(mRefreshArgs)));
+
+    mRefreshArgs.outputs = {mOutput1, mOutput2};
+    mRefreshArgs.parallelComposition = true;
+    mEngine.present(mRefreshArgs);
+}
+
 /*
  * CompositionEngine::updateCursorAsync
  */
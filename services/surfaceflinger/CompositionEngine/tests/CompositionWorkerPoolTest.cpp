@@ -0,0 +1,84 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+#include <compositionengine/impl/CompositionWorkerPool.h>
+#include <gtest/gtest.h>
+
+namespace android::compositionengine {
+namespace {
+
+using namespace std::chrono_literals;
+
+// See HwcAsyncWorkerTest.
+constexpr auto kWallTimeForEdgeCaseTests = 5ms;
+
+TEST(CompositionWorkerPool, runsEveryTaskOnce) {
+    impl::CompositionWorkerPool pool(3);
+    EXPECT_EQ(3u, pool.getThreadCount());
+
+    std::array<std::atomic<int>, 16> counts{};
+    pool.run(counts.size(), [&](size_t index) { counts[index]++; });
+
+    for (const auto& count : counts) {
+        EXPECT_EQ(1, count);
+    }
+}
+
+TEST(CompositionWorkerPool, runsWithoutWorkerThreads) {
+    // The calling thread takes part, so an empty pool still runs the tasks.
+    impl::CompositionWorkerPool pool(0);
+
+    std::array<int, 4> counts{};
+    pool.run(counts.size(), [&](size_t index) { counts[index]++; });
+
+    for (const auto& count : counts) {
+        EXPECT_EQ(1, count);
+    }
+}
+
+TEST(CompositionWorkerPool, zeroTasks) {
+    impl::CompositionWorkerPool pool(2);
+    pool.run(0, [](size_t) { FAIL(); });
+}
+
+TEST(CompositionWorkerPool, repeatedRunsEdgeCase) {
+    // Ensures that tasks handed out in short succession are neither lost nor
+    // run by a worker after `run` returns.
+
+    impl::CompositionWorkerPool pool(3);
+    const auto endTime = std::chrono::steady_clock::now() + kWallTimeForEdgeCaseTests;
+    while (std::chrono::steady_clock::now() < endTime) {
+        std::atomic<size_t> sum = 0;
+        pool.run(4, [&](size_t index) { sum += index + 1; });
+        EXPECT_EQ(10u, sum);
+    }
+}
+
+TEST(CompositionWorkerPool, constructAndDestroyEdgeCase) {
+    // Ensures that newly created pools can be immediately destroyed.
+
+    const auto endTime = std::chrono::steady_clock::now() + kWallTimeForEdgeCaseTests;
+    while (std::chrono::steady_clock::now() < endTime) {
+        impl::CompositionWorkerPool pool(3);
+    }
+}
+
+} // namespace
+} // namespace android::compositionengine
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <compositionengine/CoverageMask.h>
+#include <gtest/gtest.h>
+
+namespace android::compositionengine {
+namespace {
+
+// 1080 / 64 rounds up to 17 pixel wide tiles, so the last column is 1080 - 63 * 17 = 9 pixels
+// wide. 2400 / 64 rounds up to 38 pixel high tiles.
+const Rect kBounds(0, 0, 1080, 2400);
+
+TEST(CoverageMaskTest, withoutBoundsIsConservative) {
+    CoverageMask mask;
+    mask.addOpaqueRect(kBounds);
+
+    EXPECT_FALSE(mask.isOccluded(Rect(0, 0, 10, 10)));
+    EXPECT_TRUE(mask.mayBeOccluded(Rect(0, 0, 10, 10)));
+}
+
+TEST(CoverageMaskTest, emptyMaskOccludesNothing) {
+    CoverageMask mask;
+    mask.reset(kBounds);
+
+    EXPECT_FALSE(mask.isOccluded(Rect(0, 0, 10, 10)));
+    EXPECT_FALSE(mask.mayBeOccluded(Rect(0, 0, 10, 10)));
+    EXPECT_FALSE(mask.mayBeOccluded(kBounds));
+}
+
+TEST(CoverageMaskTest, fullyCoveredBounds) {
+    CoverageMask mask;
+    mask.reset(kBounds);
+    mask.addOpaqueRect(kBounds);
+
+    EXPECT_TRUE(mask.isOccluded(kBounds));
+    EXPECT_TRUE(mask.isOccluded(Rect(1070, 2390, 1080, 2400)));
+    EXPECT_TRUE(mask.mayBeOccluded(Rect(500, 500, 600, 600)));
+}
+
+TEST(CoverageMaskTest, partiallyCoveredTilesAreNotOccluded) {
+    CoverageMask mask;
+    mask.reset(kBounds);
+
+    // Spans tile columns [1, 5) exactly, and only part of tile column 5.
+    mask.addOpaqueRect(Rect(17, 0, 90, 2400));
+
+    EXPECT_TRUE(mask.isOccluded(Rect(17, 100, 85, 200)));
+    EXPECT_FALSE(mask.isOccluded(Rect(17, 100, 86, 200)));
+    EXPECT_FALSE(mask.isOccluded(Rect(16, 100, 85, 200)));
+
+    // Still touched, so still possibly occluded.
+    EXPECT_TRUE(mask.mayBeOccluded(Rect(86, 100, 90, 200)));
+    EXPECT_FALSE(mask.mayBeOccluded(Rect(102, 100, 200, 200)));
+    EXPECT_FALSE(mask.mayBeOccluded(Rect(0, 100, 17, 200)));
+}
+
+TEST(CoverageMaskTest, combinesRects) {
+    CoverageMask mask;
+    mask.reset(kBounds);
+    mask.addOpaqueRect(Rect(0, 0, 1080, 1216));
+    mask.addOpaqueRect(Rect(0, 1216, 1080, 2400));
+
+    EXPECT_TRUE(mask.isOccluded(Rect(100, 1100, 200, 1300)));
+
+    // The tile rows split by these rects are not fully covered by either one.
+    mask.reset(kBounds);
+    mask.addOpaqueRect(Rect(0, 0, 1080, 1200));
+    mask.addOpaqueRect(Rect(0, 1200, 1080, 2400));
+
+    EXPECT_FALSE(mask.isOccluded(Rect(100, 1100, 200, 1300)));
+}
+
+TEST(CoverageMaskTest, rectsOutsideBoundsAreConservative) {
+    CoverageMask mask;
+    mask.reset(kBounds);
+    mask.addOpaqueRect(Rect(-100, -100, 2000, 3000));
+
+    EXPECT_TRUE(mask.isOccluded(kBounds));
+    EXPECT_FALSE(mask.isOccluded(Rect(-10, 0, 10, 10)));
+    EXPECT_TRUE(mask.mayBeOccluded(Rect(-10, 0, 10, 10)));
+    EXPECT_TRUE(mask.mayBeOccluded(Rect(2000, 2000, 2100, 2100)));
+}
+
+TEST(CoverageMaskTest, resetClearsCoverage) {
+    CoverageMask mask;
+    mask.reset(kBounds);
+    mask.addOpaqueRect(kBounds);
+    mask.reset(kBounds);
+
+    EXPECT_FALSE(mask.isOccluded(kBounds));
+    EXPECT_FALSE(mask.mayBeOccluded(kBounds));
+}
+
+} // namespace
+} // namespace android::compositionengine
@@ -1955,6 +1955,81 @@ TEST_F(OutputEnsureOutputLayerIfVisibleTest, takesNotSoEarlyOutifLayerWithShadow
     ensureOutputLayerIfVisible();
 }
 
+TEST_F(OutputEnsureOutputLayerIfVisibleTest, coverageMaskRejectsOccludedLayer) {
+    mCoverageState.aboveOpaqueLayersMask.reset(Rect(0, 0, 200, 300));
+    mCoverageState.aboveOpaqueLayersMask.addOpaqueRect(Rect(0, 0, 200, 300));
+    mCoverageState.aboveCoveredLayers = Region(Rect(0, 0, 200, 300));
+    mCoverageState.aboveOpaqueLayers = Region(Rect(0, 0, 200, 300));
+    mCoverageState.aboveCoveredLayersExcludingOverlays = Region(Rect(0, 0, 10, 10));
+
+    ensureOutputLayerIfVisible();
+
+    EXPECT_THAT(mCoverageState.dirtyRegion, RegionEq(kEmptyRegion));
+    EXPECT_THAT(mCoverageState.aboveCoveredLayers, RegionEq(Region(Rect(0, 0, 200, 300))));
+    EXPECT_THAT(mCoverageState.aboveOpaqueLayers, RegionEq(Region(Rect(0, 0, 200, 300))));
+    EXPECT_THAT(*mCoverageState.aboveCoveredLayersExcludingOverlays,
+                RegionEq(Region(Rect(0, 0, 10, 10)).orSelf(kFullBoundsNoRotation)));
+}
+
+TEST_F(OutputEnsureOutputLayerIfVisibleTest, coverageMaskGivesSameResultForPartialOcclusion) {
+    // Same as coverageAccumulatesTest, with the opaque region above also in the mask.
+    mLayer.layerFEState.isOpaque = false;
+    mLayer.layerFEState.contentDirty = true;
+    mLayer.layerFEState.geomLayerTransform = ui::Transform(TR_IDENT, 100, 200);
+
+    mCoverageState.aboveOpaqueLayersMask.reset(Rect(0, 0, 200, 300));
+    mCoverageState.aboveOpaqueLayersMask.addOpaqueRect(Rect(50, 0, 150, 200));
+    mCoverageState.dirtyRegion = Region(Rect(0, 0, 500, 500));
+    mCoverageState.aboveCoveredLayers = Region(Rect(50, 0, 150, 200));
+    mCoverageState.aboveOpaqueLayers = Region(Rect(50, 0, 150, 200));
+
+    EXPECT_CALL(mOutput, ensureOutputLayer(Eq(0u), Eq(mLayer.layerFE)))
+            .WillOnce(Return(&mLayer.outputLayer));
+
+    ensureOutputLayerIfVisible();
+
+    const Region kExpectedLayerVisibleRegion = Region(Rect(0, 0, 50, 200));
+
+    EXPECT_THAT(mCoverageState.dirtyRegion, RegionEq(Region(Rect(0, 0, 500, 500))));
+    EXPECT_THAT(mCoverageState.aboveCoveredLayers, RegionEq(Region(Rect(0, 0, 150, 200))));
+    EXPECT_THAT(mCoverageState.aboveOpaqueLayers, RegionEq(Region(Rect(50, 0, 150, 200))));
+
+    EXPECT_THAT(mLayer.outputLayerState.visibleRegion, RegionEq(kExpectedLayerVisibleRegion));
+    EXPECT_THAT(mLayer.outputLayerState.visibleNonTransparentRegion,
+                RegionEq(Region(Rect(0, 100, 50, 200))));
+    EXPECT_THAT(mLayer.outputLayerState.coveredRegion, RegionEq(Region(Rect(50, 0, 100, 200))));
+    EXPECT_THAT(mLayer.outputLayerState.outputSpaceVisibleRegion,
+                RegionEq(kExpectedLayerVisibleRegion));
+}
+
+TEST_F(OutputEnsureOutputLayerIfVisibleTest, coverageMaskGivesSameResultWithoutOcclusion) {
+    mCoverageState.aboveOpaqueLayersMask.reset(Rect(0, 0, 200, 300));
+    mCoverageState.aboveOpaqueLayersMask.addOpaqueRect(Rect(100, 200, 200, 300));
+    mCoverageState.aboveCoveredLayers = Region(Rect(100, 200, 200, 300));
+    mCoverageState.aboveOpaqueLayers = Region(Rect(100, 200, 200, 300));
+
+    EXPECT_CALL(mOutput, ensureOutputLayer(Eq(0u), Eq(mLayer.layerFE)))
+            .WillOnce(Return(&mLayer.outputLayer));
+
+    ensureOutputLayerIfVisible();
+
+    const Region kExpectedAboveRegion =
+            Region(Rect(100, 200, 200, 300)).orSelf(kFullBoundsNoRotation);
+
+    EXPECT_THAT(mCoverageState.dirtyRegion, RegionEq(kFullBoundsNoRotation));
+    EXPECT_THAT(mCoverageState.aboveCoveredLayers, RegionEq(kExpectedAboveRegion));
+    EXPECT_THAT(mCoverageState.aboveOpaqueLayers, RegionEq(kExpectedAboveRegion));
+
+    EXPECT_THAT(mLayer.outputLayerState.visibleRegion, RegionEq(kFullBoundsNoRotation));
+    EXPECT_THAT(mLayer.outputLayerState.visibleNonTransparentRegion,
+                RegionEq(kFullBoundsNoRotation));
+    EXPECT_THAT(mLayer.outputLayerState.coveredRegion, RegionEq(kEmptyRegion));
+    EXPECT_THAT(mLayer.outputLayerState.outputSpaceVisibleRegion, RegionEq(kFullBoundsNoRotation));
+
+    // The layer is opaque, so it is added to the mask for the layers below.
+    EXPECT_TRUE(mCoverageState.aboveOpaqueLayersMask.isOccluded(Rect(0, 0, 100, 200)));
+}
+
 TEST_F(OutputEnsureOutputLayerIfVisibleTest, displayDecorSetsBlockingFromTransparentRegion) {
     mLayer.layerFEState.isOpaque = false;
     mLayer.layerFEState.contentDirty = true;
@@ -2114,6 +2189,47 @@ TEST_F(OutputPresentTest, predictingCompositionStrategyInvokesPrepareFrameAsync)
     mOutput.present(args);
 }
 
+TEST_F(OutputPresentTest, skipsStagesRunByPrepareCompositionState) {
+    CompositionRefreshArgs args;
+
+    InSequence seq;
+    EXPECT_CALL(mOutput, updateColorProfile(Ref(args)));
+    EXPECT_CALL(mOutput, updateCompositionState(Ref(args)));
+    EXPECT_CALL(mOutput, planComposition());
+
+    mOutput.prepareCompositionState(args);
+
+    EXPECT_CALL(mOutput, writeCompositionState(Ref(args)));
+    EXPECT_CALL(mOutput, setColorTransform(Ref(args)));
+    EXPECT_CALL(mOutput, beginFrame());
+    EXPECT_CALL(mOutput, setHintSessionRequiresRenderEngine(false));
+    EXPECT_CALL(mOutput, canPredictCompositionStrategy(Ref(args))).WillOnce(Return(false));
+    EXPECT_CALL(mOutput, prepareFrame());
+    EXPECT_CALL(mOutput, devOptRepaintFlash(Ref(args)));
+    EXPECT_CALL(mOutput, finishFrame(_));
+    EXPECT_CALL(mOutput, presentFrameAndReleaseLayers(false));
+    EXPECT_CALL(mOutput, renderCachedSets(Ref(args)));
+
+    mOutput.present(args);
+
+    // The next frame runs every stage again.
+    EXPECT_CALL(mOutput, updateColorProfile(Ref(args)));
+    EXPECT_CALL(mOutput, updateCompositionState(Ref(args)));
+    EXPECT_CALL(mOutput, planComposition());
+    EXPECT_CALL(mOutput, writeCompositionState(Ref(args)));
+    EXPECT_CALL(mOutput, setColorTransform(Ref(args)));
+    EXPECT_CALL(mOutput, beginFrame());
+    EXPECT_CALL(mOutput, setHintSessionRequiresRenderEngine(false));
+    EXPECT_CALL(mOutput, canPredictCompositionStrategy(Ref(args))).WillOnce(Return(false));
+    EXPECT_CALL(mOutput, prepareFrame());
+    EXPECT_CALL(mOutput, devOptRepaintFlash(Ref(args)));
+    EXPECT_CALL(mOutput, finishFrame(_));
+    EXPECT_CALL(mOutput, presentFrameAndReleaseLayers(false));
+    EXPECT_CALL(mOutput, renderCachedSets(Ref(args)));
+
+    mOutput.present(args);
+}
+
 /*
  * Output::updateColorProfile()
  */
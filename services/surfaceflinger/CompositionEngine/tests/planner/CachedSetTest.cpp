@@ -25,6 +25,7 @@
 #include <renderengine/mock/FakeExternalTexture.h>
 #include <renderengine/mock/RenderEngine.h>
 #include <ui/GraphicTypes.h>
+#include <ui/MockFence.h>
 #include <utils/Errors.h>
 #include <memory>
 
@@ -32,6 +33,7 @@ namespace android::compositionengine {
 using namespace std::chrono_literals;
 
 using testing::_;
+using testing::ByMove;
 using testing::DoAll;
 using testing::Invoke;
 using testing::Return;
@@ -577,6 +579,185 @@ TEST_F(CachedSetTest, rendersWithOffsetFramebufferContent) {
     cachedSet.append(CachedSet(layer3));
 }
 
+TEST_F(CachedSetTest, partialRenderOnlyRedrawsDamage) {
+    mTexturePool.setDisplaySize(ui::Size(10, 20));
+    mOutputState.displaySpace = mOutputState.framebufferSpace;
+
+    CachedSet::Layer& layer1 = *mTestLayers[1]->cachedSetLayer.get();
+    sp<mock::LayerFE> layerFE1 = mTestLayers[1]->layerFE;
+    CachedSet::Layer& layer2 = *mTestLayers[2]->cachedSetLayer.get();
+    sp<mock::LayerFE> layerFE2 = mTestLayers[2]->layerFE;
+
+    CachedSet cachedSet(layer1);
+    cachedSet.append(CachedSet(layer2));
+    EXPECT_FALSE(cachedSet.canRenderPartially());
+
+    std::optional<compositionengine::LayerFE::LayerSettings> clientComp;
+    clientComp.emplace();
+    EXPECT_CALL(*layerFE1, prepareClientComposition(_)).WillRepeatedly(Return(clientComp));
+    EXPECT_CALL(*layerFE2, prepareClientComposition(_)).WillRepeatedly(Return(clientComp));
+
+    const auto drawAll = [&](const renderengine::DisplaySettings& displaySettings,
+                             const std::vector<renderengine::LayerSettings>& layers,
+                             const std::shared_ptr<renderengine::ExternalTexture>&,
+                             base::unique_fd&&) -> ftl::Future<FenceResult> {
+        EXPECT_FALSE(displaySettings.scissor.isValid());
+        EXPECT_EQ(2u, layers.size());
+        return ftl::yield<FenceResult>(Fence::NO_FENCE);
+    };
+    EXPECT_CALL(mRenderEngine, drawLayers(_, _, _, _)).WillOnce(Invoke(drawAll));
+    cachedSet.render(mRenderEngine, mTexturePool, mOutputState, true);
+    expectReadyBuffer(cachedSet);
+    const auto previousBuffer = cachedSet.getBuffer();
+
+    // Nothing changed since the set was rendered.
+    EXPECT_FALSE(cachedSet.canRenderPartially());
+
+    mTestLayers[2]->layerState->resetFramesSinceBufferUpdate();
+    ASSERT_TRUE(cachedSet.canRenderPartially());
+    cachedSet.prepareForPartialRender();
+    EXPECT_FALSE(cachedSet.hasRenderedBuffer());
+    EXPECT_EQ(Rect(2, 2, 3, 3), cachedSet.getDamage().getBounds());
+
+    // The previous buffer may still be scanned out until a frame without it was presented, and
+    // that frame's present fence signals.
+    EXPECT_CALL(mRenderEngine, drawLayers(_, _, _, _)).Times(0);
+    cachedSet.render(mRenderEngine, mTexturePool, mOutputState, true);
+    EXPECT_FALSE(cachedSet.hasRenderedBuffer());
+
+    const auto presentFence = sp<mock::MockFence>::make();
+    EXPECT_CALL(*presentFence, getStatus())
+            .WillOnce(Return(Fence::Status::Unsignaled))
+            .WillRepeatedly(Return(Fence::Status::Signaled));
+    cachedSet.setPartialRenderSourceReleaseFence(presentFence);
+    cachedSet.render(mRenderEngine, mTexturePool, mOutputState, true);
+    EXPECT_FALSE(cachedSet.hasRenderedBuffer());
+
+    // A later present fence does not replace the one of the first frame without the buffer.
+    cachedSet.setPartialRenderSourceReleaseFence(sp<mock::MockFence>::make());
+
+    const auto drawDamage = [&](const renderengine::DisplaySettings& displaySettings,
+                                const std::vector<renderengine::LayerSettings>& layers,
+                                const std::shared_ptr<renderengine::ExternalTexture>& buffer,
+                                base::unique_fd&&) -> ftl::Future<FenceResult> {
+        // The damage, plus a pixel for filtering, drawn into the previous buffer.
+        EXPECT_EQ(previousBuffer, buffer);
+        EXPECT_EQ(Rect(1, 1, 4, 4), displaySettings.scissor);
+        EXPECT_EQ(mOutputState.layerStackSpace.getContent(), displaySettings.clip);
+        EXPECT_EQ(2u, layers.size());
+        return ftl::yield<FenceResult>(Fence::NO_FENCE);
+    };
+    EXPECT_CALL(mRenderEngine, drawLayers(_, _, _, _)).WillOnce(Invoke(drawDamage));
+    cachedSet.render(mRenderEngine, mTexturePool, mOutputState, true);
+    expectReadyBuffer(cachedSet);
+    EXPECT_EQ(previousBuffer, cachedSet.getBuffer());
+    EXPECT_TRUE(cachedSet.getDamage().isEmpty());
+}
+
+TEST_F(CachedSetTest, partialRenderRedrawsEverythingIfOutputChanged) {
+    mTexturePool.setDisplaySize(ui::Size(10, 20));
+    mOutputState.displaySpace = mOutputState.framebufferSpace;
+
+    CachedSet::Layer& layer1 = *mTestLayers[1]->cachedSetLayer.get();
+    sp<mock::LayerFE> layerFE1 = mTestLayers[1]->layerFE;
+    CachedSet::Layer& layer2 = *mTestLayers[2]->cachedSetLayer.get();
+    sp<mock::LayerFE> layerFE2 = mTestLayers[2]->layerFE;
+
+    CachedSet cachedSet(layer1);
+    cachedSet.append(CachedSet(layer2));
+
+    std::optional<compositionengine::LayerFE::LayerSettings> clientComp;
+    clientComp.emplace();
+    EXPECT_CALL(*layerFE1, prepareClientComposition(_)).WillRepeatedly(Return(clientComp));
+    EXPECT_CALL(*layerFE2, prepareClientComposition(_)).WillRepeatedly(Return(clientComp));
+
+    const auto drawAll = [&](const renderengine::DisplaySettings& displaySettings,
+                             const std::vector<renderengine::LayerSettings>& layers,
+                             const std::shared_ptr<renderengine::ExternalTexture>&,
+                             base::unique_fd&&) -> ftl::Future<FenceResult> {
+        EXPECT_FALSE(displaySettings.scissor.isValid());
+        EXPECT_EQ(2u, layers.size());
+        return ftl::yield<FenceResult>(Fence::NO_FENCE);
+    };
+    EXPECT_CALL(mRenderEngine, drawLayers(_, _, _, _)).WillOnce(Invoke(drawAll));
+    cachedSet.render(mRenderEngine, mTexturePool, mOutputState, true);
+
+    mTestLayers[2]->layerState->resetFramesSinceBufferUpdate();
+    ASSERT_TRUE(cachedSet.canRenderPartially());
+    cachedSet.prepareForPartialRender();
+    cachedSet.setPartialRenderSourceReleaseFence(Fence::NO_FENCE);
+
+    mOutputState.dataspace = ui::Dataspace::DISPLAY_P3;
+    EXPECT_CALL(mRenderEngine, drawLayers(_, _, _, _)).WillOnce(Invoke(drawAll));
+    cachedSet.render(mRenderEngine, mTexturePool, mOutputState, true);
+    expectReadyBuffer(cachedSet);
+}
+
+TEST_F(CachedSetTest, renderIntoSizedTexture) {
+    mTexturePool.setSizedTexturesEnabled(true);
+    mTexturePool.setDisplaySize(ui::Size(10, 20));
+    mOutputState.displaySpace = mOutputState.framebufferSpace;
+
+    CachedSet::Layer& layer1 = *mTestLayers[1]->cachedSetLayer.get();
+    sp<mock::LayerFE> layerFE1 = mTestLayers[1]->layerFE;
+    CachedSet::Layer& layer2 = *mTestLayers[2]->cachedSetLayer.get();
+    sp<mock::LayerFE> layerFE2 = mTestLayers[2]->layerFE;
+
+    CachedSet cachedSet(layer1);
+    cachedSet.append(CachedSet(layer2));
+
+    std::optional<compositionengine::LayerFE::LayerSettings> clientComp;
+    clientComp.emplace();
+    EXPECT_CALL(*layerFE1, prepareClientComposition(_)).WillOnce(Return(clientComp));
+    EXPECT_CALL(*layerFE2, prepareClientComposition(_)).WillOnce(Return(clientComp));
+
+    // The set covers (1, 1, 3, 3), which rounds up to a texture of 2x3 in buckets of 1/8 of the
+    // display size.
+    const auto drawLayers = [&](const renderengine::DisplaySettings& displaySettings,
+                                const std::vector<renderengine::LayerSettings>&,
+                                const std::shared_ptr<renderengine::ExternalTexture>& buffer,
+                                base::unique_fd&&) -> ftl::Future<FenceResult> {
+        EXPECT_EQ(Rect(2, 3), buffer->getBuffer()->getBounds());
+        EXPECT_EQ(Rect(-1, -1, 9, 4), displaySettings.physicalDisplay);
+        EXPECT_EQ(mOutputState.layerStackSpace.getContent(), displaySettings.clip);
+        return ftl::yield<FenceResult>(Fence::NO_FENCE);
+    };
+    EXPECT_CALL(mRenderEngine, drawLayers(_, _, _, _)).WillOnce(Invoke(drawLayers));
+    cachedSet.render(mRenderEngine, mTexturePool, mOutputState, true);
+    expectReadyBuffer(cachedSet);
+
+    EXPECT_EQ(mOutputState.framebufferSpace, cachedSet.getOutputSpace());
+    EXPECT_EQ(Rect(1, 1, 3, 4), cachedSet.getTextureBounds());
+}
+
+TEST_F(CachedSetTest, cannotRenderPartiallyWithHolePunch) {
+    mTestLayers[0]->outputLayerCompositionState.displayFrame = Rect(0, 0, 5, 5);
+    CachedSet::Layer& layer1 = *mTestLayers[0]->cachedSetLayer.get();
+    sp<mock::LayerFE> layerFE1 = mTestLayers[0]->layerFE;
+    CachedSet::Layer& layer2 = *mTestLayers[1]->cachedSetLayer.get();
+    sp<mock::LayerFE> layerFE2 = mTestLayers[1]->layerFE;
+    CachedSet::Layer& layer3 = *mTestLayers[2]->cachedSetLayer.get();
+    sp<mock::LayerFE> layerFE3 = mTestLayers[2]->layerFE;
+
+    CachedSet cachedSet(layer1);
+    cachedSet.addLayer(layer2.getState(), kStartTime + 10ms);
+    cachedSet.addHolePunchLayerIfFeasible(layer3, true);
+    ASSERT_EQ(&mTestLayers[2]->outputLayer, cachedSet.getHolePunchLayer());
+
+    std::optional<compositionengine::LayerFE::LayerSettings> clientComp;
+    clientComp.emplace();
+    EXPECT_CALL(*layerFE1, prepareClientComposition(_)).WillRepeatedly(Return(clientComp));
+    EXPECT_CALL(*layerFE2, prepareClientComposition(_)).WillRepeatedly(Return(clientComp));
+    EXPECT_CALL(*layerFE3, prepareClientComposition(_)).WillRepeatedly(Return(clientComp));
+    EXPECT_CALL(mRenderEngine, drawLayers(_, _, _, _))
+            .WillOnce(Return(ByMove(ftl::yield<FenceResult>(Fence::NO_FENCE))));
+    cachedSet.render(mRenderEngine, mTexturePool, mOutputState, true);
+    expectReadyBuffer(cachedSet);
+
+    mTestLayers[1]->layerState->resetFramesSinceBufferUpdate();
+    EXPECT_FALSE(cachedSet.canRenderPartially());
+}
+
 TEST_F(CachedSetTest, cachingHintIncludesLayersByDefault) {
     CachedSet cachedSet(*mTestLayers[0]->cachedSetLayer.get());
     EXPECT_FALSE(cachedSet.cachingHintExcludesLayers());
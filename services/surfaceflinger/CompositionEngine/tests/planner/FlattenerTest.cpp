@@ -1493,5 +1493,87 @@ TEST_F(FlattenerTest, flattenLayers_includes_DISPLAY_DECORATION) {
     EXPECT_EQ(overrideBuffer1, overrideBuffer3);
 }
 
+class FlattenerPartialRenderTest : public FlattenerTest {
+public:
+    FlattenerPartialRenderTest()
+          : FlattenerTest(Flattener::Tunables{
+                    .mActiveLayerTimeout = 100ms,
+                    .mRenderScheduling = std::nullopt,
+                    .mEnableHolePunch = true,
+                    .mEnablePartialRender = true,
+            }) {}
+
+    void SetUp() override {
+        FlattenerTest::SetUp();
+        mOutputState.displaySpace = mOutputState.framebufferSpace;
+    }
+};
+
+TEST_F(FlattenerPartialRenderTest, flattenLayers_BufferUpdateRendersPartially) {
+    auto& layerState1 = mTestLayers[0]->layerState;
+    const auto& overrideBuffer1 = layerState1->getOutputLayer()->getState().overrideInfo.buffer;
+
+    auto& layerState2 = mTestLayers[1]->layerState;
+    const auto& overrideBuffer2 = layerState2->getOutputLayer()->getState().overrideInfo.buffer;
+
+    auto& layerState3 = mTestLayers[2]->layerState;
+    const auto& overrideBuffer3 = layerState3->getOutputLayer()->getState().overrideInfo.buffer;
+
+    const std::vector<const LayerState*> layers = {
+            layerState1.get(),
+            layerState2.get(),
+            layerState3.get(),
+    };
+
+    initializeFlattener(layers);
+
+    // make all layers inactive
+    mTime += 200ms;
+    expectAllLayersFlattened(layers);
+    const auto flattenedBuffer = overrideBuffer1;
+
+    // Only the first layer is updated, so the set is shown decomposed while the first layer is
+    // redrawn into the flattened buffer. That waits until the frame without the buffer is
+    // presented.
+    layerState1->resetFramesSinceBufferUpdate();
+    EXPECT_CALL(mRenderEngine, drawLayers(_, _, _, _)).Times(0);
+    initializeOverrideBuffer(layers);
+    EXPECT_EQ(getNonBufferHash(layers),
+              mFlattener->flattenLayers(layers, getNonBufferHash(layers), mTime));
+    mFlattener->renderCachedSets(mOutputState, std::nullopt, true);
+
+    EXPECT_EQ(nullptr, overrideBuffer1);
+    EXPECT_EQ(nullptr, overrideBuffer2);
+    EXPECT_EQ(nullptr, overrideBuffer3);
+
+    layerState1->incrementFramesSinceBufferUpdate();
+    initializeOverrideBuffer(layers);
+    mFlattener->flattenLayers(layers, getNonBufferHash(layers), mTime);
+    mFlattener->renderCachedSets(mOutputState, std::nullopt, true);
+
+    EXPECT_CALL(mRenderEngine, drawLayers(_, _, _, _))
+            .WillOnce(Return(ByMove(ftl::yield<FenceResult>(Fence::NO_FENCE))));
+    mFlattener->reportPresentFence(Fence::NO_FENCE);
+    initializeOverrideBuffer(layers);
+    mFlattener->flattenLayers(layers, getNonBufferHash(layers), mTime);
+    mFlattener->renderCachedSets(mOutputState, std::nullopt, true);
+
+    EXPECT_EQ(nullptr, overrideBuffer1);
+    EXPECT_EQ(nullptr, overrideBuffer2);
+    EXPECT_EQ(nullptr, overrideBuffer3);
+
+    // The re-rendered set is used right away.
+    EXPECT_CALL(mRenderEngine, drawLayers(_, _, _, _)).Times(0);
+    initializeOverrideBuffer(layers);
+    EXPECT_NE(getNonBufferHash(layers),
+              mFlattener->flattenLayers(layers, getNonBufferHash(layers), mTime));
+    mFlattener->renderCachedSets(mOutputState, std::nullopt, true);
+
+    EXPECT_NE(nullptr, overrideBuffer1);
+    EXPECT_EQ(flattenedBuffer, overrideBuffer1);
+    EXPECT_EQ(overrideBuffer1, overrideBuffer2);
+    EXPECT_EQ(overrideBuffer2, overrideBuffer3);
+}
+
 } // namespace
 } // namespace android::compositionengine
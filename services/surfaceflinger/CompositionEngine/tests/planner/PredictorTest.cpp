@@ -344,6 +344,104 @@ TEST_F(LayerStackTest, getApproximateMatch_doesNotMatchMultipleApproximations) {
     EXPECT_FALSE(stack.getApproximateMatch({&layerStateTwo, &layerStateTwo}));
 }
 
+TEST_F(LayerStackTest, getApproximateMatchKeys_agreeOnlyAtDifferingIndex) {
+    SET_FLAG_FOR_TEST(com::android::graphics::surfaceflinger::flags::
+                              cache_when_source_crop_layer_only_moved,
+                      false);
+    mock::OutputLayer outputLayerOne;
+    sp<mock::LayerFE> layerFEOne = sp<mock::LayerFE>::make();
+    OutputLayerCompositionState outputLayerCompositionStateOne{
+            .sourceCrop = sFloatRectOne,
+    };
+    LayerFECompositionState layerFECompositionStateOne;
+    setupMocksForLayer(outputLayerOne, *layerFEOne, outputLayerCompositionStateOne,
+                       layerFECompositionStateOne);
+    LayerState layerStateOne(&outputLayerOne);
+
+    mock::OutputLayer outputLayerTwo;
+    sp<mock::LayerFE> layerFETwo = sp<mock::LayerFE>::make();
+    OutputLayerCompositionState outputLayerCompositionStateTwo{
+            .sourceCrop = sFloatRectTwo,
+    };
+    LayerFECompositionState layerFECompositionStateTwo;
+    setupMocksForLayer(outputLayerTwo, *layerFETwo, outputLayerCompositionStateTwo,
+                       layerFECompositionStateTwo);
+    LayerState layerStateTwo(&outputLayerTwo);
+
+    LayerStack stack({&layerStateOne, &layerStateOne});
+    const auto stackKeys = stack.getApproximateMatchKeys();
+    const auto otherKeys = LayerStack::getApproximateMatchKeys({&layerStateOne, &layerStateTwo});
+    ASSERT_EQ(2u, stackKeys.size());
+    ASSERT_EQ(2u, otherKeys.size());
+    EXPECT_NE(stackKeys[0], otherKeys[0]);
+    EXPECT_EQ(stackKeys[1], otherKeys[1]);
+
+    EXPECT_EQ(stackKeys, LayerStack::getApproximateMatchKeys({&layerStateOne, &layerStateOne}));
+}
+
+TEST_F(LayerStackTest, getApproximateMatchKeys_ignoreClientCompositedLayers) {
+    mock::OutputLayer outputLayerOne;
+    sp<mock::LayerFE> layerFEOne = sp<mock::LayerFE>::make();
+    OutputLayerCompositionState outputLayerCompositionStateOne{
+            .forceClientComposition = true,
+            .displayFrame = sRectOne,
+    };
+    LayerFECompositionState layerFECompositionStateOne;
+    setupMocksForLayer(outputLayerOne, *layerFEOne, outputLayerCompositionStateOne,
+                       layerFECompositionStateOne);
+    LayerState layerStateOne(&outputLayerOne);
+
+    mock::OutputLayer outputLayerTwo;
+    sp<mock::LayerFE> layerFETwo = sp<mock::LayerFE>::make();
+    OutputLayerCompositionState outputLayerCompositionStateTwo{
+            .forceClientComposition = true,
+            .displayFrame = sRectTwo,
+    };
+    LayerFECompositionState layerFECompositionStateTwo;
+    setupMocksForLayer(outputLayerTwo, *layerFETwo, outputLayerCompositionStateTwo,
+                       layerFECompositionStateTwo);
+    LayerState layerStateTwo(&outputLayerTwo);
+
+    EXPECT_EQ(LayerStack::getApproximateMatchKeys({&layerStateOne}),
+              LayerStack::getApproximateMatchKeys({&layerStateTwo}));
+}
+
+TEST(PlanTest, packsManyLayers) {
+    const std::string planString = "DDDDCCCCSSSSUUUUBBBBAAAAIIII";
+    const auto plan = Plan::fromString(planString);
+    ASSERT_TRUE(plan);
+    EXPECT_EQ(planString.size(), plan->getLayerCount());
+    EXPECT_EQ(Composition::DEVICE, plan->getLayerType(0));
+    EXPECT_EQ(Composition::SOLID_COLOR, plan->getLayerType(8));
+    EXPECT_EQ(Composition::DISPLAY_DECORATION, plan->getLayerType(20));
+    EXPECT_EQ(planString, to_string(*plan));
+}
+
+TEST(PlanTest, comparesLayerCount) {
+    // INVALID packs to zero, so only the layer count tells these apart.
+    const auto plan = Plan::fromString("D");
+    const auto longerPlan = Plan::fromString("DI");
+    ASSERT_TRUE(plan);
+    ASSERT_TRUE(longerPlan);
+    EXPECT_NE(*plan, *longerPlan);
+    EXPECT_NE(std::hash<Plan>{}(*plan), std::hash<Plan>{}(*longerPlan));
+}
+
+TEST(PlanTest, equalPlansHashEqually) {
+    Plan plan;
+    plan.addLayerType(Composition::DEVICE);
+    plan.addLayerType(Composition::CLIENT);
+
+    const auto otherPlan = Plan::fromString("DC");
+    ASSERT_TRUE(otherPlan);
+    EXPECT_EQ(plan, *otherPlan);
+    EXPECT_EQ(std::hash<Plan>{}(plan), std::hash<Plan>{}(*otherPlan));
+
+    plan.reset();
+    EXPECT_EQ(0u, plan.getLayerCount());
+    EXPECT_EQ("", to_string(plan));
+}
+
 struct PredictionTest : public testing::Test {
     PredictionTest() {
         const ::testing::TestInfo* const test_info =
@@ -571,5 +669,70 @@ TEST_F(PredictorTest, recordMissedPlan_skipsApproximateMatch) {
     EXPECT_FALSE(predictedPlanTwo);
 }
 
+TEST_F(PredictorTest, getPredictedPlan_retrievesRecordedApproximateStack) {
+    SET_FLAG_FOR_TEST(com::android::graphics::surfaceflinger::flags::
+                              cache_when_source_crop_layer_only_moved,
+                      false);
+    mock::OutputLayer outputLayerOne;
+    sp<mock::LayerFE> layerFEOne = sp<mock::LayerFE>::make();
+    OutputLayerCompositionState outputLayerCompositionStateOne{
+            .sourceCrop = sFloatRectOne,
+    };
+    LayerFECompositionState layerFECompositionStateOne;
+    setupMocksForLayer(outputLayerOne, *layerFEOne, outputLayerCompositionStateOne,
+                       layerFECompositionStateOne);
+    LayerState layerStateOne(&outputLayerOne);
+
+    mock::OutputLayer outputLayerTwo;
+    sp<mock::LayerFE> layerFETwo = sp<mock::LayerFE>::make();
+    OutputLayerCompositionState outputLayerCompositionStateTwo{
+            .sourceCrop = sFloatRectTwo,
+    };
+    LayerFECompositionState layerFECompositionStateTwo;
+    setupMocksForLayer(outputLayerTwo, *layerFETwo, outputLayerCompositionStateTwo,
+                       layerFECompositionStateTwo);
+    LayerState layerStateTwo(&outputLayerTwo);
+
+    mock::OutputLayer outputLayerThree;
+    sp<mock::LayerFE> layerFEThree = sp<mock::LayerFE>::make();
+    OutputLayerCompositionState outputLayerCompositionStateThree{
+            .displayFrame = sRectTwo,
+            .sourceCrop = sFloatRectOne,
+    };
+    LayerFECompositionState layerFECompositionStateThree;
+    setupMocksForLayer(outputLayerThree, *layerFEThree, outputLayerCompositionStateThree,
+                       layerFECompositionStateThree);
+    LayerState layerStateThree(&outputLayerThree);
+
+    Plan plan;
+    plan.addLayerType(Composition::DEVICE);
+    plan.addLayerType(Composition::DEVICE);
+
+    Predictor predictor;
+
+    NonBufferHash hashOne = getNonBufferHash({&layerStateOne, &layerStateOne});
+    NonBufferHash hashTwo = getNonBufferHash({&layerStateOne, &layerStateTwo});
+    NonBufferHash hashThree = getNonBufferHash({&layerStateOne, &layerStateThree});
+
+    predictor.recordResult(std::nullopt, hashOne, {&layerStateOne, &layerStateOne}, false, plan);
+
+    // A hit promotes the candidate to a prediction, and records the approximate stack.
+    auto predictedPlan = predictor.getPredictedPlan({&layerStateOne, &layerStateTwo}, hashTwo);
+    ASSERT_TRUE(predictedPlan);
+    EXPECT_EQ(Prediction::Type::Approximate, predictedPlan->type);
+    predictor.recordResult(predictedPlan, hashTwo, {&layerStateOne, &layerStateTwo}, false, plan);
+
+    predictedPlan = predictor.getPredictedPlan({&layerStateOne, &layerStateTwo}, hashTwo);
+    Predictor::PredictedPlan expectedPlan{hashOne, plan, Prediction::Type::Approximate};
+    EXPECT_EQ(expectedPlan, predictedPlan);
+
+    // The same layer differs, but in other fields than the recorded approximate stack.
+    EXPECT_FALSE(predictor.getPredictedPlan({&layerStateOne, &layerStateThree}, hashThree));
+
+    // The recorded approximate stack does not match if another layer differs.
+    EXPECT_FALSE(predictor.getPredictedPlan({&layerStateTwo, &layerStateOne},
+                                            getNonBufferHash({&layerStateTwo, &layerStateOne})));
+}
+
 } // namespace
 } // namespace android::compositionengine::impl::planner
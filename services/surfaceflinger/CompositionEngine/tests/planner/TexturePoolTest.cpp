@@ -27,6 +27,8 @@ namespace {
 
 const ui::Size kDisplaySize(1, 1);
 const ui::Size kDisplaySizeTwo(2, 2);
+// Sized textures come in multiples of 10x20.
+const ui::Size kLargeDisplaySize(80, 160);
 
 class TestableTexturePool : public TexturePool {
 public:
@@ -35,8 +37,21 @@ public:
     size_t getMinPoolSize() const { return kMinPoolSize; }
     size_t getMaxPoolSize() const { return kMaxPoolSize; }
     size_t getPoolSize() const { return mPool.size(); }
+    size_t getRetainedPoolSize() const { return mMaxPoolSize; }
+    size_t getMaxDemandPoolSize() const { return kMaxDemandPoolSize; }
+    size_t getDemandWindow() const { return kDemandWindow; }
 };
 
+ui::Size getSize(const std::shared_ptr<TexturePool::AutoTexture>& texture) {
+    return texture->get()->getBuffer()->getBounds().getSize();
+}
+
+size_t getBytes(const std::shared_ptr<TexturePool::AutoTexture>& texture) {
+    const auto& buffer = texture->get()->getBuffer();
+    return static_cast<size_t>(std::max(buffer->getStride(), buffer->getWidth())) *
+            buffer->getHeight() * 4;
+}
+
 struct TexturePoolTest : public testing::Test {
     TexturePoolTest() {
         const ::testing::TestInfo* const test_info =
@@ -170,5 +185,115 @@ TEST_F(TexturePoolTest, reallocatesWhenReEnabled) {
     EXPECT_EQ(mTexturePool.getPoolSize(), mTexturePool.getMinPoolSize());
 }
 
+TEST_F(TexturePoolTest, ignoresSizeUnlessSizedTexturesEnabled) {
+    mTexturePool.setDisplaySize(kLargeDisplaySize);
+    auto texture = mTexturePool.borrowTexture(ui::Size(5, 5));
+    EXPECT_EQ(kLargeDisplaySize, getSize(texture));
+}
+
+TEST_F(TexturePoolTest, generatesBucketSizedTextures) {
+    mTexturePool.setSizedTexturesEnabled(true);
+    mTexturePool.setDisplaySize(kLargeDisplaySize);
+
+    EXPECT_EQ(ui::Size(20, 20), mTexturePool.getBucketSize(ui::Size(15, 5)));
+    EXPECT_EQ(ui::Size(10, 20), mTexturePool.getBucketSize(ui::Size(0, 0)));
+    EXPECT_EQ(kLargeDisplaySize, mTexturePool.getBucketSize(ui::Size(100, 200)));
+
+    // The preallocated display-sized textures are much too large.
+    auto texture = mTexturePool.borrowTexture(ui::Size(15, 5));
+    EXPECT_EQ(ui::Size(20, 20), getSize(texture));
+    EXPECT_EQ(mTexturePool.getMinPoolSize(), mTexturePool.getPoolSize());
+}
+
+TEST_F(TexturePoolTest, handsOutBestFit) {
+    mTexturePool.setSizedTexturesEnabled(true);
+    mTexturePool.setDisplaySize(kLargeDisplaySize);
+
+    auto small = mTexturePool.borrowTexture(ui::Size(20, 20));
+    auto medium = mTexturePool.borrowTexture(ui::Size(40, 40));
+    const uint64_t smallId = small->get()->getBuffer()->getId();
+    const uint64_t mediumId = medium->get()->getBuffer()->getId();
+    small.reset();
+    medium.reset();
+
+    auto texture = mTexturePool.borrowTexture(ui::Size(30, 30));
+    EXPECT_EQ(mediumId, texture->get()->getBuffer()->getId());
+    texture = mTexturePool.borrowTexture(ui::Size(15, 15));
+    EXPECT_EQ(smallId, texture->get()->getBuffer()->getId());
+    texture = mTexturePool.borrowTexture(ui::Size(75, 150));
+    EXPECT_EQ(kLargeDisplaySize, getSize(texture));
+}
+
+TEST_F(TexturePoolTest, evictsLeastRecentlyUsedOverMemoryBudget) {
+    std::vector<std::shared_ptr<TexturePool::AutoTexture>> textures;
+    for (size_t i = 0; i < mTexturePool.getMinPoolSize(); i++) {
+        textures.emplace_back(mTexturePool.borrowTexture());
+    }
+    const size_t textureBytes = getBytes(textures.front());
+    const uint64_t lastId = textures.back()->get()->getBuffer()->getId();
+
+    // Borrowed textures count towards the budget too, so returning them drops all but the last.
+    mTexturePool.setMemoryBudget(textureBytes);
+    EXPECT_EQ(0u, mTexturePool.getPoolSize());
+    for (auto& texture : textures) {
+        texture.reset();
+    }
+    EXPECT_EQ(1u, mTexturePool.getPoolSize());
+
+    auto texture = mTexturePool.borrowTexture();
+    EXPECT_EQ(lastId, texture->get()->getBuffer()->getId());
+}
+
+TEST_F(TexturePoolTest, ignoresDemandWithoutSizedTextures) {
+    mTexturePool.setDemand(mTexturePool.getMaxPoolSize() + 2);
+    EXPECT_EQ(mTexturePool.getMaxPoolSize(), mTexturePool.getRetainedPoolSize());
+
+    for (size_t i = 0; i < 2 * mTexturePool.getDemandWindow(); i++) {
+        mTexturePool.setDemand(1);
+    }
+    EXPECT_EQ(mTexturePool.getMaxPoolSize(), mTexturePool.getRetainedPoolSize());
+}
+
+TEST_F(TexturePoolTest, followsDemand) {
+    mTexturePool.setSizedTexturesEnabled(true);
+
+    // Growing happens right away.
+    mTexturePool.setDemand(mTexturePool.getMaxPoolSize() + 2);
+    EXPECT_EQ(mTexturePool.getMaxPoolSize() + 2, mTexturePool.getRetainedPoolSize());
+
+    std::vector<std::shared_ptr<TexturePool::AutoTexture>> textures;
+    for (size_t i = 0; i < mTexturePool.getMaxPoolSize() + 2; i++) {
+        textures.emplace_back(mTexturePool.borrowTexture());
+    }
+    textures.clear();
+    EXPECT_EQ(mTexturePool.getMaxPoolSize() + 2, mTexturePool.getPoolSize());
+
+    // Shrinking waits for the demand to stay low for a whole window.
+    for (size_t i = 0; i < mTexturePool.getDemandWindow(); i++) {
+        mTexturePool.setDemand(1);
+    }
+    EXPECT_EQ(mTexturePool.getMaxPoolSize() + 2, mTexturePool.getRetainedPoolSize());
+    for (size_t i = 0; i < mTexturePool.getDemandWindow(); i++) {
+        mTexturePool.setDemand(1);
+    }
+    EXPECT_EQ(1u, mTexturePool.getRetainedPoolSize());
+    EXPECT_EQ(1u, mTexturePool.getPoolSize());
+
+    mTexturePool.setDemand(100);
+    EXPECT_EQ(mTexturePool.getMaxDemandPoolSize(), mTexturePool.getRetainedPoolSize());
+}
+
+TEST_F(TexturePoolTest, dumpsHitRate) {
+    { auto texture = mTexturePool.borrowTexture(); }
+    std::vector<std::shared_ptr<TexturePool::AutoTexture>> textures;
+    for (size_t i = 0; i < mTexturePool.getMinPoolSize() + 1; i++) {
+        textures.emplace_back(mTexturePool.borrowTexture());
+    }
+
+    std::string dump;
+    mTexturePool.dump(dump);
+    EXPECT_NE(std::string::npos, dump.find("Hits: 4 of 5 borrows (80.0%)")) << dump;
+}
+
 } // namespace
 } // namespace android::compositionengine::impl::planner
@@ -895,27 +895,100 @@ namespace impl {
 int64_t TokenManager::generateTokenForPredictions(TimelineItem&& predictions) {
     SFTRACE_CALL();
     std::scoped_lock lock(mMutex);
-    while (mPredictions.size() >= kMaxTokens) {
-        mPredictions.erase(mPredictions.begin());
-    }
     const int64_t assignedToken = mCurrentToken++;
-    mPredictions[assignedToken] = predictions;
+    mPredictions[static_cast<size_t>(assignedToken) % kMaxTokens] = {assignedToken, predictions};
     return assignedToken;
 }
 
 std::optional<TimelineItem> TokenManager::getPredictionsForToken(int64_t token) const {
+    if (token < 0) {
+        return {};
+    }
     std::scoped_lock lock(mMutex);
-    auto predictionsIterator = mPredictions.find(token);
-    if (predictionsIterator != mPredictions.end()) {
-        return predictionsIterator->second;
+    const Prediction& prediction = mPredictions[static_cast<size_t>(token) % kMaxTokens];
+    if (prediction.token == token) {
+        return prediction.predictions;
     }
     return {};
 }
 
+// Keeps the memory of freed SurfaceFrames for the next ones. Each SurfaceFrame holds a reference
+// to the pool through its allocator, so SurfaceFrames can outlive FrameTimeline.
+class SurfaceFramePool {
+public:
+    SurfaceFramePool() { mFreeBlocks.reserve(kMaxFreeBlocks); }
+
+    ~SurfaceFramePool() {
+        for (void* block : mFreeBlocks) {
+            ::operator delete(block);
+        }
+    }
+
+    void* allocate(size_t size) {
+        {
+            std::scoped_lock lock(mMutex);
+            if (size == mBlockSize && !mFreeBlocks.empty()) {
+                void* block = mFreeBlocks.back();
+                mFreeBlocks.pop_back();
+                return block;
+            }
+        }
+        return ::operator new(size);
+    }
+
+    void deallocate(void* block, size_t size) {
+        {
+            std::scoped_lock lock(mMutex);
+            if (mBlockSize == 0) {
+                mBlockSize = size;
+            }
+            if (size == mBlockSize && mFreeBlocks.size() < kMaxFreeBlocks) {
+                mFreeBlocks.push_back(block);
+                return;
+            }
+        }
+        ::operator delete(block);
+    }
+
+private:
+    // Bounds the memory held by the pool. SurfaceFrames past this are freed as usual.
+    static constexpr size_t kMaxFreeBlocks = 256;
+
+    std::mutex mMutex;
+    // All blocks hold a SurfaceFrame and its shared_ptr control block.
+    size_t mBlockSize GUARDED_BY(mMutex) = 0;
+    std::vector<void*> mFreeBlocks GUARDED_BY(mMutex);
+};
+
+namespace {
+
+template <typename T>
+struct SurfaceFrameAllocator {
+    using value_type = T;
+
+    explicit SurfaceFrameAllocator(std::shared_ptr<SurfaceFramePool> pool)
+          : pool(std::move(pool)) {}
+    template <typename U>
+    SurfaceFrameAllocator(const SurfaceFrameAllocator<U>& other) : pool(other.pool) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(pool->allocate(n * sizeof(T))); }
+    void deallocate(T* p, size_t n) { pool->deallocate(p, n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const SurfaceFrameAllocator<U>& other) const {
+        return pool == other.pool;
+    }
+
+    std::shared_ptr<SurfaceFramePool> pool;
+};
+
+} // namespace
+
 FrameTimeline::FrameTimeline(std::shared_ptr<TimeStats> timeStats, pid_t surfaceFlingerPid,
                              JankClassificationThresholds thresholds, bool useBootTimeClock,
                              bool filterFramesBeforeTraceStarts)
-      : mUseBootTimeClock(useBootTimeClock),
+      : mSurfaceFramePool(std::make_shared<SurfaceFramePool>()),
+        mUseBootTimeClock(useBootTimeClock),
         mFilterFramesBeforeTraceStarts(
                 FlagManager::getInstance().filter_frames_before_trace_starts() &&
                 filterFramesBeforeTraceStarts),
@@ -944,27 +1017,30 @@ std::shared_ptr<SurfaceFrame> FrameTimeline::createSurfaceFrameForToken(
         const FrameTimelineInfo& frameTimelineInfo, pid_t ownerPid, uid_t ownerUid, int32_t layerId,
         std::string layerName, std::string debugName, bool isBuffer, GameMode gameMode) {
     SFTRACE_CALL();
+    const SurfaceFrameAllocator<SurfaceFrame> allocator(mSurfaceFramePool);
     if (frameTimelineInfo.vsyncId == FrameTimelineInfo::INVALID_VSYNC_ID) {
-        return std::make_shared<SurfaceFrame>(frameTimelineInfo, ownerPid, ownerUid, layerId,
-                                              std::move(layerName), std::move(debugName),
-                                              PredictionState::None, TimelineItem(), mTimeStats,
-                                              mJankClassificationThresholds, &mTraceCookieCounter,
-                                              isBuffer, gameMode);
+        return std::allocate_shared<SurfaceFrame>(allocator, frameTimelineInfo, ownerPid, ownerUid,
+                                                  layerId, std::move(layerName),
+                                                  std::move(debugName), PredictionState::None,
+                                                  TimelineItem(), mTimeStats,
+                                                  mJankClassificationThresholds,
+                                                  &mTraceCookieCounter, isBuffer, gameMode);
     }
     std::optional<TimelineItem> predictions =
             mTokenManager.getPredictionsForToken(frameTimelineInfo.vsyncId);
     if (predictions) {
-        return std::make_shared<SurfaceFrame>(frameTimelineInfo, ownerPid, ownerUid, layerId,
-                                              std::move(layerName), std::move(debugName),
-                                              PredictionState::Valid, std::move(*predictions),
-                                              mTimeStats, mJankClassificationThresholds,
-                                              &mTraceCookieCounter, isBuffer, gameMode);
-    }
-    return std::make_shared<SurfaceFrame>(frameTimelineInfo, ownerPid, ownerUid, layerId,
-                                          std::move(layerName), std::move(debugName),
-                                          PredictionState::Expired, TimelineItem(), mTimeStats,
-                                          mJankClassificationThresholds, &mTraceCookieCounter,
-                                          isBuffer, gameMode);
+        return std::allocate_shared<SurfaceFrame>(allocator, frameTimelineInfo, ownerPid, ownerUid,
+                                                  layerId, std::move(layerName),
+                                                  std::move(debugName), PredictionState::Valid,
+                                                  std::move(*predictions), mTimeStats,
+                                                  mJankClassificationThresholds,
+                                                  &mTraceCookieCounter, isBuffer, gameMode);
+    }
+    return std::allocate_shared<SurfaceFrame>(allocator, frameTimelineInfo, ownerPid, ownerUid,
+                                              layerId, std::move(layerName), std::move(debugName),
+                                              PredictionState::Expired, TimelineItem(), mTimeStats,
+                                              mJankClassificationThresholds, &mTraceCookieCounter,
+                                              isBuffer, gameMode);
 }
 
 FrameTimeline::DisplayFrame::DisplayFrame(std::shared_ptr<TimeStats> timeStats,
@@ -978,6 +1054,22 @@ FrameTimeline::DisplayFrame::DisplayFrame(std::shared_ptr<TimeStats> timeStats,
     mSurfaceFrames.reserve(kNumSurfaceFramesInitial);
 }
 
+void FrameTimeline::DisplayFrame::reset() {
+    mToken = FrameTimelineInfo::INVALID_VSYNC_ID;
+    mSurfaceFlingerPredictions = TimelineItem();
+    mSurfaceFlingerActuals = TimelineItem();
+    mSurfaceFrames.clear();
+    mPredictionState = PredictionState::None;
+    mJankType = JankType::None;
+    mJankSeverityType = JankSeverityType::None;
+    mGpuFence = FenceTime::NO_FENCE;
+    mFramePresentMetadata = FramePresentMetadata::UnknownPresent;
+    mFrameReadyMetadata = FrameReadyMetadata::UnknownFinish;
+    mFrameStartMetadata = FrameStartMetadata::UnknownStart;
+    mRefreshRate = Fps();
+    mRenderRate = Fps();
+}
+
 void FrameTimeline::addSurfaceFrame(std::shared_ptr<SurfaceFrame> surfaceFrame) {
     SFTRACE_CALL();
     std::scoped_lock lock(mMutex);
@@ -1008,9 +1100,8 @@ void FrameTimeline::onCommitNotComposited() {
     SFTRACE_CALL();
     std::scoped_lock lock(mMutex);
     mCurrentDisplayFrame->onCommitNotComposited();
-    mCurrentDisplayFrame.reset();
-    mCurrentDisplayFrame = std::make_shared<DisplayFrame>(mTimeStats, mJankClassificationThresholds,
-                                                          &mTraceCookieCounter);
+    recycleDisplayFrame(std::move(mCurrentDisplayFrame));
+    mCurrentDisplayFrame = makeDisplayFrame();
 }
 
 void FrameTimeline::DisplayFrame::addSurfaceFrame(std::shared_ptr<SurfaceFrame> surfaceFrame) {
@@ -1488,10 +1579,16 @@ void FrameTimeline::generateFrameStats(int32_t layer, size_t count, FrameStats*
     }
 }
 
-std::optional<size_t> FrameTimeline::getFirstSignalFenceIndex() const {
+std::optional<size_t> FrameTimeline::getFirstSignalFenceIndex() {
+    // Poll all the pending present fences at once, rather than one syscall per fence.
+    for (const auto& [fence, _] : mPendingPresentFences) {
+        mFenceTimeBatch.add(fence);
+    }
+    mFenceTimeBatch.updateSignalTimes();
+
     for (size_t i = 0; i < mPendingPresentFences.size(); i++) {
         const auto& [fence, _] = mPendingPresentFences[i];
-        if (fence && fence->getSignalTime() != Fence::SIGNAL_TIME_PENDING) {
+        if (fence && fence->getCachedSignalTime() != Fence::SIGNAL_TIME_PENDING) {
             return i;
         }
     }
@@ -1528,7 +1625,8 @@ void FrameTimeline::flushPendingPresentFences() {
         const auto& pendingPresentFence = mPendingPresentFences[i];
         nsecs_t signalTime = Fence::SIGNAL_TIME_INVALID;
         if (pendingPresentFence.first && pendingPresentFence.first->isValid()) {
-            signalTime = pendingPresentFence.first->getSignalTime();
+            // Already polled by getFirstSignalFenceIndex.
+            signalTime = pendingPresentFence.first->getCachedSignalTime();
             if (signalTime == Fence::SIGNAL_TIME_PENDING) {
                 break;
             }
@@ -1550,12 +1648,31 @@ void FrameTimeline::flushPendingPresentFences() {
 void FrameTimeline::finalizeCurrentDisplayFrame() {
     while (mDisplayFrames.size() >= mMaxDisplayFrames) {
         // We maintain only a fixed number of frames' data. Pop older frames
+        recycleDisplayFrame(std::move(mDisplayFrames.front()));
         mDisplayFrames.pop_front();
     }
-    mDisplayFrames.push_back(mCurrentDisplayFrame);
-    mCurrentDisplayFrame.reset();
-    mCurrentDisplayFrame = std::make_shared<DisplayFrame>(mTimeStats, mJankClassificationThresholds,
-                                                          &mTraceCookieCounter);
+    mDisplayFrames.push_back(std::move(mCurrentDisplayFrame));
+    mCurrentDisplayFrame = makeDisplayFrame();
+}
+
+std::shared_ptr<FrameTimeline::DisplayFrame> FrameTimeline::makeDisplayFrame() {
+    if (mFreeDisplayFrames.empty()) {
+        return std::make_shared<DisplayFrame>(mTimeStats, mJankClassificationThresholds,
+                                              &mTraceCookieCounter);
+    }
+    auto displayFrame = std::move(mFreeDisplayFrames.back());
+    mFreeDisplayFrames.pop_back();
+    return displayFrame;
+}
+
+void FrameTimeline::recycleDisplayFrame(std::shared_ptr<DisplayFrame>&& displayFrame) {
+    // A DisplayFrame still waiting for its present fence, or held elsewhere, is left alone.
+    if (displayFrame.use_count() != 1 || mFreeDisplayFrames.size() >= kMaxFreeDisplayFrames) {
+        displayFrame.reset();
+        return;
+    }
+    displayFrame->reset();
+    mFreeDisplayFrames.push_back(std::move(displayFrame));
 }
 
 nsecs_t FrameTimeline::DisplayFrame::getBaseTime() const {
@@ -1663,6 +1780,7 @@ void FrameTimeline::setMaxDisplayFrames(uint32_t size) {
     // The size can either increase or decrease, clear everything, to be consistent
     mDisplayFrames.clear();
     mPendingPresentFences.clear();
+    mFreeDisplayFrames.clear();
     mMaxDisplayFrames = size;
 }
 
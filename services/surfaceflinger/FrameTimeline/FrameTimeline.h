@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <deque>
@@ -23,6 +24,7 @@
 #include <mutex>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include <gui/ISurfaceComposer.h>
 #include <gui/JankInfo.h>
@@ -370,14 +372,22 @@ private:
     // Friend class for testing
     friend class android::frametimeline::FrameTimelineTest;
 
-    void flushTokens(nsecs_t flushTime) REQUIRES(mMutex);
+    static constexpr size_t kMaxTokens = 500;
+
+    struct Prediction {
+        int64_t token = FrameTimelineInfo::INVALID_VSYNC_ID;
+        TimelineItem predictions;
+    };
 
-    std::map<int64_t, TimelineItem> mPredictions GUARDED_BY(mMutex);
+    // Predictions for the last kMaxTokens tokens, indexed by token modulo kMaxTokens. A newer
+    // token overwrites the slot of the token that expires.
+    std::array<Prediction, kMaxTokens> mPredictions GUARDED_BY(mMutex);
     int64_t mCurrentToken GUARDED_BY(mMutex);
     mutable std::mutex mMutex;
-    static constexpr size_t kMaxTokens = 500;
 };
 
+class SurfaceFramePool;
+
 class FrameTimeline : public android::frametimeline::FrameTimeline {
 public:
     class FrameTimelineDataSource : public perfetto::DataSource<FrameTimelineDataSource> {
@@ -401,6 +411,9 @@ public:
         DisplayFrame(std::shared_ptr<TimeStats> timeStats, JankClassificationThresholds thresholds,
                      TraceCookieCounter* traceCookieCounter);
         virtual ~DisplayFrame() = default;
+        // Returns the DisplayFrame to its initial state so that it can be reused for another
+        // frame. The storage for SurfaceFrames is kept.
+        void reset();
         // Dumpsys interface - dumps only if the DisplayFrame itself is janky or is at least one
         // SurfaceFrame is janky.
         void dumpJank(std::string& result, nsecs_t baseTime, int displayFrameCount) const;
@@ -528,8 +541,10 @@ private:
     friend class android::frametimeline::FrameTimelineTest;
 
     void flushPendingPresentFences() REQUIRES(mMutex);
-    std::optional<size_t> getFirstSignalFenceIndex() const REQUIRES(mMutex);
+    std::optional<size_t> getFirstSignalFenceIndex() REQUIRES(mMutex);
     void finalizeCurrentDisplayFrame() REQUIRES(mMutex);
+    std::shared_ptr<DisplayFrame> makeDisplayFrame() REQUIRES(mMutex);
+    void recycleDisplayFrame(std::shared_ptr<DisplayFrame>&& displayFrame) REQUIRES(mMutex);
     void dumpAll(std::string& result);
     void dumpJank(std::string& result);
 
@@ -537,7 +552,13 @@ private:
     std::deque<std::shared_ptr<DisplayFrame>> mDisplayFrames GUARDED_BY(mMutex);
     std::vector<std::pair<std::shared_ptr<FenceTime>, std::shared_ptr<DisplayFrame>>>
             mPendingPresentFences GUARDED_BY(mMutex);
+    FenceTimeBatch mFenceTimeBatch GUARDED_BY(mMutex);
     std::shared_ptr<DisplayFrame> mCurrentDisplayFrame GUARDED_BY(mMutex);
+    // DisplayFrames that left the window and are no longer referenced, kept to avoid allocating
+    // a DisplayFrame and its SurfaceFrames storage on every frame.
+    std::vector<std::shared_ptr<DisplayFrame>> mFreeDisplayFrames GUARDED_BY(mMutex);
+    // Recycles the memory of SurfaceFrames, which are created for every layer on every frame.
+    const std::shared_ptr<SurfaceFramePool> mSurfaceFramePool;
     TokenManager mTokenManager;
     TraceCookieCounter mTraceCookieCounter;
     mutable std::mutex mMutex;
@@ -550,6 +571,8 @@ private:
     nsecs_t mPreviousPredictionPresentTime = 0;
     const JankClassificationThresholds mJankClassificationThresholds;
     static constexpr uint32_t kDefaultMaxDisplayFrames = 64;
+    // DisplayFrames leave the window one at a time, so a few free ones are enough.
+    static constexpr size_t kMaxFreeDisplayFrames = 4;
     // The initial container size for the vector<SurfaceFrames> inside display frame. Although
     // this number doesn't represent any bounds on the number of surface frames that can go in a
     // display frame, this is a good starting size for the vector so that we can avoid the
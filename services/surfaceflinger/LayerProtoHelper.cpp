@@ -75,6 +75,13 @@ void LayerProtoHelper::writeToProto(const Region& region,
     }
 }
 
+void LayerProtoHelper::writeToProto(const Region& region,
+                                    perfetto::protos::pbzero::RegionProto* regionProto) {
+    for (const Rect& rect : region) {
+        writeToProto(rect, regionProto->add_rect());
+    }
+}
+
 void LayerProtoHelper::readFromProto(const perfetto::protos::RegionProto& regionProto,
                                      Region& outRegion) {
     for (int i = 0; i < regionProto.rect_size(); i++) {
@@ -99,6 +106,14 @@ void LayerProtoHelper::writeToProto(const Rect& rect, perfetto::protos::RectProt
     rectProto->set_right(rect.right);
 }
 
+void LayerProtoHelper::writeToProto(const Rect& rect,
+                                    perfetto::protos::pbzero::RectProto* rectProto) {
+    rectProto->set_left(rect.left);
+    rectProto->set_top(rect.top);
+    rectProto->set_bottom(rect.bottom);
+    rectProto->set_right(rect.right);
+}
+
 void LayerProtoHelper::readFromProto(const perfetto::protos::RectProto& proto, Rect& outRect) {
     outRect.left = proto.left();
     outRect.top = proto.top();
@@ -222,6 +237,15 @@ void LayerProtoHelper::writeToProto(const mat4 matrix,
     }
 }
 
+void LayerProtoHelper::writeToProto(
+        const mat4 matrix, perfetto::protos::pbzero::ColorTransformProto* colorTransformProto) {
+    for (int i = 0; i < mat4::ROW_SIZE; i++) {
+        for (int j = 0; j < mat4::COL_SIZE; j++) {
+            colorTransformProto->add_val(matrix[i][j]);
+        }
+    }
+}
+
 void LayerProtoHelper::readFromProto(
         const perfetto::protos::ColorTransformProto& colorTransformProto, mat4& matrix) {
     for (int i = 0; i < mat4::ROW_SIZE; i++) {
@@ -245,6 +269,20 @@ void LayerProtoHelper::writeToProto(const android::BlurRegion region,
     proto->set_bottom(region.bottom);
 }
 
+void LayerProtoHelper::writeToProto(const android::BlurRegion region,
+                                    perfetto::protos::pbzero::BlurRegion* proto) {
+    proto->set_blur_radius(region.blurRadius);
+    proto->set_corner_radius_tl(region.cornerRadiusTL);
+    proto->set_corner_radius_tr(region.cornerRadiusTR);
+    proto->set_corner_radius_bl(region.cornerRadiusBL);
+    proto->set_corner_radius_br(region.cornerRadiusBR);
+    proto->set_alpha(region.alpha);
+    proto->set_left(region.left);
+    proto->set_top(region.top);
+    proto->set_right(region.right);
+    proto->set_bottom(region.bottom);
+}
+
 void LayerProtoHelper::readFromProto(const perfetto::protos::BlurRegion& proto,
                                      android::BlurRegion& outRegion) {
     outRegion.blurRadius = proto.blur_radius();
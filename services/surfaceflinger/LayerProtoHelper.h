@@ -43,6 +43,7 @@ public:
     static void writeToProto(const Rect& rect,
                              std::function<perfetto::protos::RectProto*()> getRectProto);
     static void writeToProto(const Rect& rect, perfetto::protos::RectProto* rectProto);
+    static void writeToProto(const Rect& rect, perfetto::protos::pbzero::RectProto* rectProto);
     static void readFromProto(const perfetto::protos::RectProto& proto, Rect& outRect);
     static void readFromProto(const perfetto::protos::RectProto& proto, FloatRect& outRect);
     static void writeToProto(const FloatRect& rect,
@@ -50,6 +51,8 @@ public:
     static void writeToProto(const Region& region,
                              std::function<perfetto::protos::RegionProto*()> getRegionProto);
     static void writeToProto(const Region& region, perfetto::protos::RegionProto* regionProto);
+    static void writeToProto(const Region& region,
+                             perfetto::protos::pbzero::RegionProto* regionProto);
     static void readFromProto(const perfetto::protos::RegionProto& regionProto, Region& outRegion);
     static void writeToProto(const half4 color,
                              std::function<perfetto::protos::ColorProto*()> getColorProto);
@@ -67,9 +70,13 @@ public:
             std::function<perfetto::protos::InputWindowInfoProto*()> getInputWindowInfoProto);
     static void writeToProto(const mat4 matrix,
                              perfetto::protos::ColorTransformProto* colorTransformProto);
+    static void writeToProto(const mat4 matrix,
+                             perfetto::protos::pbzero::ColorTransformProto* colorTransformProto);
     static void readFromProto(const perfetto::protos::ColorTransformProto& colorTransformProto,
                               mat4& matrix);
     static void writeToProto(const android::BlurRegion region, perfetto::protos::BlurRegion*);
+    static void writeToProto(const android::BlurRegion region,
+                             perfetto::protos::pbzero::BlurRegion*);
     static void readFromProto(const perfetto::protos::BlurRegion& proto,
                               android::BlurRegion& outRegion);
     static void writeSnapshotToProto(perfetto::protos::LayerProto* outProto,
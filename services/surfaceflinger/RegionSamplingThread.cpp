@@ -36,6 +36,8 @@
 #include <renderengine/impl/ExternalTexture.h>
 #include <ui/DisplayStatInfo.h>
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 
 #include "DisplayDevice.h"
@@ -61,6 +63,7 @@ constexpr auto defaultRegionSamplingWorkDuration = 3ms;
 constexpr auto defaultRegionSamplingPeriod = 100ms;
 constexpr auto defaultRegionSamplingTimerTimeout = 100ms;
 constexpr auto maxRegionSamplingDelay = 100ms;
+constexpr int32_t maxRegionSamplingDownscaleFactor = 16;
 // TODO: (b/127403193) duration to string conversion could probably be constexpr
 template <typename Rep, typename Per>
 inline std::string toNsString(std::chrono::duration<Rep, Per> t) {
@@ -94,9 +97,22 @@ RegionSamplingThread::EnvironmentTimingTunables::EnvironmentTimingTunables() {
     }
 }
 
+static int32_t getDownscaleFactor() {
+    const int32_t factor = property_get_int32("debug.sf.region_sampling_downscale", 1);
+    return std::clamp(factor, 1, maxRegionSamplingDownscaleFactor);
+}
+
+// Maps an area of the sampled bounds to the pixels of a capture downscaled by factor, including
+// the pixels it partially covers.
+static Rect downscaleArea(const Rect& area, int32_t factor) {
+    return Rect(area.left / factor, area.top / factor, (area.right + factor - 1) / factor,
+                (area.bottom + factor - 1) / factor);
+}
+
 RegionSamplingThread::RegionSamplingThread(SurfaceFlinger& flinger, const TimingTunables& tunables)
       : mFlinger(flinger),
         mTunables(tunables),
+        mDownscaleFactor(getDownscaleFactor()),
         mIdleTimer(
                 "RegSampIdle",
                 std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -194,53 +210,142 @@ void RegionSamplingThread::binderDied(const wp<IBinder>& who) {
     mDescriptors.erase(who);
 }
 
-float sampleArea(const uint32_t* data, int32_t width, int32_t height, int32_t stride,
-                 uint32_t orientation, const Rect& sample_area) {
-    if (!sample_area.isValid() || (sample_area.getWidth() > width) ||
-        (sample_area.getHeight() > height)) {
-        ALOGE("invalid sampling region requested");
-        return 0.0f;
+namespace {
+
+// Approximates the luma of Rec. 709 primaries, in [0, 255].
+uint32_t luma(uint32_t pixel) {
+    const uint32_t r = pixel & 0xFF;
+    const uint32_t g = (pixel >> 8) & 0xFF;
+    const uint32_t b = (pixel >> 16) & 0xFF;
+    return (r * 7 + b * 2 + g * 23) >> 5;
+}
+
+// Sums the luma of a run of RGBA pixels. The generic vector type lowers to NEON or SSE, and
+// handles eight pixels per iteration.
+uint32_t sumLuma(const uint32_t* pixels, int32_t count) {
+    typedef uint32_t Pixels __attribute__((vector_size(8 * sizeof(uint32_t))));
+    constexpr int32_t kLanes = sizeof(Pixels) / sizeof(uint32_t);
+
+    Pixels sums = {};
+    int32_t i = 0;
+    for (; i + kLanes <= count; i += kLanes) {
+        Pixels vector;
+        std::memcpy(&vector, pixels + i, sizeof(vector));
+        const Pixels r = vector & 0xFF;
+        const Pixels g = (vector >> 8) & 0xFF;
+        const Pixels b = (vector >> 16) & 0xFF;
+        sums += (r * 7 + b * 2 + g * 23) >> 5;
+    }
+
+    uint32_t sum = 0;
+    for (int32_t lane = 0; lane < kLanes; lane++) {
+        sum += sums[lane];
+    }
+    for (; i < count; i++) {
+        sum += luma(pixels[i]);
+    }
+    return sum;
+}
+
+// A run of columns covered by the same set of areas.
+struct Segment {
+    int32_t left;
+    int32_t right;
+    std::vector<size_t> areas;
+};
+
+} // namespace
+
+std::vector<float> sampleAreas(const uint32_t* data, int32_t width, int32_t height, int32_t stride,
+                               const std::vector<Rect>& areas) {
+    std::vector<float> lumas(areas.size(), 0.0f);
+
+    std::vector<size_t> validAreas;
+    std::vector<int32_t> rowBreaks;
+    for (size_t i = 0; i < areas.size(); i++) {
+        const Rect& area = areas[i];
+        if (area.isEmpty() || area.left < 0 || area.top < 0 || area.right > width ||
+            area.bottom > height) {
+            ALOGE("invalid sampling region requested");
+            continue;
+        }
+        validAreas.push_back(i);
+        rowBreaks.push_back(area.top);
+        rowBreaks.push_back(area.bottom);
     }
+    std::sort(rowBreaks.begin(), rowBreaks.end());
+    rowBreaks.erase(std::unique(rowBreaks.begin(), rowBreaks.end()), rowBreaks.end());
+
+    // Split the areas into bands of rows covered by the same areas, and the bands into segments
+    // of columns covered by the same areas. Each pixel is then read once, and its luma added to
+    // every area covering it.
+    std::vector<uint64_t> sums(areas.size(), 0);
+    std::vector<int32_t> columnBreaks;
+    std::vector<Segment> segments;
+    for (size_t band = 0; band + 1 < rowBreaks.size(); band++) {
+        const int32_t top = rowBreaks[band];
+        const int32_t bottom = rowBreaks[band + 1];
+
+        columnBreaks.clear();
+        for (const size_t i : validAreas) {
+            if (areas[i].top <= top && areas[i].bottom >= bottom) {
+                columnBreaks.push_back(areas[i].left);
+                columnBreaks.push_back(areas[i].right);
+            }
+        }
+        std::sort(columnBreaks.begin(), columnBreaks.end());
+        columnBreaks.erase(std::unique(columnBreaks.begin(), columnBreaks.end()),
+                           columnBreaks.end());
+
+        segments.clear();
+        for (size_t column = 0; column + 1 < columnBreaks.size(); column++) {
+            Segment segment{.left = columnBreaks[column], .right = columnBreaks[column + 1]};
+            for (const size_t i : validAreas) {
+                if (areas[i].top <= top && areas[i].bottom >= bottom &&
+                    areas[i].left <= segment.left && areas[i].right >= segment.right) {
+                    segment.areas.push_back(i);
+                }
+            }
+            if (!segment.areas.empty()) {
+                segments.push_back(std::move(segment));
+            }
+        }
 
-    const uint32_t pixelCount =
-            (sample_area.bottom - sample_area.top) * (sample_area.right - sample_area.left);
-    uint32_t accumulatedLuma = 0;
-
-    // Calculates luma with approximation of Rec. 709 primaries
-    for (int32_t row = sample_area.top; row < sample_area.bottom; ++row) {
-        const uint32_t* rowBase = data + row * stride;
-        for (int32_t column = sample_area.left; column < sample_area.right; ++column) {
-            uint32_t pixel = rowBase[column];
-            const uint32_t r = pixel & 0xFF;
-            const uint32_t g = (pixel >> 8) & 0xFF;
-            const uint32_t b = (pixel >> 16) & 0xFF;
-            const uint32_t luma = (r * 7 + b * 2 + g * 23) >> 5;
-            accumulatedLuma += luma;
+        for (int32_t row = top; row < bottom; row++) {
+            const uint32_t* rowBase = data + static_cast<ptrdiff_t>(row) * stride;
+            for (const Segment& segment : segments) {
+                const uint32_t sum =
+                        sumLuma(rowBase + segment.left, segment.right - segment.left);
+                for (const size_t i : segment.areas) {
+                    sums[i] += sum;
+                }
+            }
         }
     }
 
-    return accumulatedLuma / (255.0f * pixelCount);
+    for (const size_t i : validAreas) {
+        const uint64_t pixelCount = static_cast<uint64_t>(areas[i].getWidth()) *
+                static_cast<uint64_t>(areas[i].getHeight());
+        lumas[i] = static_cast<float>(sums[i]) / (255.0f * static_cast<float>(pixelCount));
+    }
+    return lumas;
+}
+
+float sampleArea(const uint32_t* data, int32_t width, int32_t height, int32_t stride,
+                 uint32_t orientation, const Rect& sample_area) {
+    return sampleAreas(data, width, height, stride, {sample_area}).front();
 }
 
-std::vector<float> RegionSamplingThread::sampleBuffer(
-        const sp<GraphicBuffer>& buffer, const Point& leftTop,
-        const std::vector<RegionSamplingThread::Descriptor>& descriptors, uint32_t orientation) {
+std::vector<float> RegionSamplingThread::sampleBuffer(const sp<GraphicBuffer>& buffer,
+                                                      const std::vector<Rect>& areas) {
     void* data_raw = nullptr;
     buffer->lock(GRALLOC_USAGE_SW_READ_OFTEN, &data_raw);
     std::shared_ptr<uint32_t> data(reinterpret_cast<uint32_t*>(data_raw),
                                    [&buffer](auto) { buffer->unlock(); });
     if (!data) return {};
 
-    const int32_t width = buffer->getWidth();
-    const int32_t height = buffer->getHeight();
-    const int32_t stride = buffer->getStride();
-    std::vector<float> lumas(descriptors.size());
-    std::transform(descriptors.begin(), descriptors.end(), lumas.begin(),
-                   [&](auto const& descriptor) {
-                       return sampleArea(data.get(), width, height, stride, orientation,
-                                         descriptor.area - leftTop);
-                   });
-    return lumas;
+    return sampleAreas(data.get(), buffer->getWidth(), buffer->getHeight(), buffer->getStride(),
+                       areas);
 }
 
 void RegionSamplingThread::captureSample() {
@@ -254,7 +359,6 @@ void RegionSamplingThread::captureSample() {
     wp<const DisplayDevice> displayWeak;
 
     ui::LayerStack layerStack;
-    ui::Transform::RotationFlags orientation;
     ui::Size displaySize;
     Rect layerStackSpaceRect;
 
@@ -263,7 +367,6 @@ void RegionSamplingThread::captureSample() {
         const sp<const DisplayDevice> display = mFlinger.getDefaultDisplayDevice();
         displayWeak = display;
         layerStack = display->getLayerStack();
-        orientation = ui::Transform::toRotationFlags(display->getOrientation());
         displaySize = display->getSize();
         layerStackSpaceRect = display->getLayerStackSpaceRect();
     }
@@ -323,15 +426,19 @@ void RegionSamplingThread::captureSample() {
     auto getLayerSnapshotsFn =
             mFlinger.getLayerSnapshotsForScreenshots(layerStack, CaptureArgs::UNSET_UID, filterFn);
 
+    // The capture covers the sampled bounds, scaled down by the GPU if enabled.
+    const Rect captureBounds = downscaleArea(sampledBounds - sampledBounds.leftTop(),
+                                             mDownscaleFactor);
+
     std::shared_ptr<renderengine::ExternalTexture> buffer = nullptr;
-    if (mCachedBuffer && mCachedBuffer->getBuffer()->getWidth() == sampledBounds.getWidth() &&
-        mCachedBuffer->getBuffer()->getHeight() == sampledBounds.getHeight()) {
+    if (mCachedBuffer && mCachedBuffer->getBuffer()->getWidth() == captureBounds.getWidth() &&
+        mCachedBuffer->getBuffer()->getHeight() == captureBounds.getHeight()) {
         buffer = mCachedBuffer;
     } else {
         const uint32_t usage =
                 GRALLOC_USAGE_SW_READ_OFTEN | GRALLOC_USAGE_HW_RENDER | GRALLOC_USAGE_HW_TEXTURE;
         sp<GraphicBuffer> graphicBuffer =
-                sp<GraphicBuffer>::make(sampledBounds.getWidth(), sampledBounds.getHeight(),
+                sp<GraphicBuffer>::make(captureBounds.getWidth(), captureBounds.getHeight(),
                                         PIXEL_FORMAT_RGBA_8888, 1, usage, "RegionSamplingThread");
         const status_t bufferStatus = graphicBuffer->initCheck();
         LOG_ALWAYS_FATAL_IF(bufferStatus != OK, "captureSample: Buffer failed to allocate: %d",
@@ -350,7 +457,7 @@ void RegionSamplingThread::captureSample() {
     screenshotArgs.captureTypeVariant = displayWeak;
     screenshotArgs.displayIdVariant = std::nullopt;
     screenshotArgs.sourceCrop = sampledBounds.isEmpty() ? layerStackSpaceRect : sampledBounds;
-    screenshotArgs.reqSize = sampledBounds.getSize();
+    screenshotArgs.reqSize = captureBounds.getSize();
     screenshotArgs.dataspace = ui::Dataspace::V0_SRGB;
     screenshotArgs.isSecure = true;
     screenshotArgs.seamlessTransition = false;
@@ -365,15 +472,17 @@ void RegionSamplingThread::captureSample() {
     }
 
     std::vector<Descriptor> activeDescriptors;
+    std::vector<Rect> areas;
     for (const auto& descriptor : descriptors) {
         if (listeners.count(descriptor.listener) != 0) {
             activeDescriptors.emplace_back(descriptor);
+            areas.push_back(
+                    downscaleArea(descriptor.area - sampledBounds.leftTop(), mDownscaleFactor));
         }
     }
 
     ALOGV("Sampling %zu descriptors", activeDescriptors.size());
-    std::vector<float> lumas = sampleBuffer(buffer->getBuffer(), sampledBounds.leftTop(),
-                                            activeDescriptors, orientation);
+    std::vector<float> lumas = sampleBuffer(buffer->getBuffer(), areas);
     if (lumas.size() != activeDescriptors.size()) {
         ALOGW("collected %zu median luma values for %zu descriptors", lumas.size(),
               activeDescriptors.size());
@@ -30,6 +30,7 @@
 #include <mutex>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "Scheduler/OneShotTimer.h"
 #include "WpHash.h"
@@ -45,6 +46,11 @@ using gui::IRegionSamplingListener;
 float sampleArea(const uint32_t* data, int32_t width, int32_t height, int32_t stride,
                  uint32_t orientation, const Rect& area);
 
+// Returns the mean luma of each area of an RGBA buffer, in a single pass over the buffer. Areas
+// that are empty or not within the buffer have a luma of 0.
+std::vector<float> sampleAreas(const uint32_t* data, int32_t width, int32_t height, int32_t stride,
+                               const std::vector<Rect>& areas);
+
 class RegionSamplingThread : public IBinder::DeathRecipient {
 public:
     struct TimingTunables {
@@ -91,9 +97,7 @@ private:
         sp<IRegionSamplingListener> listener;
     };
 
-    std::vector<float> sampleBuffer(
-            const sp<GraphicBuffer>& buffer, const Point& leftTop,
-            const std::vector<RegionSamplingThread::Descriptor>& descriptors, uint32_t orientation);
+    std::vector<float> sampleBuffer(const sp<GraphicBuffer>& buffer, const std::vector<Rect>& areas);
 
     void doSample(std::optional<std::chrono::steady_clock::time_point> samplingDeadline);
     void binderDied(const wp<IBinder>& who) override;
@@ -104,6 +108,10 @@ private:
 
     SurfaceFlinger& mFlinger;
     const TimingTunables mTunables;
+    // debug.sf.region_sampling_downscale
+    // If greater than 1, the sampled area is captured at this fraction of its size in each
+    // dimension, so that the GPU does most of the averaging and less memory is read back.
+    const int32_t mDownscaleFactor;
     scheduler::OneShotTimer mIdleTimer;
 
     std::thread mThread;
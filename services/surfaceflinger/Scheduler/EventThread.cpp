@@ -31,6 +31,7 @@
 #include <utility>
 
 #include <android-base/stringprintf.h>
+#include <ftl/small_map.h>
 
 #include <binder/IPCThreadState.h>
 #include <common/trace.h>
@@ -80,8 +81,9 @@ std::string toString(VSyncRequest request) {
 }
 
 std::string toString(const EventThreadConnection& connection) {
-    return StringPrintf("Connection{%p, %s}", &connection,
-                        toString(connection.vsyncRequest).c_str());
+    return StringPrintf("Connection{%p, %s%s}", &connection,
+                        toString(connection.vsyncRequest).c_str(),
+                        connection.vsyncBroadcast ? ", broadcast" : "");
 }
 
 std::string toString(const DisplayEventReceiver::Event& event) {
@@ -265,6 +267,13 @@ binder::Status EventThreadConnection::getSchedulingPolicy(gui::SchedulingPolicy*
     return gui::getSchedulingPolicy(outPolicy);
 }
 
+binder::Status EventThreadConnection::getVsyncBroadcast(gui::VsyncBroadcastChannel* outChannel) {
+    SFTRACE_CALL();
+    return binder::Status::fromStatusT(
+            mEventThread->enableVsyncBroadcast(sp<EventThreadConnection>::fromExisting(this),
+                                               outChannel));
+}
+
 status_t EventThreadConnection::postEvent(const DisplayEventReceiver::Event& event) {
     constexpr auto toStatus = [](ssize_t size) {
         return size < 0 ? status_t(size) : status_t(NO_ERROR);
@@ -433,6 +442,21 @@ VsyncEventData EventThread::getLatestVsyncEventData(const sp<EventThreadConnecti
     return vsyncEventData;
 }
 
+status_t EventThread::enableVsyncBroadcast(const sp<EventThreadConnection>& connection,
+                                           gui::VsyncBroadcastChannel* outChannel) {
+    if (!connection->mEventRegistration.test(
+                gui::ISurfaceComposer::EventRegistration::vsyncBroadcast)) {
+        return INVALID_OPERATION;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (connection->vsyncBroadcast) {
+        return ALREADY_EXISTS;
+    }
+    return gui::VsyncBroadcastPublisher::create(connection->vsyncBroadcast, *outChannel);
+}
+
 void EventThread::enableSyntheticVsync(bool enable) {
     std::lock_guard<std::mutex> lock(mMutex);
     if (!mVSyncState || mVSyncState->synthetic == enable) {
@@ -753,16 +777,33 @@ void EventThread::generateFrameTimeline(VsyncEventData& outVsyncEventData, nsecs
 
 void EventThread::dispatchEvent(const DisplayEventReceiver::Event& event,
                                 const DisplayEventConsumers& consumers) {
+    // The frame interval is looked up once per uid. The frame timelines are still generated for
+    // every connection, so that no two connections share prediction tokens.
+    ftl::SmallMap<uid_t, nsecs_t, 4> frameIntervalsByUid;
+
     for (const auto& consumer : consumers) {
         DisplayEventReceiver::Event copy = event;
         if (event.header.type == DisplayEventType::DISPLAY_EVENT_VSYNC) {
-            const Period frameInterval = mCallback.getVsyncPeriod(consumer->mOwnerUid);
-            copy.vsync.vsyncData.frameInterval = frameInterval.ns();
-            generateFrameTimeline(copy.vsync.vsyncData, frameInterval.ns(), copy.header.timestamp,
+            auto intervalIt = frameIntervalsByUid.find(consumer->mOwnerUid);
+            if (intervalIt == frameIntervalsByUid.end()) {
+                intervalIt = frameIntervalsByUid
+                                     .try_emplace(consumer->mOwnerUid,
+                                                  mCallback.getVsyncPeriod(consumer->mOwnerUid)
+                                                          .ns())
+                                     .first;
+            }
+            const nsecs_t frameInterval = intervalIt->second;
+            copy.vsync.vsyncData.frameInterval = frameInterval;
+            generateFrameTimeline(copy.vsync.vsyncData, frameInterval, copy.header.timestamp,
                                   event.vsync.vsyncData.preferredExpectedPresentationTime(),
                                   event.vsync.vsyncData.preferredDeadlineTimestamp());
         }
-        switch (consumer->postEvent(copy)) {
+        const bool broadcast =
+                event.header.type == DisplayEventType::DISPLAY_EVENT_VSYNC &&
+                consumer->vsyncBroadcast;
+        const status_t status =
+                broadcast ? consumer->vsyncBroadcast->publish(copy) : consumer->postEvent(copy);
+        switch (status) {
             case NO_ERROR:
                 break;
 
@@ -19,6 +19,7 @@
 #include <android-base/thread_annotations.h>
 #include <android/gui/BnDisplayEventConnection.h>
 #include <gui/DisplayEventReceiver.h>
+#include <gui/VsyncBroadcast.h>
 #include <private/gui/BitTube.h>
 #include <sys/types.h>
 #include <ui/DisplayId.h>
@@ -80,6 +81,7 @@ public:
     binder::Status requestNextVsync() override; // asynchronous
     binder::Status getLatestVsyncEventData(ParcelableVsyncEventData* outVsyncEventData) override;
     binder::Status getSchedulingPolicy(gui::SchedulingPolicy* outPolicy) override;
+    binder::Status getVsyncBroadcast(gui::VsyncBroadcastChannel* outChannel) override;
 
     VSyncRequest vsyncRequest = VSyncRequest::None;
     const uid_t mOwnerUid;
@@ -88,6 +90,9 @@ public:
     /** The frame rate set to the attached choreographer. */
     Fps frameRate;
 
+    /** Set once vsync events are broadcast to the connection instead of posted to it. */
+    std::unique_ptr<gui::VsyncBroadcastPublisher> vsyncBroadcast;
+
 private:
     virtual void onFirstRef();
     EventThread* const mEventThread;
@@ -135,6 +140,9 @@ public:
     virtual void requestNextVsync(const sp<EventThreadConnection>& connection) = 0;
     virtual VsyncEventData getLatestVsyncEventData(const sp<EventThreadConnection>& connection,
                                                    nsecs_t now) const = 0;
+    // Broadcasts the vsync events of a connection registered for it, through the returned channel.
+    virtual status_t enableVsyncBroadcast(const sp<EventThreadConnection>& connection,
+                                          gui::VsyncBroadcastChannel* outChannel) = 0;
 
     virtual void onNewVsyncSchedule(std::shared_ptr<scheduler::VsyncSchedule>) = 0;
 
@@ -168,6 +176,8 @@ public:
     void requestNextVsync(const sp<EventThreadConnection>& connection) override;
     VsyncEventData getLatestVsyncEventData(const sp<EventThreadConnection>& connection,
                                            nsecs_t now) const override;
+    status_t enableVsyncBroadcast(const sp<EventThreadConnection>& connection,
+                                  gui::VsyncBroadcastChannel* outChannel) override;
 
     void enableSyntheticVsync(bool) override;
 
@@ -40,6 +40,7 @@ class VSyncDispatch {
 public:
     struct CallbackToken : ftl::DefaultConstructible<CallbackToken, size_t>,
                            ftl::Equatable<CallbackToken>,
+                           ftl::Orderable<CallbackToken>,
                            ftl::Incrementable<CallbackToken> {
         using DefaultConstructible::DefaultConstructible;
     };
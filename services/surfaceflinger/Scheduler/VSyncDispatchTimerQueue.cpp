@@ -16,6 +16,7 @@
 
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 
+#include <algorithm>
 #include <vector>
 
 #include <android-base/stringprintf.h>
@@ -282,6 +283,110 @@ void VSyncDispatchTimerQueueEntry::dump(std::string& result) const {
     }
 }
 
+void VSyncWakeupQueue::set(CallbackToken token, nsecs_t wakeupTime) {
+    const auto it = mPositions.find(ftl::to_underlying(token));
+    if (it == mPositions.end()) {
+        mHeap.push_back({wakeupTime, token});
+        mPositions[ftl::to_underlying(token)] = mHeap.size() - 1;
+        siftUp(mHeap.size() - 1);
+        return;
+    }
+
+    const size_t index = it->second;
+    const nsecs_t previousTime = mHeap[index].time;
+    mHeap[index].time = wakeupTime;
+    if (wakeupTime < previousTime) {
+        siftUp(index);
+    } else {
+        siftDown(index);
+    }
+}
+
+void VSyncWakeupQueue::erase(CallbackToken token) {
+    const auto it = mPositions.find(ftl::to_underlying(token));
+    if (it == mPositions.end()) {
+        return;
+    }
+
+    const size_t index = it->second;
+    const size_t last = mHeap.size() - 1;
+    if (index != last) {
+        swapNodes(index, last);
+    }
+    mHeap.pop_back();
+    mPositions.erase(ftl::to_underlying(token));
+
+    if (index < mHeap.size()) {
+        siftUp(index);
+        siftDown(index);
+    }
+}
+
+bool VSyncWakeupQueue::contains(CallbackToken token) const {
+    return mPositions.count(ftl::to_underlying(token)) > 0;
+}
+
+auto VSyncWakeupQueue::top() const -> std::optional<Wakeup> {
+    if (mHeap.empty()) {
+        return {};
+    }
+    return mHeap.front();
+}
+
+auto VSyncWakeupQueue::pop() -> std::optional<Wakeup> {
+    const auto wakeup = top();
+    if (wakeup) {
+        erase(wakeup->token);
+    }
+    return wakeup;
+}
+
+auto VSyncWakeupQueue::tokens() const -> std::vector<CallbackToken> {
+    std::vector<CallbackToken> tokens;
+    tokens.reserve(mHeap.size());
+    for (const auto& wakeup : mHeap) {
+        tokens.push_back(wakeup.token);
+    }
+    std::sort(tokens.begin(), tokens.end());
+    return tokens;
+}
+
+void VSyncWakeupQueue::swapNodes(size_t a, size_t b) {
+    std::swap(mHeap[a], mHeap[b]);
+    mPositions[ftl::to_underlying(mHeap[a].token)] = a;
+    mPositions[ftl::to_underlying(mHeap[b].token)] = b;
+}
+
+void VSyncWakeupQueue::siftUp(size_t index) {
+    while (index > 0) {
+        const size_t parent = (index - 1) / 2;
+        if (!before(mHeap[index], mHeap[parent])) {
+            break;
+        }
+        swapNodes(index, parent);
+        index = parent;
+    }
+}
+
+void VSyncWakeupQueue::siftDown(size_t index) {
+    while (true) {
+        const size_t left = 2 * index + 1;
+        const size_t right = left + 1;
+        size_t smallest = index;
+        if (left < mHeap.size() && before(mHeap[left], mHeap[smallest])) {
+            smallest = left;
+        }
+        if (right < mHeap.size() && before(mHeap[right], mHeap[smallest])) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        swapNodes(index, smallest);
+        index = smallest;
+    }
+}
+
 VSyncDispatchTimerQueue::VSyncDispatchTimerQueue(std::unique_ptr<TimeKeeper> tk,
                                                  VsyncSchedule::TrackerPtr tracker,
                                                  nsecs_t timerSlack, nsecs_t minVsyncDistance)
@@ -312,38 +417,61 @@ void VSyncDispatchTimerQueue::setTimer(nsecs_t targetTime, nsecs_t /*now*/) {
     mLastTimerSchedule = mTimeKeeper->now();
 }
 
+nsecs_t VSyncDispatchTimerQueue::timerSlack() const {
+    // A confident model allows callbacks to be woken closer to their intended time.
+    const auto confidenceOpt = mTracker->predictionConfidenceInterval();
+    if (!confidenceOpt) {
+        return mTimerSlack;
+    }
+    return std::min(mTimerSlack, confidenceOpt->ns());
+}
+
 void VSyncDispatchTimerQueue::rearmTimer(nsecs_t now) {
     rearmTimerSkippingUpdateFor(now, mCallbacks.cend());
 }
 
+void VSyncDispatchTimerQueue::updateWakeupQueue(CallbackMap::const_iterator it) {
+    if (const auto wakeupTime = it->second->wakeupTime()) {
+        mWakeupQueue.set(it->first, *wakeupTime);
+    } else {
+        mWakeupQueue.erase(it->first);
+    }
+}
+
 void VSyncDispatchTimerQueue::rearmTimerSkippingUpdateFor(
         nsecs_t now, CallbackMap::const_iterator skipUpdateIt) {
     SFTRACE_CALL();
-    std::optional<nsecs_t> min;
-    std::optional<nsecs_t> targetVsync;
-    std::optional<std::string_view> nextWakeupName;
-    for (auto it = mCallbacks.cbegin(); it != mCallbacks.cend(); ++it) {
-        auto& callback = it->second;
-        if (!callback->wakeupTime() && !callback->hasPendingWorkloadUpdate()) {
+
+    // Only armed callbacks and callbacks with a pending workload update can have a wakeup, so
+    // the disarmed ones are not visited at all.
+    auto tokens = mWakeupQueue.tokens();
+    if (!mPendingWorkloadUpdates.empty()) {
+        tokens.insert(tokens.end(), mPendingWorkloadUpdates.begin(),
+                      mPendingWorkloadUpdates.end());
+        std::sort(tokens.begin(), tokens.end());
+        tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+        mPendingWorkloadUpdates.clear();
+    }
+
+    for (const auto token : tokens) {
+        const auto it = mCallbacks.find(token);
+        if (it == mCallbacks.cend()) {
+            mWakeupQueue.erase(token);
             continue;
         }
 
+        auto& callback = it->second;
         if (it != skipUpdateIt) {
             callback->update(*mTracker, now);
         }
 
         traceEntry(*callback, now);
-
-        const auto wakeupTime = *callback->wakeupTime();
-        if (!min || *min > wakeupTime) {
-            nextWakeupName = callback->name();
-            min = wakeupTime;
-            targetVsync = callback->targetVsync();
-        }
+        updateWakeupQueue(it);
     }
 
-    if (min && min < mIntendedWakeupTime) {
-        setTimer(*min, now);
+    const auto nextWakeup = mWakeupQueue.top();
+    if (nextWakeup && nextWakeup->time < mIntendedWakeupTime) {
+        setTimer(nextWakeup->time, now);
     } else {
         SFTRACE_NAME("cancel timer");
         cancelTimer();
@@ -366,8 +494,23 @@ void VSyncDispatchTimerQueue::timerCallback() {
             return;
         }
         auto const now = mTimeKeeper->now();
+        auto const timerSlack = this->timerSlack();
         mLastTimerCallback = now;
-        for (auto it = mCallbacks.begin(); it != mCallbacks.end(); it++) {
+        auto const lagAllowance = std::max(now - mIntendedWakeupTime, static_cast<nsecs_t>(0));
+        auto const dispatchThreshold = mIntendedWakeupTime + timerSlack + lagAllowance;
+
+        std::vector<CallbackToken> dueTokens;
+        while (!mWakeupQueue.empty() && mWakeupQueue.top()->time < dispatchThreshold) {
+            dueTokens.push_back(mWakeupQueue.pop()->token);
+        }
+
+        // Invoke the due callbacks in registration order, independently of their wakeup order.
+        std::sort(dueTokens.begin(), dueTokens.end());
+        for (const auto token : dueTokens) {
+            const auto it = mCallbacks.find(token);
+            if (it == mCallbacks.end()) {
+                continue;
+            }
             auto& callback = it->second;
             auto const wakeupTime = callback->wakeupTime();
             if (!wakeupTime) {
@@ -377,12 +520,9 @@ void VSyncDispatchTimerQueue::timerCallback() {
             traceEntry(*callback, now);
 
             auto const readyTime = callback->readyTime();
-            auto const lagAllowance = std::max(now - mIntendedWakeupTime, static_cast<nsecs_t>(0));
-            if (*wakeupTime < mIntendedWakeupTime + mTimerSlack + lagAllowance) {
-                callback->executing();
-                invocations.emplace_back(Invocation{callback, *callback->lastExecutedVsyncTarget(),
-                                                    *wakeupTime, *readyTime});
-            }
+            callback->executing();
+            invocations.emplace_back(Invocation{callback, *callback->lastExecutedVsyncTarget(),
+                                                *wakeupTime, *readyTime});
         }
 
         mIntendedWakeupTime = kInvalidTime;
@@ -415,7 +555,9 @@ void VSyncDispatchTimerQueue::unregisterCallback(CallbackToken token) {
         auto it = mCallbacks.find(token);
         if (it != mCallbacks.end()) {
             entry = it->second;
-            mCallbacks.erase(it->first);
+            mWakeupQueue.erase(it->first);
+            mPendingWorkloadUpdates.erase(it->first);
+            mCallbacks.erase(it);
         }
     }
 
@@ -443,12 +585,14 @@ std::optional<ScheduleResult> VSyncDispatchTimerQueue::scheduleLocked(
      * timer recalculation to avoid cancelling a callback that is about to fire. */
     auto const rearmImminent = now > mIntendedWakeupTime;
     if (CC_UNLIKELY(rearmImminent)) {
+        mPendingWorkloadUpdates.insert(token);
         return callback->addPendingWorkloadUpdate(*mTracker, now, scheduleTiming);
     }
 
     const auto result = callback->schedule(scheduleTiming, *mTracker, now);
+    updateWakeupQueue(it);
 
-    if (callback->wakeupTime() < mIntendedWakeupTime - mTimerSlack) {
+    if (callback->wakeupTime() < mIntendedWakeupTime - timerSlack()) {
         rearmTimerSkippingUpdateFor(now, it);
     }
 
@@ -483,6 +627,7 @@ CancelResult VSyncDispatchTimerQueue::cancel(CallbackToken token) {
     auto const wakeupTime = callback->wakeupTime();
     if (wakeupTime) {
         callback->disarm();
+        mWakeupQueue.erase(token);
 
         if (*wakeupTime == mIntendedWakeupTime) {
             mIntendedWakeupTime = kInvalidTime;
@@ -16,13 +16,16 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include <android-base/thread_annotations.h>
-#include <ftl/small_map.h>
 
 #include "VSyncDispatch.h"
 #include "VsyncSchedule.h"
@@ -110,6 +113,45 @@ private:
     bool mRunning GUARDED_BY(mRunningMutex) = false;
 };
 
+// VSyncWakeupQueue is a min-heap of callback tokens ordered by wakeup time, hoisted to public for
+// unit testing. The heap position of each token is indexed so that a wakeup can be moved or
+// removed in O(log n).
+class VSyncWakeupQueue {
+public:
+    using CallbackToken = VSyncDispatch::CallbackToken;
+
+    struct Wakeup {
+        nsecs_t time;
+        CallbackToken token;
+    };
+
+    // Inserts the token, or moves it to the new wakeup time if it is already queued.
+    void set(CallbackToken, nsecs_t wakeupTime);
+    void erase(CallbackToken);
+    bool contains(CallbackToken) const;
+
+    std::optional<Wakeup> top() const;
+    std::optional<Wakeup> pop();
+
+    size_t size() const { return mHeap.size(); }
+    bool empty() const { return mHeap.empty(); }
+
+    // Returns the queued tokens in ascending token order.
+    std::vector<CallbackToken> tokens() const;
+
+private:
+    static bool before(const Wakeup& lhs, const Wakeup& rhs) {
+        return lhs.time < rhs.time || (lhs.time == rhs.time && lhs.token < rhs.token);
+    }
+
+    void swapNodes(size_t, size_t);
+    void siftUp(size_t);
+    void siftDown(size_t);
+
+    std::vector<Wakeup> mHeap;
+    std::unordered_map<size_t, size_t> mPositions;
+};
+
 /*
  * VSyncDispatchTimerQueue is a class that will dispatch callbacks as per VSyncDispatch interface
  * using a single timer queue.
@@ -138,16 +180,17 @@ private:
     VSyncDispatchTimerQueue(const VSyncDispatchTimerQueue&) = delete;
     VSyncDispatchTimerQueue& operator=(const VSyncDispatchTimerQueue&) = delete;
 
-    // The static capacity was chosen to exceed the expected number of callbacks.
-    using CallbackMap =
-            ftl::SmallMap<CallbackToken, std::shared_ptr<VSyncDispatchTimerQueueEntry>, 5>;
+    // Ordered by token, so that callbacks are updated and invoked in registration order.
+    using CallbackMap = std::map<CallbackToken, std::shared_ptr<VSyncDispatchTimerQueueEntry>>;
 
     void timerCallback();
     void setTimer(nsecs_t, nsecs_t) REQUIRES(mMutex);
+    nsecs_t timerSlack() const REQUIRES(mMutex);
     void rearmTimer(nsecs_t now) REQUIRES(mMutex);
     void rearmTimerSkippingUpdateFor(nsecs_t now, CallbackMap::const_iterator skipUpdate)
             REQUIRES(mMutex);
     void cancelTimer() REQUIRES(mMutex);
+    void updateWakeupQueue(CallbackMap::const_iterator) REQUIRES(mMutex);
     std::optional<ScheduleResult> scheduleLocked(CallbackToken, ScheduleTiming) REQUIRES(mMutex);
 
     std::mutex mutable mMutex;
@@ -165,6 +208,11 @@ private:
     CallbackToken mCallbackToken GUARDED_BY(mMutex);
 
     CallbackMap mCallbacks GUARDED_BY(mMutex);
+
+    // The armed callbacks, and the callbacks whose workload update is deferred to the next rearm.
+    // Only these need to be visited when the timer is rearmed or fires.
+    VSyncWakeupQueue mWakeupQueue GUARDED_BY(mMutex);
+    std::set<CallbackToken> mPendingWorkloadUpdates GUARDED_BY(mMutex);
     nsecs_t mIntendedWakeupTime GUARDED_BY(mMutex) = kInvalidTime;
 
     // For debugging purposes
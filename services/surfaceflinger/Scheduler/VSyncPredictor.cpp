@@ -25,6 +25,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <sstream>
 
 #include <android-base/logging.h>
@@ -54,17 +55,125 @@ int numVsyncsPerFrame(const ftl::NonNull<DisplayModePtr>& displayModePtr) {
 }
 } // namespace
 
+RobustVsyncModel::RobustVsyncModel(size_t historySize)
+      : mForgettingFactor(1.0 - 1.0 / static_cast<double>(std::max(historySize, size_t(2)))) {}
+
+void RobustVsyncModel::reset(nsecs_t idealPeriod) {
+    // Initial uncertainty of the parameters, in units of the residual variance. The display mode
+    // gives a good prior for the period, while nothing is known about the phase.
+    static constexpr double kInitialSlopeCovariance = 0.01;
+    static constexpr double kInitialInterceptCovariance = 100.0;
+    // Fence timestamps are expected to be within 10% of the ideal period before the model has
+    // learned the actual noise, and never closer than 50us.
+    static constexpr double kInitialNoiseRatio = 0.1;
+    static constexpr double kMinResidualStdDevNs = 50'000.0;
+
+    mOrigin = 0;
+    mSlope = static_cast<double>(idealPeriod);
+    mIntercept = 0;
+    mCovariance[0][0] = kInitialSlopeCovariance;
+    mCovariance[0][1] = 0;
+    mCovariance[1][0] = 0;
+    mCovariance[1][1] = kInitialInterceptCovariance;
+    mResidualVariance = std::pow(kInitialNoiseRatio * mSlope, 2);
+    mMinResidualVariance = kMinResidualStdDevNs * kMinResidualStdDevNs;
+    mSampleCount = 0;
+}
+
+void RobustVsyncModel::addSample(nsecs_t timestamp) {
+    // Residuals beyond kHuberThreshold standard deviations get a linearly decaying weight.
+    static constexpr double kHuberThreshold = 1.345;
+
+    if (mSampleCount == 0 || mSlope <= 0) {
+        mOrigin = timestamp;
+        mIntercept = 0;
+        mSampleCount = 1;
+        return;
+    }
+
+    const double y = static_cast<double>(timestamp - mOrigin);
+    const double ordinal = std::round((y - mIntercept) / mSlope);
+    if (ordinal <= 0) {
+        // Duplicate or out of order sample.
+        return;
+    }
+
+    const double residual = y - (mSlope * ordinal + mIntercept);
+    const double threshold =
+            kHuberThreshold * std::sqrt(std::max(mResidualVariance, mMinResidualVariance));
+    const double weight = std::abs(residual) <= threshold ? 1.0 : threshold / std::abs(residual);
+
+    // Recursive least squares update of [slope, intercept] for the regressor [ordinal, 1].
+    // The covariance is symmetric, so P * x is also x' * P.
+    auto& p = mCovariance;
+    const double px0 = p[0][0] * ordinal + p[0][1];
+    const double px1 = p[1][0] * ordinal + p[1][1];
+    const double denominator = mForgettingFactor / weight + ordinal * px0 + px1;
+    const double gain0 = px0 / denominator;
+    const double gain1 = px1 / denominator;
+
+    mSlope += gain0 * residual;
+    mIntercept += gain1 * residual;
+
+    p[0][0] = (p[0][0] - gain0 * px0) / mForgettingFactor;
+    p[0][1] = (p[0][1] - gain0 * px1) / mForgettingFactor;
+    p[1][0] = (p[1][0] - gain1 * px0) / mForgettingFactor;
+    p[1][1] = (p[1][1] - gain1 * px1) / mForgettingFactor;
+
+    mResidualVariance = mForgettingFactor * mResidualVariance +
+            (1.0 - mForgettingFactor) * weight * residual * residual;
+
+    // Move ordinal 0 to this sample. The intercept absorbs the rounding of the shift and the
+    // covariance is transformed by [[1, 0], [ordinal, 1]].
+    const double shifted = mSlope * ordinal + mIntercept;
+    const auto shift = static_cast<nsecs_t>(std::llround(shifted));
+    mOrigin += shift;
+    mIntercept = shifted - static_cast<double>(shift);
+
+    const double p00 = p[0][0];
+    const double p01 = p[0][1];
+    p[1][1] = ordinal * ordinal * p00 + 2 * ordinal * p01 + p[1][1];
+    p[0][1] = p[1][0] = ordinal * p00 + p01;
+
+    mSampleCount++;
+}
+
+nsecs_t RobustVsyncModel::slope() const {
+    return static_cast<nsecs_t>(std::llround(mSlope));
+}
+
+nsecs_t RobustVsyncModel::anchor() const {
+    return mOrigin + static_cast<nsecs_t>(std::llround(mIntercept));
+}
+
+nsecs_t RobustVsyncModel::confidenceInterval() const {
+    static constexpr double kZScore95 = 1.96;
+
+    // Variance of a prediction for the regressor [1, 1], i.e. one vsync after the anchor.
+    const auto& p = mCovariance;
+    const double leverage = p[0][0] + p[0][1] + p[1][0] + p[1][1];
+    const double variance =
+            std::max(mResidualVariance, mMinResidualVariance) * (1.0 + std::max(leverage, 0.0));
+    return static_cast<nsecs_t>(std::llround(kZScore95 * std::sqrt(variance)));
+}
+
 VSyncPredictor::~VSyncPredictor() = default;
 
+bool VSyncPredictor::robustModelEnabled() {
+    return property_get_bool("debug.sf.vsp_robust_model", false);
+}
+
 VSyncPredictor::VSyncPredictor(std::unique_ptr<Clock> clock, ftl::NonNull<DisplayModePtr> modePtr,
                                size_t historySize, size_t minimumSamplesForPrediction,
-                               uint32_t outlierTolerancePercent)
+                               uint32_t outlierTolerancePercent, bool useRobustModel)
       : mClock(std::move(clock)),
         mId(modePtr->getPhysicalDisplayId()),
         mTraceOn(property_get_bool("debug.sf.vsp_trace", false)),
+        mUseRobustModel(useRobustModel),
         kHistorySize(historySize),
         kMinimumSamplesForPrediction(minimumSamplesForPrediction),
         kOutlierTolerancePercent(std::min(outlierTolerancePercent, kMaxPercent)),
+        mRobustModel(historySize),
         mDisplayModePtr(modePtr),
         mNumVsyncsForFrame(numVsyncsPerFrame(mDisplayModePtr)) {
     resetModel();
@@ -179,12 +288,20 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
 
     traceInt64If("VSP-ts", timestamp);
 
+    if (mUseRobustModel) {
+        mRobustModel.addSample(timestamp);
+    }
+
     const size_t numSamples = mTimestamps.size();
     if (numSamples < kMinimumSamplesForPrediction) {
         mRateMap[idealPeriod()] = {idealPeriod(), 0};
         return true;
     }
 
+    if (mUseRobustModel) {
+        return updateRobustModel(timestamp);
+    }
+
     // This is a 'simple linear regression' calculation of Y over X, with Y being the
     // vsync timestamps, and X being the ordinal of vsync count.
     // The calculated slope is the vsync period.
@@ -273,6 +390,43 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
     return true;
 }
 
+bool VSyncPredictor::updateRobustModel(nsecs_t timestamp) {
+    auto it = mRateMap.find(idealPeriod());
+    const nsecs_t anticipatedPeriod = mRobustModel.slope();
+
+    auto const percent = std::abs(anticipatedPeriod - idealPeriod()) * kMaxPercent / idealPeriod();
+    if (anticipatedPeriod <= 0 || percent >= kOutlierTolerancePercent) {
+        it->second = {idealPeriod(), 0};
+        clearTimestamps(/* clearTimelines */ true);
+        return false;
+    }
+
+    // snapToVsync() expects the intercept to be relative to the oldest timestamp, so fold the
+    // anchor of the streaming model into the first period after it.
+    const auto oldestTS = oldestTimestamp();
+    const auto offset = mRobustModel.anchor() - oldestTS;
+    const auto ordinal = (offset + (offset >= 0 ? 1 : -1) * anticipatedPeriod / 2) /
+            anticipatedPeriod;
+    const nsecs_t intercept = offset - ordinal * anticipatedPeriod;
+
+    traceInt64If("VSP-period", anticipatedPeriod);
+    traceInt64If("VSP-intercept", intercept);
+    traceInt64If("VSP-confidence", mRobustModel.confidenceInterval());
+
+    it->second = {anticipatedPeriod, intercept};
+
+    ALOGV("robust model update ts %" PRIu64 ": %" PRId64 " slope: %" PRId64 " intercept: %" PRId64,
+          mId.value, timestamp, anticipatedPeriod, intercept);
+    return true;
+}
+
+nsecs_t VSyncPredictor::oldestTimestamp() const {
+    // The ring buffer is filled from index 0 and then overwritten from the oldest sample on, so
+    // the oldest sample is found without scanning it.
+    return mTimestamps.size() == kHistorySize ? mTimestamps[next(mLastTimestampIndex)]
+                                              : mTimestamps.front();
+}
+
 nsecs_t VSyncPredictor::snapToVsync(nsecs_t timePoint) const {
     auto const [slope, intercept] = getVSyncPredictionModelLocked();
 
@@ -283,7 +437,9 @@ nsecs_t VSyncPredictor::snapToVsync(nsecs_t timePoint) const {
         return knownTimestamp + numPeriodsOut * idealPeriod();
     }
 
-    auto const oldest = *std::min_element(mTimestamps.begin(), mTimestamps.end());
+    auto const oldest = mUseRobustModel
+            ? oldestTimestamp()
+            : *std::min_element(mTimestamps.begin(), mTimestamps.end());
 
     // See b/145667109, the ordinal calculation must take into account the intercept.
     auto const zeroPoint = oldest + intercept;
@@ -427,6 +583,14 @@ void VSyncPredictor::setRenderRate(Fps renderRate, bool applyImmediately) {
     purgeTimelines(TimePoint::fromNs(mClock->now()));
 }
 
+std::optional<Duration> VSyncPredictor::predictionConfidenceInterval() const {
+    std::lock_guard lock(mMutex);
+    if (!mUseRobustModel || mTimestamps.size() < kMinimumSamplesForPrediction) {
+        return {};
+    }
+    return Duration::fromNs(mRobustModel.confidenceInterval());
+}
+
 void VSyncPredictor::setDisplayModePtr(ftl::NonNull<DisplayModePtr> modePtr) {
     LOG_ALWAYS_FATAL_IF(mId != modePtr->getPhysicalDisplayId(),
                         "mode does not belong to the display");
@@ -588,6 +752,9 @@ void VSyncPredictor::clearTimestamps(bool clearTimelines) {
         mTimestamps.clear();
         mLastTimestampIndex = 0;
     }
+    if (mUseRobustModel) {
+        mRobustModel.reset(idealPeriod());
+    }
 
     mIdealPeriod = Period::fromNs(idealPeriod());
     if (mTimelines.empty()) {
@@ -630,6 +797,10 @@ void VSyncPredictor::dump(std::string& result) const {
                       period / 1e6f, periodInterceptTuple.slope / 1e6f,
                       periodInterceptTuple.intercept);
     }
+    if (mUseRobustModel) {
+        StringAppendF(&result, "\tRobust model: samples=%zu confidence=+/-%.2fms\n",
+                      mRobustModel.sampleCount(), mRobustModel.confidenceInterval() / 1e6f);
+    }
     StringAppendF(&result, "\tmTimelines.size()=%zu\n", mTimelines.size());
 }
 
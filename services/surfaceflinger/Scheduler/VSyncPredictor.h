@@ -30,8 +30,48 @@
 
 namespace android::scheduler {
 
+/*
+ * RobustVsyncModel is a streaming estimate of the vsync model (period and phase) refined in O(1)
+ * per sample using exponentially weighted recursive least squares. Residuals are Huber weighted,
+ * so a single early or late timestamp only has a bounded effect on the model.
+ */
+class RobustVsyncModel {
+public:
+    /*
+     * \param [in] historySize  The effective number of samples the model remembers. Older samples
+     *                          are forgotten exponentially.
+     */
+    explicit RobustVsyncModel(size_t historySize);
+
+    void reset(nsecs_t idealPeriod);
+    void addSample(nsecs_t timestamp);
+
+    size_t sampleCount() const { return mSampleCount; }
+    nsecs_t slope() const;
+
+    // The modelled vsync closest to the last sample that was added.
+    nsecs_t anchor() const;
+
+    // Half-width of the ~95% confidence interval around the prediction for the next vsync.
+    nsecs_t confidenceInterval() const;
+
+private:
+    const double mForgettingFactor;
+
+    // The model is kept relative to the last sample (ordinal 0) so that the ordinals stay small.
+    nsecs_t mOrigin = 0;
+    double mSlope = 0;
+    double mIntercept = 0;
+    double mCovariance[2][2] = {};
+    double mResidualVariance = 0;
+    double mMinResidualVariance = 0;
+    size_t mSampleCount = 0;
+};
+
 class VSyncPredictor : public VSyncTracker {
 public:
+    static bool robustModelEnabled();
+
     /*
      * \param [in] Clock The clock abstraction. Useful for unit tests.
      * \param [in] PhysicalDisplayid The display this corresponds to.
@@ -40,9 +80,12 @@ public:
      * \param [in] minimumSamplesForPrediction The minimum number of samples to collect before
      * predicting. \param [in] outlierTolerancePercent a number 0 to 100 that will be used to filter
      * samples that fall outlierTolerancePercent from an anticipated vsync event.
+     * \param [in] useRobustModel Whether to predict with RobustVsyncModel rather than the
+     * regression over the whole history. Defaults to the debug.sf.vsp_robust_model property.
      */
     VSyncPredictor(std::unique_ptr<Clock>, ftl::NonNull<DisplayModePtr> modePtr, size_t historySize,
-                   size_t minimumSamplesForPrediction, uint32_t outlierTolerancePercent);
+                   size_t minimumSamplesForPrediction, uint32_t outlierTolerancePercent,
+                   bool useRobustModel = robustModelEnabled());
     ~VSyncPredictor();
 
     bool addVsyncTimestamp(nsecs_t timestamp) final EXCLUDES(mMutex);
@@ -78,6 +121,8 @@ public:
 
     void setRenderRate(Fps, bool applyImmediately) final EXCLUDES(mMutex);
 
+    std::optional<Duration> predictionConfidenceInterval() const final EXCLUDES(mMutex);
+
     void onFrameBegin(TimePoint expectedPresentTime, FrameTime lastSignaledFrameTime) final
             EXCLUDES(mMutex);
     void onFrameMissed(TimePoint expectedPresentTime) final EXCLUDES(mMutex);
@@ -144,8 +189,11 @@ private:
     void purgeTimelines(android::TimePoint now) REQUIRES(mMutex);
 
     nsecs_t idealPeriod() const REQUIRES(mMutex);
+    bool updateRobustModel(nsecs_t timestamp) REQUIRES(mMutex);
+    nsecs_t oldestTimestamp() const REQUIRES(mMutex);
 
     bool const mTraceOn;
+    bool const mUseRobustModel;
     size_t const kHistorySize;
     size_t const kMinimumSamplesForPrediction;
     size_t const kOutlierTolerancePercent;
@@ -158,6 +206,7 @@ private:
 
     size_t mLastTimestampIndex GUARDED_BY(mMutex) = 0;
     std::vector<nsecs_t> mTimestamps GUARDED_BY(mMutex);
+    RobustVsyncModel mRobustModel GUARDED_BY(mMutex);
 
     ftl::NonNull<DisplayModePtr> mDisplayModePtr GUARDED_BY(mMutex);
     int mNumVsyncsForFrame GUARDED_BY(mMutex);
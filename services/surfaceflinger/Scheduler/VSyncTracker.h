@@ -113,6 +113,12 @@ public:
      */
     virtual void setRenderRate(Fps, bool applyImmediately) = 0;
 
+    /*
+     * The half-width of the confidence interval around the next anticipated vsync, if the tracker
+     * is able to estimate it. Callers may use this to tighten their wakeup margins.
+     */
+    virtual std::optional<Duration> predictionConfidenceInterval() const = 0;
+
     virtual void onFrameBegin(TimePoint expectedPresentTime, FrameTime lastSignaledFrameTime) = 0;
 
     virtual void onFrameMissed(TimePoint expectedPresentTime) = 0;
@@ -480,6 +480,9 @@ SurfaceFlinger::SurfaceFlinger(Factory& factory) : SurfaceFlinger(factory, SkipI
                                   sysprop::SurfaceFlingerProperties::enable_layer_caching()
                                           .value_or(false));
 
+    mParallelCompositionEnabled =
+            base::GetBoolProperty("debug.sf.enable_parallel_composition"s, false);
+
     useContextPriority = use_context_priority(true);
 
     mInternalDisplayPrimaries = sysprop::getDisplayNativePrimaries();
@@ -926,7 +929,10 @@ void SurfaceFlinger::init() FTL_FAKE_GUARD(kMainThreadContext) {
                            .setContextPriority(
                                    useContextPriority
                                            ? renderengine::RenderEngine::ContextPriority::REALTIME
-                                           : renderengine::RenderEngine::ContextPriority::MEDIUM);
+                                           : renderengine::RenderEngine::ContextPriority::MEDIUM)
+                           .setShaderManifestPath(
+                                   base::GetProperty("debug.sf.prime_shader_cache.manifest_path"s,
+                                                     ""));
     chooseRenderEngineType(builder);
     mRenderEngine = renderengine::RenderEngine::create(builder.build());
     mCompositionEngine->setRenderEngine(mRenderEngine.get());
@@ -2961,6 +2967,7 @@ CompositeResultsPerDisplay SurfaceFlinger::composite(
             : std::nullopt;
     refreshArgs.scheduledFrameTime = scheduledFrameTimeOpt;
     refreshArgs.hasTrustedPresentationListener = mNumTrustedPresentationListeners > 0;
+    refreshArgs.parallelComposition = mParallelCompositionEnabled;
     // Store the present time just before calling to the composition engine so we could notify
     // the scheduler.
     const auto presentTime = systemTime();
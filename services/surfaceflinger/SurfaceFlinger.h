@@ -1373,6 +1373,7 @@ private:
     std::atomic_bool mForceFullDamage = false;
 
     bool mLayerCachingEnabled = false;
+    bool mParallelCompositionEnabled = false;
     bool mPropagateBackpressure = true;
     bool mBackpressureGpuComposition = false;
 
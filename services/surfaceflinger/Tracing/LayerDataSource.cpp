@@ -96,6 +96,10 @@ LayerTracing::Mode LayerDataSource::GetMode() const {
     return mMode;
 }
 
+uint32_t LayerDataSource::GetFlags() const {
+    return mFlags;
+}
+
 std::atomic<LayerTracing*> LayerDataSource::mLayerTracing = nullptr;
 
 } // namespace android
@@ -35,9 +35,11 @@ struct LayerDataSourceTlsState {
         mMode = dataSource.valid()
                 ? dataSource->GetMode()
                 : perfetto::protos::pbzero::SurfaceFlingerLayersConfig::Mode::MODE_GENERATED;
+        mFlags = dataSource.valid() ? dataSource->GetFlags() : 0;
     }
 
     LayerTracing::Mode mMode;
+    uint32_t mFlags;
 };
 
 struct LayerDataSourceTraits : public perfetto::DefaultDataSourceTraits {
@@ -60,6 +62,7 @@ public:
     void OnFlush(const FlushArgs&) override;
     void OnStop(const StopArgs&) override;
     LayerTracing::Mode GetMode() const;
+    uint32_t GetFlags() const;
 
     static constexpr auto* kName = "android.surfaceflinger.layers";
     static constexpr perfetto::BufferExhaustedPolicy kBufferExhaustedPolicy =
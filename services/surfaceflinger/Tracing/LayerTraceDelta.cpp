@@ -0,0 +1,173 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "LayerTracing"
+#define ATRACE_TAG ATRACE_TAG_GRAPHICS
+
+#include "LayerTraceDelta.h"
+
+#include <common/trace.h>
+#include <log/log.h>
+
+#include <string_view>
+
+namespace android {
+
+namespace {
+
+// A removed layer is written as a layer with nothing but its id, while other layers always have a
+// name.
+bool isRemovedLayer(const perfetto::protos::LayerProto& layer) {
+    return !layer.has_name();
+}
+
+void appendVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// Appends a length-delimited field, such as an embedded message.
+void appendBytesField(std::string& out, int fieldNumber, std::string_view bytes) {
+    constexpr uint64_t kWireTypeLengthDelimited = 2;
+    appendVarint(out, static_cast<uint64_t>(fieldNumber) << 3 | kWireTypeLengthDelimited);
+    appendVarint(out, bytes.size());
+    out.append(bytes);
+}
+
+} // namespace
+
+std::string LayerTraceDeltaEncoder::encode(perfetto::protos::LayersSnapshotProto& snapshot) {
+    SFTRACE_CALL();
+    const bool keyframe =
+            mSnapshotsSinceKeyframe == 0 || mSnapshotsSinceKeyframe >= mKeyframeInterval;
+    constexpr int kLayerField = perfetto::protos::LayersProto::kLayersFieldNumber;
+
+    std::unordered_map<int32_t, size_t> layerHashes;
+    layerHashes.reserve(static_cast<size_t>(snapshot.layers().layers_size()));
+    std::string layers;
+    for (const perfetto::protos::LayerProto& layer : snapshot.layers().layers()) {
+        const int32_t id = layer.id();
+        layer.SerializeToString(&mLayerBytes);
+        const size_t hash = std::hash<std::string_view>()(mLayerBytes);
+        if (keyframe) {
+            appendBytesField(layers, kLayerField, mLayerBytes);
+        } else if (const auto it = mLayerHashes.find(id);
+                   it == mLayerHashes.end() || it->second != hash) {
+            appendBytesField(layers, kLayerField, mLayerBytes);
+        }
+        layerHashes.emplace(id, hash);
+    }
+
+    std::string where;
+    if (keyframe) {
+        mSnapshotsSinceKeyframe = 1;
+    } else {
+        perfetto::protos::LayerProto removed;
+        for (const auto& [id, _] : mLayerHashes) {
+            if (layerHashes.find(id) == layerHashes.end()) {
+                removed.set_id(id);
+                appendBytesField(layers, kLayerField, removed.SerializeAsString());
+            }
+        }
+        where = snapshot.where();
+        snapshot.set_where(kDeltaPrefix + where);
+        mSnapshotsSinceKeyframe++;
+    }
+    mLayerHashes = std::move(layerHashes);
+
+    // Serialize the rest of the snapshot without its layers, and append the layers encoded above.
+    perfetto::protos::LayersProto snapshotLayers;
+    snapshotLayers.Swap(snapshot.mutable_layers());
+    snapshot.clear_layers();
+    std::string bytes = snapshot.SerializeAsString();
+    snapshot.mutable_layers()->Swap(&snapshotLayers);
+    if (!keyframe) {
+        snapshot.set_where(std::move(where));
+    }
+    appendBytesField(bytes, perfetto::protos::LayersSnapshotProto::kLayersFieldNumber, layers);
+    return bytes;
+}
+
+bool LayerTraceDeltaDecoder::isDelta(const perfetto::protos::LayersSnapshotProto& snapshot) {
+    return std::string_view(snapshot.where()).starts_with(LayerTraceDeltaEncoder::kDeltaPrefix);
+}
+
+bool LayerTraceDeltaDecoder::decode(perfetto::protos::LayersSnapshotProto& snapshot) {
+    if (!isDelta(snapshot)) {
+        mOrder.clear();
+        mLayers.clear();
+        for (const perfetto::protos::LayerProto& layer : snapshot.layers().layers()) {
+            mOrder.push_back(layer.id());
+            mLayers.emplace(layer.id(), layer);
+        }
+        mHasKeyframe = true;
+        return true;
+    }
+
+    if (!mHasKeyframe) {
+        ALOGW("Dropping layers trace delta at vsyncid=%" PRId64 " without a keyframe",
+              snapshot.vsync_id());
+        return false;
+    }
+
+    bool removedLayers = false;
+    for (perfetto::protos::LayerProto& layer : *snapshot.mutable_layers()->mutable_layers()) {
+        const int32_t id = layer.id();
+        if (isRemovedLayer(layer)) {
+            removedLayers |= mLayers.erase(id) > 0;
+            continue;
+        }
+        if (mLayers.insert_or_assign(id, std::move(layer)).second) {
+            mOrder.push_back(id);
+        }
+    }
+    if (removedLayers) {
+        std::erase_if(mOrder, [this](int32_t id) { return mLayers.find(id) == mLayers.end(); });
+    }
+
+    perfetto::protos::LayersProto layers;
+    layers.mutable_layers()->Reserve(static_cast<int32_t>(mOrder.size()));
+    for (const int32_t id : mOrder) {
+        *layers.add_layers() = mLayers.at(id);
+    }
+    *snapshot.mutable_layers() = std::move(layers);
+    snapshot.set_where(snapshot.where().substr(
+            std::string_view(LayerTraceDeltaEncoder::kDeltaPrefix).size()));
+    return true;
+}
+
+bool LayerTraceDeltaDecoder::decode(perfetto::protos::Trace& trace) {
+    SFTRACE_CALL();
+    LayerTraceDeltaDecoder decoder;
+    auto& packets = *trace.mutable_packet();
+    int decoded = 0;
+    for (int i = 0; i < packets.size(); i++) {
+        auto& packet = *packets.Mutable(i);
+        if (!packet.has_surfaceflinger_layers_snapshot() ||
+            decoder.decode(*packet.mutable_surfaceflinger_layers_snapshot())) {
+            packets.SwapElements(decoded++, i);
+        }
+    }
+    const bool complete = decoded == packets.size();
+    packets.DeleteSubrange(decoded, packets.size() - decoded);
+    return complete;
+}
+
+} // namespace android
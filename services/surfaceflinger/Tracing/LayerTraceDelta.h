@@ -0,0 +1,88 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <layerproto/LayerProtoHeader.h>
+#include <perfetto/trace/trace.pb.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace android {
+
+/*
+ * Delta encoding of layers snapshots, so that a layers trace holds more entries within the same
+ * buffer.
+ *
+ * A keyframe is a complete snapshot. A delta only holds the layers that were added or changed
+ * since the previous snapshot, and a layer with nothing but its id for each layer that was
+ * removed. Deltas are marked by prefixing the snapshot's "where" field with kDeltaPrefix.
+ *
+ * The encoder tells changed layers apart by the hash of their encoding, which it writes as is, so
+ * each layer is only serialized once.
+ *
+ * LayerTraceDeltaDecoder expands a sequence of keyframes and deltas back into complete snapshots.
+ * The layers of an expanded snapshot keep the order in which they first appeared, which may
+ * differ from the order of the original snapshot; the hierarchy is still described by the
+ * children and parent of each layer.
+ */
+class LayerTraceDeltaEncoder {
+public:
+    static constexpr const char* kDeltaPrefix = "delta:";
+
+    // Writes a keyframe every keyframeInterval snapshots.
+    explicit LayerTraceDeltaEncoder(uint32_t keyframeInterval)
+          : mKeyframeInterval(keyframeInterval) {}
+
+    // Serializes the snapshot as a keyframe if one is due, or else as a delta against the
+    // previous snapshot. The snapshot is modified while encoding, and restored before returning.
+    std::string encode(perfetto::protos::LayersSnapshotProto& snapshot);
+
+    // Makes the next snapshot a keyframe, e.g. when a new tracing session starts.
+    void requestKeyframe() { mSnapshotsSinceKeyframe = 0; }
+
+private:
+    const uint32_t mKeyframeInterval;
+    uint32_t mSnapshotsSinceKeyframe = 0;
+    // Hashes of the encoded layers of the previous snapshot, by layer id.
+    std::unordered_map<int32_t, size_t> mLayerHashes;
+    // Reused to encode each layer.
+    std::string mLayerBytes;
+};
+
+class LayerTraceDeltaDecoder {
+public:
+    static bool isDelta(const perfetto::protos::LayersSnapshotProto& snapshot);
+
+    // Expands a delta into a complete snapshot. Keyframes are left as they are. Returns false for
+    // a delta that does not follow a keyframe.
+    bool decode(perfetto::protos::LayersSnapshotProto& snapshot);
+
+    // Expands all deltas of the layers snapshots in a perfetto trace, leaving the other packets
+    // as they are. Returns false if the trace has a delta without a preceding keyframe, in which
+    // case such packets are dropped.
+    static bool decode(perfetto::protos::Trace& trace);
+
+private:
+    bool mHasKeyframe = false;
+    std::vector<int32_t> mOrder;
+    std::unordered_map<int32_t, perfetto::protos::LayerProto> mLayers;
+};
+
+} // namespace android
@@ -24,15 +24,21 @@
 #include "Tracing/tools/LayerTraceGenerator.h"
 #include "TransactionTracing.h"
 
+#include <android-base/properties.h>
 #include <common/trace.h>
 #include <log/log.h>
 #include <perfetto/tracing.h>
 #include <utils/Timers.h>
 
+#include <algorithm>
+
 namespace android {
 
 LayerTracing::LayerTracing() {
     mTakeLayersSnapshotProto = [](uint32_t, const OnLayersSnapshotCallback&) {};
+    mDeltaEncoder.emplace(std::max(1u,
+                                   base::GetUintProperty("debug.sf.layer_trace_keyframe_interval",
+                                                         kDefaultKeyframeInterval)));
     LayerDataSource::Initialize(*this);
 }
 
@@ -57,6 +63,10 @@ void LayerTracing::onStart(Mode mode, uint32_t flags) {
     switch (mode) {
         case Mode::MODE_ACTIVE: {
             mActiveTracingFlags.store(flags);
+            // A new session that traces deltas needs a complete snapshot to expand them.
+            if (flags & Flag::TRACE_DELTAS) {
+                mKeyframeRequested.store(true);
+            }
             mIsActiveTracingStarted.store(true);
             ALOGV("Starting active tracing (waiting for initial snapshot)");
             // It might take a while before a layers change occurs and a "spontaneous" snapshot is
@@ -190,12 +200,19 @@ void LayerTracing::writeSnapshotToStream(perfetto::protos::LayersSnapshotProto&&
     mOutStream->get() << fileProto.SerializeAsString();
 }
 
-void LayerTracing::writeSnapshotToPerfetto(const perfetto::protos::LayersSnapshotProto& snapshot,
+void LayerTracing::writeSnapshotToPerfetto(perfetto::protos::LayersSnapshotProto& snapshot,
                                            Mode srcMode) {
-    const auto snapshotBytes = snapshot.SerializeAsString();
+    // Each encoding is made once, by the first session that needs it.
+    std::optional<std::string> snapshotBytes;
+    std::optional<std::string> deltaBytes;
+    const bool canTraceDeltas = srcMode == Mode::MODE_ACTIVE && mDeltaEncoder;
+    if (canTraceDeltas && mKeyframeRequested.exchange(false)) {
+        mDeltaEncoder->requestKeyframe();
+    }
 
     LayerDataSource::Trace([&](LayerDataSource::TraceContext context) {
         auto dstMode = context.GetCustomTlsState()->mMode;
+        auto dstFlags = context.GetCustomTlsState()->mFlags;
         if (srcMode == Mode::MODE_GENERATED) {
             // Layers snapshots produced by LayerTraceGenerator have srcMode == MODE_GENERATED
             // and should be written to tracing sessions with MODE_GENERATED
@@ -210,12 +227,18 @@ void LayerTracing::writeSnapshotToPerfetto(const perfetto::protos::LayersSnapsho
         if (!checkAndUpdateLastVsyncIdWrittenToPerfetto(srcMode, snapshot.vsync_id())) {
             return;
         }
+
+        const bool traceDelta = canTraceDeltas && (dstFlags & Flag::TRACE_DELTAS);
+        auto& bytes = traceDelta ? deltaBytes : snapshotBytes;
+        if (!bytes) {
+            bytes = traceDelta ? mDeltaEncoder->encode(snapshot) : snapshot.SerializeAsString();
+        }
         {
             auto packet = context.NewTracePacket();
             packet->set_timestamp(static_cast<uint64_t>(snapshot.elapsed_realtime_nanos()));
             packet->set_timestamp_clock_id(perfetto::protos::pbzero::BUILTIN_CLOCK_MONOTONIC);
             auto* snapshotProto = packet->set_surfaceflinger_layers_snapshot();
-            snapshotProto->AppendRawProtoBytes(snapshotBytes.data(), snapshotBytes.size());
+            snapshotProto->AppendRawProtoBytes(bytes->data(), bytes->size());
         }
         {
             // TODO (b/162206162): remove empty packet when perfetto bug is fixed.
@@ -223,6 +246,11 @@ void LayerTracing::writeSnapshotToPerfetto(const perfetto::protos::LayersSnapsho
             context.NewTracePacket();
         }
     });
+
+    // The next delta must follow a snapshot that every session tracing deltas has.
+    if (canTraceDeltas && !deltaBytes) {
+        mDeltaEncoder->requestKeyframe();
+    }
 }
 
 bool LayerTracing::checkAndUpdateLastVsyncIdWrittenToPerfetto(Mode mode, std::int64_t vsyncId) {
@@ -18,6 +18,8 @@
 
 #include <layerproto/LayerProtoHeader.h>
 
+#include "LayerTraceDelta.h"
+
 #include <atomic>
 #include <functional>
 #include <optional>
@@ -54,6 +56,12 @@ class TransactionTracing;
  * When the 'start' event is received a single layers snapshot is taken
  * and written to perfetto.
  *
+ * An ACTIVE mode session can opt in to delta encoding with the TRACE_DELTAS flag, which the
+ * perfetto TraceFlag enum doesn't name (trace_flags: 128). It then gets a complete snapshot every
+ * debug.sf.layer_trace_keyframe_interval snapshots, and only the changed layers in between (see
+ * LayerTraceDeltaEncoder). Other sessions still get complete snapshots. Such traces are expanded
+ * with `layertracegenerator --expand-deltas`.
+ *
  *
  * E.g. start active mode tracing
  * (replace mode value with MODE_DUMP, MODE_GENERATED or MODE_GENERATED_BUGREPORT_ONLY to enable
@@ -96,6 +104,7 @@ public:
         TRACE_HWC = 1 << 4,
         TRACE_BUFFERS = 1 << 5,
         TRACE_VIRTUAL_DISPLAYS = 1 << 6,
+        TRACE_DELTAS = 1 << 7,
         TRACE_ALL = TRACE_INPUT | TRACE_COMPOSITION | TRACE_EXTRA,
     };
 
@@ -121,7 +130,7 @@ public:
 
 private:
     void writeSnapshotToStream(perfetto::protos::LayersSnapshotProto&& snapshot) const;
-    void writeSnapshotToPerfetto(const perfetto::protos::LayersSnapshotProto& snapshot, Mode mode);
+    void writeSnapshotToPerfetto(perfetto::protos::LayersSnapshotProto& snapshot, Mode mode);
     bool checkAndUpdateLastVsyncIdWrittenToPerfetto(Mode mode, std::int64_t vsyncId);
 
     std::function<void(uint32_t, const OnLayersSnapshotCallback&)> mTakeLayersSnapshotProto;
@@ -131,6 +140,10 @@ private:
     std::atomic<uint32_t> mActiveTracingFlags{0};
     std::atomic<std::int64_t> mLastVsyncIdWrittenToPerfetto{-1};
     std::optional<std::reference_wrapper<std::ostream>> mOutStream;
+    static constexpr uint32_t kDefaultKeyframeInterval = 30;
+    // Only accessed from the main thread, which takes the active snapshots.
+    std::optional<LayerTraceDeltaEncoder> mDeltaEncoder;
+    std::atomic<bool> mKeyframeRequested{false};
 };
 
 } // namespace android
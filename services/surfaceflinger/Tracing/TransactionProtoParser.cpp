@@ -15,6 +15,7 @@
  */
 
 #include <gui/SurfaceComposerClient.h>
+#include <perfetto/protozero/scattered_heap_buffer.h>
 #include <ui/Fence.h>
 #include <ui/Rect.h>
 
@@ -51,33 +52,47 @@ public:
     ~FakeExternalTexture() = default;
 };
 
+namespace {
+
+// Decodes a message that was encoded with protozero into its full proto, for the callers that
+// need to inspect or modify it.
+template <typename Proto, typename Message, typename Encode>
+Proto decodeAs(Encode&& encode) {
+    protozero::HeapBuffered<Message> message;
+    encode(message.get());
+    Proto proto;
+    proto.ParseFromString(message.SerializeAsString());
+    return proto;
+}
+
+} // namespace
+
 perfetto::protos::TransactionState TransactionProtoParser::toProto(
         const QueuedTransactionState& t) {
-    perfetto::protos::TransactionState proto;
-    proto.set_pid(t.originPid);
-    proto.set_uid(t.originUid);
-    proto.set_vsync_id(t.frameTimelineInfo.vsyncId);
-    proto.set_input_event_id(t.frameTimelineInfo.inputEventId);
-    proto.set_post_time(t.postTime);
-    proto.set_transaction_id(t.id);
-
-    proto.mutable_layer_changes()->Reserve(static_cast<int32_t>(t.states.size()));
+    return decodeAs<perfetto::protos::TransactionState, perfetto::protos::pbzero::TransactionState>(
+            [&](perfetto::protos::pbzero::TransactionState* proto) { toProto(t, proto); });
+}
+
+void TransactionProtoParser::toProto(const QueuedTransactionState& t,
+                                     perfetto::protos::pbzero::TransactionState* proto) {
+    proto->set_pid(t.originPid);
+    proto->set_uid(t.originUid);
+    proto->set_vsync_id(t.frameTimelineInfo.vsyncId);
+    proto->set_input_event_id(t.frameTimelineInfo.inputEventId);
+    proto->set_post_time(t.postTime);
+    proto->set_transaction_id(t.id);
+
     for (auto& layerState : t.states) {
-        proto.mutable_layer_changes()->Add(toProto(layerState));
+        toProto(layerState, proto->add_layer_changes());
     }
 
-    proto.mutable_display_changes()->Reserve(static_cast<int32_t>(t.displays.size()));
     for (auto& displayState : t.displays) {
-        proto.mutable_display_changes()->Add(toProto(displayState));
+        toProto(displayState, proto->add_display_changes());
     }
 
-    proto.mutable_merged_transaction_ids()->Reserve(
-            static_cast<int32_t>(t.mergedTransactionIds.size()));
     for (auto& mergedTransactionId : t.mergedTransactionIds) {
-        proto.mutable_merged_transaction_ids()->Add(mergedTransactionId);
+        proto->add_merged_transaction_ids(mergedTransactionId);
     }
-
-    return proto;
 }
 
 perfetto::protos::TransactionState TransactionProtoParser::toProto(
@@ -94,71 +109,78 @@ perfetto::protos::TransactionState TransactionProtoParser::toProto(
 
 perfetto::protos::LayerState TransactionProtoParser::toProto(
         const ResolvedComposerState& resolvedComposerState) {
-    perfetto::protos::LayerState proto;
+    return decodeAs<perfetto::protos::LayerState, perfetto::protos::pbzero::LayerState>(
+            [&](perfetto::protos::pbzero::LayerState* proto) {
+                toProto(resolvedComposerState, proto);
+            });
+}
+
+void TransactionProtoParser::toProto(const ResolvedComposerState& resolvedComposerState,
+                                     perfetto::protos::pbzero::LayerState* proto) {
     auto& layer = resolvedComposerState.state;
-    proto.set_layer_id(resolvedComposerState.layerId);
-    proto.set_what(layer.what);
+    proto->set_layer_id(resolvedComposerState.layerId);
+    proto->set_what(layer.what);
 
     if (layer.what & layer_state_t::ePositionChanged) {
-        proto.set_x(layer.x);
-        proto.set_y(layer.y);
+        proto->set_x(layer.x);
+        proto->set_y(layer.y);
     }
     if (layer.what & layer_state_t::eLayerChanged) {
-        proto.set_z(layer.z);
+        proto->set_z(layer.z);
     }
 
     if (layer.what & layer_state_t::eLayerStackChanged) {
-        proto.set_layer_stack(layer.layerStack.id);
+        proto->set_layer_stack(layer.layerStack.id);
     }
     if (layer.what & layer_state_t::eFlagsChanged) {
-        proto.set_flags(layer.flags);
-        proto.set_mask(layer.mask);
+        proto->set_flags(layer.flags);
+        proto->set_mask(layer.mask);
     }
     if (layer.what & layer_state_t::eMatrixChanged) {
-        perfetto::protos::LayerState_Matrix22* matrixProto = proto.mutable_matrix();
+        perfetto::protos::pbzero::LayerState_Matrix22* matrixProto = proto->set_matrix();
         matrixProto->set_dsdx(layer.matrix.dsdx);
         matrixProto->set_dsdy(layer.matrix.dsdy);
         matrixProto->set_dtdx(layer.matrix.dtdx);
         matrixProto->set_dtdy(layer.matrix.dtdy);
     }
     if (layer.what & layer_state_t::eCornerRadiusChanged) {
-        proto.set_corner_radius(layer.cornerRadius);
+        proto->set_corner_radius(layer.cornerRadius);
     }
     if (layer.what & layer_state_t::eBackgroundBlurRadiusChanged) {
-        proto.set_background_blur_radius(layer.backgroundBlurRadius);
+        proto->set_background_blur_radius(layer.backgroundBlurRadius);
     }
 
     if (layer.what & layer_state_t::eAlphaChanged) {
-        proto.set_alpha(layer.color.a);
+        proto->set_alpha(layer.color.a);
     }
 
     if (layer.what & layer_state_t::eColorChanged) {
-        perfetto::protos::LayerState_Color3* colorProto = proto.mutable_color();
+        perfetto::protos::pbzero::LayerState_Color3* colorProto = proto->set_color();
         colorProto->set_r(layer.color.r);
         colorProto->set_g(layer.color.g);
         colorProto->set_b(layer.color.b);
     }
     if (layer.what & layer_state_t::eTransparentRegionChanged) {
         LayerProtoHelper::writeToProto(layer.getTransparentRegion(),
-                                       proto.mutable_transparent_region());
+                                       proto->set_transparent_region());
     }
     if (layer.what & layer_state_t::eBufferTransformChanged) {
-        proto.set_transform(layer.bufferTransform);
+        proto->set_transform(layer.bufferTransform);
     }
     if (layer.what & layer_state_t::eTransformToDisplayInverseChanged) {
-        proto.set_transform_to_display_inverse(layer.transformToDisplayInverse);
+        proto->set_transform_to_display_inverse(layer.transformToDisplayInverse);
     }
     if (layer.what & layer_state_t::eCropChanged) {
-        LayerProtoHelper::writeToProto(Rect(layer.crop), proto.mutable_crop());
+        LayerProtoHelper::writeToProto(Rect(layer.crop), proto->set_crop());
     }
     if (layer.what & layer_state_t::eBufferChanged) {
-        perfetto::protos::LayerState_BufferData* bufferProto = proto.mutable_buffer_data();
+        perfetto::protos::pbzero::LayerState_BufferData* bufferProto = proto->set_buffer_data();
         if (resolvedComposerState.externalTexture) {
             bufferProto->set_buffer_id(resolvedComposerState.externalTexture->getId());
             bufferProto->set_width(resolvedComposerState.externalTexture->getWidth());
             bufferProto->set_height(resolvedComposerState.externalTexture->getHeight());
             bufferProto->set_pixel_format(
-                    static_cast<perfetto::protos::LayerState_BufferData_PixelFormat>(
+                    static_cast<perfetto::protos::pbzero::LayerState_BufferData_PixelFormat>(
                             resolvedComposerState.externalTexture->getPixelFormat()));
             bufferProto->set_usage(resolvedComposerState.externalTexture->getUsage());
         }
@@ -167,46 +189,46 @@ perfetto::protos::LayerState TransactionProtoParser::toProto(
         bufferProto->set_cached_buffer_id(layer.bufferData->cachedBuffer.id);
     }
     if (layer.what & layer_state_t::eSidebandStreamChanged) {
-        proto.set_has_sideband_stream(layer.sidebandStream != nullptr);
+        proto->set_has_sideband_stream(layer.sidebandStream != nullptr);
     }
 
     if (layer.what & layer_state_t::eApiChanged) {
-        proto.set_api(layer.api);
+        proto->set_api(layer.api);
     }
 
     if (layer.what & layer_state_t::eColorTransformChanged) {
-        LayerProtoHelper::writeToProto(layer.colorTransform, proto.mutable_color_transform());
+        LayerProtoHelper::writeToProto(layer.colorTransform, proto->set_color_transform());
     }
     if (layer.what & layer_state_t::eBlurRegionsChanged) {
         for (auto& region : layer.blurRegions) {
-            LayerProtoHelper::writeToProto(region, proto.add_blur_regions());
+            LayerProtoHelper::writeToProto(region, proto->add_blur_regions());
         }
     }
 
     if (layer.what & layer_state_t::eReparent) {
-        proto.set_parent_id(resolvedComposerState.parentId);
+        proto->set_parent_id(resolvedComposerState.parentId);
     }
     if (layer.what & layer_state_t::eRelativeLayerChanged) {
-        proto.set_relative_parent_id(resolvedComposerState.relativeParentId);
-        proto.set_z(layer.z);
+        proto->set_relative_parent_id(resolvedComposerState.relativeParentId);
+        proto->set_z(layer.z);
     }
 
     if (layer.what & layer_state_t::eInputInfoChanged) {
         const gui::WindowInfo* inputInfo = &layer.getWindowInfo();
-        perfetto::protos::LayerState_WindowInfo* windowInfoProto =
-                proto.mutable_window_info_handle();
+        perfetto::protos::pbzero::LayerState_WindowInfo* windowInfoProto =
+                proto->set_window_info_handle();
         windowInfoProto->set_layout_params_flags(inputInfo->layoutParamsFlags.get());
         windowInfoProto->set_layout_params_type(static_cast<int32_t>(inputInfo->layoutParamsType));
         windowInfoProto->set_input_config(inputInfo->inputConfig.get());
         LayerProtoHelper::writeToProto(inputInfo->touchableRegion,
-                                       windowInfoProto->mutable_touchable_region());
+                                       windowInfoProto->set_touchable_region());
         windowInfoProto->set_surface_inset(inputInfo->surfaceInset);
         windowInfoProto->set_focusable(
                 !inputInfo->inputConfig.test(gui::WindowInfo::InputConfig::NOT_FOCUSABLE));
         windowInfoProto->set_has_wallpaper(inputInfo->inputConfig.test(
                 gui::WindowInfo::InputConfig::DUPLICATE_TOUCH_TO_WALLPAPER));
         windowInfoProto->set_global_scale_factor(inputInfo->globalScaleFactor);
-        perfetto::protos::Transform* transformProto = windowInfoProto->mutable_transform();
+        perfetto::protos::pbzero::Transform* transformProto = windowInfoProto->set_transform();
         transformProto->set_dsdx(inputInfo->transform.dsdx());
         transformProto->set_dtdx(inputInfo->transform.dtdx());
         transformProto->set_dtdy(inputInfo->transform.dtdy());
@@ -218,85 +240,88 @@ perfetto::protos::LayerState TransactionProtoParser::toProto(
         windowInfoProto->set_crop_layer_id(resolvedComposerState.touchCropId);
     }
     if (layer.what & layer_state_t::eBackgroundColorChanged) {
-        proto.set_bg_color_alpha(layer.bgColor.a);
-        proto.set_bg_color_dataspace(static_cast<int32_t>(layer.bgColorDataspace));
-        perfetto::protos::LayerState_Color3* colorProto = proto.mutable_color();
+        proto->set_bg_color_alpha(layer.bgColor.a);
+        proto->set_bg_color_dataspace(static_cast<int32_t>(layer.bgColorDataspace));
+        perfetto::protos::pbzero::LayerState_Color3* colorProto = proto->set_color();
         colorProto->set_r(layer.bgColor.r);
         colorProto->set_g(layer.bgColor.g);
         colorProto->set_b(layer.bgColor.b);
     }
     if (layer.what & layer_state_t::eColorSpaceAgnosticChanged) {
-        proto.set_color_space_agnostic(layer.colorSpaceAgnostic);
+        proto->set_color_space_agnostic(layer.colorSpaceAgnostic);
     }
     if (layer.what & layer_state_t::eShadowRadiusChanged) {
-        proto.set_shadow_radius(layer.shadowRadius);
+        proto->set_shadow_radius(layer.shadowRadius);
     }
     if (layer.what & layer_state_t::eFrameRateSelectionPriority) {
-        proto.set_frame_rate_selection_priority(layer.frameRateSelectionPriority);
+        proto->set_frame_rate_selection_priority(layer.frameRateSelectionPriority);
     }
     if (layer.what & layer_state_t::eFrameRateChanged) {
-        proto.set_frame_rate(layer.frameRate);
-        proto.set_frame_rate_compatibility(layer.frameRateCompatibility);
-        proto.set_change_frame_rate_strategy(layer.changeFrameRateStrategy);
+        proto->set_frame_rate(layer.frameRate);
+        proto->set_frame_rate_compatibility(layer.frameRateCompatibility);
+        proto->set_change_frame_rate_strategy(layer.changeFrameRateStrategy);
     }
     if (layer.what & layer_state_t::eFixedTransformHintChanged) {
-        proto.set_fixed_transform_hint(layer.fixedTransformHint);
+        proto->set_fixed_transform_hint(layer.fixedTransformHint);
     }
     if (layer.what & layer_state_t::eAutoRefreshChanged) {
-        proto.set_auto_refresh(layer.autoRefresh);
+        proto->set_auto_refresh(layer.autoRefresh);
     }
     if (layer.what & layer_state_t::eTrustedOverlayChanged) {
-        proto.set_is_trusted_overlay(layer.trustedOverlay == gui::TrustedOverlay::ENABLED);
+        proto->set_is_trusted_overlay(layer.trustedOverlay == gui::TrustedOverlay::ENABLED);
         // TODO(b/339701674) update protos
     }
     if (layer.what & layer_state_t::eBufferCropChanged) {
-        LayerProtoHelper::writeToProto(layer.bufferCrop, proto.mutable_buffer_crop());
+        LayerProtoHelper::writeToProto(layer.bufferCrop, proto->set_buffer_crop());
     }
     if (layer.what & layer_state_t::eDestinationFrameChanged) {
-        LayerProtoHelper::writeToProto(layer.destinationFrame, proto.mutable_destination_frame());
+        LayerProtoHelper::writeToProto(layer.destinationFrame, proto->set_destination_frame());
     }
     if (layer.what & layer_state_t::eDropInputModeChanged) {
-        proto.set_drop_input_mode(
-                static_cast<perfetto::protos::LayerState_DropInputMode>(layer.dropInputMode));
+        proto->set_drop_input_mode(static_cast<perfetto::protos::pbzero::LayerState_DropInputMode>(
+                layer.dropInputMode));
     }
-    return proto;
 }
 
-perfetto::protos::DisplayState TransactionProtoParser::toProto(const DisplayState& display) {
-    perfetto::protos::DisplayState proto;
-    proto.set_what(display.what);
-    proto.set_id(mMapper->getDisplayId(display.token));
+void TransactionProtoParser::toProto(const DisplayState& display,
+                                     perfetto::protos::pbzero::DisplayState* proto) {
+    proto->set_what(display.what);
+    proto->set_id(mMapper->getDisplayId(display.token));
 
     if (display.what & DisplayState::eLayerStackChanged) {
-        proto.set_layer_stack(display.layerStack.id);
+        proto->set_layer_stack(display.layerStack.id);
     }
     if (display.what & DisplayState::eDisplayProjectionChanged) {
-        proto.set_orientation(static_cast<uint32_t>(display.orientation));
+        proto->set_orientation(static_cast<uint32_t>(display.orientation));
         LayerProtoHelper::writeToProto(display.orientedDisplaySpaceRect,
-                                       proto.mutable_oriented_display_space_rect());
+                                       proto->set_oriented_display_space_rect());
         LayerProtoHelper::writeToProto(display.layerStackSpaceRect,
-                                       proto.mutable_layer_stack_space_rect());
+                                       proto->set_layer_stack_space_rect());
     }
     if (display.what & DisplayState::eDisplaySizeChanged) {
-        proto.set_width(display.width);
-        proto.set_height(display.height);
+        proto->set_width(display.width);
+        proto->set_height(display.height);
     }
     if (display.what & DisplayState::eFlagsChanged) {
-        proto.set_flags(display.flags);
+        proto->set_flags(display.flags);
     }
-    return proto;
 }
 
 perfetto::protos::LayerCreationArgs TransactionProtoParser::toProto(const LayerCreationArgs& args) {
-    perfetto::protos::LayerCreationArgs proto;
-    proto.set_layer_id(args.sequence);
-    proto.set_name(args.name);
-    proto.set_flags(args.flags);
-    proto.set_parent_id(args.parentId);
-    proto.set_mirror_from_id(args.layerIdToMirror);
-    proto.set_add_to_root(args.addToRoot);
-    proto.set_layer_stack_to_mirror(args.layerStackToMirror.id);
-    return proto;
+    return decodeAs<perfetto::protos::LayerCreationArgs,
+                    perfetto::protos::pbzero::LayerCreationArgs>(
+            [&](perfetto::protos::pbzero::LayerCreationArgs* proto) { toProto(args, proto); });
+}
+
+void TransactionProtoParser::toProto(const LayerCreationArgs& args,
+                                     perfetto::protos::pbzero::LayerCreationArgs* proto) {
+    proto->set_layer_id(args.sequence);
+    proto->set_name(args.name);
+    proto->set_flags(args.flags);
+    proto->set_parent_id(args.parentId);
+    proto->set_mirror_from_id(args.layerIdToMirror);
+    proto->set_add_to_root(args.addToRoot);
+    proto->set_layer_stack_to_mirror(args.layerStackToMirror.id);
 }
 
 QueuedTransactionState TransactionProtoParser::fromProto(
@@ -557,7 +582,7 @@ DisplayState TransactionProtoParser::fromProto(const perfetto::protos::DisplaySt
     return display;
 }
 
-void asProto(perfetto::protos::Transform* proto, const ui::Transform& transform) {
+void asProto(perfetto::protos::pbzero::Transform* proto, const ui::Transform& transform) {
     proto->set_dsdx(transform.dsdx());
     proto->set_dtdx(transform.dtdx());
     proto->set_dtdy(transform.dtdy());
@@ -568,20 +593,26 @@ void asProto(perfetto::protos::Transform* proto, const ui::Transform& transform)
 
 perfetto::protos::DisplayInfo TransactionProtoParser::toProto(
         const frontend::DisplayInfo& displayInfo, uint32_t layerStack) {
-    perfetto::protos::DisplayInfo proto;
-    proto.set_layer_stack(layerStack);
-    proto.set_display_id(displayInfo.info.displayId.val());
-    proto.set_logical_width(displayInfo.info.logicalWidth);
-    proto.set_logical_height(displayInfo.info.logicalHeight);
-    asProto(proto.mutable_transform_inverse(), displayInfo.info.transform);
-    asProto(proto.mutable_transform(), displayInfo.transform);
-    proto.set_receives_input(displayInfo.receivesInput);
-    proto.set_is_secure(displayInfo.isSecure);
-    proto.set_is_primary(displayInfo.isPrimary);
-    proto.set_is_virtual(displayInfo.isVirtual);
-    proto.set_rotation_flags((int)displayInfo.rotationFlags);
-    proto.set_transform_hint((int)displayInfo.transformHint);
-    return proto;
+    return decodeAs<perfetto::protos::DisplayInfo, perfetto::protos::pbzero::DisplayInfo>(
+            [&](perfetto::protos::pbzero::DisplayInfo* proto) {
+                toProto(displayInfo, layerStack, proto);
+            });
+}
+
+void TransactionProtoParser::toProto(const frontend::DisplayInfo& displayInfo, uint32_t layerStack,
+                                     perfetto::protos::pbzero::DisplayInfo* proto) {
+    proto->set_layer_stack(layerStack);
+    proto->set_display_id(displayInfo.info.displayId.val());
+    proto->set_logical_width(displayInfo.info.logicalWidth);
+    proto->set_logical_height(displayInfo.info.logicalHeight);
+    asProto(proto->set_transform_inverse(), displayInfo.info.transform);
+    asProto(proto->set_transform(), displayInfo.transform);
+    proto->set_receives_input(displayInfo.receivesInput);
+    proto->set_is_secure(displayInfo.isSecure);
+    proto->set_is_primary(displayInfo.isPrimary);
+    proto->set_is_virtual(displayInfo.isVirtual);
+    proto->set_rotation_flags((int)displayInfo.rotationFlags);
+    proto->set_transform_hint((int)displayInfo.transformHint);
 }
 
 void fromProto2(ui::Transform& outTransform, const perfetto::protos::Transform& proto) {
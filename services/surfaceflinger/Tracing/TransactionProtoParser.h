@@ -44,12 +44,19 @@ public:
     TransactionProtoParser(std::unique_ptr<FlingerDataMapper> provider)
           : mMapper(std::move(provider)) {}
 
+    // The states are encoded with protozero. The overloads that return a full proto decode that
+    // encoding, for callers that need to inspect or modify the message.
     perfetto::protos::TransactionState toProto(const QueuedTransactionState&);
+    void toProto(const QueuedTransactionState&, perfetto::protos::pbzero::TransactionState*);
     perfetto::protos::TransactionState toProto(
             const std::map<uint32_t /* layerId */, TracingLayerState>&);
     perfetto::protos::LayerCreationArgs toProto(const LayerCreationArgs& args);
+    void toProto(const LayerCreationArgs& args, perfetto::protos::pbzero::LayerCreationArgs*);
     perfetto::protos::LayerState toProto(const ResolvedComposerState&);
+    void toProto(const ResolvedComposerState&, perfetto::protos::pbzero::LayerState*);
     static perfetto::protos::DisplayInfo toProto(const frontend::DisplayInfo&, uint32_t layerStack);
+    static void toProto(const frontend::DisplayInfo&, uint32_t layerStack,
+                        perfetto::protos::pbzero::DisplayInfo*);
 
     QueuedTransactionState fromProto(const perfetto::protos::TransactionState&);
     void mergeFromProto(const perfetto::protos::LayerState&, TracingLayerState& outState);
@@ -60,7 +67,7 @@ public:
                           frontend::DisplayInfos& outDisplayInfos);
 
 private:
-    perfetto::protos::DisplayState toProto(const DisplayState&);
+    void toProto(const DisplayState&, perfetto::protos::pbzero::DisplayState*);
     void fromProto(const perfetto::protos::LayerState&, ResolvedComposerState& out);
     DisplayState fromProto(const perfetto::protos::DisplayState&);
 };
@@ -24,67 +24,99 @@
 #include <utils/Errors.h>
 #include <utils/Timers.h>
 #include <chrono>
+#include <deque>
 #include <fstream>
+#include <memory>
 
 namespace android {
 
 class SurfaceFlinger;
 
+// Appends bytes that already hold an encoded message to out, as a length-delimited field of the
+// enclosing message. This lets entries be copied into a trace without being parsed again.
+inline void appendEncodedField(std::string& out, uint32_t fieldNumber, const std::string& bytes) {
+    auto appendVarInt = [&out](uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    };
+    constexpr uint32_t kWireTypeLengthDelimited = 2;
+    appendVarInt(fieldNumber << 3 | kWireTypeLengthDelimited);
+    appendVarInt(bytes.size());
+    out.append(bytes);
+}
+
 template <typename FileProto, typename EntryProto>
 class TransactionRingBuffer {
 public:
+    // An encoded EntryProto. Entries are never modified once stored, so they can be handed out
+    // and written after the lock that guards the ring buffer is released.
+    using Entry = std::shared_ptr<const std::string>;
+
     size_t size() const { return mSizeInBytes; }
     size_t used() const { return mUsedInBytes; }
     size_t frameCount() const { return mStorage.size(); }
     void setSize(size_t newSize) { mSizeInBytes = newSize; }
-    const std::string& front() const { return mStorage.front(); }
-    const std::string& back() const { return mStorage.back(); }
+    const std::string& front() const { return *mStorage.front(); }
+    const std::string& back() const { return *mStorage.back(); }
 
     void reset() {
         // use the swap trick to make sure memory is released
-        std::deque<std::string>().swap(mStorage);
+        std::deque<Entry>().swap(mStorage);
         mUsedInBytes = 0U;
     }
 
     void writeToProto(FileProto& fileProto) const {
         fileProto.mutable_entry()->Reserve(static_cast<int>(mStorage.size()) +
                                            fileProto.entry().size());
-        for (const std::string& entry : mStorage) {
+        for (const Entry& entry : mStorage) {
             EntryProto* entryProto = fileProto.add_entry();
-            entryProto->ParseFromString(entry);
+            entryProto->ParseFromString(*entry);
+        }
+    }
+
+    // Appends the entries to an encoded FileProto as they are stored, without parsing them.
+    void appendEncodedEntries(std::string& out) const {
+        out.reserve(out.size() + mUsedInBytes + kMaxFieldHeaderSize * mStorage.size());
+        for (const Entry& entry : mStorage) {
+            appendEncodedField(out, FileProto::kEntryFieldNumber, *entry);
         }
     }
 
     status_t appendToStream(FileProto& fileProto, std::ofstream& out) {
         SFTRACE_CALL();
-        writeToProto(fileProto);
         std::string output;
         if (!fileProto.SerializeToString(&output)) {
             ALOGE("Could not serialize proto.");
             return UNKNOWN_ERROR;
         }
+        appendEncodedEntries(output);
 
         out << output;
         return NO_ERROR;
     }
 
-    std::vector<std::string> emplace(std::string&& serializedProto) {
-        std::vector<std::string> replacedEntries;
+    const std::deque<Entry>& entries() const { return mStorage; }
+
+    std::vector<Entry> emplace(std::string&& serializedProto) {
+        std::vector<Entry> replacedEntries;
         size_t protoSize = static_cast<size_t>(serializedProto.size());
         while (mUsedInBytes + protoSize > mSizeInBytes) {
             if (mStorage.empty()) {
                 return {};
             }
-            mUsedInBytes -= static_cast<size_t>(mStorage.front().size());
-            replacedEntries.emplace_back(mStorage.front());
+            mUsedInBytes -= static_cast<size_t>(mStorage.front()->size());
+            replacedEntries.emplace_back(std::move(mStorage.front()));
             mStorage.pop_front();
         }
         mUsedInBytes += protoSize;
-        mStorage.emplace_back(serializedProto);
+        mStorage.emplace_back(std::make_shared<const std::string>(std::move(serializedProto)));
         return replacedEntries;
     }
 
-    std::vector<std::string> emplace(EntryProto&& proto) {
+    std::vector<Entry> emplace(EntryProto&& proto) {
         std::string serializedProto;
         proto.SerializeToString(&serializedProto);
         return emplace(std::move(serializedProto));
@@ -94,7 +126,7 @@ public:
         std::chrono::milliseconds duration(0);
         if (frameCount() > 0) {
             EntryProto entry;
-            entry.ParseFromString(mStorage.front());
+            entry.ParseFromString(*mStorage.front());
             duration = std::chrono::duration_cast<std::chrono::milliseconds>(
                     std::chrono::nanoseconds(systemTime() - entry.elapsed_realtime_nanos()));
         }
@@ -106,9 +138,12 @@ public:
     }
 
 private:
+    // Largest tag and length prefix of a length-delimited field.
+    static constexpr size_t kMaxFieldHeaderSize = 15;
+
     size_t mUsedInBytes = 0U;
     size_t mSizeInBytes = 0U;
-    std::deque<std::string> mStorage;
+    std::deque<Entry> mStorage;
 };
 
 } // namespace android
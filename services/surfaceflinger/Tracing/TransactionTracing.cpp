@@ -19,6 +19,7 @@
 
 #include <android-base/stringprintf.h>
 #include <log/log.h>
+#include <perfetto/protozero/scattered_heap_buffer.h>
 #include <utils/SystemClock.h>
 
 #include "Client.h"
@@ -87,22 +88,30 @@ void TransactionTracing::onFlush(TransactionTracing::Mode mode) {
 void TransactionTracing::writeRingBufferToPerfetto(TransactionTracing::Mode mode) {
     // Write the ring buffer (starting state + following sequence of transactions) to perfetto
     // tracing sessions with the specified mode.
-    const auto fileProto = writeToProto();
+    std::vector<RingBuffer::Entry> entries;
+    {
+        std::scoped_lock lock(mTraceLock);
+        entries = encodeEntriesLocked();
+    }
+    std::vector<uint64_t> timestamps;
+    timestamps.reserve(entries.size());
+    for (const RingBuffer::Entry& entry : entries) {
+        const perfetto::protos::pbzero::TransactionTraceEntry::Decoder decoder(*entry);
+        timestamps.push_back(static_cast<uint64_t>(decoder.elapsed_realtime_nanos()));
+    }
 
     TransactionDataSource::Trace([&](TransactionDataSource::TraceContext context) {
         // Write packets only to tracing sessions with specified mode
         if (context.GetCustomTlsState()->mMode != mode) {
             return;
         }
-        for (const auto& entryProto : fileProto.entry()) {
-            const auto entryBytes = entryProto.SerializeAsString();
-
+        for (size_t i = 0; i < entries.size(); i++) {
             auto packet = context.NewTracePacket();
-            packet->set_timestamp(static_cast<uint64_t>(entryProto.elapsed_realtime_nanos()));
+            packet->set_timestamp(timestamps[i]);
             packet->set_timestamp_clock_id(perfetto::protos::pbzero::BUILTIN_CLOCK_MONOTONIC);
 
             auto* transactionsProto = packet->set_surfaceflinger_transactions();
-            transactionsProto->AppendRawProtoBytes(entryBytes.data(), entryBytes.size());
+            transactionsProto->AppendRawProtoBytes(entries[i]->data(), entries[i]->size());
         }
         {
             // TODO (b/162206162): remove empty packet when perfetto bug is fixed.
@@ -113,12 +122,10 @@ void TransactionTracing::writeRingBufferToPerfetto(TransactionTracing::Mode mode
 }
 
 status_t TransactionTracing::writeToFile(const std::string& filename) {
-    auto fileProto = writeToProto();
-
     std::string output;
-    if (!fileProto.SerializeToString(&output)) {
-        ALOGE("Could not serialize proto.");
-        return UNKNOWN_ERROR;
+    {
+        std::scoped_lock lock(mTraceLock);
+        output = encodeTraceFileLocked();
     }
 
     // -rw-r--r--
@@ -142,6 +149,29 @@ perfetto::protos::TransactionTraceFile TransactionTracing::writeToProto() {
     return fileProto;
 }
 
+std::string TransactionTracing::encodeTraceFileLocked() {
+    std::string output = createTraceFileProto().SerializeAsString();
+    const auto startingStateProto = createStartingStateProtoLocked();
+    if (startingStateProto) {
+        appendEncodedField(output, perfetto::protos::TransactionTraceFile::kEntryFieldNumber,
+                           startingStateProto->SerializeAsString());
+    }
+    mBuffer.appendEncodedEntries(output);
+    return output;
+}
+
+std::vector<TransactionTracing::RingBuffer::Entry> TransactionTracing::encodeEntriesLocked() {
+    std::vector<RingBuffer::Entry> entries;
+    entries.reserve(mBuffer.frameCount() + 1);
+    const auto startingStateProto = createStartingStateProtoLocked();
+    if (startingStateProto) {
+        entries.push_back(
+                std::make_shared<const std::string>(startingStateProto->SerializeAsString()));
+    }
+    entries.insert(entries.end(), mBuffer.entries().begin(), mBuffer.entries().end());
+    return entries;
+}
+
 void TransactionTracing::setBufferSize(size_t bufferSizeInBytes) {
     std::scoped_lock lock(mTraceLock);
     mBuffer.setSize(bufferSizeInBytes);
@@ -167,9 +197,11 @@ void TransactionTracing::dump(std::string& result) const {
 }
 
 void TransactionTracing::addQueuedTransaction(const QueuedTransactionState& transaction) {
-    perfetto::protos::TransactionState* state =
-            new perfetto::protos::TransactionState(mProtoParser.toProto(transaction));
-    mTransactionQueue.push(state);
+    // Encode on the binder thread, so that the tracing thread only has to copy bytes into the
+    // ring buffer.
+    protozero::HeapBuffered<perfetto::protos::pbzero::TransactionState> proto;
+    mProtoParser.toProto(transaction, proto.get());
+    mTransactionQueue.push(new EncodedTransaction{transaction.id, proto.SerializeAsString()});
 }
 
 void TransactionTracing::addCommittedTransactions(int64_t vsyncId, nsecs_t commitTime,
@@ -229,59 +261,48 @@ void TransactionTracing::loop() {
 void TransactionTracing::addEntry(const std::vector<CommittedUpdates>& committedUpdates,
                                   const std::vector<uint32_t>& destroyedLayers) {
     std::scoped_lock lock(mTraceLock);
-    std::vector<std::string> removedEntries;
-    perfetto::protos::TransactionTraceEntry entryProto;
+    std::vector<RingBuffer::Entry> removedEntries;
 
     while (auto incomingTransaction = mTransactionQueue.pop()) {
-        auto transaction = *incomingTransaction;
-        mQueuedTransactions[incomingTransaction->transaction_id()] = transaction;
+        mQueuedTransactions[incomingTransaction->id] = std::move(incomingTransaction->bytes);
         delete incomingTransaction;
     }
     for (const CommittedUpdates& update : committedUpdates) {
-        entryProto.set_elapsed_realtime_nanos(update.timestamp);
-        entryProto.set_vsync_id(update.vsyncId);
-        entryProto.mutable_added_layers()->Reserve(
-                static_cast<int32_t>(update.createdLayers.size()));
+        protozero::HeapBuffered<perfetto::protos::pbzero::TransactionTraceEntry> entryProto;
+        entryProto->set_elapsed_realtime_nanos(update.timestamp);
+        entryProto->set_vsync_id(update.vsyncId);
 
         for (const auto& args : update.createdLayers) {
-            entryProto.mutable_added_layers()->Add(mProtoParser.toProto(args));
+            mProtoParser.toProto(args, entryProto->add_added_layers());
         }
 
-        entryProto.mutable_destroyed_layers()->Reserve(
-                static_cast<int32_t>(destroyedLayers.size()));
         for (auto& destroyedLayer : destroyedLayers) {
-            entryProto.mutable_destroyed_layers()->Add(destroyedLayer);
+            entryProto->add_destroyed_layers(destroyedLayer);
         }
-        entryProto.mutable_transactions()->Reserve(
-                static_cast<int32_t>(update.transactionIds.size()));
-        for (const uint64_t& id : update.transactionIds) {
-            auto it = mQueuedTransactions.find(id);
-            if (it != mQueuedTransactions.end()) {
-                entryProto.mutable_transactions()->Add(std::move(it->second));
-                mQueuedTransactions.erase(it);
-            } else {
-                ALOGW("Could not find transaction id %" PRIu64, id);
-            }
-        }
-
-        entryProto.mutable_destroyed_layer_handles()->Reserve(
-                static_cast<int32_t>(update.destroyedLayerHandles.size()));
         for (auto layerId : update.destroyedLayerHandles) {
-            entryProto.mutable_destroyed_layer_handles()->Add(layerId);
+            entryProto->add_destroyed_layer_handles(layerId);
         }
 
-        entryProto.set_displays_changed(update.displayInfoChanged);
+        entryProto->set_displays_changed(update.displayInfoChanged);
         if (update.displayInfoChanged) {
-            entryProto.mutable_displays()->Reserve(
-                    static_cast<int32_t>(update.displayInfos.size()));
             for (auto& [layerStack, displayInfo] : update.displayInfos) {
-                entryProto.mutable_displays()->Add(
-                        mProtoParser.toProto(displayInfo, layerStack.id));
+                mProtoParser.toProto(displayInfo, layerStack.id, entryProto->add_displays());
             }
         }
 
-        std::string serializedProto;
-        entryProto.SerializeToString(&serializedProto);
+        // The transactions are already encoded and are appended to the entry as they are.
+        for (const uint64_t& id : update.transactionIds) {
+            auto it = mQueuedTransactions.find(id);
+            if (it != mQueuedTransactions.end()) {
+                entryProto->AppendBytes(perfetto::protos::TransactionTraceEntry::
+                                                kTransactionsFieldNumber,
+                                        it->second.data(), it->second.size());
+                mQueuedTransactions.erase(it);
+            } else {
+                ALOGW("Could not find transaction id %" PRIu64, id);
+            }
+        }
+        std::string serializedProto = entryProto.SerializeAsString();
 
         TransactionDataSource::Trace([&](TransactionDataSource::TraceContext context) {
             // In "active" mode write each committed transaction to perfetto.
@@ -292,7 +313,7 @@ void TransactionTracing::addEntry(const std::vector<CommittedUpdates>& committed
             }
             {
                 auto packet = context.NewTracePacket();
-                packet->set_timestamp(static_cast<uint64_t>(entryProto.elapsed_realtime_nanos()));
+                packet->set_timestamp(static_cast<uint64_t>(update.timestamp));
                 packet->set_timestamp_clock_id(perfetto::protos::pbzero::BUILTIN_CLOCK_MONOTONIC);
                 auto* transactions = packet->set_surfaceflinger_transactions();
                 transactions->AppendRawProtoBytes(serializedProto.data(), serializedProto.size());
@@ -304,17 +325,15 @@ void TransactionTracing::addEntry(const std::vector<CommittedUpdates>& committed
             }
         });
 
-        std::vector<std::string> entries = mBuffer.emplace(std::move(serializedProto));
+        std::vector<RingBuffer::Entry> entries = mBuffer.emplace(std::move(serializedProto));
         removedEntries.reserve(removedEntries.size() + entries.size());
         removedEntries.insert(removedEntries.end(), std::make_move_iterator(entries.begin()),
                               std::make_move_iterator(entries.end()));
-
-        entryProto.Clear();
     }
 
     perfetto::protos::TransactionTraceEntry removedEntryProto;
-    for (const std::string& removedEntry : removedEntries) {
-        removedEntryProto.ParseFromString(removedEntry);
+    for (const RingBuffer::Entry& removedEntry : removedEntries) {
+        removedEntryProto.ParseFromString(*removedEntry);
         updateStartingStateLocked(removedEntryProto);
         removedEntryProto.Clear();
     }
@@ -337,12 +356,13 @@ void TransactionTracing::flush() {
     base::ScopedLockAssertion assumeLocked(mTraceLock);
     mTransactionsAddedToBufferCv.wait_for(lock, std::chrono::milliseconds(100),
                                           [&]() REQUIRES(mTraceLock) {
-                                              perfetto::protos::TransactionTraceEntry entry;
-                                              if (mBuffer.used() > 0) {
-                                                  entry.ParseFromString(mBuffer.back());
+                                              if (mBuffer.used() == 0) {
+                                                  return false;
                                               }
-                                              return mBuffer.used() > 0 &&
-                                                      entry.vsync_id() >= mLastUpdatedVsyncId;
+                                              const perfetto::protos::pbzero::
+                                                      TransactionTraceEntry::Decoder
+                                                              entry(mBuffer.back());
+                                              return entry.vsync_id() >= mLastUpdatedVsyncId;
                                           });
 }
 
@@ -44,8 +44,10 @@ class TransactionTracingTest;
 /*
  * Records all committed transactions into a ring buffer.
  *
- * Transactions come in via the binder thread. They are serialized to proto
- * and stored in a map using the transaction id as key. Main thread will
+ * Transactions come in via the binder thread. They are encoded with protozero
+ * there and stored in a map using the transaction id as key. Entries in the ring
+ * buffer are assembled from these bytes and are written out without being
+ * parsed again. Main thread will
  * pass the list of transaction ids that are committed every vsync and notify
  * the tracing thread. The tracing thread will then wake up and add the
  * committed transactions to the ring buffer.
@@ -163,13 +165,17 @@ private:
         return DIR_NAME + prefix + FILE_NAME;
     }
 
+    using RingBuffer = TransactionRingBuffer<perfetto::protos::TransactionTraceFile,
+                                             perfetto::protos::TransactionTraceEntry>;
+
     mutable std::mutex mTraceLock;
-    TransactionRingBuffer<perfetto::protos::TransactionTraceFile,
-                          perfetto::protos::TransactionTraceEntry>
-            mBuffer GUARDED_BY(mTraceLock);
-    std::unordered_map<uint64_t, perfetto::protos::TransactionState> mQueuedTransactions
-            GUARDED_BY(mTraceLock);
-    LocklessStack<perfetto::protos::TransactionState> mTransactionQueue;
+    RingBuffer mBuffer GUARDED_BY(mTraceLock);
+    struct EncodedTransaction {
+        uint64_t id;
+        std::string bytes; // an encoded perfetto::protos::TransactionState
+    };
+    std::unordered_map<uint64_t, std::string> mQueuedTransactions GUARDED_BY(mTraceLock);
+    LocklessStack<EncodedTransaction> mTransactionQueue;
     nsecs_t mStartingTimestamp GUARDED_BY(mTraceLock);
     std::unordered_map<int, perfetto::protos::LayerCreationArgs> mCreatedLayers
             GUARDED_BY(mTraceLock);
@@ -204,6 +210,11 @@ private:
 
     void writeRingBufferToPerfetto(TransactionTracing::Mode mode);
     perfetto::protos::TransactionTraceFile createTraceFileProto() const;
+    // Returns an encoded TransactionTraceFile holding the starting state and the ring buffer.
+    std::string encodeTraceFileLocked() REQUIRES(mTraceLock);
+    // Returns the starting state and the ring buffer entries. The entries are shared with the ring
+    // buffer rather than copied, so they can be written out after mTraceLock is released.
+    std::vector<RingBuffer::Entry> encodeEntriesLocked() REQUIRES(mTraceLock);
     void loop();
     void addEntry(const std::vector<CommittedUpdates>& committedTransactions,
                   const std::vector<uint32_t>& removedLayers) EXCLUDES(mTraceLock);
@@ -32,6 +32,7 @@
 #include "FrontEnd/RequestedLayerState.h"
 #include "LayerProtoHelper.h"
 #include "QueuedTransactionState.h"
+#include "Tracing/LayerTraceDelta.h"
 #include "Tracing/LayerTracing.h"
 #include "cutils/properties.h"
 
@@ -185,4 +186,17 @@ bool LayerTraceGenerator::generate(const perfetto::protos::TransactionTraceFile&
     return true;
 }
 
+bool LayerTraceGenerator::expandDeltas(perfetto::protos::Trace& trace) {
+    if (trace.packet_size() == 0) {
+        ALOGD("Trace file is empty");
+        return false;
+    }
+
+    ALOGD("Expanding %d packets...", trace.packet_size());
+    if (!LayerTraceDeltaDecoder::decode(trace)) {
+        ALOGW("Dropped layers snapshots recorded before the first keyframe");
+    }
+    return true;
+}
+
 } // namespace android
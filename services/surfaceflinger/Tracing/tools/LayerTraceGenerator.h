@@ -17,6 +17,7 @@
 #pragma once
 
 #include <Tracing/TransactionTracing.h>
+#include <perfetto/trace/trace.pb.h>
 
 #include <functional>
 #include <optional>
@@ -31,5 +32,8 @@ class LayerTraceGenerator {
 public:
     bool generate(const perfetto::protos::TransactionTraceFile&, std::uint32_t traceFlags,
                   LayerTracing& layerTracing, bool onlyLastEntry = false);
+    // Expands the layers snapshots of a perfetto trace written with delta encoding into
+    // complete snapshots.
+    bool expandDeltas(perfetto::protos::Trace&);
 };
 } // namespace android
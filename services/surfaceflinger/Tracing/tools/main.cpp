@@ -26,10 +26,48 @@
 
 using namespace android;
 
+namespace {
+
+int expandDeltas(const char* tracePath, const char* outputTracePath) {
+    std::cout << "Parsing " << tracePath << "\n";
+    std::fstream input(tracePath, std::ios::in | std::ios::binary);
+    if (!input) {
+        std::cout << "Error: Could not open " << tracePath;
+        return -1;
+    }
+
+    perfetto::protos::Trace trace;
+    if (!trace.ParseFromIstream(&input)) {
+        std::cout << "Error: Failed to parse " << tracePath;
+        return -1;
+    }
+
+    std::cout << "Expanding " << outputTracePath << "\n";
+    if (!LayerTraceGenerator().expandDeltas(trace)) {
+        std::cout << "Error: Failed to expand layers trace " << outputTracePath << "\n";
+        return -1;
+    }
+
+    auto outStream = std::ofstream{outputTracePath, std::ios::binary | std::ios::out};
+    if (!trace.SerializeToOstream(&outStream)) {
+        std::cout << "Error: Failed to write " << outputTracePath << "\n";
+        return -1;
+    }
+    return 0;
+}
+
+} // namespace
+
 int main(int argc, char** argv) {
+    if (argc == 4 && std::string_view(argv[1]) == "--expand-deltas") {
+        return expandDeltas(argv[2], argv[3]);
+    }
+
     if (argc > 4) {
         std::cout << "Usage: " << argv[0]
-                  << " [transaction-trace-path] [output-layers-trace-path] [--last-entry-only]\n";
+                  << " [transaction-trace-path] [output-layers-trace-path] [--last-entry-only]\n"
+                  << "       " << argv[0]
+                  << " --expand-deltas perfetto-trace-path output-perfetto-trace-path\n";
         return -1;
     }
 
@@ -154,10 +154,16 @@ status_t TransactionCallbackInvoker::addCallbackHandle(const sp<CallbackHandle>&
                                        "Txn release");
                 }
             }
-            mBufferReleases.emplace_back(handle->name, handle->bufferReleaseChannel,
-                                         handle->previousReleaseCallbackId,
-                                         handle->previousReleaseFence,
-                                         handle->currentMaxAcquiredBufferCount);
+            auto& bufferReleases = mBufferReleases[handle->bufferReleaseChannel.get()];
+            if (!bufferReleases.channel) {
+                bufferReleases.layerName = handle->name;
+                bufferReleases.channel = handle->bufferReleaseChannel;
+            }
+            bufferReleases.messages.emplace_back(handle->previousReleaseCallbackId,
+                                                 handle->previousReleaseFence
+                                                         ? handle->previousReleaseFence
+                                                         : Fence::NO_FENCE,
+                                                 handle->currentMaxAcquiredBufferCount);
         }
     }
     return NO_ERROR;
@@ -168,13 +174,12 @@ void TransactionCallbackInvoker::addPresentFence(sp<Fence> presentFence) {
 }
 
 void TransactionCallbackInvoker::sendCallbacks(bool onCommitOnly) {
-    for (const auto& bufferRelease : mBufferReleases) {
-        status_t status = bufferRelease.channel
-                                  ->writeReleaseFence(bufferRelease.callbackId, bufferRelease.fence,
-                                                      bufferRelease.currentMaxAcquiredBufferCount);
+    // Each channel gets all of its releases of the frame in one write.
+    for (const auto& [_, bufferReleases] : mBufferReleases) {
+        status_t status = bufferReleases.channel->writeReleaseFences(bufferReleases.messages);
         if (status != OK) {
-            ALOGE("[%s] writeReleaseFence failed. error %d (%s)", bufferRelease.layerName.c_str(),
-                  -status, strerror(-status));
+            ALOGE("[%s] writeReleaseFences failed. error %d (%s)",
+                  bufferReleases.layerName.c_str(), -status, strerror(-status));
         }
     }
     mBufferReleases.clear();
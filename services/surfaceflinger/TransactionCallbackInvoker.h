@@ -84,14 +84,14 @@ private:
     std::unordered_map<sp<IBinder>, std::deque<TransactionStats>, IListenerHash>
         mCompletedTransactions;
 
-    struct BufferRelease {
+    // The buffer releases of a channel, written to it together in sendCallbacks.
+    struct BufferReleases {
         std::string layerName;
         std::shared_ptr<gui::BufferReleaseChannel::ProducerEndpoint> channel;
-        ReleaseCallbackId callbackId;
-        sp<Fence> fence;
-        uint32_t currentMaxAcquiredBufferCount;
+        std::vector<gui::BufferReleaseChannel::Message> messages;
     };
-    std::vector<BufferRelease> mBufferReleases;
+    std::unordered_map<const gui::BufferReleaseChannel::ProducerEndpoint*, BufferReleases>
+            mBufferReleases;
 
     sp<Fence> mPresentFence;
 };
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <binder/Binder.h>
+#include <gmock/gmock.h>
+#include <renderengine/mock/RenderEngine.h>
+
+#include "ClientCache.h"
+
+namespace android {
+namespace {
+
+constexpr uint64_t kBuffersPerProcess = 32;
+constexpr int kMaxProcesses = 64;
+
+// Each benchmark thread plays a client process, with its own buffers.
+ClientCache& getClientCache() {
+    static testing::NiceMock<renderengine::mock::RenderEngine> sRenderEngine;
+    static ClientCache& sClientCache = []() -> ClientCache& {
+        static ClientCache cache;
+        cache.setRenderEngine(&sRenderEngine);
+        return cache;
+    }();
+    return sClientCache;
+}
+
+sp<IBinder> addProcess(ClientCache& cache) {
+    sp<IBinder> token = sp<BBinder>::make();
+    for (uint64_t id = 0; id < kBuffersPerProcess; id++) {
+        static_cast<void>(cache.add({token, id}, sp<GraphicBuffer>::make()));
+    }
+    return token;
+}
+
+// Transactions that refer to cached buffers.
+void get(benchmark::State& state) {
+    ClientCache& cache = getClientCache();
+    const sp<IBinder> token = addProcess(cache);
+
+    uint64_t id = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.get({token, id}));
+        id = (id + 1) % kBuffersPerProcess;
+    }
+
+    cache.removeProcess(token);
+}
+BENCHMARK(get)->ThreadRange(1, kMaxProcesses)->UseRealTime();
+
+// Clients replacing their cached buffers.
+void eraseAndAdd(benchmark::State& state) {
+    ClientCache& cache = getClientCache();
+    const sp<IBinder> token = addProcess(cache);
+    const sp<GraphicBuffer> buffer = sp<GraphicBuffer>::make();
+
+    uint64_t id = 0;
+    for (auto _ : state) {
+        cache.erase({token, id});
+        benchmark::DoNotOptimize(cache.add({token, id}, buffer));
+        id = (id + 1) % kBuffersPerProcess;
+    }
+
+    cache.removeProcess(token);
+}
+BENCHMARK(eraseAndAdd)->ThreadRange(1, kMaxProcesses)->UseRealTime();
+
+} // namespace
+} // namespace android
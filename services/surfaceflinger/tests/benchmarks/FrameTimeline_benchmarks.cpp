@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#include <benchmark/benchmark.h>
+
+#include <FrameTimeline/FrameTimeline.h>
+#include <TimeStats/TimeStats.h>
+
+namespace {
+
+// Allocations made by the current thread while counting.
+thread_local bool tCountAllocations = false;
+thread_local size_t tAllocationCount = 0;
+
+} // namespace
+
+void* operator new(size_t size) {
+    if (tCountAllocations) {
+        tAllocationCount++;
+    }
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace android::frametimeline {
+namespace {
+
+constexpr nsecs_t kPeriod = 16'666'666;
+
+// A frame of SurfaceFlinger with the given number of layers, each presenting a buffer. Layer
+// names fit in the small string buffer, so that only FrameTimeline's own allocations count.
+void frame(benchmark::State& state) {
+    const int64_t layerCount = state.range(0);
+    impl::FrameTimeline frameTimeline(std::make_shared<android::impl::TimeStats>(),
+                                      /*surfaceFlingerPid=*/0);
+    TokenManager& tokenManager = *frameTimeline.getTokenManager();
+    const auto presentFence = FenceTime::NO_FENCE;
+    const Fps refreshRate = Fps::fromPeriodNsecs(kPeriod);
+
+    nsecs_t time = 0;
+    auto runFrame = [&] {
+        const int64_t token =
+                tokenManager.generateTokenForPredictions({time, time + kPeriod, time + 2 * kPeriod});
+        frameTimeline.setSfWakeUp(token, time, refreshRate, refreshRate);
+        FrameTimelineInfo info;
+        info.vsyncId = token;
+        for (int32_t layerId = 0; layerId < layerCount; layerId++) {
+            auto surfaceFrame =
+                    frameTimeline.createSurfaceFrameForToken(info, /*ownerPid=*/1, /*ownerUid=*/1,
+                                                             layerId, "layer", "layer",
+                                                             /*isBuffer=*/true, GameMode::Standard);
+            surfaceFrame->setAcquireFenceTime(time + kPeriod);
+            surfaceFrame->setPresentState(SurfaceFrame::PresentState::Presented);
+            frameTimeline.addSurfaceFrame(std::move(surfaceFrame));
+        }
+        frameTimeline.setSfPresent(time + kPeriod, presentFence);
+        time += kPeriod;
+    };
+
+    // Fill the window of DisplayFrames, so that frames are recycled from then on.
+    for (int i = 0; i < 128; i++) {
+        runFrame();
+    }
+
+    tAllocationCount = 0;
+    tCountAllocations = true;
+    for (auto _ : state) {
+        runFrame();
+    }
+    tCountAllocations = false;
+    state.counters["allocations/frame"] =
+            benchmark::Counter(static_cast<double>(tAllocationCount),
+                               benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(frame)->Arg(1)->Arg(8)->Arg(32);
+
+} // namespace
+} // namespace android::frametimeline
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <gmock/gmock.h>
+
+#include <compositionengine/impl/planner/Predictor.h>
+#include <compositionengine/mock/LayerFE.h>
+#include <compositionengine/mock/OutputLayer.h>
+
+namespace android::compositionengine::impl::planner {
+
+namespace {
+
+using aidl::android::hardware::graphics::composer3::Composition;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+constexpr size_t kLayersPerStack = 8;
+constexpr float kAlpha = 1.f;
+constexpr float kRecordedAlpha = 0.5f;
+constexpr float kQueriedAlpha = 0.25f;
+
+// Owns the mocks backing a set of LayerStates.
+class LayerFactory {
+public:
+    const LayerState* createLayer(int32_t id, const Rect& displayFrame, float alpha) {
+        auto& outputLayerState = mOutputLayerStates.emplace_back();
+        outputLayerState.displayFrame = displayFrame;
+        auto& layerFEState = mLayerFEStates.emplace_back();
+        layerFEState.alpha = alpha;
+
+        auto& layerFE = mLayerFEs.emplace_back(sp<NiceMock<mock::LayerFE>>::make());
+        ON_CALL(*layerFE, getSequence()).WillByDefault(Return(id));
+        ON_CALL(*layerFE, getDebugName()).WillByDefault(Return("PredictorBenchmarkLayer"));
+        ON_CALL(*layerFE, getCompositionState()).WillByDefault(Return(&layerFEState));
+
+        auto& outputLayer = mOutputLayers.emplace_back();
+        ON_CALL(outputLayer, getLayerFE()).WillByDefault(ReturnRef(*layerFE));
+        ON_CALL(outputLayer, getState()).WillByDefault(ReturnRef(outputLayerState));
+
+        return &mLayerStates.emplace_back(&outputLayer);
+    }
+
+private:
+    std::deque<OutputLayerCompositionState> mOutputLayerStates;
+    std::deque<LayerFECompositionState> mLayerFEStates;
+    std::vector<sp<NiceMock<mock::LayerFE>>> mLayerFEs;
+    std::deque<NiceMock<mock::OutputLayer>> mOutputLayers;
+    std::deque<LayerState> mLayerStates;
+};
+
+// Returns a stack whose layers all differ from those of any other stack index, optionally with
+// the alpha of the first layer changed.
+std::vector<const LayerState*> createStack(LayerFactory& factory, size_t stackIndex,
+                                           std::optional<float> firstLayerAlpha = std::nullopt) {
+    std::vector<const LayerState*> layers;
+    for (size_t i = 0; i < kLayersPerStack; i++) {
+        const auto id = static_cast<int32_t>(stackIndex * kLayersPerStack + i);
+        const Rect displayFrame(id, id, id + 100, id + 100);
+        const float alpha = (i == 0 && firstLayerAlpha) ? *firstLayerAlpha : kAlpha;
+        layers.push_back(factory.createLayer(id, displayFrame, alpha));
+    }
+    return layers;
+}
+
+// Gives each stack its own plan, so that the similar stacks recorded per plan stay short.
+Plan createPlan(size_t stackIndex) {
+    constexpr Composition kTypes[] = {Composition::DEVICE, Composition::SOLID_COLOR,
+                                      Composition::CURSOR, Composition::SIDEBAND};
+    Plan plan;
+    for (size_t i = 0; i < kLayersPerStack; i++) {
+        plan.addLayerType(kTypes[stackIndex % 4]);
+        stackIndex /= 4;
+    }
+    return plan;
+}
+
+// Records stackCount predictions, each with an approximate stack differing in the alpha of its
+// first layer.
+void populatePredictor(Predictor& predictor, LayerFactory& factory, size_t stackCount) {
+    for (size_t stackIndex = 0; stackIndex < stackCount; stackIndex++) {
+        const Plan plan = createPlan(stackIndex);
+
+        const auto layers = createStack(factory, stackIndex);
+        predictor.recordResult(std::nullopt, getNonBufferHash(layers), layers, false, plan);
+
+        const auto approximateLayers = createStack(factory, stackIndex, kRecordedAlpha);
+        const NonBufferHash approximateHash = getNonBufferHash(approximateLayers);
+        const auto predictedPlan = predictor.getPredictedPlan(approximateLayers, approximateHash);
+        predictor.recordResult(predictedPlan, approximateHash, approximateLayers, false, plan);
+    }
+}
+
+// Looks up a never seen variant of the most recently recorded stack, which only an approximate
+// stack matches.
+void getPredictedPlan_approximateMatch(benchmark::State& state) {
+    const auto stackCount = static_cast<size_t>(state.range(0));
+    LayerFactory factory;
+    Predictor predictor;
+    populatePredictor(predictor, factory, stackCount);
+
+    const auto layers = createStack(factory, stackCount - 1, kQueriedAlpha);
+    const NonBufferHash hash = getNonBufferHash(layers);
+    if (!predictor.getPredictedPlan(layers, hash)) {
+        state.SkipWithError("Expected an approximate match");
+        return;
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(predictor.getPredictedPlan(layers, hash));
+    }
+}
+BENCHMARK(getPredictedPlan_approximateMatch)->Arg(16)->Arg(256)->Arg(1024);
+
+// Looks up a stack that matches nothing.
+void getPredictedPlan_miss(benchmark::State& state) {
+    const auto stackCount = static_cast<size_t>(state.range(0));
+    LayerFactory factory;
+    Predictor predictor;
+    populatePredictor(predictor, factory, stackCount);
+
+    const auto layers = createStack(factory, stackCount);
+    const NonBufferHash hash = getNonBufferHash(layers);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(predictor.getPredictedPlan(layers, hash));
+    }
+}
+BENCHMARK(getPredictedPlan_miss)->Arg(16)->Arg(256)->Arg(1024);
+
+void planHash(benchmark::State& state) {
+    const Plan plan = createPlan(12345);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::hash<Plan>{}(plan));
+    }
+}
+BENCHMARK(planHash);
+
+} // namespace
+} // namespace android::compositionengine::impl::planner
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <numeric>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "RegionSamplingThread.h"
+
+namespace android {
+namespace {
+
+// A navigation bar sized buffer, sampled as a whole and in three overlapping parts, as when
+// several listeners sample the same bar. The argument is the downscale factor of the capture.
+void sampleAreas_navigationBar(benchmark::State& state) {
+    const int32_t factor = static_cast<int32_t>(state.range(0));
+    const int32_t width = 1080 / factor;
+    const int32_t height = 132 / factor;
+    const int32_t stride = width + 8;
+
+    std::vector<uint32_t> buffer(static_cast<size_t>(stride) * height);
+    std::iota(buffer.begin(), buffer.end(), 0x123456);
+
+    const std::vector<Rect> areas = {Rect(0, 0, width, height), Rect(0, 0, width / 3, height),
+                                     Rect(width / 4, 0, 3 * width / 4, height),
+                                     Rect(2 * width / 3, 0, width, height)};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sampleAreas(buffer.data(), width, height, stride, areas));
+    }
+}
+BENCHMARK(sampleAreas_navigationBar)->Arg(1)->Arg(4)->Arg(8);
+
+} // namespace
+} // namespace android
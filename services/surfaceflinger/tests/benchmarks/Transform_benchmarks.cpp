@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <ui/Transform.h>
+
+namespace android {
+namespace {
+
+constexpr size_t kLayerCount = 64;
+
+// The display transform, for a display rotated by the argument, in degrees.
+ui::Transform displayTransform(int64_t degrees) {
+    const auto rotation = ui::toRotation(static_cast<int>(degrees / 90));
+    return ui::Transform(ui::Transform::toRotationFlags(rotation), 1080, 2340);
+}
+
+// Per layer transforms as in an app: mostly translations, with a few scaled layers.
+std::vector<ui::Transform> layerTransforms() {
+    std::vector<ui::Transform> transforms(kLayerCount);
+    for (size_t i = 0; i < kLayerCount; i++) {
+        if (i % 8 == 0) {
+            transforms[i].set(0.5f, 0.f, 0.f, 0.5f);
+        }
+        transforms[i].set(static_cast<float>(i * 10), static_cast<float>(i * 20));
+    }
+    return transforms;
+}
+
+std::vector<Rect> layerBounds() {
+    std::vector<Rect> bounds;
+    for (size_t i = 0; i < kLayerCount; i++) {
+        const int32_t offset = static_cast<int32_t>(i);
+        bounds.emplace_back(offset, offset, 1080 - offset, 200 + offset);
+    }
+    return bounds;
+}
+
+// The geometry each layer snapshot computes: its transform in the display, then its bounds,
+// crop and input region in display space.
+void layerGeometry(benchmark::State& state) {
+    const ui::Transform display = displayTransform(state.range(0));
+    const std::vector<ui::Transform> transforms = layerTransforms();
+    const std::vector<Rect> bounds = layerBounds();
+    for (auto _ : state) {
+        for (size_t i = 0; i < kLayerCount; i++) {
+            const ui::Transform transform = display * transforms[i];
+            benchmark::DoNotOptimize(transform.transform(bounds[i].toFloatRect()));
+            benchmark::DoNotOptimize(transform.transform(bounds[i], true));
+            benchmark::DoNotOptimize(transform.makeBounds(bounds[i].width(), bounds[i].height()));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kLayerCount);
+}
+BENCHMARK(layerGeometry)->ArgName("rotation")->Arg(0)->Arg(90);
+
+// Maps the bounds of all the layers through one transform, one at a time or as one batch.
+void transformRects(benchmark::State& state) {
+    const ui::Transform display = displayTransform(state.range(0));
+    const std::vector<Rect> bounds = layerBounds();
+    std::vector<Rect> mapped(bounds.size());
+    const bool batch = state.range(1) != 0;
+    for (auto _ : state) {
+        if (batch) {
+            display.transform(bounds, mapped);
+        } else {
+            for (size_t i = 0; i < bounds.size(); i++) {
+                mapped[i] = display.transform(bounds[i]);
+            }
+        }
+        benchmark::DoNotOptimize(mapped.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * bounds.size());
+}
+BENCHMARK(transformRects)->ArgNames({"rotation", "batch"})->ArgsProduct({{0, 90}, {0, 1}});
+
+} // namespace
+} // namespace android
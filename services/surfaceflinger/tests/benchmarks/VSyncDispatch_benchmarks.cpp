@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <Scheduler/VSyncDispatchTimerQueue.h>
+#include <Scheduler/VSyncTracker.h>
+#include <scheduler/TimeKeeper.h>
+
+namespace android::scheduler {
+
+namespace {
+
+constexpr nsecs_t kPeriod = 16'666'666;
+constexpr nsecs_t kTimerSlack = 500'000;
+constexpr nsecs_t kMinVsyncDistance = 3'000'000;
+
+class ManualTimeKeeper : public TimeKeeper {
+public:
+    nsecs_t now() const final { return mNow; }
+
+    void alarmAt(std::function<void()> callback, nsecs_t time) final {
+        mCallback = std::move(callback);
+        mAlarmTime = time;
+    }
+
+    void alarmCancel() final { mCallback = nullptr; }
+    void dump(std::string&) const final {}
+
+    // Advances the time to the armed alarm and fires it.
+    void fire() {
+        if (!mCallback) return;
+        mNow = std::max(mNow, mAlarmTime);
+        auto callback = std::move(mCallback);
+        callback();
+    }
+
+    void advanceBy(nsecs_t duration) { mNow += duration; }
+
+private:
+    nsecs_t mNow = 0;
+    nsecs_t mAlarmTime = 0;
+    std::function<void()> mCallback;
+};
+
+class FixedRateTracker : public VSyncTracker {
+public:
+    bool addVsyncTimestamp(nsecs_t) final { return true; }
+    nsecs_t nextAnticipatedVSyncTimeFrom(nsecs_t timePoint, std::optional<nsecs_t>) final {
+        return (timePoint / kPeriod + 1) * kPeriod;
+    }
+    nsecs_t currentPeriod() const final { return kPeriod; }
+    Period minFramePeriod() const final { return Period::fromNs(kPeriod); }
+    bool isCurrentMode(const ftl::NonNull<DisplayModePtr>&) const final { return false; }
+    void resetModel() final {}
+    bool needsMoreSamples() const final { return false; }
+    bool isVSyncInPhase(nsecs_t, Fps) final { return false; }
+    void setDisplayModePtr(ftl::NonNull<DisplayModePtr>) final {}
+    void setRenderRate(Fps, bool) final {}
+    std::optional<Duration> predictionConfidenceInterval() const final { return {}; }
+    void onFrameBegin(TimePoint, FrameTime) final {}
+    void onFrameMissed(TimePoint) final {}
+    void dump(std::string&) const final {}
+};
+
+struct Fixture {
+    explicit Fixture(size_t callbackCount) {
+        auto timeKeeper = std::make_unique<ManualTimeKeeper>();
+        clock = timeKeeper.get();
+        dispatch = std::make_shared<VSyncDispatchTimerQueue>(std::move(timeKeeper),
+                                                             std::make_shared<FixedRateTracker>(),
+                                                             kTimerSlack, kMinVsyncDistance);
+        for (size_t i = 0; i < callbackCount; i++) {
+            tokens.push_back(dispatch->registerCallback([](nsecs_t, nsecs_t, nsecs_t) {},
+                                                        "benchmark"));
+        }
+    }
+
+    ~Fixture() {
+        for (const auto token : tokens) {
+            dispatch->unregisterCallback(token);
+        }
+    }
+
+    // Spread the wakeups of the callbacks across the vsync period.
+    VSyncDispatch::ScheduleTiming timing(size_t i) const {
+        const auto workDuration =
+                static_cast<nsecs_t>(1'000'000 + (i * 7919) % (kPeriod - 2'000'000));
+        return {.workDuration = workDuration, .readyDuration = 0, .lastVsync = clock->now()};
+    }
+
+    ManualTimeKeeper* clock;
+    std::shared_ptr<VSyncDispatchTimerQueue> dispatch;
+    std::vector<VSyncDispatch::CallbackToken> tokens;
+};
+
+static void scheduleCancel(benchmark::State& state) {
+    Fixture fixture(static_cast<size_t>(state.range(0)));
+    for (size_t i = 0; i < fixture.tokens.size(); i++) {
+        fixture.dispatch->schedule(fixture.tokens[i], fixture.timing(i));
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto token = fixture.tokens[i];
+        benchmark::DoNotOptimize(fixture.dispatch->cancel(token));
+        benchmark::DoNotOptimize(fixture.dispatch->schedule(token, fixture.timing(i)));
+        i = (i + 1) % fixture.tokens.size();
+    }
+}
+BENCHMARK(scheduleCancel)->Arg(8)->Arg(128)->Arg(1000);
+
+static void scheduleAndFire(benchmark::State& state) {
+    Fixture fixture(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        for (size_t i = 0; i < fixture.tokens.size(); i++) {
+            fixture.dispatch->schedule(fixture.tokens[i], fixture.timing(i));
+        }
+        fixture.clock->fire();
+        fixture.clock->advanceBy(kPeriod);
+    }
+}
+BENCHMARK(scheduleAndFire)->Arg(8)->Arg(128)->Arg(1000);
+
+} // namespace
+} // namespace android::scheduler
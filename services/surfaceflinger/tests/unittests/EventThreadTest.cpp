@@ -23,7 +23,9 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <gui/VsyncBroadcast.h>
 #include <log/log.h>
+#include <poll.h>
 #include <scheduler/VsyncConfig.h>
 #include <utils/Errors.h>
 
@@ -456,6 +458,86 @@ TEST_F(EventThreadTest, requestNextVsyncEventFrameTimelinesCorrect) {
     expectVsyncEventFrameTimelinesCorrect(123, {-1, 789, 456});
 }
 
+TEST_F(EventThreadTest, connectionsWithSameFrameIntervalGetTheirOwnFrameTimelines) {
+    setupEventThread();
+
+    ConnectionEventRecorder secondConnectionEventRecorder{0};
+    sp<MockEventThreadConnection> secondConnection =
+            createConnection(secondConnectionEventRecorder);
+
+    mThread->requestNextVsync(mConnection);
+    mThread->requestNextVsync(secondConnection);
+    expectVSyncCallbackScheduleReceived(true);
+
+    onVSyncEvent(123, 456, 789);
+
+    auto args = mConnectionEventCallRecorder.waitForCall();
+    ASSERT_TRUE(args.has_value());
+    auto secondArgs = secondConnectionEventRecorder.waitForCall();
+    ASSERT_TRUE(secondArgs.has_value());
+
+    const auto& vsyncData = std::get<0>(args.value()).vsync.vsyncData;
+    const auto& secondVsyncData = std::get<0>(secondArgs.value()).vsync.vsyncData;
+    ASSERT_EQ(vsyncData.frameTimelinesLength, secondVsyncData.frameTimelinesLength);
+    EXPECT_EQ(vsyncData.preferredFrameTimelineIndex, secondVsyncData.preferredFrameTimelineIndex);
+    for (size_t i = 0; i < vsyncData.frameTimelinesLength; i++) {
+        EXPECT_EQ(vsyncData.frameTimelines[i].expectedPresentationTime,
+                  secondVsyncData.frameTimelines[i].expectedPresentationTime);
+        EXPECT_NE(vsyncData.frameTimelines[i].vsyncId, secondVsyncData.frameTimelines[i].vsyncId)
+                << "Frame timeline " << i << " shares its token with another connection";
+    }
+}
+
+TEST_F(EventThreadTest, vsyncBroadcastRequiresRegistration) {
+    setupEventThread();
+
+    gui::VsyncBroadcastChannel channel;
+    EXPECT_EQ(INVALID_OPERATION, mThread->enableVsyncBroadcast(mConnection, &channel));
+}
+
+TEST_F(EventThreadTest, broadcastConnectionReadsVsyncFromSharedMemory) {
+    setupEventThread();
+
+    ConnectionEventRecorder broadcastConnectionEventRecorder{0};
+    sp<MockEventThreadConnection> broadcastConnection =
+            createConnection(broadcastConnectionEventRecorder,
+                             gui::ISurfaceComposer::EventRegistration::vsyncBroadcast);
+
+    gui::VsyncBroadcastChannel channel;
+    ASSERT_EQ(NO_ERROR, mThread->enableVsyncBroadcast(broadcastConnection, &channel));
+    EXPECT_EQ(ALREADY_EXISTS, mThread->enableVsyncBroadcast(broadcastConnection, &channel));
+    std::unique_ptr<gui::VsyncBroadcastReceiver> receiver;
+    ASSERT_EQ(NO_ERROR, gui::VsyncBroadcastReceiver::open(std::move(channel), receiver));
+
+    mThread->requestNextVsync(mConnection);
+    mThread->requestNextVsync(broadcastConnection);
+    expectVSyncCallbackScheduleReceived(true);
+
+    onVSyncEvent(123, 456, 789);
+
+    auto args = mConnectionEventCallRecorder.waitForCall();
+    ASSERT_TRUE(args.has_value());
+
+    pollfd fd{.fd = receiver->getFd(), .events = POLLIN, .revents = 0};
+    ASSERT_EQ(1, poll(&fd, 1, 1000));
+    DisplayEventReceiver::Event event;
+    ASSERT_EQ(NO_ERROR, receiver->readVsync(event));
+    EXPECT_EQ(WOULD_BLOCK, receiver->readVsync(event));
+    EXPECT_FALSE(broadcastConnectionEventRecorder.waitForUnexpectedCall().has_value());
+
+    // Both connections have the same frame interval, but their own prediction tokens.
+    const auto& vsyncData = std::get<0>(args.value()).vsync.vsyncData;
+    EXPECT_EQ(DisplayEventType::DISPLAY_EVENT_VSYNC, event.header.type);
+    EXPECT_EQ(123, event.header.timestamp);
+    ASSERT_EQ(vsyncData.frameTimelinesLength, event.vsync.vsyncData.frameTimelinesLength);
+    for (size_t i = 0; i < vsyncData.frameTimelinesLength; i++) {
+        EXPECT_EQ(vsyncData.frameTimelines[i].expectedPresentationTime,
+                  event.vsync.vsyncData.frameTimelines[i].expectedPresentationTime);
+        EXPECT_NE(vsyncData.frameTimelines[i].vsyncId,
+                  event.vsync.vsyncData.frameTimelines[i].vsyncId);
+    }
+}
+
 TEST_F(EventThreadTest, requestNextVsyncEventFrameTimelinesValidLength) {
     setupEventThread();
     // The VsyncEventData should not have kFrameTimelinesCapacity amount of valid frame timelines,
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "LayerTraceDeltaTest"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+
+#include "Tracing/LayerTraceDelta.h"
+
+namespace android {
+namespace {
+
+using perfetto::protos::LayersSnapshotProto;
+
+// Layer id to z order.
+using Layers = std::map<int32_t, int32_t>;
+
+LayersSnapshotProto makeSnapshot(int64_t vsyncId, const Layers& layers) {
+    LayersSnapshotProto snapshot;
+    snapshot.set_vsync_id(vsyncId);
+    snapshot.set_where("visibleRegionsDirty");
+    for (const auto& [id, z] : layers) {
+        auto* layer = snapshot.mutable_layers()->add_layers();
+        layer->set_id(id);
+        layer->set_name("layer " + std::to_string(id));
+        layer->set_z(z);
+    }
+    return snapshot;
+}
+
+LayersSnapshotProto encode(LayerTraceDeltaEncoder& encoder, LayersSnapshotProto snapshot) {
+    const std::string bytes = encoder.encode(snapshot);
+    LayersSnapshotProto encoded;
+    EXPECT_TRUE(encoded.ParseFromString(bytes));
+    return encoded;
+}
+
+Layers getLayers(const LayersSnapshotProto& snapshot) {
+    Layers layers;
+    for (const auto& layer : snapshot.layers().layers()) {
+        layers[layer.id()] = layer.z();
+    }
+    return layers;
+}
+
+TEST(LayerTraceDeltaTest, deltaHoldsChangedLayers) {
+    LayerTraceDeltaEncoder encoder(/*keyframeInterval=*/10);
+
+    const auto keyframe = encode(encoder, makeSnapshot(1, {{1, 0}, {2, 0}, {3, 0}}));
+    EXPECT_FALSE(LayerTraceDeltaDecoder::isDelta(keyframe));
+    EXPECT_EQ(3, keyframe.layers().layers_size());
+
+    // Layer 2 changed, layer 3 was removed and layer 4 was added.
+    const auto delta = encode(encoder, makeSnapshot(2, {{1, 0}, {2, 1}, {4, 0}}));
+    ASSERT_TRUE(LayerTraceDeltaDecoder::isDelta(delta));
+    EXPECT_EQ(2, delta.vsync_id());
+    ASSERT_EQ(3, delta.layers().layers_size());
+    EXPECT_EQ(2, delta.layers().layers(0).id());
+    EXPECT_EQ(4, delta.layers().layers(1).id());
+    EXPECT_EQ(3, delta.layers().layers(2).id());
+    EXPECT_FALSE(delta.layers().layers(2).has_name());
+
+    const auto unchanged = encode(encoder, makeSnapshot(3, {{1, 0}, {2, 1}, {4, 0}}));
+    EXPECT_TRUE(LayerTraceDeltaDecoder::isDelta(unchanged));
+    EXPECT_EQ(0, unchanged.layers().layers_size());
+}
+
+TEST(LayerTraceDeltaTest, encodeLeavesSnapshotAsItWas) {
+    LayerTraceDeltaEncoder encoder(/*keyframeInterval=*/10);
+    for (int64_t vsyncId = 0; vsyncId < 2; vsyncId++) {
+        auto snapshot = makeSnapshot(vsyncId, {{1, 0}, {2, static_cast<int32_t>(vsyncId)}});
+        const std::string bytes = snapshot.SerializeAsString();
+        encoder.encode(snapshot);
+        EXPECT_EQ(bytes, snapshot.SerializeAsString()) << vsyncId;
+    }
+}
+
+TEST(LayerTraceDeltaTest, writesKeyframes) {
+    LayerTraceDeltaEncoder encoder(/*keyframeInterval=*/3);
+    for (int64_t vsyncId = 0; vsyncId < 7; vsyncId++) {
+        const auto snapshot = encode(encoder, makeSnapshot(vsyncId, {{1, 0}}));
+        EXPECT_EQ(vsyncId % 3 != 0, LayerTraceDeltaDecoder::isDelta(snapshot)) << vsyncId;
+    }
+
+    encoder.requestKeyframe();
+    const auto snapshot = encode(encoder, makeSnapshot(7, {{1, 0}}));
+    EXPECT_FALSE(LayerTraceDeltaDecoder::isDelta(snapshot));
+}
+
+TEST(LayerTraceDeltaTest, decodeExpandsDeltas) {
+    const std::vector<Layers> frames = {{{1, 0}, {2, 0}, {3, 0}},
+                                        {{1, 0}, {2, 1}, {4, 0}},
+                                        {{1, 0}, {2, 1}, {4, 0}},
+                                        {{2, 2}},
+                                        {{2, 2}, {3, 5}},
+                                        {{1, 0}, {2, 2}, {3, 5}}};
+
+    LayerTraceDeltaEncoder encoder(/*keyframeInterval=*/4);
+    perfetto::protos::Trace trace;
+    for (size_t i = 0; i < frames.size(); i++) {
+        auto* packet = trace.add_packet();
+        *packet->mutable_surfaceflinger_layers_snapshot() =
+                encode(encoder, makeSnapshot(static_cast<int64_t>(i), frames[i]));
+        // Packets of other data sources are left as they are.
+        trace.add_packet()->set_timestamp(i);
+    }
+
+    ASSERT_TRUE(LayerTraceDeltaDecoder::decode(trace));
+    ASSERT_EQ(static_cast<int>(frames.size() * 2), trace.packet_size());
+    for (size_t i = 0; i < frames.size(); i++) {
+        const auto& packet = trace.packet(static_cast<int>(i * 2));
+        ASSERT_TRUE(packet.has_surfaceflinger_layers_snapshot());
+        const auto& entry = packet.surfaceflinger_layers_snapshot();
+        EXPECT_FALSE(LayerTraceDeltaDecoder::isDelta(entry));
+        EXPECT_EQ("visibleRegionsDirty", entry.where());
+        EXPECT_EQ(static_cast<int64_t>(i), entry.vsync_id());
+        EXPECT_EQ(frames[i], getLayers(entry)) << i;
+        EXPECT_EQ(i, trace.packet(static_cast<int>(i * 2 + 1)).timestamp());
+    }
+}
+
+TEST(LayerTraceDeltaTest, decodeDropsDeltasWithoutKeyframe) {
+    LayerTraceDeltaEncoder encoder(/*keyframeInterval=*/3);
+    perfetto::protos::Trace trace;
+    for (int64_t vsyncId = 0; vsyncId < 5; vsyncId++) {
+        auto snapshot =
+                encode(encoder, makeSnapshot(vsyncId, {{1, static_cast<int32_t>(vsyncId)}}));
+        // The first keyframe was overwritten in the trace buffer.
+        if (vsyncId > 0) {
+            *trace.add_packet()->mutable_surfaceflinger_layers_snapshot() = std::move(snapshot);
+        }
+    }
+
+    EXPECT_FALSE(LayerTraceDeltaDecoder::decode(trace));
+    ASSERT_EQ(2, trace.packet_size());
+    const auto& first = trace.packet(0).surfaceflinger_layers_snapshot();
+    EXPECT_EQ(3, first.vsync_id());
+    EXPECT_EQ((Layers{{1, 3}}), getLayers(first));
+    const auto& second = trace.packet(1).surfaceflinger_layers_snapshot();
+    EXPECT_EQ(4, second.vsync_id());
+    EXPECT_EQ((Layers{{1, 4}}), getLayers(second));
+}
+
+} // namespace
+} // namespace android
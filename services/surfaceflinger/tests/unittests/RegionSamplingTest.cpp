@@ -106,6 +106,45 @@ TEST_F(RegionSamplingTest, bounds_checking) {
                 testing::Eq(0.0));
 }
 
+TEST_F(RegionSamplingTest, sample_areas_matches_individual_areas) {
+    std::generate(buffer.begin(), buffer.end(), [n = 0]() mutable {
+        uint32_t const pixel = (n % std::numeric_limits<uint8_t>::max()) << ((n % 3) * CHAR_BIT);
+        n++;
+        return pixel;
+    });
+
+    // Overlapping areas, with widths that are not a multiple of the vector size.
+    std::vector<Rect> const areas = {whole_area,       {3, 2, 50, 20},  {10, 5, 97, 29},
+                                     {0, 0, 1, 1},     {40, 0, 41, 29}, {0, 0, 4, kHeight + 1},
+                                     {20, 10, 20, 20}};
+    std::vector<float> const lumas = sampleAreas(buffer.data(), kWidth, kHeight, kStride, areas);
+    ASSERT_EQ(areas.size(), lumas.size());
+    for (size_t i = 0; i < areas.size(); i++) {
+        EXPECT_THAT(lumas[i],
+                    testing::FloatEq(sampleArea(buffer.data(), kWidth, kHeight, kStride,
+                                                kOrientation, areas[i])))
+                << "area " << i;
+    }
+
+    // Out of bounds and empty areas.
+    EXPECT_THAT(lumas[5], testing::Eq(0.0f));
+    EXPECT_THAT(lumas[6], testing::Eq(0.0f));
+}
+
+TEST_F(RegionSamplingTest, sample_areas_separate_regions) {
+    auto const halfway_down = kHeight >> 1;
+    auto const half = halfway_down * kStride;
+    std::fill(buffer.begin(), buffer.begin() + half, kBlack);
+    std::fill(buffer.begin() + half, buffer.end(), kWhite);
+
+    std::vector<Rect> const areas = {{0, 0, kWidth, halfway_down},
+                                     {0, halfway_down, kWidth, kHeight},
+                                     {0, halfway_down - 1, kWidth, halfway_down + 1}};
+    EXPECT_THAT(sampleAreas(buffer.data(), kWidth, kHeight, kStride, areas),
+                testing::ElementsAre(testing::FloatEq(0.0f), testing::FloatEq(1.0f),
+                                     testing::FloatEq(0.5f)));
+}
+
 } // namespace android
 
 // TODO(b/129481165): remove the #pragma below and fix conversion issues
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <android-base/file.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -47,6 +48,15 @@ protected:
         return entry;
     }
 
+    // Returns whether the entries written out when flushing are the ring buffer's own entries.
+    bool flushedEntriesAreShared() {
+        std::scoped_lock<std::mutex> lock(mTracing.mTraceLock);
+        const auto entries = mTracing.encodeEntriesLocked();
+        const auto& bufferEntries = mTracing.mBuffer.entries();
+        return std::equal(entries.begin(), entries.end(), bufferEntries.begin(),
+                          bufferEntries.end());
+    }
+
     void queueAndCommitTransaction(int64_t vsyncId) {
         frontend::Update update;
         QueuedTransactionState transaction;
@@ -124,6 +134,13 @@ TEST_F(TransactionTracingTest, addTransactions) {
     verifyEntry(proto.entry(1), secondUpdate.transactions, secondTransactionSetVsyncId);
 }
 
+TEST_F(TransactionTracingTest, flushSharesRingBufferEntries) {
+    for (int64_t vsyncId = 1; vsyncId <= 3; vsyncId++) {
+        queueAndCommitTransaction(vsyncId);
+    }
+    EXPECT_TRUE(flushedEntriesAreShared());
+}
+
 class TransactionTracingLayerHandlingTest : public TransactionTracingTest {
 protected:
     void SetUp() override {
@@ -261,6 +278,30 @@ TEST_F(TransactionTracingLayerHandlingTest, startingStateSurvivesBufferFlush) {
     EXPECT_TRUE(proto.entry(0).displays_changed());
 }
 
+TEST_F(TransactionTracingLayerHandlingTest, writeToFileMatchesProto) {
+    // add transactions until the buffer holds a starting state
+    while (bufferFront().vsync_id() <= VSYNC_ID_SECOND_LAYER_CHANGE) {
+        queueAndCommitTransaction(++mVsyncId);
+    }
+
+    TemporaryFile file;
+    ASSERT_EQ(mTracing.writeToFile(file.path), NO_ERROR);
+    std::string output;
+    ASSERT_TRUE(base::ReadFileToString(file.path, &output));
+    perfetto::protos::TransactionTraceFile fileProto;
+    ASSERT_TRUE(fileProto.ParseFromString(output));
+
+    perfetto::protos::TransactionTraceFile proto = writeToProto();
+    EXPECT_EQ(fileProto.magic_number(), proto.magic_number());
+    EXPECT_EQ(fileProto.version(), proto.version());
+    ASSERT_EQ(fileProto.entry().size(), proto.entry().size());
+    for (int i = 0; i < proto.entry().size(); i++) {
+        EXPECT_EQ(fileProto.entry(i).vsync_id(), proto.entry(i).vsync_id());
+        EXPECT_EQ(fileProto.entry(i).transactions().size(), proto.entry(i).transactions().size());
+    }
+    EXPECT_EQ(fileProto.entry(0).transactions(0).layer_changes(0).z(), 41);
+}
+
 class TransactionTracingMirrorLayerTest : public TransactionTracingTest {
 protected:
     void SetUp() override {
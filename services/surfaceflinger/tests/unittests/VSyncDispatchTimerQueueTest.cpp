@@ -1103,6 +1103,46 @@ TEST_F(VSyncDispatchTimerQueueTest, laggedTimerGroupsCallbacksWithinLag) {
     EXPECT_THAT(cb2.mReadyTime[0], Eq(1000));
 }
 
+TEST_F(VSyncDispatchTimerQueueTest, dispatchesCallbacksWithinTimerSlackTogether) {
+    auto dispatch =
+            std::make_shared<VSyncDispatchTimerQueue>(createTimeKeeper(), mStubTracker,
+                                                      /*timerSlack*/ 50, mVsyncMoveThreshold);
+    CountingCallback cb1(dispatch);
+    CountingCallback cb2(dispatch);
+
+    EXPECT_CALL(mMockClock, alarmAt(_, 600));
+    dispatch->schedule(cb1, {.workDuration = 400, .readyDuration = 0, .lastVsync = 1000});
+    dispatch->schedule(cb2, {.workDuration = 390, .readyDuration = 0, .lastVsync = 1000});
+
+    mMockClock.advanceBy(600);
+    EXPECT_THAT(cb1.mCalls.size(), Eq(1));
+    EXPECT_THAT(cb2.mCalls.size(), Eq(1));
+}
+
+TEST_F(VSyncDispatchTimerQueueTest, timerSlackTightenedByPredictionConfidence) {
+    ON_CALL(*mStubTracker, predictionConfidenceInterval())
+            .WillByDefault(Return(Duration::fromNs(5)));
+    auto dispatch =
+            std::make_shared<VSyncDispatchTimerQueue>(createTimeKeeper(), mStubTracker,
+                                                      /*timerSlack*/ 50, mVsyncMoveThreshold);
+    CountingCallback cb1(dispatch);
+    CountingCallback cb2(dispatch);
+
+    Sequence seq;
+    EXPECT_CALL(mMockClock, alarmAt(_, 600)).InSequence(seq);
+    EXPECT_CALL(mMockClock, alarmAt(_, 610)).InSequence(seq);
+    dispatch->schedule(cb1, {.workDuration = 400, .readyDuration = 0, .lastVsync = 1000});
+    dispatch->schedule(cb2, {.workDuration = 390, .readyDuration = 0, .lastVsync = 1000});
+
+    // cb2 wakes up 10ns after cb1, which is beyond the slack the tracker is confident about.
+    mMockClock.advanceBy(600);
+    EXPECT_THAT(cb1.mCalls.size(), Eq(1));
+    EXPECT_THAT(cb2.mCalls.size(), Eq(0));
+
+    mMockClock.advanceBy(10);
+    EXPECT_THAT(cb2.mCalls.size(), Eq(1));
+}
+
 TEST_F(VSyncDispatchTimerQueueTest, basicAlarmSettingFutureWithReadyDuration) {
     auto intended = mPeriod - 230;
     EXPECT_CALL(mMockClock, alarmAt(_, 900));
@@ -1509,6 +1549,61 @@ TEST_F(VSyncDispatchTimerQueueEntryTest, runCallbackWithReadyDuration) {
     EXPECT_THAT(*lastCalledTarget, Eq(mPeriod));
 }
 
+using Token = VSyncDispatch::CallbackToken;
+
+TEST(VSyncWakeupQueueTest, popsInWakeupOrder) {
+    VSyncWakeupQueue queue;
+    queue.set(Token(1), 300);
+    queue.set(Token(2), 100);
+    queue.set(Token(3), 200);
+    ASSERT_EQ(3u, queue.size());
+
+    EXPECT_EQ(Token(2), queue.pop()->token);
+    EXPECT_EQ(Token(3), queue.pop()->token);
+    EXPECT_EQ(Token(1), queue.pop()->token);
+    EXPECT_FALSE(queue.pop().has_value());
+}
+
+TEST(VSyncWakeupQueueTest, breaksTiesByToken) {
+    VSyncWakeupQueue queue;
+    queue.set(Token(5), 100);
+    queue.set(Token(2), 100);
+    queue.set(Token(9), 100);
+
+    EXPECT_EQ(Token(2), queue.pop()->token);
+    EXPECT_EQ(Token(5), queue.pop()->token);
+    EXPECT_EQ(Token(9), queue.pop()->token);
+}
+
+TEST(VSyncWakeupQueueTest, movesAndErasesWakeups) {
+    VSyncWakeupQueue queue;
+    for (size_t i = 1; i <= 8; i++) {
+        queue.set(Token(i), static_cast<nsecs_t>(i * 100));
+    }
+
+    queue.set(Token(8), 50);
+    EXPECT_EQ(Token(8), queue.top()->token);
+    EXPECT_EQ(50, queue.top()->time);
+
+    queue.set(Token(8), 1000);
+    EXPECT_EQ(Token(1), queue.top()->token);
+
+    queue.erase(Token(1));
+    queue.erase(Token(4));
+    queue.erase(Token(42));
+    EXPECT_FALSE(queue.contains(Token(1)));
+    EXPECT_TRUE(queue.contains(Token(8)));
+    EXPECT_EQ(6u, queue.size());
+    EXPECT_THAT(queue.tokens(), ElementsAre(Token(2), Token(3), Token(5), Token(6), Token(7),
+                                            Token(8)));
+
+    nsecs_t last = 0;
+    while (const auto wakeup = queue.pop()) {
+        EXPECT_GE(wakeup->time, last);
+        last = wakeup->time;
+    }
+}
+
 } // namespace android::scheduler
 
 // TODO(b/129481165): remove the #pragma below and fix conversion issues
@@ -1129,6 +1129,119 @@ TEST_F(VSyncPredictorTest, adjustsOnlyMinFrameViolatingVrrTimeline) {
     // Enough time without adjusting vsync to present with new rate on time, no need of adjustment
     EXPECT_EQ(5500, vrrTracker.nextAnticipatedVSyncTimeFrom(4000, 3500));
 }
+
+TEST(RobustVsyncModelTest, tracksRealTraceData) {
+    // Same trace as robustToDuplicateTimestamps_60hzRealTraceData, which contains both duplicate
+    // and late timestamps.
+    std::vector<nsecs_t> const simulatedVsyncs{
+            198353408177, 198370074844, 198371400000, 198374274000, 198390941000, 198407565000,
+            198540887994, 198607538588, 198624218276, 198657655939, 198674224176, 198690880955,
+            198724204319, 198740988133, 198758166681, 198790869196, 198824205052, 198840871678,
+            198857715631, 198890885797, 198924199640, 198940873834, 198974204401,
+    };
+    auto constexpr idealPeriod = 16'666'666;
+    auto constexpr kTolerance = 100'000;
+
+    RobustVsyncModel model(20);
+    model.reset(idealPeriod);
+    for (auto const& timestamp : simulatedVsyncs) {
+        model.addSample(timestamp);
+    }
+    EXPECT_THAT(model.slope(), IsCloseTo(idealPeriod, kTolerance));
+    EXPECT_THAT(model.anchor(), IsCloseTo(simulatedVsyncs.back(), model.confidenceInterval()));
+}
+
+TEST(RobustVsyncModelTest, boundsEffectOfOutliers) {
+    auto constexpr idealPeriod = 16'666'666;
+    auto constexpr kOutlierIndex = 20;
+    auto constexpr kOutlierError = 7'000'000;
+
+    RobustVsyncModel model(20);
+    model.reset(idealPeriod);
+    for (nsecs_t i = 0; i < 40; i++) {
+        model.addSample(i * idealPeriod + (i == kOutlierIndex ? kOutlierError : 0));
+    }
+    EXPECT_THAT(model.slope(), IsCloseTo(idealPeriod, 10'000));
+    EXPECT_THAT(model.anchor(), IsCloseTo(39 * idealPeriod, 50'000));
+}
+
+TEST(RobustVsyncModelTest, adaptsToActualPeriod) {
+    auto constexpr idealPeriod = 16'666'666;
+    auto constexpr actualPeriod = 16'000'000;
+
+    RobustVsyncModel model(20);
+    model.reset(idealPeriod);
+    for (nsecs_t i = 0; i < 40; i++) {
+        model.addSample(i * actualPeriod);
+    }
+    EXPECT_THAT(model.slope(), IsCloseTo(actualPeriod, 10'000));
+}
+
+TEST(RobustVsyncModelTest, confidenceIntervalNarrowsWithConsistentSamples) {
+    auto constexpr idealPeriod = 16'666'666;
+
+    RobustVsyncModel model(20);
+    model.reset(idealPeriod);
+    model.addSample(0);
+    const auto initialConfidence = model.confidenceInterval();
+    for (nsecs_t i = 1; i < 200; i++) {
+        model.addSample(i * idealPeriod);
+    }
+    EXPECT_LT(model.confidenceInterval(), initialConfidence);
+    EXPECT_LT(model.confidenceInterval(), 200'000);
+}
+
+TEST_F(VSyncPredictorTest, noConfidenceIntervalWithoutRobustModel) {
+    for (auto i = 0u; i < kMinimumSamplesForPrediction; i++) {
+        tracker.addVsyncTimestamp(mNow += mPeriod);
+    }
+    EXPECT_FALSE(tracker.predictionConfidenceInterval().has_value());
+}
+
+TEST_F(VSyncPredictorTest, predictsWithRobustModelWhenEnabled) {
+    VSyncPredictor robustTracker{std::make_unique<ClockWrapper>(mClock), mMode, kHistorySize,
+                                 kMinimumSamplesForPrediction, kOutlierTolerancePercent,
+                                 /*useRobustModel*/ true};
+    RobustVsyncModel model(kHistorySize);
+    model.reset(mPeriod);
+
+    // Jittery timestamps, for which the robust model and the regression disagree slightly.
+    for (size_t i = 1; i <= 2 * kHistorySize; i++) {
+        const nsecs_t timestamp = static_cast<nsecs_t>(i) * mPeriod + (i % 3 == 0 ? 40 : 0);
+        EXPECT_TRUE(robustTracker.addVsyncTimestamp(timestamp));
+        model.addSample(timestamp);
+    }
+
+    EXPECT_EQ(model.slope(), robustTracker.getVSyncPredictionModel().slope);
+    const auto confidence = robustTracker.predictionConfidenceInterval();
+    ASSERT_TRUE(confidence.has_value());
+    EXPECT_EQ(model.confidenceInterval(), confidence->ns());
+}
+
+TEST_F(VSyncPredictorTest, noConfidenceIntervalBeforeEnoughSamples) {
+    VSyncPredictor robustTracker{std::make_unique<ClockWrapper>(mClock), mMode, kHistorySize,
+                                 kMinimumSamplesForPrediction, kOutlierTolerancePercent,
+                                 /*useRobustModel*/ true};
+    for (auto i = 0u; i < kMinimumSamplesForPrediction - 1; i++) {
+        robustTracker.addVsyncTimestamp(mNow += mPeriod);
+        EXPECT_FALSE(robustTracker.predictionConfidenceInterval().has_value());
+    }
+    robustTracker.addVsyncTimestamp(mNow += mPeriod);
+    EXPECT_TRUE(robustTracker.predictionConfidenceInterval().has_value());
+}
+
+TEST_F(VSyncPredictorTest, robustModelPredictsOnVsyncsAfterHistoryWraps) {
+    VSyncPredictor robustTracker{std::make_unique<ClockWrapper>(mClock), mMode, kHistorySize,
+                                 kMinimumSamplesForPrediction, kOutlierTolerancePercent,
+                                 /*useRobustModel*/ true};
+    // The intercept is relative to the oldest sample, which moves through the ring buffer.
+    for (size_t i = 0; i < 3 * kHistorySize + 1; i++) {
+        EXPECT_TRUE(robustTracker.addVsyncTimestamp(mNow += mPeriod));
+        if (i + 1 >= kMinimumSamplesForPrediction) {
+            EXPECT_EQ(mNow + mPeriod, robustTracker.nextAnticipatedVSyncTimeFrom(mNow + 1));
+        }
+    }
+}
 } // namespace android::scheduler
 
 // TODO(b/129481165): remove the #pragma below and fix conversion issues